@@ -0,0 +1,45 @@
+# - Try to find Zstandard
+# Once done this will define
+#
+#  Zstd_FOUND - System has zstd
+#  Zstd_INCLUDE_DIRS - The zstd include directories
+#  Zstd_LIBRARIES - The libraries needed to use zstd
+#  Zstd_VERSION - the zstd version
+#
+
+find_package(PkgConfig)
+pkg_check_modules(PC_Zstd QUIET libzstd)
+
+find_path(Zstd_INCLUDE_DIR NAMES zstd.h
+          HINTS ${PC_Zstd_INCLUDE_DIRS}
+          PATHS
+          /usr/include
+          /usr/local/include )
+
+find_library(Zstd_LIBRARY
+             NAMES zstd libzstd
+             HINTS ${PC_Zstd_LIBRARY_DIRS}
+             PATHS
+             /usr/lib
+             /usr/local/lib )
+
+set(Zstd_VERSION ${PC_Zstd_VERSION})
+# without pkg-config take the version from the header
+if(NOT Zstd_VERSION AND Zstd_INCLUDE_DIR)
+    file(STRINGS "${Zstd_INCLUDE_DIR}/zstd.h" Zstd_VERSION_LINES REGEX "^#define ZSTD_VERSION_(MAJOR|MINOR|RELEASE) ")
+    string(REGEX REPLACE ".*MAJOR +([0-9]+).*MINOR +([0-9]+).*RELEASE +([0-9]+).*" "\\1.\\2.\\3" Zstd_VERSION "${Zstd_VERSION_LINES}")
+endif()
+
+include(FindPackageHandleStandardArgs)
+# handle the QUIETLY and REQUIRED arguments and set Zstd_FOUND to TRUE
+# if all listed variables are TRUE
+# Note that `FOUND_VAR Zstd_FOUND` is needed for cmake 3.2 and older.
+find_package_handle_standard_args(Zstd
+                                  FOUND_VAR Zstd_FOUND
+                                  REQUIRED_VARS Zstd_LIBRARY Zstd_INCLUDE_DIR
+                                  VERSION_VAR Zstd_VERSION)
+
+mark_as_advanced(Zstd_LIBRARY Zstd_INCLUDE_DIR Zstd_VERSION)
+
+set(Zstd_LIBRARIES ${Zstd_LIBRARY} )
+set(Zstd_INCLUDE_DIRS ${Zstd_INCLUDE_DIR} )
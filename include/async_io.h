@@ -0,0 +1,93 @@
+/** @file
+    Asynchronous read-ahead and write-behind for sample files.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_ASYNC_IO_H_
+#define INCLUDE_ASYNC_IO_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define ASYNC_READER_BLOCK_LEN  (1024 * 1024)     ///< bytes per read-ahead block
+#define ASYNC_READER_BLOCKS     3                 ///< read-ahead blocks, one in use and two filling
+#define ASYNC_WRITER_BUFFER_LEN (2 * 1024 * 1024) ///< bytes per write-behind buffer
+#define ASYNC_WRITER_BUFFERS    4                 ///< write-behind buffers
+
+/// Read or write up to @p len bytes, returns the number of bytes transferred, 0 at the end of input or on error.
+typedef size_t (*async_io_fn)(void *ctx, void *buf, size_t len);
+
+/// I/O statistics, only updated on the thread using the reader or writer.
+typedef struct async_io_stats {
+    uint64_t read_bytes;    ///< bytes passed to the reader
+    uint64_t read_wait_ns;  ///< time the reader waited for input
+    uint64_t write_bytes;   ///< bytes passed to the writers
+    uint64_t write_wait_ns; ///< time the writers waited for output to complete
+} async_io_stats_t;
+
+typedef struct async_reader async_reader_t;
+
+typedef struct async_writer async_writer_t;
+
+/// Read from a FILE, pass the FILE as ctx.
+size_t async_io_fread(void *ctx, void *buf, size_t len);
+
+/// Write to a FILE, pass the FILE as ctx.
+size_t async_io_fwrite(void *ctx, void *buf, size_t len);
+
+/** Start reading ahead on a background thread.
+
+    Without threads the reads happen when requested.
+
+    @param read_fn the input, called on the background thread
+    @param ctx passed to @p read_fn
+    @param stats the statistics to add to, may be NULL
+    @return the reader, or NULL on alloc failure
+*/
+async_reader_t *async_reader_create(async_io_fn read_fn, void *ctx, async_io_stats_t *stats);
+
+/** Read when requested, without a background thread.
+
+    For live input, e.g. a pipe, where reading ahead only adds latency.
+
+    @param read_fn the input
+    @param ctx passed to @p read_fn
+    @param stats the statistics to add to, may be NULL
+    @return the reader, or NULL on alloc failure
+*/
+async_reader_t *async_reader_create_direct(async_io_fn read_fn, void *ctx, async_io_stats_t *stats);
+
+/// Read up to @p nmemb elements of @p size bytes like fread(), returns the number of elements read.
+size_t async_reader_read(async_reader_t *reader, void *ptr, size_t size, size_t nmemb);
+
+/// Stop reading ahead and free the reader, the input is not closed. NULL is ignored.
+void async_reader_free(async_reader_t *reader);
+
+/** Start writing behind on a background thread.
+
+    Without threads the writes happen when a buffer is full.
+
+    @param write_fn the output, called on the background thread
+    @param ctx passed to @p write_fn
+    @param stats the statistics to add to, may be NULL
+    @return the writer, or NULL on alloc failure
+*/
+async_writer_t *async_writer_create(async_io_fn write_fn, void *ctx, async_io_stats_t *stats);
+
+/// Queue @p len bytes for output, returns 0 on success, -1 if an earlier write failed.
+int async_writer_write(async_writer_t *writer, void const *data, size_t len);
+
+/// Wait for all queued output to be written, returns 0 on success, -1 if a write failed.
+int async_writer_flush(async_writer_t *writer);
+
+/// Flush and free the writer, the output is not closed. NULL is ignored.
+void async_writer_free(async_writer_t *writer);
+
+#endif /* INCLUDE_ASYNC_IO_H_ */
@@ -137,7 +137,51 @@ void baseband_demod_FM(demodfm_state_t *state, uint8_t const *x_buf, int16_t *y_
 /// For evaluation.
 void baseband_demod_FM_cs16(demodfm_state_t *state, int16_t const *x_buf, int16_t *y_buf, unsigned long num_samples, uint32_t samp_rate, float low_pass);
 
-/** Initialize tables and constants.
+/** Fused AM and FM front end, reads each sample once.
+
+    Processes the samples in tiles that stay in cache. The results are the same as
+    envelope_detect(), magnitude_est_cu8(), or magnitude_est_cs16(), followed by
+    baseband_low_pass_filter() and baseband_demod_FM() or baseband_demod_FM_cs16().
+
+    @param[in,out] lowpass_state AM low pass filter state
+    @param[in,out] fm_state FM demodulator state, NULL to skip FM demodulation
+    @param iq_buf input samples, interleaved uint8 or int16 I/Q
+    @param sample_size 2 for CU8, 4 for CS16
+    @param use_mag_est use the magnitude estimator on CU8 samples, CS16 always uses it
+    @param[out] am_buf low pass filtered AM output
+    @param[out] fm_buf FM output, without @p fm_state the envelope output, may then be NULL
+    @param len number of samples to process
+    @param samp_rate sample rate of samples to process
+    @param low_pass FM low-pass filter frequency or ratio
+    @return the average level in dB
+*/
+float baseband_demod_AM_FM(filter_state_t *lowpass_state, demodfm_state_t *fm_state,
+        uint8_t const *iq_buf, unsigned sample_size, int use_mag_est,
+        int16_t *am_buf, int16_t *fm_buf, uint32_t len, uint32_t samp_rate, float low_pass);
+
+/// SIMD instruction sets for the envelope, magnitude, and FM kernels, in order of preference.
+enum baseband_simd {
+    BASEBAND_SIMD_NONE,
+    BASEBAND_SIMD_NEON,
+    BASEBAND_SIMD_SSE2,
+    BASEBAND_SIMD_AVX2,
+    BASEBAND_SIMD_END,
+};
+
+/// Check if the kernels for a SIMD instruction set are compiled in and supported by the CPU.
+int baseband_simd_supported(int simd);
+
+/** Select the kernels for a SIMD instruction set, all kernels are bit-exact with the scalar ones.
+
+    @param simd the instruction set, falls back to BASEBAND_SIMD_NONE if not supported
+    @return the instruction set selected
+*/
+int baseband_simd_select(int simd);
+
+/// Get the name of a SIMD instruction set.
+char const *baseband_simd_name(int simd);
+
+/** Initialize tables and constants, and select the best SIMD kernels for the CPU.
     Should be called once at startup.
 */
 void baseband_init(void);
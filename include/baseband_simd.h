@@ -0,0 +1,59 @@
+/** @file
+    SIMD kernels for envelope, magnitude, and FM demodulation, internal to baseband.c.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_BASEBAND_SIMD_H_
+#define INCLUDE_BASEBAND_SIMD_H_
+
+#include <stdint.h>
+
+// x86 kernels need GCC/clang function target attributes, SSE2 is the x86-64 baseline
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(DISABLE_SIMD)
+#define BASEBAND_SIMD_X86
+#endif
+// NEON kernels need the AArch64 double precision vector ops
+#if defined(__aarch64__) && defined(__ARM_NEON) && !defined(DISABLE_SIMD)
+#define BASEBAND_SIMD_ARM
+#endif
+
+// All kernels return the sum of the output samples (modulo 2^32).
+
+/// Scalar envelope kernel, uses the squares table.
+uint32_t envelope_cu8_c(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len);
+/// Scalar CU8 magnitude estimator kernel.
+uint32_t magnitude_est_cu8_c(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len);
+/// Scalar CS16 magnitude estimator kernel.
+uint32_t magnitude_est_cs16_c(int16_t const *iq_buf, uint16_t *y_buf, uint32_t len);
+/// Scalar instantaneous frequency kernel, @p x1r, @p x1i is the sample before the first.
+void phase_diff_cu8_c(int16_t x1r, int16_t x1i, uint8_t const *x_buf, int16_t *y_buf, uint32_t len);
+
+#ifdef BASEBAND_SIMD_X86
+int baseband_cpu_has_sse2(void);
+int baseband_cpu_has_avx2(void);
+
+uint32_t envelope_cu8_sse2(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len);
+uint32_t magnitude_est_cu8_sse2(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len);
+uint32_t magnitude_est_cs16_sse2(int16_t const *iq_buf, uint16_t *y_buf, uint32_t len);
+void phase_diff_cu8_sse2(int16_t x1r, int16_t x1i, uint8_t const *x_buf, int16_t *y_buf, uint32_t len);
+
+uint32_t envelope_cu8_avx2(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len);
+uint32_t magnitude_est_cu8_avx2(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len);
+uint32_t magnitude_est_cs16_avx2(int16_t const *iq_buf, uint16_t *y_buf, uint32_t len);
+void phase_diff_cu8_avx2(int16_t x1r, int16_t x1i, uint8_t const *x_buf, int16_t *y_buf, uint32_t len);
+#endif
+
+#ifdef BASEBAND_SIMD_ARM
+uint32_t envelope_cu8_neon(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len);
+uint32_t magnitude_est_cu8_neon(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len);
+uint32_t magnitude_est_cs16_neon(int16_t const *iq_buf, uint16_t *y_buf, uint32_t len);
+void phase_diff_cu8_neon(int16_t x1r, int16_t x1i, uint8_t const *x_buf, int16_t *y_buf, uint32_t len);
+#endif
+
+#endif /* INCLUDE_BASEBAND_SIMD_H_ */
@@ -0,0 +1,80 @@
+/** @file
+    Benchmark of the decode pipeline, per stage timing and throughput.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_BENCH_H_
+#define INCLUDE_BENCH_H_
+
+#include <stdint.h>
+
+struct data;
+struct list;
+
+/// Timed stages of the decode pipeline.
+typedef enum bench_stage {
+    BENCH_DEMOD,    ///< AM and FM demodulation, including the low pass filter
+    BENCH_DETECT,   ///< pulse_detect_package()
+    BENCH_DECODERS, ///< run_ook_demods() and run_fsk_demods(), slicing and decoding
+    BENCH_OUTPUT,   ///< passing events to the outputs
+    BENCH_STAGES,
+} bench_stage_t;
+
+typedef struct bench {
+    char const *filename;        ///< the current input
+    uint64_t start_ns;           ///< start of the current input
+    uint64_t samples;            ///< samples of the current input
+    unsigned packages;           ///< packages of the current input
+    unsigned events;             ///< decoder events of the current input
+    uint64_t stage_ns[BENCH_STAGES];
+    uint64_t decoders_output_ns; ///< outputs run from the decoders, part of BENCH_DECODERS
+    int in_decoders;             ///< the decoders are running
+    // totals of all inputs
+    unsigned inputs;
+    uint64_t total_ns;
+    uint64_t total_samples;
+    unsigned total_packages;
+    unsigned total_events;
+    uint64_t total_stage_ns[BENCH_STAGES + 1]; ///< demod, detect, slice, decode, output
+} bench_t;
+
+/// Create a benchmark, returns NULL on alloc failure.
+bench_t *bench_create(void);
+
+/// Free the benchmark, NULL is ignored.
+void bench_free(bench_t *bench);
+
+/// Get the start time for bench_add(), 0 if @p bench is NULL.
+uint64_t bench_now(bench_t const *bench);
+
+/// Add the time since @p start to a stage, ignored if @p bench is NULL.
+void bench_add(bench_t *bench, bench_stage_t stage, uint64_t start);
+
+/// Start running the decoders, get the start time for bench_decoders_end().
+uint64_t bench_decoders_start(bench_t *bench);
+
+/// End running the decoders, ignored if @p bench is NULL.
+void bench_decoders_end(bench_t *bench, uint64_t start);
+
+/// Start a new input, resets the per decoder timing of @p r_devs.
+void bench_input_start(bench_t *bench, char const *filename, struct list *r_devs);
+
+/** End the input.
+
+    The decoder time of @p r_devs is split into slicing and decoding, this
+    is exact with a single decoder thread, an estimate with a decoder pool.
+
+    @return the report for the input
+*/
+struct data *bench_input_end(bench_t *bench, struct list *r_devs);
+
+/// Get the report for all inputs.
+struct data *bench_total_data(bench_t *bench);
+
+#endif /* INCLUDE_BENCH_H_ */
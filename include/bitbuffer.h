@@ -41,6 +41,15 @@ typedef struct bitbuffer {
 /// Clear the content of the bitbuffer.
 void bitbuffer_clear(bitbuffer_t *bits);
 
+/// Number of rows in use, including the rows long rows spilled into.
+unsigned bitbuffer_rows_used(bitbuffer_t const *bits);
+
+/// Clear the content of a reused bitbuffer, only the rows in use are cleared.
+///
+/// The rows after the rows in use need to be clear, i.e. the bits were only
+/// added with the bitbuffer functions since the bitbuffer was zero-initialized.
+void bitbuffer_reset(bitbuffer_t *bits);
+
 /// Add a single bit at the end of the bitbuffer (MSB first).
 void bitbuffer_add_bit(bitbuffer_t *bits, int bit);
 
@@ -111,6 +120,22 @@ void bitbuffer_parse(bitbuffer_t *bits, const char *code);
 unsigned bitbuffer_search(bitbuffer_t *bitbuffer, unsigned row, unsigned start,
         const uint8_t *pattern, unsigned pattern_bits_len);
 
+/// A pattern for bitbuffer_search_any(), starting in the high bit.
+typedef struct bitbuffer_pattern {
+    uint8_t const *bits;
+    unsigned bits_len;
+} bitbuffer_pattern_t;
+
+/// Search the specified row of the bitbuffer, starting from bit 'start', for
+/// any of the patterns provided, in a single pass over the row.
+///
+/// If several patterns match at the same location the first one in the list is reported.
+///
+/// @param[out] match the index of the matching pattern, unchanged if no match is found, may be NULL
+/// @return the location of the first match, or the end of the row if no match is found.
+unsigned bitbuffer_search_any(bitbuffer_t *bitbuffer, unsigned row, unsigned start,
+        bitbuffer_pattern_t const *patterns, unsigned num_patterns, unsigned *match);
+
 /// Manchester decoding from one bitbuffer into another, starting at the
 /// specified row and start bit.
 ///
@@ -0,0 +1,62 @@
+/** @file
+    Frequency translating, decimating channelizer for wideband I/Q samples.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_CHANNELIZER_H_
+#define INCLUDE_CHANNELIZER_H_
+
+#include <stdint.h>
+
+#define CHANNELIZER_TAPS_PER_PHASE 8 ///< prototype filter length per polyphase branch
+
+typedef struct channelizer channelizer_t;
+
+/** Create a channelizer.
+
+    Each channel is shifted from @p offsets_hz to baseband, low pass filtered and decimated.
+    The filter is only evaluated at the decimated output positions (polyphase decimation).
+
+    @param num_channels the number of channels
+    @param offsets_hz the channel offsets from the center frequency in Hz
+    @param samp_rate the input sample rate
+    @param decimation the decimation factor, the channel sample rate is @p samp_rate / @p decimation
+    @return the channelizer handle, NULL on failure
+*/
+channelizer_t *channelizer_create(unsigned num_channels, int32_t const *offsets_hz, uint32_t samp_rate, unsigned decimation);
+
+/// Free the channelizer, a NULL channelizer is ignored.
+void channelizer_free(channelizer_t *c);
+
+/// Reset the sample history and the channel phases.
+void channelizer_reset(channelizer_t *c);
+
+/** Load a frame of CU8 samples, shared by all channels.
+
+    @return the number of output samples each channel will produce for this frame
+*/
+unsigned channelizer_load_cu8(channelizer_t *c, uint8_t const *iq_buf, unsigned n_samples);
+
+/** Load a frame of CS16 samples, shared by all channels.
+
+    @return the number of output samples each channel will produce for this frame
+*/
+unsigned channelizer_load_cs16(channelizer_t *c, int16_t const *iq_buf, unsigned n_samples);
+
+/** Produce the CS16 output of one channel for the last loaded frame.
+
+    Different channels may be run concurrently, loading a frame must not.
+
+    @param c the channelizer
+    @param channel the channel index
+    @param[out] y_buf output I/Q samples, large enough for the count returned by the last load
+*/
+void channelizer_run(channelizer_t *c, unsigned channel, int16_t *y_buf);
+
+#endif /* INCLUDE_CHANNELIZER_H_ */
@@ -0,0 +1,49 @@
+/** @file
+    Multi-channel demodulation of one wideband capture.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_CHANNELS_H_
+#define INCLUDE_CHANNELS_H_
+
+#include <stdint.h>
+
+#define CHANNEL_SAMPLE_RATE 250000 ///< target sample rate of each channel
+
+struct r_cfg;
+
+typedef struct channels channels_t;
+
+/// Get the capture center frequency for all configured frequencies, the middle of the lowest and highest.
+uint32_t channels_center_frequency(struct r_cfg *cfg);
+
+/** Create the channel states, one for each configured frequency.
+
+    @param cfg the config, the frequencies and demod settings are used
+    @param threads the number of threads to use, 0 for one per CPU
+    @return the channels handle, NULL on failure
+*/
+channels_t *channels_create(struct r_cfg *cfg, unsigned threads);
+
+/// Free all channel states and stop the threads, NULL is ignored.
+void channels_free(channels_t *chs);
+
+/// Reset the channelizer and all channel demod states.
+void channels_reset(channels_t *chs);
+
+/** Demodulate and decode a frame of wideband I/Q samples on all channels.
+
+    The channelizer and the pulse detection runs in parallel for all channels,
+    the decoders then run on the calling thread in channel order.
+
+    @return the number of decoder events
+*/
+int channels_process(struct r_cfg *cfg, uint8_t const *iq_buf, unsigned n_samples);
+
+#endif /* INCLUDE_CHANNELS_H_ */
@@ -0,0 +1,26 @@
+#ifndef INCLUDE_COMPAT_ATOMIC_H_
+#define INCLUDE_COMPAT_ATOMIC_H_
+
+// minimal atomics on unsigned counters for lock-free single-producer/single-consumer queues,
+// and on pointers for lock-free insert-only lists
+
+#ifdef _MSC_VER
+
+#include <windows.h>
+#define compat_atomic_load_acq_u(p)             ((unsigned)InterlockedCompareExchange((LONG volatile *)(p), 0, 0))
+#define compat_atomic_store_rel_u(p, v)         ((void)InterlockedExchange((LONG volatile *)(p), (LONG)(v)))
+#define compat_atomic_fetch_add_u(p, v)         ((unsigned)InterlockedExchangeAdd((LONG volatile *)(p), (LONG)(v)))
+#define compat_atomic_load_acq_ptr(p)           InterlockedCompareExchangePointer((PVOID volatile *)(p), NULL, NULL)
+#define compat_atomic_cas_ptr(p, old, new)      (InterlockedCompareExchangePointer((PVOID volatile *)(p), (new), (old)) == (old))
+
+#else
+
+#define compat_atomic_load_acq_u(p)             __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define compat_atomic_store_rel_u(p, v)         __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define compat_atomic_fetch_add_u(p, v)         __atomic_fetch_add((p), (v), __ATOMIC_ACQ_REL)
+#define compat_atomic_load_acq_ptr(p)           __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define compat_atomic_cas_ptr(p, old, new)      __sync_bool_compare_and_swap((p), (old), (new))
+
+#endif
+
+#endif /* INCLUDE_COMPAT_ATOMIC_H_ */
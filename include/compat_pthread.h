@@ -42,4 +42,13 @@ typedef CONDITION_VARIABLE              pthread_cond_t;
 
 #endif
 
+// storage for per thread state, plain static storage if there are no threads
+#ifndef THREADS
+#define THREAD_LOCAL
+#elif defined(_MSC_VER)
+#define THREAD_LOCAL                    __declspec(thread)
+#else
+#define THREAD_LOCAL                    __thread
+#endif
+
 #endif /* INCLUDE_COMPAT_PTHREAD_H_ */
@@ -9,6 +9,8 @@
 #ifndef INCLUDE_COMPAT_TIME_H_
 #define INCLUDE_COMPAT_TIME_H_
 
+#include <stdint.h>
+
 // ensure struct timeval is known
 #ifdef _WIN32
 #include <winsock2.h>
@@ -25,6 +27,12 @@
 */
 int timeval_subtract(struct timeval *result, struct timeval const *x, struct timeval const *y);
 
+/** Get a monotonic time stamp for measuring intervals.
+
+    @return the time in nanoseconds since an unspecified start
+*/
+uint64_t time_monotonic_ns(void);
+
 // platform-specific functions
 
 #ifdef _WIN32
@@ -0,0 +1,63 @@
+/** @file
+    Streaming gzip and zstd compression for sample files.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_COMPRESS_IO_H_
+#define INCLUDE_COMPRESS_IO_H_
+
+#include <stddef.h>
+#include <stdio.h>
+
+/** Streams to pass to the async reader and writer.
+
+    The read and write functions match async_io_fn, so the
+    decompression and compression run on the I/O thread,
+    overlapping the demodulation.
+*/
+
+typedef struct compress_reader compress_reader_t;
+
+typedef struct compress_writer compress_writer_t;
+
+/// Check if a file_compression is supported by this build.
+int compress_supported(unsigned compression);
+
+/// Get the name of a file_compression, e.g. "gzip".
+char const *compress_name(unsigned compression);
+
+/** Start decompressing a stream.
+
+    @param file the stream to read from, the reader does not take ownership
+    @param compression the file_compression of the stream
+    @return the reader, or NULL if not supported or on alloc failure
+*/
+compress_reader_t *compress_reader_create(FILE *file, unsigned compression);
+
+/// Read up to @p len decompressed bytes, returns 0 at the end of input or on a corrupt stream, see async_io_fn.
+size_t compress_reader_read(void *reader, void *buf, size_t len);
+
+/// Free the reader, the stream is not closed. NULL is ignored.
+void compress_reader_free(compress_reader_t *reader);
+
+/** Start compressing to a stream.
+
+    @param file the stream to write to, the writer does not take ownership
+    @param compression the file_compression of the stream
+    @return the writer, or NULL if not supported or on alloc failure
+*/
+compress_writer_t *compress_writer_create(FILE *file, unsigned compression);
+
+/// Compress @p len bytes, returns @p len on success, 0 on write error, see async_io_fn.
+size_t compress_writer_write(void *writer, void *buf, size_t len);
+
+/// End the compressed stream and free the writer, the stream is not closed. NULL is ignored.
+void compress_writer_free(compress_writer_t *writer);
+
+#endif /* INCLUDE_COMPRESS_IO_H_ */
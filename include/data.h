@@ -67,14 +67,17 @@ typedef union data_value {
     void        *v_ptr; /**< A data value pointer, 4/8 bytes size/alignment */
 } data_value_t;
 
+struct data_arena;
+
 typedef struct data {
     struct data *next; /**< chaining to the next element in the linked list; NULL indicates end-of-list */
-    char        *key;
-    char        *pretty_key; /**< the name used for displaying data to user in with a nicer name */
+    char const  *key; /**< interned, see data_intern() */
+    char const  *pretty_key; /**< the name used for displaying data to user in with a nicer name, interned */
     char        *format; /**< if not null, contains special formatting string */
     data_value_t value;
     data_type_t type;
     unsigned    retain; /**< incremented on data_retain, data_free only frees if this is zero */
+    struct data_arena *arena; /**< memory holding this element, its strings, and the other elements of the event */
 } data_t;
 
 /** Constructs a structured data object.
@@ -167,6 +170,31 @@ R_API data_t *data_hex(data_t *first, char const *key, char const *pretty_key, c
 */
 R_API data_array_t *data_array(int num_values, data_type_t type, void const *ptr);
 
+/** Interns a string, e.g. to replace the key of a data element.
+
+    Interned strings are immutable and never released, equal strings get the same pointer.
+    All keys and pretty keys are interned, compare them by pointer to interned constants.
+    Safe to call from any thread.
+
+    @return The interned string, NULL if @p str is NULL or there was a memory allocation error.
+*/
+R_API char const *data_intern(char const *str);
+
+/** Gets the ID of an interned string, e.g. to index per key tables.
+
+    @param str An interned string, see data_intern()
+    @return The small integer ID of the string, starting at 1
+*/
+R_API unsigned data_key_id(char const *str);
+
+/** Copies a string into the memory of a data element, e.g. to replace the format.
+
+    The copy is released with the element, do not free() it.
+
+    @return The copied string, NULL if @p str is NULL or there was a memory allocation error.
+*/
+R_API char *data_strcpy(data_t *data, char const *str);
+
 /** Releases a data array. */
 R_API void data_array_free(data_array_t *array);
 
@@ -212,4 +240,15 @@ R_API void print_array_value(data_output_t *output, data_array_t *array, char co
 
 R_API size_t data_print_jsons(data_t *data, char *dst, size_t len);
 
+/** Renders a structure as JSON string once, for all outputs sending the same event.
+
+    The rendering is kept with the event and released with it. Appending or
+    prepending elements drops it, the elements must not be changed otherwise.
+
+    @param data the structure to render
+    @param[out] len the length of the JSON string, may be NULL
+    @return The JSON string, do not free() it, NULL if there was a memory allocation error.
+*/
+R_API char const *data_jsons(data_t *data, size_t *len);
+
 #endif // INCLUDE_DATA_H_
@@ -0,0 +1,98 @@
+/** @file
+    DSP worker thread, runs the demodulation off the event loop.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_DSP_WORKER_H_
+#define INCLUDE_DSP_WORKER_H_
+
+#include <stdint.h>
+
+#define DSP_WORKER_SLOTS 16 ///< data frames buffered between acquire and demod, must be a power of two
+#define DSP_WORKER_EVENTS 1024 ///< events buffered between demod and event loop, must be a power of two
+
+struct sdr_event;
+struct data;
+
+typedef struct dsp_worker dsp_worker_t;
+
+/// Called on the worker thread for each queued data frame.
+typedef void (*dsp_worker_process_fn)(struct sdr_event *ev, void *ctx);
+
+/// Called on the worker thread when events are waiting to be drained.
+typedef void (*dsp_worker_notify_fn)(void *ctx);
+
+/// Called on the draining thread for each queued event.
+typedef void (*dsp_worker_event_fn)(void *ctx, struct data *data, int level);
+
+typedef struct dsp_worker_stats {
+    unsigned frames;         ///< data frames queued
+    unsigned drops;          ///< data frames dropped because the queue was full
+    unsigned queue_depth;    ///< data frames currently waiting
+    unsigned queue_max;      ///< highest number of data frames waiting
+    unsigned events;         ///< events handed back to the event loop
+    unsigned events_pending; ///< events currently waiting
+    unsigned event_drops;    ///< events dropped because the event loop fell behind
+} dsp_worker_stats_t;
+
+/** Create and start a DSP worker thread.
+
+    Data frames are copied into one of @p slots buffers of @p slot_len bytes each,
+    a single producer (the acquire thread) and a single consumer (the worker) share the ring lock-free.
+
+    @param process_fn the demod function to run for each data frame
+    @param notify_fn the function to wake the event loop, may be NULL
+    @param ctx a user context to be passed to @p process_fn and @p notify_fn
+    @param slots the number of data frame buffers, rounded up to a power of two
+    @param slot_len the size in bytes of each data frame buffer
+    @return the worker handle, NULL if threads are not available or on failure
+*/
+dsp_worker_t *dsp_worker_create(dsp_worker_process_fn process_fn, dsp_worker_notify_fn notify_fn, void *ctx, unsigned slots, uint32_t slot_len);
+
+/// Stop and join the worker thread, frames still queued are discarded.
+void dsp_worker_stop(dsp_worker_t *w);
+
+/// Stop the worker and free all resources, events still queued are discarded.
+void dsp_worker_free(dsp_worker_t *w);
+
+/** Queue a copy of a data frame for the worker, call only from the single producer thread.
+
+    @return 0 on success, -1 if the frame was dropped
+*/
+int dsp_worker_push(dsp_worker_t *w, struct sdr_event const *ev);
+
+/// Check if the caller is running on the worker thread.
+int dsp_worker_in_thread(dsp_worker_t *w);
+
+/** Lock the state the worker shares with other threads.
+
+    The worker holds the lock while it processes a frame, other threads
+    take it to read or change that state. Does nothing if @p w is NULL.
+*/
+void dsp_worker_lock(dsp_worker_t *w);
+
+/// Unlock the state the worker shares with other threads, does nothing if @p w is NULL.
+void dsp_worker_unlock(dsp_worker_t *w);
+
+/** Hand an event back to the draining thread, call only from the worker thread.
+
+    The event is dropped and counted if the event queue is full.
+*/
+void dsp_worker_emit(dsp_worker_t *w, struct data *data, int level);
+
+/** Pass all queued events to @p event_fn, call only from the single draining thread.
+
+    @return the number of events drained
+*/
+unsigned dsp_worker_drain(dsp_worker_t *w, dsp_worker_event_fn event_fn, void *ctx);
+
+/// Get a snapshot of the worker counters.
+void dsp_worker_get_stats(dsp_worker_t *w, dsp_worker_stats_t *stats);
+
+#endif /* INCLUDE_DSP_WORKER_H_ */
@@ -0,0 +1,80 @@
+/** @file
+    Parallel decoding of input files with output in file order.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_FILE_BATCH_H_
+#define INCLUDE_FILE_BATCH_H_
+
+#include <stdint.h>
+
+struct r_cfg;
+struct pulse_data;
+
+#define FILE_CHUNK_PACKAGE_MS 1000 ///< longest package expected to cross a chunk boundary
+#define FILE_CHUNK_MIN_LENGTH (16 * 1024 * 1024) ///< minimum input bytes per chunk
+#define FILE_CHUNK_PACKAGES   256 ///< packages kept to compare at each chunk boundary
+
+/// The packages a chunk detected just after a chunk boundary.
+typedef struct chunk_boundary {
+    int has_noise;     ///< the noise level was recorded
+    float noise_level; ///< estimated noise level at the boundary
+    unsigned count;    ///< number of packages, may exceed FILE_CHUNK_PACKAGES
+    uint64_t offset[FILE_CHUNK_PACKAGES];
+    unsigned num_pulses[FILE_CHUNK_PACKAGES];
+} chunk_boundary_t;
+
+/** A part of an input file, decoded by a batch worker.
+
+    All positions are sample offsets from the start of the file.
+    A chunk reads from an overlap before its first owned package to
+    an overlap past its last owned package, only packages starting in
+    the owned range are passed to the decoders.
+*/
+typedef struct file_chunk {
+    uint64_t read_start; ///< first sample to read, a multiple of the block length
+    uint64_t read_end;   ///< sample to stop reading at, 0 to read to the end of the file
+    uint64_t own_start;  ///< packages starting before are output by the previous chunk
+    uint64_t own_end;    ///< packages starting here or later are output by the next chunk, 0 for none
+    uint64_t overlap;    ///< samples after a boundary that are compared between the chunks
+    chunk_boundary_t head; ///< packages after own_start, as seen right after the warm-up
+    chunk_boundary_t tail; ///< packages after own_end, as seen by a continuous run
+} file_chunk_t;
+
+/// Decode one input file, or a chunk of it, on a batch worker. Returns 0 on success, non-zero to stop after this file.
+typedef int (*file_batch_decode_fn)(struct r_cfg *worker, char const *in_filename, file_chunk_t *chunk, void *ctx);
+
+/** Decode all input files of @p cfg in parallel.
+
+    Each worker decodes whole files or chunks with fresh demodulator and decoder state.
+    The events of each file or chunk are held until all previous ones are output,
+    the outputs see the same sequence of events as when decoding in order.
+    If a file fails, the events of later files are discarded.
+
+    Files in a raw IQ format are split into @p chunks parts that overlap
+    by PD_MAX_GAP_MS and FILE_CHUNK_PACKAGE_MS. The packages near each
+    boundary are compared between both chunks and a summary of the warm-up
+    differences to a continuous run is logged.
+
+    @param cfg the config with the input files and outputs
+    @param threads number of workers, including the calling thread
+    @param chunks number of chunks to split large files into, 1 to decode whole files
+    @param decode_fn called for each file or chunk on a worker thread
+    @param ctx passed to @p decode_fn
+    @return 0 when all files are done or the batch stopped on a failed file, -1 if the workers could not be created
+*/
+int file_batch_run(struct r_cfg *cfg, unsigned threads, unsigned chunks, file_batch_decode_fn decode_fn, void *ctx);
+
+/// Check if the chunk outputs the package, records the packages near the chunk boundaries.
+int file_chunk_package(file_chunk_t *chunk, struct pulse_data const *package);
+
+/// Record the noise level of the block of samples starting at @p pos if it starts a chunk boundary.
+void file_chunk_frame(file_chunk_t *chunk, uint64_t pos, float noise_level);
+
+#endif /* INCLUDE_FILE_BATCH_H_ */
@@ -41,6 +41,7 @@ enum file_type {
     F_LOGIC    = 5 << 16,
     F_VCD      = 6 << 16,
     F_OOK      = 7 << 16,
+    F_PULSE    = 8 << 16,
     // format types
     F_U8       = F_1CH | F_UNSIGNED | F_INT | F_W8,
     F_S8       = F_1CH | F_SIGNED   | F_INT | F_W8,
@@ -70,16 +71,32 @@ enum file_type {
     U8_LOGIC   = F_LOGIC | F_U8,
     VCD_LOGIC  = F_VCD,
     PULSE_OOK  = F_OOK,
+    PULSE_BIN  = F_PULSE,
 };
 
+/// Compression of a sample file, from a "gz" or "zst" tag.
+enum file_compression {
+    FILE_COMPRESS_NONE,
+    FILE_COMPRESS_GZIP,
+    FILE_COMPRESS_ZSTD,
+};
+
+struct pulse_writer;
+struct async_writer;
+struct compress_writer;
+
 typedef struct {
     uint32_t format;
     uint32_t raw_format;
     uint32_t center_frequency;
     uint32_t sample_rate;
+    uint32_t compression; ///< the file_compression
     char const *spec;
     char const *path;
     FILE *file;
+    struct pulse_writer *pulse_writer; ///< writer state for PULSE_BIN output
+    struct async_writer *sample_writer; ///< write-behind for sample output to a file
+    struct compress_writer *compress_writer; ///< compression for sample output
 } file_info_t;
 
 /// Clear all file info.
@@ -100,7 +117,9 @@ void file_info_clear(file_info_t *info);
 /// - 2ch formats: "cu8", "cs8", "cs16", "cs32", "cf32"
 /// - 1ch formats: "u8", "s8", "s16", "u16", "s32", "u32", "f32"
 /// - text formats: "vcd", "ook"
+/// - binary pulse format: "pulse"
 /// - content types: "iq", "i", "q", "am", "fm", "logic"
+/// - compression: "gz", "zst"
 ///
 /// Parses left to right, with the exception of a prefix up to the last colon ":"
 /// This prefix is the forced override, parsed last and removed from the filename.
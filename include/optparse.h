@@ -60,6 +60,22 @@ typedef struct tls_opts {
 /// @return 0 if the option was valid, error code otherwise
 int tls_param(tls_opts_t *tls_opts, char const *key, char const *val);
 
+/// Spool settings for network outputs.
+typedef struct spool_opts {
+    /// Directory for the spool segments, no spooling if NULL.
+    char const *spool_dir;
+    /// Maximum size of the spool in bytes, 0 for the default.
+    uint32_t spool_size;
+    /// Maximum replay rate in records per second, 0 for the default.
+    unsigned spool_rate;
+} spool_opts_t;
+
+/// Parse a spool option.
+///
+/// @sa spool_opts_t
+/// @return 0 if the option was valid, error code otherwise
+int spool_param(spool_opts_t *spool_opts, char const *key, char const *val);
+
 /// Convert string to bool with fallback default.
 /// Parses "true", "yes", "on", "enable" (not case-sensitive) to 1, atoi() otherwise.
 int atobv(char const *arg, int def);
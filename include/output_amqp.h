@@ -0,0 +1,21 @@
+/** @file
+    AMQP 0-9-1 output for rtl_433 events, e.g. to RabbitMQ.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_OUTPUT_AMQP_H_
+#define INCLUDE_OUTPUT_AMQP_H_
+
+#include "data.h"
+
+struct mg_mgr;
+
+struct data_output *data_output_amqp_create(struct mg_mgr *mgr, char *param);
+
+#endif /* INCLUDE_OUTPUT_AMQP_H_ */
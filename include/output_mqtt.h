@@ -14,8 +14,36 @@
 
 #include "data.h"
 
+#include <stdint.h>
+#include <stddef.h>
+
 struct mg_mgr;
+struct mbuf;
 
 struct data_output *data_output_mqtt_create(struct mg_mgr *mgr, char *param, char const *dev_hint);
 
+/** Expand a topic format string with the well-known keys of an event.
+
+    Tokens are e.g. "[/model]" or "[.id:default]", a non-letter after the bracket is
+    prepended if the key exists, see the MQTT output options.
+
+    @param[out] topic the output buffer, large enough for the expanded topic
+    @param format the topic format string
+    @param data the event
+    @param hostname the value for the "[hostname]" token
+    @return the end of the expanded topic
+*/
+char *expand_topic(char *topic, char const *format, data_t *data, char const *hostname);
+
+/** Append an MQTT PUBLISH packet, encoded the same as mg_mqtt_publish().
+
+    @param out the buffer to append to
+    @param topic the topic
+    @param message_id the packet identifier, only used with QoS 1 or 2
+    @param flags the QoS and retain flags, e.g. MG_MQTT_QOS(1) | MG_MQTT_RETAIN
+    @param data the payload
+    @param len the length of the payload
+*/
+void mqtt_publish_encode(struct mbuf *out, char const *topic, uint16_t message_id, int flags, void const *data, size_t len);
+
 #endif /* INCLUDE_OUTPUT_MQTT_H_ */
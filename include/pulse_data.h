@@ -17,7 +17,7 @@
 #include <stdio.h>
 #include "data.h"
 
-#define PD_MAX_PULSES        1200 // Maximum number of pulses before forcing End Of Package
+#define PD_MAX_PULSES        1200 // Maximum number of pulses before forcing End Of Package (OOK) or a new segment (FSK)
 #define PD_MIN_PULSES        16   // Minimum number of pulses before declaring a proper package
 #define PD_MIN_PULSE_SAMPLES 10   // Minimum number of samples in a pulse for proper detection
 #define PD_MIN_GAP_MS        10   // Minimum gap size in milliseconds to exceed to declare End Of Package
@@ -46,13 +46,19 @@ typedef struct pulse_data {
     float rssi_db;
     float snr_db;
     float noise_db;
+    unsigned num_candidates; ///< Number of decoders run on the package, the others were skipped by the prefilter.
+    unsigned segment;        ///< Number of this segment of a package longer than PD_MAX_PULSES, 0 for the first.
+    unsigned continued;      ///< The package continues in the next segment, see pulse_data_continue().
 } pulse_data_t;
 
 /// Clear the content of a pulse_data_t structure.
 void pulse_data_clear(pulse_data_t *data);
 
-/// Shift out part of the data to make room for more.
-void pulse_data_shift(pulse_data_t *data);
+/// Start the next segment of a continued package.
+///
+/// The pulse and gap after the last pulse of the segment are not final yet
+/// and carry over as the first pulse of the next segment.
+void pulse_data_continue(pulse_data_t *data);
 
 /// Print the content of a pulse_data_t structure (for debug).
 void pulse_data_print(pulse_data_t const *data);
@@ -66,7 +72,7 @@ void pulse_data_print_vcd_header(FILE *file, uint32_t sample_rate);
 /// Print the content of a pulse_data_t structure in VCD format.
 void pulse_data_print_vcd(FILE *file, pulse_data_t const *data, int ch_id);
 
-/// Read the next pulse_data_t structure from OOK text.
+/// Read the next pulse_data_t structure from OOK text, a segment continues the previous one in @p data.
 void pulse_data_load(FILE *file, pulse_data_t *data, uint32_t sample_rate);
 
 /// Print a header for the OOK text format.
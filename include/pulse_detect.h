@@ -55,6 +55,9 @@ void pulse_detect_set_levels(pulse_detect_t *pulse_detect, int use_mag_est, floa
 ///
 /// Function is stateful and can be called with chunks of input data.
 ///
+/// An FSK package longer than PD_MAX_PULSES is returned in segments,
+/// all but the last one are marked as `continued`.
+///
 /// @param pulse_detect The pulse_detect instance
 /// @param envelope_data Samples with amplitude envelope of carrier
 /// @param fm_data Samples with frequency offset from center frequency
@@ -0,0 +1,85 @@
+/** @file
+    Binary pulse data file format with a seek index.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_PULSE_FILE_H_
+#define INCLUDE_PULSE_FILE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include "pulse_data.h"
+#include "compat_time.h"
+
+/** A compact, binary alternative to the OOK text format.
+
+    The file starts with a header, followed by one record per package.
+    A record is a fixed part with the fields of pulse_data_t and the
+    pulse and gap widths as zigzag delta varints.
+    When the writer is closed a sparse index of record offsets and a
+    trailer are appended. Files without a trailer (e.g. from an aborted
+    capture) are still readable, the index is then rebuilt by a scan.
+
+    All values are stored little-endian.
+*/
+
+/// Records per entry in the seek index.
+#define PULSE_FILE_INDEX_STRIDE 64
+
+typedef struct pulse_writer pulse_writer_t;
+
+typedef struct pulse_reader pulse_reader_t;
+
+/** Start a pulse file, writes the header.
+
+    @param file the stream to write to, the writer does not take ownership
+    @return the writer, or NULL on alloc failure
+*/
+pulse_writer_t *pulse_writer_create(FILE *file);
+
+/** Append a package.
+
+    @param writer the pulse file writer
+    @param data the package
+    @param now the time the package was received, start_ago is relative to this
+    @return 0 on success, -1 on write error
+*/
+int pulse_writer_write(pulse_writer_t *writer, pulse_data_t const *data, struct timeval const *now);
+
+/// Finish the file with the index and trailer, then free the writer. NULL is ignored.
+void pulse_writer_free(pulse_writer_t *writer);
+
+/** Open a pulse file for reading.
+
+    Regular files are memory-mapped, other streams are read into memory.
+
+    @param file the stream to read from, the reader does not take ownership
+    @return the reader, or NULL if the file is not a valid pulse file
+*/
+pulse_reader_t *pulse_reader_open(FILE *file);
+
+/// Get the number of packages in the file.
+unsigned pulse_reader_count(pulse_reader_t const *reader);
+
+/// Position the reader at package @p idx, returns 0 on success, -1 if out of range.
+int pulse_reader_seek(pulse_reader_t *reader, unsigned idx);
+
+/** Read the next package.
+
+    @param reader the pulse file reader
+    @param[out] data the package, cleared first
+    @param[out] now the time the package was received, may be NULL
+    @return 1 if a package was read, 0 at the end of file, -1 on a corrupt record
+*/
+int pulse_reader_read(pulse_reader_t *reader, pulse_data_t *data, struct timeval *now);
+
+/// Close the reader. NULL is ignored.
+void pulse_reader_free(pulse_reader_t *reader);
+
+#endif /* INCLUDE_PULSE_FILE_H_ */
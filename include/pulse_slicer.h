@@ -16,6 +16,56 @@
 
 #include "pulse_detect.h"
 #include "r_device.h"
+#include "list.h"
+
+typedef struct slice_entry slice_entry_t;
+typedef struct slice_stream slice_stream_t;
+
+/// Per package cache of slicer results, decoders with identical modulation and timing share the bits.
+/// Zero-initialize for each package and release with slice_cache_free().
+typedef struct slice_cache {
+    list_t entries; ///< slice_entry_t for each distinct slicer and timing
+} slice_cache_t;
+
+/// Free the cached slicer results.
+void slice_cache_free(slice_cache_t *cache);
+
+/// Check if there is a slicer for a modulation.
+///
+/// @param modulation The decoder modulation, e.g. OOK_PULSE_PPM
+/// @return 1 if pulse_slicer_run() can demodulate it, 0 otherwise
+int pulse_slicer_known(unsigned modulation);
+
+/// Check if two decoders use the same slicer with the same timing.
+///
+/// Marks both decoders as sharing slicer results if so.
+///
+/// @param a A decoder
+/// @param b Another decoder
+/// @return 1 if the decoders produce the same bits for any package, 0 otherwise
+int pulse_slicer_share(r_device *a, r_device *b);
+
+/// Demodulate a package with the slicer for the decoder modulation.
+///
+/// With a cache, a decoder with the same slicer and timing as an earlier decoder
+/// gets a copy of the earlier bits instead of slicing the package again.
+/// Only decoders marked by pulse_slicer_share() use the cache.
+///
+/// Messages that can't meet the limits of the decoder (r_device::min_rows etc.)
+/// are accounted with the code the decoder would return (r_device::rows_reject etc.)
+/// without running the decoder. The PCM, PPM, and PWM
+/// slicers stop adding bits to such a message as soon as a limit is exceeded,
+/// unless the bits are cached for other decoders. Limits are ignored in verbose mode.
+///
+/// A long FSK package comes in segments (pulse_data_t::continued). The PCM, PWM,
+/// and Manchester slicers keep a message that is in progress at the end of a segment
+/// with the decoder and continue it with the next segment, each pulse is sliced once.
+///
+/// @param pulses The pulse sequence to demodulate
+/// @param device The decoder to run
+/// @param cache The slicer results of the package so far, may be NULL
+/// @return number of events processed
+int pulse_slicer_run(pulse_data_t const *pulses, r_device *device, slice_cache_t *cache);
 
 /// Demodulate a Pulse Code Modulation signal.
 ///
@@ -147,6 +197,34 @@ int pulse_slicer_nrzs(pulse_data_t const *pulses, r_device *device);
 
 int pulse_slicer_osv1(pulse_data_t const *pulses, r_device *device);
 
+/// Get the set of width classes of all pulses and gaps in a package.
+///
+/// A width class is a half octave of widths in samples, i.e. bit 2k for
+/// widths from 2^k and bit 2k+1 for widths from 1.5*2^k, bit 0 for widths below 2.
+///
+/// @param pulses The pulse sequence to classify
+/// @param[out] pulse_classes The set of pulse width classes
+/// @param[out] gap_classes The set of gap width classes
+void pulse_slicer_width_classes(pulse_data_t const *pulses, uint64_t *pulse_classes, uint64_t *gap_classes);
+
+/// Compute the width classes of pulses and gaps that can produce bits with a decoder.
+///
+/// The classes mirror the timing windows of the slicer for the decoder modulation,
+/// modulations without fixed windows accept all widths.
+///
+/// @param device The decoder to set the prefilter classes for
+/// @param sample_rate The sample rate of the pulse data
+void pulse_slicer_prefilter_init(r_device *device, uint32_t sample_rate);
+
+/// Check if a package could produce bits with a decoder, otherwise the slicer can be skipped.
+///
+/// @param pulses The pulse sequence, to update the decoder classes on sample rate changes
+/// @param pulse_classes The set of pulse width classes of the package
+/// @param gap_classes The set of gap width classes of the package
+/// @param device The decoder to check
+/// @return 1 if the decoder needs to run, 0 otherwise
+int pulse_slicer_prefilter(pulse_data_t const *pulses, uint64_t pulse_classes, uint64_t gap_classes, r_device *device);
+
 /// Simulate demodulation using a given signal code string.
 ///
 /// The (optionally "0x" prefixed) hex code is processed into a bitbuffer_t.
@@ -31,6 +31,35 @@ void r_init_cfg(struct r_cfg *cfg);
 
 void r_free_cfg(struct r_cfg *cfg);
 
+/** Create a worker to decode input files in parallel to other workers.
+
+    The worker shares the settings of @p cfg but has its own demodulator state.
+    Events are not output but held in the list set as `held_events`,
+    pass them to r_output_held_events() in file order.
+*/
+struct r_cfg *r_create_batch_cfg(struct r_cfg *cfg);
+
+/// Free a worker created with r_create_batch_cfg().
+void r_free_batch_cfg(struct r_cfg *worker);
+
+/// Replace the decoders of the worker with fresh copies of the decoders of its parent cfg.
+void r_reset_batch_protocols(struct r_cfg *worker);
+
+/// Output and free the events held by a batch worker, tags are applied for @p in_filename.
+void r_output_held_events(struct r_cfg *cfg, struct list *held_events, char const *in_filename);
+
+/// Free the events held by a batch worker without output.
+void r_free_held_events(struct list *held_events);
+
+/** Make sure the demodulator buffers hold blocks of @p n_samples.
+
+    The buffers grow to the largest block seen, the conversion
+    buffers are only allocated if a dumper needs them.
+
+    @return 0 on success, -1 on alloc failure
+*/
+int r_reserve_demod_buffers(struct r_cfg *cfg, unsigned n_samples);
+
 /* device decoder protocols */
 
 void register_protocol(struct r_cfg *cfg, struct r_device *r_dev, char *arg);
@@ -43,6 +72,9 @@ void register_all_protocols(struct r_cfg *cfg, unsigned disabled);
 
 /* output helper */
 
+/// Compute the levels and frequencies of a package detected in @p sample_size I/Q samples tuned to @p center_frequency.
+void calc_pulse_levels(struct pulse_data *pulse_data, uint32_t center_frequency, int sample_size, int use_mag_est);
+
 void calc_rssi_snr(struct r_cfg *cfg, struct pulse_data *pulse_data);
 
 char *time_pos_str(struct r_cfg *cfg, unsigned samples_ago, char *buf);
@@ -59,6 +91,15 @@ int run_fsk_demods(struct list *r_devs, struct pulse_data *fsk_pulse_data);
 
 void r_redirect_logging(struct r_cfg *cfg);
 
+/// Hold the log messages of the calling thread with the events of the batch worker, NULL to stop.
+void r_redirect_batch_logging(struct r_cfg *worker);
+
+/// Hold the log messages of the calling thread in @p logs, NULL to stop, e.g. while running on a thread pool.
+void r_hold_logs(struct list *logs);
+
+/// Print and free the log messages held by r_hold_logs(), call from the thread owning the outputs.
+void r_flush_held_logs(struct list *logs);
+
 void event_occurred_handler(struct r_cfg *cfg, struct data *data);
 
 void log_device_handler(struct r_device *r_dev, int level, struct data *data);
@@ -69,6 +110,9 @@ struct data *create_report_data(struct r_cfg *cfg, int level);
 
 void flush_report_data(struct r_cfg *cfg);
 
+/// Pass all events queued by the DSP worker to the output handlers, call on the event loop.
+void flush_dsp_events(struct r_cfg *cfg);
+
 /* setup */
 
 void add_json_output(struct r_cfg *cfg, char *param);
@@ -83,6 +127,8 @@ void add_mqtt_output(struct r_cfg *cfg, char *param);
 
 void add_influx_output(struct r_cfg *cfg, char *param);
 
+void add_amqp_output(struct r_cfg *cfg, char *param);
+
 void add_syslog_output(struct r_cfg *cfg, char *param);
 
 void add_http_output(struct r_cfg *cfg, char *param);
@@ -5,6 +5,8 @@
 #ifndef INCLUDE_R_DEVICE_H_
 #define INCLUDE_R_DEVICE_H_
 
+#include <stdint.h>
+
 /**
     Supported Modulation and Coding types.
 
@@ -53,6 +55,7 @@ enum decode_return_codes {
 
 struct bitbuffer;
 struct data;
+struct slice_stream;
 
 /** Device protocol decoder struct. */
 typedef struct r_device {
@@ -72,6 +75,19 @@ typedef struct r_device {
     unsigned priority; ///< Run later and only if no previous events were produced
     unsigned disabled; ///< 0: default enabled, 1: default disabled, 2: disabled, 3: disabled and hidden
     char const *const *fields; ///< List of fields this decoder produces; required for CSV output. NULL-terminated.
+    unsigned serial;   ///< decoder keeps state in static variables, never run it on the decoder pool
+
+    /* optional limits on the bits of a message, decode_fn is not run if they are not met, see pulse_slicer_run() */
+    unsigned min_rows;        ///< at least this many rows, 0 for no limit
+    unsigned max_rows;        ///< at most this many rows, 0 for no limit
+    unsigned min_bits;        ///< at least one row with this many bits, 0 for no limit
+    unsigned max_bits;        ///< no row with more bits, 0 for no limit
+    uint8_t const *preamble;  ///< the first row starts with these bits, may be NULL
+    unsigned preamble_bits;   ///< length of the preamble in bits, 0 for none
+    /* the code a failed limit is accounted with, as the decoder would return it, checked in this order */
+    int rows_reject;          ///< for min_rows and max_rows, 0 for DECODE_ABORT_LENGTH
+    int bits_reject;          ///< for min_bits and max_bits, 0 for DECODE_ABORT_LENGTH
+    int preamble_reject;      ///< for the preamble, 0 for DECODE_ABORT_EARLY
 
     /* public for each decoder */
     int verbose;
@@ -87,7 +103,21 @@ typedef struct r_device {
 
     /* private for flex decoder and output callback */
     void *decode_ctx;
+    unsigned decode_ctx_size; ///< size of decode_ctx, see decoder_create()
     void *output_ctx;
+
+    /* private prefilter, see pulse_slicer_prefilter() */
+    uint32_t prefilter_rate;   ///< sample rate the width classes are computed for
+    uint64_t prefilter_pulses; ///< pulse width classes that can produce bits
+    uint64_t prefilter_gaps;   ///< gap width classes that can produce bits
+
+    /* private slice sharing, see pulse_slicer_run() */
+    unsigned slice_shared; ///< another decoder has the same slicer and timing
+    struct slice_stream *slice_stream; ///< message continued in the next segment of a long package
+
+    /* private benchmark timing, see bench_input_start() */
+    unsigned decode_timing; ///< measure the time spent in decode_fn
+    uint64_t decode_ns;     ///< time spent in decode_fn
 } r_device;
 
 #endif /* INCLUDE_R_DEVICE_H_ */
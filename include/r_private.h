@@ -13,6 +13,7 @@
 #include "fileformat.h"
 #include "samp_grab.h"
 #include "am_analyze.h"
+#include "channels.h"
 #include "rtl_433.h"
 #include "compat_time.h"
 
@@ -28,14 +29,16 @@ struct dm_state {
     int use_mag_est;
     int detect_verbosity;
 
-    int16_t am_buf[MAXIMAL_BUF_LENGTH];  // AM demodulated signal (for OOK decoding)
+    // The buffers hold buf_len samples, sized to the blocks by r_reserve_demod_buffers()
+    unsigned buf_len;
+    int16_t *am_buf;  // AM demodulated signal (for OOK decoding)
     union {
-        // These buffers aren't used at the same time, so let's use a union to save some memory
-        int16_t fm[MAXIMAL_BUF_LENGTH];  // FM demodulated signal (for FSK decoding)
-        uint16_t temp[MAXIMAL_BUF_LENGTH];  // Temporary buffer (to be optimized out..)
+        // These buffers aren't used at the same time, so they share the memory
+        int16_t *fm;  // FM demodulated signal (for FSK decoding)
+        uint16_t *temp;  // Temporary buffer (to be optimized out..)
     } buf;
-    uint8_t u8_buf[MAXIMAL_BUF_LENGTH]; // format conversion buffer
-    float f32_buf[MAXIMAL_BUF_LENGTH]; // format conversion buffer
+    uint8_t *u8_buf; // logic dumper buffer, NULL without a U8_LOGIC dumper
+    float *f32_buf; // format conversion buffer, 2 values per sample, NULL without a converting dumper
     int sample_size; // CU8: 2, CS16: 4
     pulse_detect_t *pulse_detect;
     filter_state_t lowpass_filter_state;
@@ -52,6 +55,8 @@ struct dm_state {
     /* Protocol states */
     list_t r_devs;
 
+    channels_t *channels; ///< Multi-channel demod states, NULL for a single channel
+
     pulse_data_t    pulse_data;
     pulse_data_t    fsk_pulse_data;
     unsigned frame_event_count;
@@ -59,6 +64,7 @@ struct dm_state {
     unsigned frame_end_ago;
     struct timeval now;
     float sample_file_pos;
+    struct file_chunk *chunk; ///< the part of the input file a batch worker decodes, NULL for the whole file
 };
 
 #endif /* INCLUDE_R_PRIVATE_H_ */
@@ -7,6 +7,7 @@
 
 #include <stdint.h>
 #include "list.h"
+#include "async_io.h"
 #include <time.h>
 #include <signal.h>
 
@@ -27,6 +28,7 @@
 struct sdr_dev;
 struct r_device;
 struct mg_mgr;
+struct dsp_worker;
 
 typedef enum {
     CONVERT_NATIVE,
@@ -78,6 +80,11 @@ typedef struct r_cfg {
     uint32_t frequency[MAX_FREQS];
     uint32_t center_frequency;
     int fsk_pulse_detect_mode;
+    int channel_mode; ///< Demodulate all frequencies as channels of one capture
+    int threads; ///< Threads for multi-channel demodulation, 0 for one per CPU
+    int decoder_threads; ///< Threads to run the decoders of a priority in parallel, 0 for one per CPU
+    int file_threads; ///< Threads to decode input files in parallel, 0 for one per CPU
+    int chunk_threads; ///< Threads to decode chunks of each input file in parallel, 0 for one per CPU
     int hop_times;
     int hop_time[MAX_FREQS];
     time_t hop_start_time;
@@ -86,6 +93,7 @@ typedef struct r_cfg {
     int after_successful_events_flag;
     uint32_t samp_rate;
     uint64_t input_pos;
+    async_io_stats_t io_stats; ///< Sample file read-ahead and write-behind statistics
     uint32_t bytes_to_read;
     struct sdr_dev *dev;
     int grab_mode; ///< Signal grabber mode: 0=off, 1=all, 2=unknown, 3=known
@@ -93,6 +101,8 @@ typedef struct r_cfg {
     int verbosity; ///< 0=normal, 1=verbose, 2=verbose decoders, 3=debug decoders, 4=trace decoding.
     int verbose_bits;
     conversion_mode_t conversion_mode;
+    struct unit_key *unit_keys; ///< unit conversions by interned key ID
+    unsigned unit_keys_len;
     int report_meta;
     int report_noise;
     int report_protocol;
@@ -113,6 +123,12 @@ typedef struct r_cfg {
     list_t raw_handler;
     int has_logout;
     struct dm_state *demod;
+    struct dsp_worker *dsp_worker; ///< DSP worker thread for live input, NULL otherwise
+    struct thread_pool *decoder_pool; ///< pool to run the decoders of a priority in parallel, NULL otherwise
+    int report_bench; ///< benchmark the file inputs
+    struct bench *bench; ///< benchmark of the current file input, NULL otherwise
+    struct r_cfg *batch_parent; ///< the cfg this batch worker decodes files for, NULL otherwise
+    list_t *held_events; ///< events of the current file, held by a batch worker until output in order
     char const *sr_filename;
     int sr_execopen;
     int watchdog; ///< SDR acquire stall watchdog
@@ -130,6 +146,7 @@ typedef struct r_cfg {
     unsigned frames_ook;    ///< counter of ook demods for report interval statistic
     unsigned frames_fsk;    ///< counter of fsk demods for report interval statistic
     unsigned frames_events; ///< counter of decoder events for report interval statistic
+    unsigned frames_decoders; ///< counter of decoders run after prefiltering for report interval statistic
     struct mg_mgr *mgr;
 } r_cfg_t;
 
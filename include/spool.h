@@ -0,0 +1,78 @@
+/** @file
+    Disk-backed store-and-forward spool for network outputs.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_SPOOL_H_
+#define INCLUDE_SPOOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+/** A spool is an append-only log of records in memory-mapped segment files.
+
+    Records are a key (e.g. a topic) and a payload, read back oldest-first.
+    Segments are named "<dir>/<name>.<seq>.spool" and persist over restarts.
+    If the spool exceeds its size the oldest segment is evicted.
+
+    Spools are not thread-safe, use them from the output (main) thread only.
+*/
+typedef struct spool spool_t;
+
+typedef struct spool_stats {
+    char const *name;
+    unsigned records;  ///< records waiting for replay
+    uint64_t bytes;    ///< bytes of records waiting for replay
+    time_t oldest;     ///< time the oldest record was spooled, 0 if empty
+    unsigned segments; ///< segment files on disk
+    unsigned dropped;  ///< records lost to eviction or errors
+} spool_stats_t;
+
+#define SPOOL_SIZE_DEFAULT    (64 * 1024 * 1024)
+#define SPOOL_SEGMENT_DEFAULT (1024 * 1024)
+#define SPOOL_RATE_DEFAULT    100 ///< records per second
+
+/** Open or create a spool, existing segments are recovered.
+
+    @param dir the directory for the segment files, created if missing
+    @param name the base name of the segment files
+    @param max_size the maximum size of all segments in bytes
+    @param segment_size the size of one segment in bytes
+    @return the spool, or NULL on error
+*/
+spool_t *spool_create(char const *dir, char const *name, size_t max_size, size_t segment_size);
+
+/// Close the spool, the segments are kept on disk. NULL is ignored.
+void spool_free(spool_t *spool);
+
+/// Append a record, returns 0 on success, -1 if the record was dropped.
+int spool_write(spool_t *spool, char const *key, void const *data, size_t len);
+
+/** Get the oldest record.
+
+    The record is valid until the next call to any spool function.
+
+    @return the record id for spool_pop(), 0 if the spool is empty
+*/
+uint64_t spool_peek(spool_t *spool, char const **key, void const **data, size_t *len);
+
+/// Remove the oldest record if it still is the record @p id from spool_peek().
+void spool_pop(spool_t *spool, uint64_t id);
+
+/// Get the number of records waiting for replay.
+unsigned spool_depth(spool_t const *spool);
+
+/// Get the statistics of a spool.
+void spool_get_stats(spool_t const *spool, spool_stats_t *stats);
+
+/// Get the open spools by index, returns NULL past the last spool.
+spool_t *spool_at(unsigned idx);
+
+#endif /* INCLUDE_SPOOL_H_ */
@@ -0,0 +1,44 @@
+/** @file
+    Fork-join thread pool for parallel demodulation.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#ifndef INCLUDE_THREAD_POOL_H_
+#define INCLUDE_THREAD_POOL_H_
+
+typedef struct thread_pool thread_pool_t;
+
+/// A task function, called once for each task index.
+typedef void (*thread_pool_task_fn)(void *ctx, unsigned task);
+
+/// Get the number of online CPUs, at least 1.
+unsigned thread_pool_cpu_count(void);
+
+/** Create a thread pool.
+
+    @param threads total number of threads to use, including the calling thread
+    @return the pool handle, NULL if @p threads is less than 2, threads are not available or on failure
+*/
+thread_pool_t *thread_pool_create(unsigned threads);
+
+/// Stop all threads and free the pool, a NULL pool is ignored.
+void thread_pool_free(thread_pool_t *pool);
+
+/// Get the total number of threads, including the calling thread, 1 for a NULL pool.
+unsigned thread_pool_size(thread_pool_t *pool);
+
+/** Run @p tasks calls of @p task_fn and wait for all to complete.
+
+    The calling thread takes part in running the tasks.
+    A NULL pool runs all tasks in order on the calling thread.
+    Only one thread may run tasks on a pool at a time.
+*/
+void thread_pool_run(thread_pool_t *pool, unsigned tasks, thread_pool_task_fn task_fn, void *ctx);
+
+#endif /* INCLUDE_THREAD_POOL_H_ */
@@ -0,0 +1,444 @@
+/** @file
+    Asynchronous read-ahead and write-behind for sample files.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+
+#include "async_io.h"
+#include "compat_time.h"
+#include "logger.h"
+#include "fatal.h"
+#include "compat_pthread.h"
+#include "compat_atomic.h"
+
+size_t async_io_fread(void *ctx, void *buf, size_t len)
+{
+    return fread(buf, 1, len, ctx);
+}
+
+size_t async_io_fwrite(void *ctx, void *buf, size_t len)
+{
+    return fwrite(buf, 1, len, ctx);
+}
+
+// A ring of blocks: the background thread fills blocks [tail, head) for the reader,
+// the writer queues buffers [tail, head) for the background thread.
+// Both sides only wait on the lock when the ring is empty or full.
+
+struct async_reader {
+    async_io_fn read_fn;
+    void *ctx;
+    async_io_stats_t *stats;
+
+    uint8_t *buf;      ///< ASYNC_READER_BLOCKS blocks of ASYNC_READER_BLOCK_LEN
+    size_t len[ASYNC_READER_BLOCKS]; ///< bytes in each filled block
+    unsigned head;     ///< blocks filled, written by the background thread
+    unsigned tail;     ///< blocks consumed, written by the reader
+    size_t pos;        ///< read position in the tail block
+    int eof;           ///< the input ended, no more blocks will be filled
+    int stop;
+
+#ifdef THREADS
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t filled; ///< wait for a filled block
+    pthread_cond_t freed;  ///< wait for a free block
+#endif
+};
+
+struct async_writer {
+    async_io_fn write_fn;
+    void *ctx;
+    async_io_stats_t *stats;
+
+    uint8_t *buf;      ///< ASYNC_WRITER_BUFFERS buffers of ASYNC_WRITER_BUFFER_LEN
+    size_t len[ASYNC_WRITER_BUFFERS]; ///< bytes in each queued buffer
+    unsigned head;     ///< buffers queued, written by the writer
+    unsigned tail;     ///< buffers written, written by the background thread
+    size_t fill;       ///< bytes in the head buffer
+    int error;         ///< a write failed
+    int stop;
+    int threaded;      ///< the background thread is running
+
+#ifdef THREADS
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t queued;  ///< wait for a queued buffer
+    pthread_cond_t written; ///< wait for a written buffer
+#endif
+};
+
+#ifdef THREADS
+static int start_thread(pthread_t *thread, THREAD_RETURN (THREAD_CALL *fn)(void *), void *arg)
+{
+#ifndef _WIN32
+    // Block all signals from the I/O thread
+    sigset_t sigset;
+    sigset_t oldset;
+    sigfillset(&sigset);
+    pthread_sigmask(SIG_SETMASK, &sigset, &oldset);
+#endif
+    int r = pthread_create(thread, NULL, fn, arg);
+#ifndef _WIN32
+    pthread_sigmask(SIG_SETMASK, &oldset, NULL);
+#endif
+    if (r) {
+        print_logf(LOG_ERROR, __func__, "error in pthread_create, rc: %d", r);
+    }
+    return r;
+}
+#endif
+
+/* reader */
+
+#ifdef THREADS
+static THREAD_RETURN THREAD_CALL reader_thread(void *arg)
+{
+    async_reader_t *r = arg;
+
+    for (;;) {
+        pthread_mutex_lock(&r->lock);
+        while (r->head - r->tail == ASYNC_READER_BLOCKS && !r->stop)
+            pthread_cond_wait(&r->freed, &r->lock);
+        int stop      = r->stop;
+        unsigned head = r->head;
+        pthread_mutex_unlock(&r->lock);
+        if (stop)
+            break;
+
+        unsigned idx = head % ASYNC_READER_BLOCKS;
+        size_t n     = r->read_fn(r->ctx, &r->buf[(size_t)idx * ASYNC_READER_BLOCK_LEN], ASYNC_READER_BLOCK_LEN);
+
+        pthread_mutex_lock(&r->lock);
+        if (n) {
+            r->len[idx] = n;
+            compat_atomic_store_rel_u(&r->head, head + 1);
+        }
+        else {
+            r->eof = 1;
+        }
+        pthread_mutex_unlock(&r->lock);
+        pthread_cond_signal(&r->filled);
+        if (!n)
+            break;
+    }
+
+    return 0;
+}
+#endif
+
+async_reader_t *async_reader_create(async_io_fn read_fn, void *ctx, async_io_stats_t *stats)
+{
+    async_reader_t *r = calloc(1, sizeof(*r));
+    if (!r) {
+        WARN_CALLOC("async_reader_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    r->read_fn = read_fn;
+    r->ctx     = ctx;
+    r->stats   = stats;
+
+#ifdef THREADS
+    r->buf = malloc((size_t)ASYNC_READER_BLOCKS * ASYNC_READER_BLOCK_LEN);
+    if (!r->buf) {
+        WARN_MALLOC("async_reader_create()");
+        free(r);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+
+    pthread_mutex_init(&r->lock, NULL);
+    pthread_cond_init(&r->filled, NULL);
+    pthread_cond_init(&r->freed, NULL);
+    if (start_thread(&r->thread, reader_thread, r)) {
+        pthread_mutex_destroy(&r->lock);
+        pthread_cond_destroy(&r->filled);
+        pthread_cond_destroy(&r->freed);
+        free(r->buf);
+        r->buf = NULL; // read when requested
+    }
+#endif
+
+    return r;
+}
+
+async_reader_t *async_reader_create_direct(async_io_fn read_fn, void *ctx, async_io_stats_t *stats)
+{
+    async_reader_t *r = calloc(1, sizeof(*r));
+    if (!r) {
+        WARN_CALLOC("async_reader_create_direct()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    r->read_fn = read_fn;
+    r->ctx     = ctx;
+    r->stats   = stats;
+    // no buf, read when requested
+
+    return r;
+}
+
+size_t async_reader_read(async_reader_t *r, void *ptr, size_t size, size_t nmemb)
+{
+    size_t want = size * nmemb;
+    size_t done = 0;
+
+    if (!r->buf) {
+        // no background thread
+        while (done < want) {
+            size_t n = r->read_fn(r->ctx, (uint8_t *)ptr + done, want - done);
+            if (!n)
+                break;
+            done += n;
+        }
+        if (r->stats)
+            r->stats->read_bytes += done;
+        return done / size;
+    }
+
+#ifdef THREADS
+    while (done < want) {
+        if (r->tail == compat_atomic_load_acq_u(&r->head)) {
+            uint64_t wait_start = time_monotonic_ns();
+            pthread_mutex_lock(&r->lock);
+            while (r->tail == r->head && !r->eof)
+                pthread_cond_wait(&r->filled, &r->lock);
+            int empty = r->tail == r->head;
+            pthread_mutex_unlock(&r->lock);
+            if (r->stats)
+                r->stats->read_wait_ns += time_monotonic_ns() - wait_start;
+            if (empty)
+                break; // end of input
+        }
+
+        unsigned idx = r->tail % ASYNC_READER_BLOCKS;
+        size_t avail = r->len[idx] - r->pos;
+        size_t n     = want - done < avail ? want - done : avail;
+        memcpy((uint8_t *)ptr + done, &r->buf[(size_t)idx * ASYNC_READER_BLOCK_LEN + r->pos], n);
+        done += n;
+        r->pos += n;
+        if (r->pos == r->len[idx]) {
+            r->pos = 0;
+            pthread_mutex_lock(&r->lock);
+            compat_atomic_store_rel_u(&r->tail, r->tail + 1);
+            pthread_mutex_unlock(&r->lock);
+            pthread_cond_signal(&r->freed);
+        }
+    }
+#endif
+
+    if (r->stats)
+        r->stats->read_bytes += done;
+    return done / size;
+}
+
+void async_reader_free(async_reader_t *r)
+{
+    if (!r)
+        return;
+
+#ifdef THREADS
+    if (r->buf) {
+        pthread_mutex_lock(&r->lock);
+        r->stop = 1;
+        pthread_mutex_unlock(&r->lock);
+        pthread_cond_signal(&r->freed);
+        pthread_join(r->thread, NULL);
+
+        pthread_mutex_destroy(&r->lock);
+        pthread_cond_destroy(&r->filled);
+        pthread_cond_destroy(&r->freed);
+    }
+#endif
+
+    free(r->buf);
+    free(r);
+}
+
+/* writer */
+
+#ifdef THREADS
+static THREAD_RETURN THREAD_CALL writer_thread(void *arg)
+{
+    async_writer_t *w = arg;
+
+    for (;;) {
+        pthread_mutex_lock(&w->lock);
+        while (w->tail == w->head && !w->stop)
+            pthread_cond_wait(&w->queued, &w->lock);
+        int done      = w->tail == w->head; // and stop
+        unsigned tail = w->tail;
+        pthread_mutex_unlock(&w->lock);
+        if (done)
+            break;
+
+        unsigned idx = tail % ASYNC_WRITER_BUFFERS;
+        size_t n     = w->write_fn(w->ctx, &w->buf[(size_t)idx * ASYNC_WRITER_BUFFER_LEN], w->len[idx]);
+
+        pthread_mutex_lock(&w->lock);
+        if (n != w->len[idx])
+            w->error = 1;
+        compat_atomic_store_rel_u(&w->tail, tail + 1);
+        pthread_mutex_unlock(&w->lock);
+        pthread_cond_signal(&w->written);
+    }
+
+    return 0;
+}
+#endif
+
+async_writer_t *async_writer_create(async_io_fn write_fn, void *ctx, async_io_stats_t *stats)
+{
+    async_writer_t *w = calloc(1, sizeof(*w));
+    if (!w) {
+        WARN_CALLOC("async_writer_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    w->write_fn = write_fn;
+    w->ctx      = ctx;
+    w->stats    = stats;
+
+    w->buf = malloc((size_t)ASYNC_WRITER_BUFFERS * ASYNC_WRITER_BUFFER_LEN);
+    if (!w->buf) {
+        WARN_MALLOC("async_writer_create()");
+        free(w);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+
+#ifdef THREADS
+    pthread_mutex_init(&w->lock, NULL);
+    pthread_cond_init(&w->queued, NULL);
+    pthread_cond_init(&w->written, NULL);
+    if (start_thread(&w->thread, writer_thread, w)) {
+        pthread_mutex_destroy(&w->lock);
+        pthread_cond_destroy(&w->queued);
+        pthread_cond_destroy(&w->written);
+    }
+    else {
+        w->threaded = 1;
+    }
+#endif
+
+    return w;
+}
+
+/// Queue the head buffer, wait if all buffers are queued.
+static void writer_queue(async_writer_t *w)
+{
+    unsigned idx = w->head % ASYNC_WRITER_BUFFERS;
+    w->len[idx]  = w->fill;
+    w->fill      = 0;
+
+    if (!w->threaded) {
+        // no background thread, write the full buffer now
+        uint64_t wait_start = time_monotonic_ns();
+        if (w->write_fn(w->ctx, &w->buf[(size_t)idx * ASYNC_WRITER_BUFFER_LEN], w->len[idx]) != w->len[idx])
+            w->error = 1;
+        if (w->stats)
+            w->stats->write_wait_ns += time_monotonic_ns() - wait_start;
+        return;
+    }
+
+#ifdef THREADS
+    pthread_mutex_lock(&w->lock);
+    compat_atomic_store_rel_u(&w->head, w->head + 1);
+    pthread_mutex_unlock(&w->lock);
+    pthread_cond_signal(&w->queued);
+
+    if (w->head - compat_atomic_load_acq_u(&w->tail) == ASYNC_WRITER_BUFFERS) {
+        uint64_t wait_start = time_monotonic_ns();
+        pthread_mutex_lock(&w->lock);
+        while (w->head - w->tail == ASYNC_WRITER_BUFFERS)
+            pthread_cond_wait(&w->written, &w->lock);
+        pthread_mutex_unlock(&w->lock);
+        if (w->stats)
+            w->stats->write_wait_ns += time_monotonic_ns() - wait_start;
+    }
+#endif
+}
+
+static int writer_error(async_writer_t *w)
+{
+    if (!w->threaded)
+        return w->error;
+#ifdef THREADS
+    pthread_mutex_lock(&w->lock);
+    int error = w->error;
+    pthread_mutex_unlock(&w->lock);
+    return error;
+#endif
+}
+
+int async_writer_write(async_writer_t *w, void const *data, size_t len)
+{
+    if (writer_error(w))
+        return -1;
+
+    size_t done = 0;
+    while (done < len) {
+        unsigned idx = w->head % ASYNC_WRITER_BUFFERS;
+        size_t room  = ASYNC_WRITER_BUFFER_LEN - w->fill;
+        size_t n     = len - done < room ? len - done : room;
+        memcpy(&w->buf[(size_t)idx * ASYNC_WRITER_BUFFER_LEN + w->fill], (uint8_t const *)data + done, n);
+        w->fill += n;
+        done += n;
+        if (w->fill == ASYNC_WRITER_BUFFER_LEN)
+            writer_queue(w);
+    }
+    if (w->stats)
+        w->stats->write_bytes += len;
+
+    return 0;
+}
+
+int async_writer_flush(async_writer_t *w)
+{
+    if (w->fill)
+        writer_queue(w);
+
+#ifdef THREADS
+    if (!w->threaded || compat_atomic_load_acq_u(&w->tail) == w->head)
+        return writer_error(w) ? -1 : 0; // nothing queued
+    uint64_t wait_start = time_monotonic_ns();
+    pthread_mutex_lock(&w->lock);
+    while (w->tail != w->head)
+        pthread_cond_wait(&w->written, &w->lock);
+    pthread_mutex_unlock(&w->lock);
+    if (w->stats)
+        w->stats->write_wait_ns += time_monotonic_ns() - wait_start;
+#endif
+
+    return writer_error(w) ? -1 : 0;
+}
+
+void async_writer_free(async_writer_t *w)
+{
+    if (!w)
+        return;
+
+    async_writer_flush(w);
+
+#ifdef THREADS
+    if (w->threaded) {
+        pthread_mutex_lock(&w->lock);
+        w->stop = 1;
+        pthread_mutex_unlock(&w->lock);
+        pthread_cond_signal(&w->queued);
+        pthread_join(w->thread, NULL);
+
+        pthread_mutex_destroy(&w->lock);
+        pthread_cond_destroy(&w->queued);
+        pthread_cond_destroy(&w->written);
+    }
+#endif
+
+    free(w->buf);
+    free(w);
+}
@@ -18,6 +18,7 @@
 
 #include "logger.h"
 #include "r_util.h"
+#include "baseband_simd.h"
 
 static uint16_t scaled_squares[256];
 
@@ -31,9 +32,9 @@ static void calc_squares(void)
         scaled_squares[i] = (127 - i) * (127 - i);
 }
 
-// This will give a noisy envelope of OOK/ASK signals.
-// Subtract the bias (-128) and get an envelope estimation.
-float envelope_detect(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+// Scalar reference kernels, the SIMD kernels need to be bit-exact with these.
+
+uint32_t envelope_cu8_c(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
 {
     unsigned long i;
     uint32_t sum = 0;
@@ -41,6 +42,61 @@ float envelope_detect(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
         y_buf[i] = scaled_squares[iq_buf[2 * i ]] + scaled_squares[iq_buf[2 * i + 1]];
         sum += y_buf[i];
     }
+    return sum;
+}
+
+uint32_t magnitude_est_cu8_c(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    unsigned long i;
+    uint32_t sum = 0;
+    for (i = 0; i < len; i++) {
+        uint16_t x = abs(iq_buf[2 * i] - 128);
+        uint16_t y = abs(iq_buf[2 * i + 1] - 128);
+        uint16_t mi = x < y ? x : y;
+        uint16_t mx = x > y ? x : y;
+        uint16_t mag_est = 122 * mx + 51 * mi;
+        y_buf[i] = mag_est; // max 22144, fs 16384
+        sum += y_buf[i];
+    }
+    return sum;
+}
+
+uint32_t magnitude_est_cs16_c(int16_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    unsigned long i;
+    uint32_t sum = 0;
+    for (i = 0; i < len; i++) {
+        uint32_t x = abs(iq_buf[2 * i]);
+        uint32_t y = abs(iq_buf[2 * i + 1]);
+        uint32_t mi = x < y ? x : y;
+        uint32_t mx = x > y ? x : y;
+        uint32_t mag_est = 122 * mx + 51 * mi;
+        y_buf[i] = mag_est >> 8; // max 5668864, scaled 22144, fs 16384
+        sum += y_buf[i];
+    }
+    return sum;
+}
+
+/// Kernels selected by baseband_simd_select().
+static struct baseband_kernels {
+    int simd;
+    uint32_t (*envelope_cu8)(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len);
+    uint32_t (*magnitude_est_cu8)(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len);
+    uint32_t (*magnitude_est_cs16)(int16_t const *iq_buf, uint16_t *y_buf, uint32_t len);
+    void (*phase_diff_cu8)(int16_t x1r, int16_t x1i, uint8_t const *x_buf, int16_t *y_buf, uint32_t len);
+} kernels = {
+        BASEBAND_SIMD_NONE,
+        envelope_cu8_c,
+        magnitude_est_cu8_c,
+        magnitude_est_cs16_c,
+        phase_diff_cu8_c,
+};
+
+// This will give a noisy envelope of OOK/ASK signals.
+// Subtract the bias (-128) and get an envelope estimation.
+float envelope_detect(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    uint32_t sum = kernels.envelope_cu8(iq_buf, y_buf, len);
     return len > 0 && sum >= len ? AMP_TO_DB((float)sum / len) : AMP_TO_DB(1);
 }
 
@@ -64,17 +120,7 @@ float envelope_detect_nolut(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len
 /// Note that magnitude emphasizes quiet signals / deemphasizes loud signals.
 float magnitude_est_cu8(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
 {
-    unsigned long i;
-    uint32_t sum = 0;
-    for (i = 0; i < len; i++) {
-        uint16_t x = abs(iq_buf[2 * i] - 128);
-        uint16_t y = abs(iq_buf[2 * i + 1] - 128);
-        uint16_t mi = x < y ? x : y;
-        uint16_t mx = x > y ? x : y;
-        uint16_t mag_est = 122 * mx + 51 * mi;
-        y_buf[i] = mag_est; // max 22144, fs 16384
-        sum += y_buf[i];
-    }
+    uint32_t sum = kernels.magnitude_est_cu8(iq_buf, y_buf, len);
     return len > 0 && sum >= len ? MAG_TO_DB((float)sum / len) : MAG_TO_DB(1);
 }
 
@@ -95,17 +141,7 @@ float magnitude_true_cu8(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
 /// 122/128, 51/128 Magnitude Estimator for CS16 (SIMD has min/max).
 float magnitude_est_cs16(int16_t const *iq_buf, uint16_t *y_buf, uint32_t len)
 {
-    unsigned long i;
-    uint32_t sum = 0;
-    for (i = 0; i < len; i++) {
-        uint32_t x = abs(iq_buf[2 * i]);
-        uint32_t y = abs(iq_buf[2 * i + 1]);
-        uint32_t mi = x < y ? x : y;
-        uint32_t mx = x > y ? x : y;
-        uint32_t mag_est = 122 * mx + 51 * mi;
-        y_buf[i] = mag_est >> 8; // max 5668864, scaled 22144, fs 16384
-        sum += y_buf[i];
-    }
+    uint32_t sum = kernels.magnitude_est_cs16(iq_buf, y_buf, len);
     return len > 0 && sum >= len ? MAG_TO_DB((float)sum / len) : MAG_TO_DB(1);
 }
 
@@ -142,26 +178,33 @@ void baseband_low_pass_filter_reset(filter_state_t *lowpass_filter)
     - but the b coeffs are small so it won't happen
     - Q15.14>>14 = Q15.0
 */
-void baseband_low_pass_filter(filter_state_t *state, uint16_t const *x_buf, int16_t *y_buf, uint32_t len)
+
+///  [b,a] = butter(1, 0.01) -> 3x tau (95%) ~100 samples
+//static int const lp_a[FILTER_ORDER + 1] = {FIX(1.00000) >> 1, FIX(0.96907) >> 1};
+//static int const lp_b[FILTER_ORDER + 1] = {FIX(0.015466) >> 1, FIX(0.015466) >> 1};
+///  [b,a] = butter(1, 0.05) -> 3x tau (95%) ~20 samples
+static int const lp_a[FILTER_ORDER + 1] = {FIX(1.00000) >> 1, FIX(0.85408) >> 1};
+static int const lp_b[FILTER_ORDER + 1] = {FIX(0.07296) >> 1, FIX(0.07296) >> 1};
+// note that coeffs are prescaled by div 2
+
+/// Lowpass filter @p len > 0 samples, @p x1, @p y1 are the input and output sample before the first.
+static void low_pass_run(int32_t x1, int32_t y1, uint16_t const *x_buf, int16_t *y_buf, uint32_t len)
 {
-    ///  [b,a] = butter(1, 0.01) -> 3x tau (95%) ~100 samples
-    //static int const a[FILTER_ORDER + 1] = {FIX(1.00000) >> 1, FIX(0.96907) >> 1};
-    //static int const b[FILTER_ORDER + 1] = {FIX(0.015466) >> 1, FIX(0.015466) >> 1};
-    ///  [b,a] = butter(1, 0.05) -> 3x tau (95%) ~20 samples
-    static int const a[FILTER_ORDER + 1] = {FIX(1.00000) >> 1, FIX(0.85408) >> 1};
-    static int const b[FILTER_ORDER + 1] = {FIX(0.07296) >> 1, FIX(0.07296) >> 1};
-    // note that coeffs are prescaled by div 2
+    // Calculate first sample
+    y_buf[0] = (lp_a[1] * y1 + lp_b[0] * (x_buf[0] + x1)) >> (F_SCALE - 1); // note: prescaled, b[0]==b[1]
+    for (unsigned long i = 1; i < len; i++) {
+        y_buf[i] = (lp_a[1] * y_buf[i - 1] + lp_b[0] * (x_buf[i] + x_buf[i - 1])) >> (F_SCALE - 1); // note: prescaled, b[0]==b[1]
+    }
+}
 
+void baseband_low_pass_filter(filter_state_t *state, uint16_t const *x_buf, int16_t *y_buf, uint32_t len)
+{
     // Prevent out of bounds access
     if (len < FILTER_ORDER) {
         return;
     }
 
-    // Calculate first sample
-    y_buf[0] = (a[1] * state->y[0] + b[0] * (x_buf[0] + state->x[0])) >> (F_SCALE - 1); // note: prescaled, b[0]==b[1]
-    for (unsigned long i = 1; i < len; i++) {
-        y_buf[i] = (a[1] * y_buf[i - 1] + b[0] * (x_buf[i] + x_buf[i - 1])) >> (F_SCALE - 1); // note: prescaled, b[0]==b[1]
-    }
+    low_pass_run(state->x[0], state->y[0], x_buf, y_buf, len);
 
     // Save last samples
     memcpy(state->x, &x_buf[len - FILTER_ORDER], FILTER_ORDER * sizeof (int16_t));
@@ -233,44 +276,58 @@ void baseband_demod_FM(demodfm_state_t *state, uint8_t const *x_buf, int16_t *y_
     int32_t const *alp = state->alp_16;
     int32_t const *blp = state->blp_16;
 
+    if (!num_samples)
+        return;
+
+    // Instantaneous frequency into y_buf, the phase difference is SIMD friendly
+    kernels.phase_diff_cu8(state->xr, state->xi, x_buf, y_buf, num_samples);
+
     // Pre-feed old sample
-    int16_t x0r = state->xr; // IQ sample: x[n], real
-    int16_t x0i = state->xi; // IQ sample: x[n], imag
     int16_t x0f = state->xf; // Instantaneous frequency
     int16_t y0f = state->yf; // Instantaneous frequency, low pass filtered
 
     for (unsigned n = 0; n < num_samples; n++) {
-        int16_t x1r, x1i; // Old IQ sample: x[n-1]
         int16_t x1f, y1f; // Instantaneous frequency, old sample
-        int32_t pr, pi;   // Phase difference vector
 
         // delay old sample
-        x1r = x0r;
-        x1i = x0i;
         y1f = y0f;
         x1f = x0f;
-        // get new sample
-        x0r = *x_buf++ - 128;
-        x0i = *x_buf++ - 128;
-        // Calculate phase difference vector: x[n] * conj(x[n-1])
-        pr = x0r * x1r + x0i * x1i; // May exactly overflow an int16_t (-128*-128 + -128*-128)
-        pi = x0i * x1r - x0r * x1i;
-        // xlp = (int16_t)((atan2f(pi, pr) / M_PI) * INT16_MAX); // Floating point implementation
-        x0f = atan2_int16(pi, pr); // Integer implementation
-        // xlp = pi; // Cheat and use only imaginary part (works OK, but is amplitude sensitive)
+        // get new instantaneous frequency
+        x0f = y_buf[n];
         // Low pass filter
         // y0f      = ((alp[1] * y1f >> 1) + (blp[0] * x0f >> 1) + (blp[1] * x1f >> 1)) >> (F_SCALE - 1);
         y0f      = (alp[1] * y1f + blp[0] * (x0f + x1f)) >> (F_SCALE - 1); // note: prescaled, blp[0]==blp[1]
-        *y_buf++ = y0f;
+        y_buf[n] = y0f;
     }
 
     // Store newest sample for next run
-    state->xr = x0r;
-    state->xi = x0i;
+    state->xr = x_buf[2 * num_samples - 2] - 128;
+    state->xi = x_buf[2 * num_samples - 1] - 128;
     state->xf = x0f;
     state->yf = y0f;
 }
 
+/// Instantaneous frequency of CU8 samples, @p x1r, @p x1i is the sample before the first.
+void phase_diff_cu8_c(int16_t x1r, int16_t x1i, uint8_t const *x_buf, int16_t *y_buf, uint32_t len)
+{
+    for (unsigned n = 0; n < len; n++) {
+        int32_t pr, pi; // Phase difference vector
+
+        // get new sample
+        int16_t x0r = *x_buf++ - 128;
+        int16_t x0i = *x_buf++ - 128;
+        // Calculate phase difference vector: x[n] * conj(x[n-1])
+        pr = x0r * x1r + x0i * x1i; // May exactly overflow an int16_t (-128*-128 + -128*-128)
+        pi = x0i * x1r - x0r * x1i;
+        // xlp = (int16_t)((atan2f(pi, pr) / M_PI) * INT16_MAX); // Floating point implementation
+        *y_buf++ = atan2_int16(pi, pr); // Integer implementation
+        // xlp = pi; // Cheat and use only imaginary part (works OK, but is amplitude sensitive)
+        // delay old sample
+        x1r = x0r;
+        x1i = x0i;
+    }
+}
+
 
 // Fixed-point arithmetic on Q0.31 (actually Q0.30 to counter 64 signed trouble)
 #define F_SCALE32 30
@@ -365,7 +422,120 @@ void baseband_demod_FM_cs16(demodfm_state_t *state, int16_t const *x_buf, int16_
     state->yf = y0f;
 }
 
+/// Samples per tile of the fused front end, small enough for the envelope and outputs to stay in L1 cache.
+#define BASEBAND_TILE_LEN 2048
+
+float baseband_demod_AM_FM(filter_state_t *lowpass_state, demodfm_state_t *fm_state,
+        uint8_t const *iq_buf, unsigned sample_size, int use_mag_est,
+        int16_t *am_buf, int16_t *fm_buf, uint32_t len, uint32_t samp_rate, float low_pass)
+{
+    uint16_t env_buf[BASEBAND_TILE_LEN];
+    int cs16     = sample_size == 4;
+    uint32_t sum = 0;
+    // the filter input is carried over unsigned between tiles, the state truncates it like a block boundary
+    int32_t x1 = lowpass_state->x[0];
+    int32_t y1 = lowpass_state->y[0];
+
+    for (uint32_t pos = 0; pos < len; pos += BASEBAND_TILE_LEN) {
+        uint32_t n = len - pos < BASEBAND_TILE_LEN ? len - pos : BASEBAND_TILE_LEN;
+        // without FM the envelope goes to the FM buffer, as the separate passes leave it
+        uint16_t *env = !fm_state && fm_buf ? (uint16_t *)&fm_buf[pos] : env_buf;
+        if (cs16) {
+            int16_t const *x_buf = (int16_t const *)iq_buf + 2 * pos;
+            sum += kernels.magnitude_est_cs16(x_buf, env, n);
+            if (fm_state)
+                baseband_demod_FM_cs16(fm_state, x_buf, &fm_buf[pos], n, samp_rate, low_pass);
+        }
+        else {
+            uint8_t const *x_buf = &iq_buf[2 * pos];
+            sum += use_mag_est ? kernels.magnitude_est_cu8(x_buf, env, n) : kernels.envelope_cu8(x_buf, env, n);
+            if (fm_state)
+                baseband_demod_FM(fm_state, x_buf, &fm_buf[pos], n, samp_rate, low_pass);
+        }
+        low_pass_run(x1, y1, env, &am_buf[pos], n);
+        x1 = env[n - 1];
+        y1 = am_buf[pos + n - 1];
+    }
+    if (len >= FILTER_ORDER) {
+        lowpass_state->x[0] = (int16_t)x1;
+        lowpass_state->y[0] = (int16_t)y1;
+    }
+
+    if (cs16 || use_mag_est)
+        return len > 0 && sum >= len ? MAG_TO_DB((float)sum / len) : MAG_TO_DB(1);
+    return len > 0 && sum >= len ? AMP_TO_DB((float)sum / len) : AMP_TO_DB(1);
+}
+
+int baseband_simd_supported(int simd)
+{
+    switch (simd) {
+    case BASEBAND_SIMD_NONE:
+        return 1;
+#ifdef BASEBAND_SIMD_X86
+    case BASEBAND_SIMD_SSE2:
+        return baseband_cpu_has_sse2();
+    case BASEBAND_SIMD_AVX2:
+        return baseband_cpu_has_avx2();
+#endif
+#ifdef BASEBAND_SIMD_ARM
+    case BASEBAND_SIMD_NEON:
+        return 1; // NEON is always available if the compiler targets it
+#endif
+    default:
+        return 0;
+    }
+}
+
+int baseband_simd_select(int simd)
+{
+    if (!baseband_simd_supported(simd))
+        simd = BASEBAND_SIMD_NONE;
+
+    struct baseband_kernels k = {
+            BASEBAND_SIMD_NONE,
+            envelope_cu8_c,
+            magnitude_est_cu8_c,
+            magnitude_est_cs16_c,
+            phase_diff_cu8_c,
+    };
+#ifdef BASEBAND_SIMD_X86
+    if (simd == BASEBAND_SIMD_SSE2) {
+        k = (struct baseband_kernels){simd, envelope_cu8_sse2, magnitude_est_cu8_sse2, magnitude_est_cs16_sse2, phase_diff_cu8_sse2};
+    }
+    if (simd == BASEBAND_SIMD_AVX2) {
+        k = (struct baseband_kernels){simd, envelope_cu8_avx2, magnitude_est_cu8_avx2, magnitude_est_cs16_avx2, phase_diff_cu8_avx2};
+    }
+#endif
+#ifdef BASEBAND_SIMD_ARM
+    if (simd == BASEBAND_SIMD_NEON) {
+        k = (struct baseband_kernels){simd, envelope_cu8_neon, magnitude_est_cu8_neon, magnitude_est_cs16_neon, phase_diff_cu8_neon};
+    }
+#endif
+    kernels = k;
+
+    return kernels.simd;
+}
+
+char const *baseband_simd_name(int simd)
+{
+    switch (simd) {
+    case BASEBAND_SIMD_NONE: return "scalar";
+    case BASEBAND_SIMD_SSE2: return "SSE2";
+    case BASEBAND_SIMD_AVX2: return "AVX2";
+    case BASEBAND_SIMD_NEON: return "NEON";
+    default: return "unknown";
+    }
+}
+
 void baseband_init(void)
 {
     calc_squares();
+
+    // pick the best kernels for this CPU
+    int simd = BASEBAND_SIMD_NONE;
+    for (int i = BASEBAND_SIMD_NONE + 1; i < BASEBAND_SIMD_END; ++i) {
+        if (baseband_simd_supported(i))
+            simd = i;
+    }
+    baseband_simd_select(simd);
 }
@@ -0,0 +1,476 @@
+/** @file
+    SIMD kernels for envelope, magnitude, and FM demodulation.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+// All kernels are bit-exact with the scalar kernels in baseband.c,
+// the scalar kernels process the samples left over at the end.
+
+#include "baseband_simd.h"
+
+#define I_PI_4   (INT16_MAX / 4)     // M_PI/4, see atan2_int16()
+#define I_3_PI_4 (3 * INT16_MAX / 4) // 3*M_PI/4
+
+#ifdef BASEBAND_SIMD_X86
+
+#include <immintrin.h>
+
+int baseband_cpu_has_sse2(void)
+{
+    return 1; // SSE2 is part of x86-64
+}
+
+int baseband_cpu_has_avx2(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+/// SSE2: Horizontal sum of 32-bit lanes.
+static inline uint32_t hsum_epi32_sse2(__m128i v)
+{
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return (uint32_t)_mm_cvtsi128_si32(v);
+}
+
+/// SSE2: Pack 32-bit lanes in the range 0 to 32768 to unsigned 16-bit, there is no packus_epi32.
+static inline __m128i pack_u16_sse2(__m128i lo, __m128i hi)
+{
+    __m128i const bias = _mm_set1_epi32(32768);
+    __m128i const flip = _mm_set1_epi16((short)0x8000);
+    __m128i y = _mm_packs_epi32(_mm_sub_epi32(lo, bias), _mm_sub_epi32(hi, bias));
+    return _mm_xor_si128(y, flip);
+}
+
+/// SSE2: Swap the I and Q of 16-bit I/Q pairs.
+static inline __m128i swap_iq_sse2(__m128i v)
+{
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+uint32_t envelope_cu8_sse2(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const c127 = _mm_set1_epi16(127);
+    __m128i acc        = zero;
+    uint32_t i;
+    for (i = 0; i + 8 <= len; i += 8) {
+        __m128i v  = _mm_loadu_si128((__m128i const *)&iq_buf[2 * i]);
+        __m128i lo = _mm_sub_epi16(c127, _mm_unpacklo_epi8(v, zero));
+        __m128i hi = _mm_sub_epi16(c127, _mm_unpackhi_epi8(v, zero));
+        // (127 - i)^2 + (127 - q)^2, same as the squares table
+        __m128i e_lo = _mm_madd_epi16(lo, lo);
+        __m128i e_hi = _mm_madd_epi16(hi, hi);
+        acc = _mm_add_epi32(acc, _mm_add_epi32(e_lo, e_hi));
+        _mm_storeu_si128((__m128i *)&y_buf[i], pack_u16_sse2(e_lo, e_hi));
+    }
+    return hsum_epi32_sse2(acc) + envelope_cu8_c(&iq_buf[2 * i], &y_buf[i], len - i);
+}
+
+/// SSE2: 122 * max + 51 * min of 16-bit I/Q pairs, to 32-bit lanes.
+static inline __m128i mag_est_epi16_sse2(__m128i v)
+{
+    __m128i const c_mx = _mm_set1_epi32(122); // 122 on the even 16-bit lanes
+    __m128i const c_mi = _mm_set1_epi32(51);  // 51 on the even 16-bit lanes
+    __m128i sw = swap_iq_sse2(v);
+    __m128i mx = _mm_max_epi16(v, sw);
+    __m128i mi = _mm_min_epi16(v, sw);
+    return _mm_add_epi32(_mm_madd_epi16(mx, c_mx), _mm_madd_epi16(mi, c_mi));
+}
+
+uint32_t magnitude_est_cu8_sse2(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const c128 = _mm_set1_epi8((char)0x80);
+    __m128i acc        = zero;
+    uint32_t i;
+    for (i = 0; i + 8 <= len; i += 8) {
+        __m128i v = _mm_loadu_si128((__m128i const *)&iq_buf[2 * i]);
+        // abs(x - 128) on unsigned bytes
+        __m128i a    = _mm_sub_epi8(_mm_max_epu8(v, c128), _mm_min_epu8(v, c128));
+        __m128i m_lo = mag_est_epi16_sse2(_mm_unpacklo_epi8(a, zero));
+        __m128i m_hi = mag_est_epi16_sse2(_mm_unpackhi_epi8(a, zero));
+        acc = _mm_add_epi32(acc, _mm_add_epi32(m_lo, m_hi));
+        _mm_storeu_si128((__m128i *)&y_buf[i], _mm_packs_epi32(m_lo, m_hi)); // max 22144
+    }
+    return hsum_epi32_sse2(acc) + magnitude_est_cu8_c(&iq_buf[2 * i], &y_buf[i], len - i);
+}
+
+/// SSE2: Scaled magnitude estimate of 4 CS16 samples, to 32-bit lanes.
+static inline __m128i mag_est_cs16_sse2(__m128i v)
+{
+    __m128i re = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+    __m128i im = _mm_srai_epi32(v, 16);
+    __m128i s  = _mm_srai_epi32(re, 31);
+    re         = _mm_sub_epi32(_mm_xor_si128(re, s), s);
+    s          = _mm_srai_epi32(im, 31);
+    im         = _mm_sub_epi32(_mm_xor_si128(im, s), s);
+    __m128i gt = _mm_cmpgt_epi32(re, im);
+    __m128i mx = _mm_or_si128(_mm_and_si128(gt, re), _mm_andnot_si128(gt, im));
+    __m128i mi = _mm_or_si128(_mm_andnot_si128(gt, re), _mm_and_si128(gt, im));
+    // 122 * mx + 51 * mi, there is no 32-bit multiply in SSE2
+    __m128i m = _mm_sub_epi32(_mm_slli_epi32(mx, 7), _mm_add_epi32(_mm_slli_epi32(mx, 2), _mm_slli_epi32(mx, 1)));
+    m = _mm_add_epi32(m, _mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(mi, 5), _mm_slli_epi32(mi, 4)), _mm_add_epi32(_mm_slli_epi32(mi, 1), mi)));
+    return _mm_srli_epi32(m, 8);
+}
+
+uint32_t magnitude_est_cs16_sse2(int16_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    __m128i acc = _mm_setzero_si128();
+    uint32_t i;
+    for (i = 0; i + 8 <= len; i += 8) {
+        __m128i m_lo = mag_est_cs16_sse2(_mm_loadu_si128((__m128i const *)&iq_buf[2 * i]));
+        __m128i m_hi = mag_est_cs16_sse2(_mm_loadu_si128((__m128i const *)&iq_buf[2 * i + 8]));
+        acc = _mm_add_epi32(acc, _mm_add_epi32(m_lo, m_hi));
+        _mm_storeu_si128((__m128i *)&y_buf[i], _mm_packs_epi32(m_lo, m_hi)); // max 22144
+    }
+    return hsum_epi32_sse2(acc) + magnitude_est_cs16_c(&iq_buf[2 * i], &y_buf[i], len - i);
+}
+
+/// SSE2: atan2_int16() on 32-bit lanes, the division is exact in double precision.
+static inline __m128i atan2_int16_sse2(__m128i y, __m128i x)
+{
+    __m128i const zero  = _mm_setzero_si128();
+    __m128i const one   = _mm_set1_epi32(1);
+    __m128d const scale = _mm_set1_pd(I_PI_4);
+
+    __m128i ys   = _mm_srai_epi32(y, 31);
+    __m128i ay   = _mm_sub_epi32(_mm_xor_si128(y, ys), ys);
+    __m128i xs   = _mm_srai_epi32(x, 31); // x < 0: Quadrant II and III
+    __m128i ax   = _mm_sub_epi32(_mm_xor_si128(x, xs), xs);
+    __m128i nay  = _mm_sub_epi32(zero, ay);
+    __m128i num  = _mm_add_epi32(x, _mm_or_si128(_mm_and_si128(xs, ay), _mm_andnot_si128(xs, nay))); // x - abs_y, or x + abs_y
+    __m128i den  = _mm_add_epi32(ay, ax); // abs_y + x, or abs_y - x
+    den          = _mm_add_epi32(den, _mm_and_si128(_mm_cmpeq_epi32(den, zero), one));
+    __m128i base = _mm_or_si128(_mm_and_si128(xs, _mm_set1_epi32(I_3_PI_4)), _mm_andnot_si128(xs, _mm_set1_epi32(I_PI_4)));
+
+    __m128d q0 = _mm_div_pd(_mm_mul_pd(_mm_cvtepi32_pd(num), scale), _mm_cvtepi32_pd(den));
+    num        = _mm_shuffle_epi32(num, _MM_SHUFFLE(1, 0, 3, 2));
+    den        = _mm_shuffle_epi32(den, _MM_SHUFFLE(1, 0, 3, 2));
+    __m128d q1 = _mm_div_pd(_mm_mul_pd(_mm_cvtepi32_pd(num), scale), _mm_cvtepi32_pd(den));
+    __m128i q  = _mm_unpacklo_epi64(_mm_cvttpd_epi32(q0), _mm_cvttpd_epi32(q1));
+
+    __m128i angle = _mm_sub_epi32(base, q);
+    angle         = _mm_sub_epi32(_mm_xor_si128(angle, ys), ys); // Negate if in III or IV
+    __m128i zz    = _mm_and_si128(_mm_cmpeq_epi32(x, zero), _mm_cmpeq_epi32(y, zero));
+    return _mm_andnot_si128(zz, angle);
+}
+
+/// SSE2: Phase difference vector of 16-bit I/Q pairs, x[n] * conj(x[n-1]).
+static inline void phase_diff_sse2(__m128i cur, __m128i prev, __m128i *pr, __m128i *pi)
+{
+    __m128i const conj = _mm_set_epi16(-1, 1, -1, 1, -1, 1, -1, 1);
+    *pr = _mm_madd_epi16(cur, prev);
+    *pi = _mm_madd_epi16(swap_iq_sse2(cur), _mm_mullo_epi16(prev, conj));
+}
+
+void phase_diff_cu8_sse2(int16_t x1r, int16_t x1i, uint8_t const *x_buf, int16_t *y_buf, uint32_t len)
+{
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const c128 = _mm_set1_epi16(128);
+    if (!len)
+        return;
+    // the first sample needs the previous state
+    phase_diff_cu8_c(x1r, x1i, x_buf, y_buf, 1);
+    uint32_t n;
+    for (n = 1; n + 8 <= len; n += 8) {
+        __m128i cur  = _mm_loadu_si128((__m128i const *)&x_buf[2 * n]);
+        __m128i prev = _mm_loadu_si128((__m128i const *)&x_buf[2 * n - 2]);
+        __m128i pr, pi, a_lo, a_hi;
+        phase_diff_sse2(_mm_sub_epi16(_mm_unpacklo_epi8(cur, zero), c128), _mm_sub_epi16(_mm_unpacklo_epi8(prev, zero), c128), &pr, &pi);
+        a_lo = atan2_int16_sse2(pi, pr);
+        phase_diff_sse2(_mm_sub_epi16(_mm_unpackhi_epi8(cur, zero), c128), _mm_sub_epi16(_mm_unpackhi_epi8(prev, zero), c128), &pr, &pi);
+        a_hi = atan2_int16_sse2(pi, pr);
+        _mm_storeu_si128((__m128i *)&y_buf[n], _mm_packs_epi32(a_lo, a_hi));
+    }
+    phase_diff_cu8_c(x_buf[2 * n - 2] - 128, x_buf[2 * n - 1] - 128, &x_buf[2 * n], &y_buf[n], len - n);
+}
+
+/// AVX2: Horizontal sum of 32-bit lanes.
+__attribute__((target("avx2")))
+static inline uint32_t hsum_epi32_avx2(__m256i v)
+{
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return (uint32_t)_mm_cvtsi128_si32(s);
+}
+
+/// AVX2: Pack 32-bit lanes to unsigned 16-bit, keeping the order across the 128-bit lanes.
+__attribute__((target("avx2")))
+static inline __m256i pack_u16_avx2(__m256i lo, __m256i hi)
+{
+    return _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+/// AVX2: Pack 32-bit lanes to signed 16-bit, keeping the order across the 128-bit lanes.
+__attribute__((target("avx2")))
+static inline __m256i pack_s16_avx2(__m256i lo, __m256i hi)
+{
+    return _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+/// AVX2: Swap the I and Q of 16-bit I/Q pairs.
+__attribute__((target("avx2")))
+static inline __m256i swap_iq_avx2(__m256i v)
+{
+    return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+__attribute__((target("avx2")))
+uint32_t envelope_cu8_avx2(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    __m256i const c127 = _mm256_set1_epi16(127);
+    __m256i acc        = _mm256_setzero_si256();
+    uint32_t i;
+    for (i = 0; i + 16 <= len; i += 16) {
+        __m256i lo = _mm256_sub_epi16(c127, _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i const *)&iq_buf[2 * i])));
+        __m256i hi = _mm256_sub_epi16(c127, _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i const *)&iq_buf[2 * i + 16])));
+        // (127 - i)^2 + (127 - q)^2, same as the squares table
+        __m256i e_lo = _mm256_madd_epi16(lo, lo);
+        __m256i e_hi = _mm256_madd_epi16(hi, hi);
+        acc = _mm256_add_epi32(acc, _mm256_add_epi32(e_lo, e_hi));
+        _mm256_storeu_si256((__m256i *)&y_buf[i], pack_u16_avx2(e_lo, e_hi));
+    }
+    return hsum_epi32_avx2(acc) + envelope_cu8_c(&iq_buf[2 * i], &y_buf[i], len - i);
+}
+
+/// AVX2: 122 * max + 51 * min of abs(x - 128) of 8 CU8 samples, to 32-bit lanes.
+__attribute__((target("avx2")))
+static inline __m256i mag_est_cu8_avx2(__m128i v)
+{
+    __m128i const c128 = _mm_set1_epi8((char)0x80);
+    __m256i const c_mx = _mm256_set1_epi32(122); // 122 on the even 16-bit lanes
+    __m256i const c_mi = _mm256_set1_epi32(51);  // 51 on the even 16-bit lanes
+    __m256i a  = _mm256_cvtepu8_epi16(_mm_sub_epi8(_mm_max_epu8(v, c128), _mm_min_epu8(v, c128)));
+    __m256i sw = swap_iq_avx2(a);
+    __m256i mx = _mm256_max_epi16(a, sw);
+    __m256i mi = _mm256_min_epi16(a, sw);
+    return _mm256_add_epi32(_mm256_madd_epi16(mx, c_mx), _mm256_madd_epi16(mi, c_mi));
+}
+
+__attribute__((target("avx2")))
+uint32_t magnitude_est_cu8_avx2(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    __m256i acc = _mm256_setzero_si256();
+    uint32_t i;
+    for (i = 0; i + 16 <= len; i += 16) {
+        __m256i m_lo = mag_est_cu8_avx2(_mm_loadu_si128((__m128i const *)&iq_buf[2 * i]));
+        __m256i m_hi = mag_est_cu8_avx2(_mm_loadu_si128((__m128i const *)&iq_buf[2 * i + 16]));
+        acc = _mm256_add_epi32(acc, _mm256_add_epi32(m_lo, m_hi));
+        _mm256_storeu_si256((__m256i *)&y_buf[i], pack_u16_avx2(m_lo, m_hi));
+    }
+    return hsum_epi32_avx2(acc) + magnitude_est_cu8_c(&iq_buf[2 * i], &y_buf[i], len - i);
+}
+
+/// AVX2: Scaled magnitude estimate of 8 CS16 samples, to 32-bit lanes.
+__attribute__((target("avx2")))
+static inline __m256i mag_est_cs16_avx2(__m256i v)
+{
+    __m256i re = _mm256_abs_epi32(_mm256_srai_epi32(_mm256_slli_epi32(v, 16), 16));
+    __m256i im = _mm256_abs_epi32(_mm256_srai_epi32(v, 16));
+    __m256i mx = _mm256_max_epi32(re, im);
+    __m256i mi = _mm256_min_epi32(re, im);
+    __m256i m  = _mm256_add_epi32(_mm256_mullo_epi32(mx, _mm256_set1_epi32(122)), _mm256_mullo_epi32(mi, _mm256_set1_epi32(51)));
+    return _mm256_srli_epi32(m, 8);
+}
+
+__attribute__((target("avx2")))
+uint32_t magnitude_est_cs16_avx2(int16_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    __m256i acc = _mm256_setzero_si256();
+    uint32_t i;
+    for (i = 0; i + 16 <= len; i += 16) {
+        __m256i m_lo = mag_est_cs16_avx2(_mm256_loadu_si256((__m256i const *)&iq_buf[2 * i]));
+        __m256i m_hi = mag_est_cs16_avx2(_mm256_loadu_si256((__m256i const *)&iq_buf[2 * i + 16]));
+        acc = _mm256_add_epi32(acc, _mm256_add_epi32(m_lo, m_hi));
+        _mm256_storeu_si256((__m256i *)&y_buf[i], pack_u16_avx2(m_lo, m_hi)); // max 22144
+    }
+    return hsum_epi32_avx2(acc) + magnitude_est_cs16_c(&iq_buf[2 * i], &y_buf[i], len - i);
+}
+
+/// AVX2: atan2_int16() on 32-bit lanes, the division is exact in double precision.
+__attribute__((target("avx2")))
+static inline __m256i atan2_int16_avx2(__m256i y, __m256i x)
+{
+    __m256i const zero  = _mm256_setzero_si256();
+    __m256d const scale = _mm256_set1_pd(I_PI_4);
+
+    __m256i ay   = _mm256_abs_epi32(y);
+    __m256i xneg = _mm256_cmpgt_epi32(zero, x); // Quadrant II and III
+    __m256i num  = _mm256_blendv_epi8(_mm256_sub_epi32(x, ay), _mm256_add_epi32(x, ay), xneg);
+    __m256i den  = _mm256_max_epi32(_mm256_add_epi32(ay, _mm256_abs_epi32(x)), _mm256_set1_epi32(1));
+    __m256i base = _mm256_blendv_epi8(_mm256_set1_epi32(I_PI_4), _mm256_set1_epi32(I_3_PI_4), xneg);
+
+    __m256d q0 = _mm256_div_pd(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(num)), scale),
+            _mm256_cvtepi32_pd(_mm256_castsi256_si128(den)));
+    __m256d q1 = _mm256_div_pd(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(num, 1)), scale),
+            _mm256_cvtepi32_pd(_mm256_extracti128_si256(den, 1)));
+    __m256i q  = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm256_cvttpd_epi32(q0)), _mm256_cvttpd_epi32(q1), 1);
+
+    __m256i angle = _mm256_sign_epi32(_mm256_sub_epi32(base, q), _mm256_or_si256(y, _mm256_set1_epi32(1))); // Negate if in III or IV
+    __m256i zz    = _mm256_and_si256(_mm256_cmpeq_epi32(x, zero), _mm256_cmpeq_epi32(y, zero));
+    return _mm256_andnot_si256(zz, angle);
+}
+
+/// AVX2: Instantaneous frequency of 8 CU8 samples, to 32-bit lanes.
+__attribute__((target("avx2")))
+static inline __m256i phase_diff_avx2(__m128i cur, __m128i prev)
+{
+    __m256i const c128 = _mm256_set1_epi16(128);
+    __m256i const conj = _mm256_set1_epi32(-65535); // 1, -1 on the 16-bit lanes
+    __m256i c  = _mm256_sub_epi16(_mm256_cvtepu8_epi16(cur), c128);
+    __m256i p  = _mm256_sub_epi16(_mm256_cvtepu8_epi16(prev), c128);
+    __m256i pr = _mm256_madd_epi16(c, p);
+    __m256i pi = _mm256_madd_epi16(swap_iq_avx2(c), _mm256_sign_epi16(p, conj));
+    return atan2_int16_avx2(pi, pr);
+}
+
+__attribute__((target("avx2")))
+void phase_diff_cu8_avx2(int16_t x1r, int16_t x1i, uint8_t const *x_buf, int16_t *y_buf, uint32_t len)
+{
+    if (!len)
+        return;
+    // the first sample needs the previous state
+    phase_diff_cu8_c(x1r, x1i, x_buf, y_buf, 1);
+    uint32_t n;
+    for (n = 1; n + 16 <= len; n += 16) {
+        __m256i a_lo = phase_diff_avx2(_mm_loadu_si128((__m128i const *)&x_buf[2 * n]), _mm_loadu_si128((__m128i const *)&x_buf[2 * n - 2]));
+        __m256i a_hi = phase_diff_avx2(_mm_loadu_si128((__m128i const *)&x_buf[2 * n + 16]), _mm_loadu_si128((__m128i const *)&x_buf[2 * n + 14]));
+        _mm256_storeu_si256((__m256i *)&y_buf[n], pack_s16_avx2(a_lo, a_hi));
+    }
+    phase_diff_cu8_c(x_buf[2 * n - 2] - 128, x_buf[2 * n - 1] - 128, &x_buf[2 * n], &y_buf[n], len - n);
+}
+
+#endif /* BASEBAND_SIMD_X86 */
+
+#ifdef BASEBAND_SIMD_ARM
+
+#include <arm_neon.h>
+
+uint32_t envelope_cu8_neon(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    uint8x8_t const c127 = vdup_n_u8(127);
+    uint32x4_t acc       = vdupq_n_u32(0);
+    uint32_t i;
+    for (i = 0; i + 16 <= len; i += 16) {
+        uint8x16x2_t v = vld2q_u8(&iq_buf[2 * i]);
+        // (127 - i)^2 + (127 - q)^2, same as the squares table
+        int16x8_t r_lo = vreinterpretq_s16_u16(vsubl_u8(c127, vget_low_u8(v.val[0])));
+        int16x8_t i_lo = vreinterpretq_s16_u16(vsubl_u8(c127, vget_low_u8(v.val[1])));
+        int16x8_t r_hi = vreinterpretq_s16_u16(vsubl_u8(c127, vget_high_u8(v.val[0])));
+        int16x8_t i_hi = vreinterpretq_s16_u16(vsubl_u8(c127, vget_high_u8(v.val[1])));
+        uint16x8_t e_lo = vaddq_u16(vreinterpretq_u16_s16(vmulq_s16(r_lo, r_lo)), vreinterpretq_u16_s16(vmulq_s16(i_lo, i_lo)));
+        uint16x8_t e_hi = vaddq_u16(vreinterpretq_u16_s16(vmulq_s16(r_hi, r_hi)), vreinterpretq_u16_s16(vmulq_s16(i_hi, i_hi)));
+        acc = vpadalq_u16(vpadalq_u16(acc, e_lo), e_hi);
+        vst1q_u16(&y_buf[i], e_lo);
+        vst1q_u16(&y_buf[i + 8], e_hi);
+    }
+    return vaddvq_u32(acc) + envelope_cu8_c(&iq_buf[2 * i], &y_buf[i], len - i);
+}
+
+uint32_t magnitude_est_cu8_neon(uint8_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    uint8x16_t const c128 = vdupq_n_u8(128);
+    uint8x8_t const c_mx  = vdup_n_u8(122);
+    uint8x8_t const c_mi  = vdup_n_u8(51);
+    uint32x4_t acc        = vdupq_n_u32(0);
+    uint32_t i;
+    for (i = 0; i + 16 <= len; i += 16) {
+        uint8x16x2_t v  = vld2q_u8(&iq_buf[2 * i]);
+        uint8x16_t a    = vabdq_u8(v.val[0], c128);
+        uint8x16_t b    = vabdq_u8(v.val[1], c128);
+        uint8x16_t mx   = vmaxq_u8(a, b);
+        uint8x16_t mi   = vminq_u8(a, b);
+        uint16x8_t m_lo = vmlal_u8(vmull_u8(vget_low_u8(mx), c_mx), vget_low_u8(mi), c_mi);
+        uint16x8_t m_hi = vmlal_u8(vmull_u8(vget_high_u8(mx), c_mx), vget_high_u8(mi), c_mi);
+        acc = vpadalq_u16(vpadalq_u16(acc, m_lo), m_hi);
+        vst1q_u16(&y_buf[i], m_lo);
+        vst1q_u16(&y_buf[i + 8], m_hi);
+    }
+    return vaddvq_u32(acc) + magnitude_est_cu8_c(&iq_buf[2 * i], &y_buf[i], len - i);
+}
+
+/// NEON: Scaled magnitude estimate of 4 CS16 samples.
+static inline uint16x4_t mag_est_cs16_neon(int16x4_t re, int16x4_t im)
+{
+    int32x4_t ar = vabsq_s32(vmovl_s16(re));
+    int32x4_t ai = vabsq_s32(vmovl_s16(im));
+    int32x4_t mx = vmaxq_s32(ar, ai);
+    int32x4_t mi = vminq_s32(ar, ai);
+    int32x4_t m  = vmlaq_n_s32(vmulq_n_s32(mx, 122), mi, 51);
+    return vshrn_n_u32(vreinterpretq_u32_s32(m), 8);
+}
+
+uint32_t magnitude_est_cs16_neon(int16_t const *iq_buf, uint16_t *y_buf, uint32_t len)
+{
+    uint32x4_t acc = vdupq_n_u32(0);
+    uint32_t i;
+    for (i = 0; i + 8 <= len; i += 8) {
+        int16x8x2_t v = vld2q_s16(&iq_buf[2 * i]);
+        uint16x8_t m  = vcombine_u16(
+                mag_est_cs16_neon(vget_low_s16(v.val[0]), vget_low_s16(v.val[1])),
+                mag_est_cs16_neon(vget_high_s16(v.val[0]), vget_high_s16(v.val[1])));
+        acc = vpadalq_u16(acc, m);
+        vst1q_u16(&y_buf[i], m); // max 22144
+    }
+    return vaddvq_u32(acc) + magnitude_est_cs16_c(&iq_buf[2 * i], &y_buf[i], len - i);
+}
+
+/// NEON: atan2_int16() on 32-bit lanes, the division is exact in double precision.
+static inline int32x4_t atan2_int16_neon(int32x4_t y, int32x4_t x)
+{
+    int32x4_t const zero = vdupq_n_s32(0);
+
+    int32x4_t ay   = vabsq_s32(y);
+    uint32x4_t xneg = vcltq_s32(x, zero); // Quadrant II and III
+    int32x4_t num  = vbslq_s32(xneg, vaddq_s32(x, ay), vsubq_s32(x, ay));
+    int32x4_t den  = vmaxq_s32(vaddq_s32(ay, vabsq_s32(x)), vdupq_n_s32(1));
+    int32x4_t base = vbslq_s32(xneg, vdupq_n_s32(I_3_PI_4), vdupq_n_s32(I_PI_4));
+
+    float64x2_t q0 = vdivq_f64(vmulq_n_f64(vcvtq_f64_s64(vmovl_s32(vget_low_s32(num))), I_PI_4),
+            vcvtq_f64_s64(vmovl_s32(vget_low_s32(den))));
+    float64x2_t q1 = vdivq_f64(vmulq_n_f64(vcvtq_f64_s64(vmovl_s32(vget_high_s32(num))), I_PI_4),
+            vcvtq_f64_s64(vmovl_s32(vget_high_s32(den))));
+    int32x4_t q    = vcombine_s32(vmovn_s64(vcvtq_s64_f64(q0)), vmovn_s64(vcvtq_s64_f64(q1)));
+
+    int32x4_t angle = vsubq_s32(base, q);
+    angle           = vbslq_s32(vcltq_s32(y, zero), vnegq_s32(angle), angle); // Negate if in III or IV
+    uint32x4_t zz   = vandq_u32(vceqq_s32(x, zero), vceqq_s32(y, zero));
+    return vbslq_s32(zz, zero, angle);
+}
+
+void phase_diff_cu8_neon(int16_t x1r, int16_t x1i, uint8_t const *x_buf, int16_t *y_buf, uint32_t len)
+{
+    uint8x8_t const c128 = vdup_n_u8(128);
+    if (!len)
+        return;
+    // the first sample needs the previous state
+    phase_diff_cu8_c(x1r, x1i, x_buf, y_buf, 1);
+    uint32_t n;
+    for (n = 1; n + 8 <= len; n += 8) {
+        uint8x8x2_t cur  = vld2_u8(&x_buf[2 * n]);
+        uint8x8x2_t prev = vld2_u8(&x_buf[2 * n - 2]);
+        int16x8_t cr = vreinterpretq_s16_u16(vsubl_u8(cur.val[0], c128));
+        int16x8_t ci = vreinterpretq_s16_u16(vsubl_u8(cur.val[1], c128));
+        int16x8_t pr = vreinterpretq_s16_u16(vsubl_u8(prev.val[0], c128));
+        int16x8_t pi = vreinterpretq_s16_u16(vsubl_u8(prev.val[1], c128));
+        // x[n] * conj(x[n-1])
+        int32x4_t dr_lo = vmlal_s16(vmull_s16(vget_low_s16(cr), vget_low_s16(pr)), vget_low_s16(ci), vget_low_s16(pi));
+        int32x4_t di_lo = vmlsl_s16(vmull_s16(vget_low_s16(ci), vget_low_s16(pr)), vget_low_s16(cr), vget_low_s16(pi));
+        int32x4_t dr_hi = vmlal_s16(vmull_s16(vget_high_s16(cr), vget_high_s16(pr)), vget_high_s16(ci), vget_high_s16(pi));
+        int32x4_t di_hi = vmlsl_s16(vmull_s16(vget_high_s16(ci), vget_high_s16(pr)), vget_high_s16(cr), vget_high_s16(pi));
+        int16x8_t a     = vcombine_s16(vmovn_s32(atan2_int16_neon(di_lo, dr_lo)), vmovn_s32(atan2_int16_neon(di_hi, dr_hi)));
+        vst1q_s16(&y_buf[n], a);
+    }
+    phase_diff_cu8_c(x_buf[2 * n - 2] - 128, x_buf[2 * n - 1] - 128, &x_buf[2 * n], &y_buf[n], len - n);
+}
+
+#endif /* BASEBAND_SIMD_ARM */
@@ -0,0 +1,168 @@
+/** @file
+    Benchmark of the decode pipeline, per stage timing and throughput.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "bench.h"
+#include "compat_time.h"
+#include "r_device.h"
+#include "list.h"
+#include "data.h"
+#include "fatal.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+// reported stages, the decoders stage is split into slicing and decoding
+enum {
+    REPORT_DEMOD,
+    REPORT_DETECT,
+    REPORT_SLICE,
+    REPORT_DECODE,
+    REPORT_OUTPUT,
+    REPORT_STAGES,
+};
+
+bench_t *bench_create(void)
+{
+    bench_t *bench = calloc(1, sizeof(*bench));
+    if (!bench) {
+        WARN_CALLOC("bench_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    return bench;
+}
+
+void bench_free(bench_t *bench)
+{
+    free(bench);
+}
+
+uint64_t bench_now(bench_t const *bench)
+{
+    return bench ? time_monotonic_ns() : 0;
+}
+
+void bench_add(bench_t *bench, bench_stage_t stage, uint64_t start)
+{
+    if (!bench)
+        return;
+    uint64_t elapsed = time_monotonic_ns() - start;
+    bench->stage_ns[stage] += elapsed;
+    if (stage == BENCH_OUTPUT && bench->in_decoders)
+        bench->decoders_output_ns += elapsed;
+}
+
+uint64_t bench_decoders_start(bench_t *bench)
+{
+    if (!bench)
+        return 0;
+    bench->in_decoders = 1;
+    return time_monotonic_ns();
+}
+
+void bench_decoders_end(bench_t *bench, uint64_t start)
+{
+    if (!bench)
+        return;
+    bench->in_decoders = 0;
+    bench_add(bench, BENCH_DECODERS, start);
+}
+
+void bench_input_start(bench_t *bench, char const *filename, list_t *r_devs)
+{
+    bench->filename           = filename;
+    bench->samples            = 0;
+    bench->packages           = 0;
+    bench->events             = 0;
+    bench->decoders_output_ns = 0;
+    memset(bench->stage_ns, 0, sizeof(bench->stage_ns));
+
+    for (void **iter = r_devs->elems; iter && *iter; ++iter) {
+        r_device *r_dev = *iter;
+        r_dev->decode_timing = 1;
+        r_dev->decode_ns     = 0;
+    }
+
+    bench->start_ns = time_monotonic_ns();
+}
+
+static data_t *report_data(char const *name, char const *filename, unsigned inputs, uint64_t ns,
+        uint64_t samples, unsigned packages, unsigned events, uint64_t const *stage_ns)
+{
+    double secs = ns > 0 ? ns * 1e-9 : 1e-9;
+
+    /* clang-format off */
+    data_t *stages = data_make(
+            "demod",            "",     DATA_DOUBLE, stage_ns[REPORT_DEMOD] * 1e-9,
+            "detect",           "",     DATA_DOUBLE, stage_ns[REPORT_DETECT] * 1e-9,
+            "slice",            "",     DATA_DOUBLE, stage_ns[REPORT_SLICE] * 1e-9,
+            "decode",           "",     DATA_DOUBLE, stage_ns[REPORT_DECODE] * 1e-9,
+            "output",           "",     DATA_DOUBLE, stage_ns[REPORT_OUTPUT] * 1e-9,
+            NULL);
+
+    return data_make(
+            "bench",            "",     DATA_STRING, name,
+            "file",             "",     DATA_COND, filename != NULL, DATA_STRING, filename,
+            "inputs",           "",     DATA_COND, filename == NULL, DATA_INT, inputs,
+            "seconds",          "",     DATA_DOUBLE, ns * 1e-9,
+            "samples",          "",     DATA_COND, samples <= INT_MAX, DATA_INT, (int)samples,
+            "samples",          "",     DATA_COND, samples > INT_MAX, DATA_FORMAT, "%.0f", DATA_DOUBLE, (double)samples,
+            "samples_per_sec",  "",     DATA_DOUBLE, samples / secs,
+            "packages",         "",     DATA_INT, packages,
+            "packages_per_sec", "",     DATA_DOUBLE, packages / secs,
+            "events",           "",     DATA_INT, events,
+            "events_per_sec",   "",     DATA_DOUBLE, events / secs,
+            "stage_seconds",    "",     DATA_DATA, stages,
+            NULL);
+    /* clang-format on */
+}
+
+data_t *bench_input_end(bench_t *bench, list_t *r_devs)
+{
+    uint64_t ns = time_monotonic_ns() - bench->start_ns;
+
+    // with one decoder thread the outputs of the decoders run inside decode_fn
+    uint64_t decode_fn_ns = 0;
+    for (void **iter = r_devs->elems; iter && *iter; ++iter) {
+        r_device *r_dev = *iter;
+        decode_fn_ns += r_dev->decode_ns;
+        r_dev->decode_timing = 0;
+    }
+    uint64_t nested_ns   = bench->decoders_output_ns;
+    uint64_t decoders_ns = bench->stage_ns[BENCH_DECODERS] > nested_ns ? bench->stage_ns[BENCH_DECODERS] - nested_ns : 0;
+    uint64_t decode_ns   = decode_fn_ns > nested_ns ? decode_fn_ns - nested_ns : 0;
+    if (decode_ns > decoders_ns)
+        decode_ns = decoders_ns;
+
+    uint64_t stage_ns[REPORT_STAGES];
+    stage_ns[REPORT_DEMOD]  = bench->stage_ns[BENCH_DEMOD];
+    stage_ns[REPORT_DETECT] = bench->stage_ns[BENCH_DETECT];
+    stage_ns[REPORT_SLICE]  = decoders_ns - decode_ns;
+    stage_ns[REPORT_DECODE] = decode_ns;
+    stage_ns[REPORT_OUTPUT] = bench->stage_ns[BENCH_OUTPUT];
+
+    bench->inputs += 1;
+    bench->total_ns += ns;
+    bench->total_samples += bench->samples;
+    bench->total_packages += bench->packages;
+    bench->total_events += bench->events;
+    for (int i = 0; i < REPORT_STAGES; ++i) {
+        bench->total_stage_ns[i] += stage_ns[i];
+    }
+
+    return report_data("input", bench->filename, 1, ns, bench->samples, bench->packages, bench->events, stage_ns);
+}
+
+data_t *bench_total_data(bench_t *bench)
+{
+    return report_data("total", NULL, bench->inputs, bench->total_ns, bench->total_samples,
+            bench->total_packages, bench->total_events, bench->total_stage_ns);
+}
@@ -10,10 +10,14 @@
 */
 
 #include "bit_util.h"
+#include "compat_pthread.h"
 
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#ifdef _TEST
+#include <time.h>
+#endif
 
 uint8_t reverse8(uint8_t x)
 {
@@ -187,7 +191,464 @@ unsigned extract_bits_symbols(uint8_t const *message, unsigned offset_bits, unsi
     return dst_len;
 }
 
+/* Table driven CRC and LFSR digest.
+
+   The lookup tables are built on first use for each polynomial, or LFSR generator
+   and key, and kept in a cache per thread. The cache is sized for the configurations
+   the decoders use, tables are never replaced: once it is full any other configuration
+   is computed bit by bit, rebuilding tables in turn would cost far more than it saves.
+   The CRC tables hold one table per byte position to process 8 bytes per step (slice-by-8).
+   The LFSR tables hold the digest of each nibble value at each byte position.
+*/
+
+#define CRC_TABLES        16 ///< cached CRC tables per thread and CRC width
+#define LFSR_TABLES       24 ///< cached LFSR digest tables per thread
+#define LFSR_TABLE_BYTES  32 ///< message bytes covered by a LFSR digest table, longer messages continue bit by bit
+
+#define CRC_TABLE_USED    0x1000000 ///< marks a used table key
+
+enum lfsr_kind {
+    LFSR_ROLL_RIGHT = 1, ///< the key rolls right, data bits MSB to LSB
+    LFSR_ROLL_LEFT8 = 2, ///< the 8 bit key rolls left, data bits LSB to MSB
+};
+
+typedef struct crc8_table {
+    unsigned key;       ///< reflection and polynomial, 0 if unused
+    uint8_t t[8][256];  ///< the CRC of a byte followed by 0 to 7 zero bytes
+} crc8_table_t;
+
+typedef struct crc16_table {
+    unsigned key;       ///< reflection and polynomial, 0 if unused
+    uint16_t t[8][256]; ///< the CRC of a byte followed by 0 to 7 zero bytes
+} crc16_table_t;
+
+typedef struct lfsr_table {
+    unsigned kind;      ///< lfsr_kind, 0 if unused
+    uint16_t gen;
+    uint16_t key;
+    uint16_t end_key;   ///< the key after LFSR_TABLE_BYTES bytes
+    uint16_t t[LFSR_TABLE_BYTES][32]; ///< the digest of each low and high nibble at each byte
+} lfsr_table_t;
+
+static THREAD_LOCAL crc8_table_t crc8_tables[CRC_TABLES];
+static THREAD_LOCAL crc16_table_t crc16_tables[CRC_TABLES];
+static THREAD_LOCAL lfsr_table_t lfsr_tables[LFSR_TABLES];
+
+/// Get the CRC-8 table, @p reflected for LSB first with a reflected polynomial, NULL if the cache is full.
+static crc8_table_t const *crc8_table_get(unsigned reflected, uint8_t polynomial)
+{
+    unsigned key = CRC_TABLE_USED | reflected << 16 | polynomial;
+    unsigned slot = 0;
+    for (; slot < CRC_TABLES && crc8_tables[slot].key; ++slot) {
+        if (crc8_tables[slot].key == key)
+            return &crc8_tables[slot];
+    }
+    if (slot == CRC_TABLES)
+        return NULL;
+
+    crc8_table_t *table = &crc8_tables[slot];
+    for (unsigned x = 0; x < 256; ++x) {
+        uint8_t remainder = x;
+        for (unsigned bit = 0; bit < 8; ++bit) {
+            if (reflected)
+                remainder = remainder & 1 ? (remainder >> 1) ^ polynomial : remainder >> 1;
+            else
+                remainder = remainder & 0x80 ? (remainder << 1) ^ polynomial : remainder << 1;
+        }
+        table->t[0][x] = remainder;
+    }
+    // a zero byte after an 8 bit CRC is just another table lookup
+    for (unsigned k = 1; k < 8; ++k) {
+        for (unsigned x = 0; x < 256; ++x) {
+            table->t[k][x] = table->t[0][table->t[k - 1][x]];
+        }
+    }
+    table->key = key;
+    return table;
+}
+
+/// Get the CRC-16 table, @p reflected for LSB first with a reflected polynomial, NULL if the cache is full.
+static crc16_table_t const *crc16_table_get(unsigned reflected, uint16_t polynomial)
+{
+    unsigned key = CRC_TABLE_USED | reflected << 16 | polynomial;
+    unsigned slot = 0;
+    for (; slot < CRC_TABLES && crc16_tables[slot].key; ++slot) {
+        if (crc16_tables[slot].key == key)
+            return &crc16_tables[slot];
+    }
+    if (slot == CRC_TABLES)
+        return NULL;
+
+    crc16_table_t *table = &crc16_tables[slot];
+    for (unsigned x = 0; x < 256; ++x) {
+        uint16_t remainder = reflected ? x : x << 8;
+        for (unsigned bit = 0; bit < 8; ++bit) {
+            if (reflected)
+                remainder = remainder & 1 ? (remainder >> 1) ^ polynomial : remainder >> 1;
+            else
+                remainder = remainder & 0x8000 ? (remainder << 1) ^ polynomial : remainder << 1;
+        }
+        table->t[0][x] = remainder;
+    }
+    for (unsigned k = 1; k < 8; ++k) {
+        for (unsigned x = 0; x < 256; ++x) {
+            uint16_t prev = table->t[k - 1][x];
+            if (reflected)
+                table->t[k][x] = (prev >> 8) ^ table->t[0][prev & 0xff];
+            else
+                table->t[k][x] = (uint16_t)(prev << 8) ^ table->t[0][prev >> 8];
+        }
+    }
+    table->key = key;
+    return table;
+}
+
+/// Update a CRC-8 bit by bit, @p reflected for LSB first with a reflected polynomial.
+static uint8_t crc8_update_bits(unsigned reflected, uint8_t polynomial, uint8_t remainder, uint8_t const *message, unsigned len)
+{
+    while (len--) {
+        remainder ^= *message++;
+        for (unsigned bit = 0; bit < 8; ++bit) {
+            if (reflected)
+                remainder = remainder & 1 ? (remainder >> 1) ^ polynomial : remainder >> 1;
+            else
+                remainder = remainder & 0x80 ? (remainder << 1) ^ polynomial : remainder << 1;
+        }
+    }
+    return remainder;
+}
+
+/// Update a CRC-8, @p reflected for LSB first with a reflected polynomial.
+static uint8_t crc8_update(unsigned reflected, uint8_t polynomial, uint8_t remainder, uint8_t const *message, unsigned len)
+{
+    crc8_table_t const *table = crc8_table_get(reflected, polynomial);
+    if (!table)
+        return crc8_update_bits(reflected, polynomial, remainder, message, len);
+    uint8_t const (*t)[256] = table->t;
+
+    for (; len >= 8; len -= 8, message += 8) {
+        remainder = t[7][remainder ^ message[0]] ^ t[6][message[1]] ^ t[5][message[2]] ^ t[4][message[3]]
+                ^ t[3][message[4]] ^ t[2][message[5]] ^ t[1][message[6]] ^ t[0][message[7]];
+    }
+    while (len--) {
+        remainder = t[0][remainder ^ *message++];
+    }
+    return remainder;
+}
+
 uint8_t crc4(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uint8_t init)
+{
+    // the CRC-8 of a CRC-4 in the upper nibble, the lower bits never affect the upper ones
+    uint8_t poly = polynomial << 4;
+    return crc8_update(0, poly, init << 4, message, nBytes) >> 4; // discard the LSBs
+}
+
+uint8_t crc7(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uint8_t init)
+{
+    // the CRC-8 of a CRC-7 in the upper bits, the LSB never affects the upper ones
+    uint8_t poly = polynomial << 1;
+    return crc8_update(0, poly, init << 1, message, nBytes) >> 1; // discard the LSB
+}
+
+uint8_t crc8(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uint8_t init)
+{
+    return crc8_update(0, polynomial, init, message, nBytes);
+}
+
+uint8_t crc8le(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uint8_t init)
+{
+    return crc8_update(1, reverse8(polynomial), reverse8(init), message, nBytes);
+}
+
+/// Update a CRC-16 bit by bit, @p reflected for LSB first with a reflected polynomial.
+static uint16_t crc16_update_bits(unsigned reflected, uint16_t polynomial, uint16_t remainder, uint8_t const *message, unsigned len)
+{
+    while (len--) {
+        remainder ^= reflected ? *message++ : *message++ << 8;
+        for (unsigned bit = 0; bit < 8; ++bit) {
+            if (reflected)
+                remainder = remainder & 1 ? (remainder >> 1) ^ polynomial : remainder >> 1;
+            else
+                remainder = remainder & 0x8000 ? (remainder << 1) ^ polynomial : remainder << 1;
+        }
+    }
+    return remainder;
+}
+
+uint16_t crc16lsb(uint8_t const message[], unsigned nBytes, uint16_t polynomial, uint16_t init)
+{
+    crc16_table_t const *table = crc16_table_get(1, polynomial);
+    if (!table)
+        return crc16_update_bits(1, polynomial, init, message, nBytes);
+    uint16_t const (*t)[256] = table->t;
+    uint16_t remainder = init;
+
+    for (; nBytes >= 8; nBytes -= 8, message += 8) {
+        remainder ^= message[0] | message[1] << 8;
+        remainder = t[7][remainder & 0xff] ^ t[6][remainder >> 8] ^ t[5][message[2]] ^ t[4][message[3]]
+                ^ t[3][message[4]] ^ t[2][message[5]] ^ t[1][message[6]] ^ t[0][message[7]];
+    }
+    while (nBytes--) {
+        remainder = (remainder >> 8) ^ t[0][(remainder ^ *message++) & 0xff];
+    }
+    return remainder;
+}
+
+uint16_t crc16(uint8_t const message[], unsigned nBytes, uint16_t polynomial, uint16_t init)
+{
+    crc16_table_t const *table = crc16_table_get(0, polynomial);
+    if (!table)
+        return crc16_update_bits(0, polynomial, init, message, nBytes);
+    uint16_t const (*t)[256] = table->t;
+    uint16_t remainder = init;
+
+    for (; nBytes >= 8; nBytes -= 8, message += 8) {
+        remainder ^= message[0] << 8 | message[1];
+        remainder = t[7][remainder >> 8] ^ t[6][remainder & 0xff] ^ t[5][message[2]] ^ t[4][message[3]]
+                ^ t[3][message[4]] ^ t[2][message[5]] ^ t[1][message[6]] ^ t[0][message[7]];
+    }
+    while (nBytes--) {
+        remainder = (uint16_t)(remainder << 8) ^ t[0][(remainder >> 8) ^ *message++];
+    }
+    return remainder;
+}
+
+/// Roll the LFSR key one bit.
+static uint16_t lfsr_roll(unsigned kind, uint16_t gen, uint16_t key)
+{
+    if (kind == LFSR_ROLL_RIGHT)
+        return key & 1 ? (key >> 1) ^ gen : key >> 1;
+    else
+        return (key & 0x80 ? (key << 1) ^ gen : key << 1) & 0xff;
+}
+
+/// Get the LFSR digest table for a key stream, NULL if the cache is full.
+static lfsr_table_t const *lfsr_table_get(unsigned kind, uint16_t gen, uint16_t key)
+{
+    unsigned slot = 0;
+    for (; slot < LFSR_TABLES && lfsr_tables[slot].kind; ++slot) {
+        lfsr_table_t const *table = &lfsr_tables[slot];
+        if (table->kind == kind && table->gen == gen && table->key == key)
+            return table;
+    }
+    if (slot == LFSR_TABLES)
+        return NULL;
+
+    lfsr_table_t *table = &lfsr_tables[slot];
+    uint16_t k = key;
+    for (unsigned j = 0; j < LFSR_TABLE_BYTES; ++j) {
+        uint16_t bit_keys[8]; // the key for each data bit
+        for (unsigned i = 0; i < 8; ++i) {
+            bit_keys[kind == LFSR_ROLL_RIGHT ? 7 - i : i] = k;
+            k = lfsr_roll(kind, gen, k);
+        }
+        for (unsigned n = 0; n < 16; ++n) {
+            uint16_t lo = 0;
+            uint16_t hi = 0;
+            for (unsigned b = 0; b < 4; ++b) {
+                if (n >> b & 1) {
+                    lo ^= bit_keys[b];
+                    hi ^= bit_keys[b + 4];
+                }
+            }
+            table->t[j][n]      = lo;
+            table->t[j][16 + n] = hi;
+        }
+    }
+    table->kind    = kind;
+    table->gen     = gen;
+    table->key     = key;
+    table->end_key = k;
+    return table;
+}
+
+/// LFSR digest of a message, from the last byte to the first byte if @p reverse.
+static uint16_t lfsr_digest(unsigned kind, uint8_t const *message, unsigned bytes, int reverse, uint16_t gen, uint16_t key)
+{
+    lfsr_table_t const *table = lfsr_table_get(kind, gen, key);
+    uint16_t sum = 0;
+
+    unsigned len = 0;
+    if (table) {
+        len = bytes < LFSR_TABLE_BYTES ? bytes : LFSR_TABLE_BYTES;
+        for (unsigned j = 0; j < len; ++j) {
+            uint8_t data = message[reverse ? bytes - 1 - j : j];
+            sum ^= table->t[j][data & 0x0f] ^ table->t[j][16 + (data >> 4)];
+        }
+        key = table->end_key;
+    }
+
+    // continue bit by bit after the table, or from the start without a table
+    for (unsigned j = len; j < bytes; ++j) {
+        uint8_t data = message[reverse ? bytes - 1 - j : j];
+        for (unsigned i = 0; i < 8; ++i) {
+            unsigned bit = kind == LFSR_ROLL_RIGHT ? 7 - i : i;
+            if (data >> bit & 1)
+                sum ^= key;
+            key = lfsr_roll(kind, gen, key);
+        }
+    }
+    return sum;
+}
+
+uint8_t lfsr_digest8(uint8_t const message[], unsigned bytes, uint8_t gen, uint8_t key)
+{
+    // Process message from first byte to last byte, bits MSB to LSB
+    return lfsr_digest(LFSR_ROLL_RIGHT, message, bytes, 0, gen, key);
+}
+
+uint8_t lfsr_digest8_reverse(uint8_t const *message, int bytes, uint8_t gen, uint8_t key)
+{
+    if (bytes <= 0)
+        return 0;
+    // Process message from last byte to first byte (reflected), bits MSB to LSB
+    return lfsr_digest(LFSR_ROLL_RIGHT, message, bytes, 1, gen, key);
+}
+
+uint8_t lfsr_digest8_reflect(uint8_t const message[], int bytes, uint8_t gen, uint8_t key)
+{
+    if (bytes <= 0)
+        return 0;
+    // Process message from last byte to first byte (reflected), bits LSB to MSB (reflected)
+    return lfsr_digest(LFSR_ROLL_LEFT8, message, bytes, 1, gen, key);
+}
+
+uint16_t lfsr_digest16(uint8_t const message[], unsigned bytes, uint16_t gen, uint16_t key)
+{
+    return lfsr_digest(LFSR_ROLL_RIGHT, message, bytes, 0, gen, key);
+}
+
+// The CCITT data whitening process is built around a 9-bit Linear Feedback Shift Register (LFSR).
+// The LFSR polynomial is the same polynomial as for IBM data whitening (x9 + x5 + 1).
+// The initial value of the data whitening key is set to all ones, 0x1FF.
+// s.a. https://www.nxp.com/docs/en/application-note/AN5070.pdf s.5.2
+void ccitt_whitening(uint8_t *buffer, unsigned buffer_size)
+{
+    uint8_t key_msb = 0x01;
+    uint8_t key_lsb = 0xff;
+
+    for (unsigned buffer_pos = 0; buffer_pos < buffer_size; buffer_pos++) {
+        uint8_t reflected_key_lsb;
+        reflected_key_lsb = (key_lsb & 0xf0) >> 4 | (key_lsb & 0x0f) << 4;
+        reflected_key_lsb = (reflected_key_lsb & 0xcc) >> 2 | (reflected_key_lsb & 0x33) << 2;
+        reflected_key_lsb = (reflected_key_lsb & 0xaa) >> 1 | (reflected_key_lsb & 0x55) << 1;
+
+        buffer[buffer_pos] ^= reflected_key_lsb;
+
+        for (uint8_t rol_counter = 0; rol_counter < 8; rol_counter++) {
+            uint8_t key_msb_previous;
+            key_msb_previous = key_msb;
+            key_msb          = (key_lsb & 0x01) ^ ((key_lsb >> 5) & 0x01);
+            key_lsb          = ((key_msb_previous << 7) & 0x80) | ((key_lsb >> 1) & 0xff);
+        }
+    }
+}
+
+/*
+void lfsr_keys_fwd16(int rounds, uint16_t gen, uint16_t key)
+{
+    for (int i = 0; i <= rounds; ++i) {
+        fprintf(stderr, "key at bit %d : %04x\n", i, key);
+
+        // roll the key right (actually the lsb is dropped here)
+        // and apply the gen (needs to include the dropped lsb as msb)
+        if (key & 1)
+            key = (key >> 1) ^ gen;
+        else
+            key = (key >> 1);
+    }
+}
+
+void lfsr_keys_rwd16(int rounds, uint16_t gen, uint16_t key)
+{
+    for (int i = 0; i <= rounds; ++i) {
+        fprintf(stderr, "key at bit -%d : %04x\n", i, key);
+
+        // roll the key left (actually the msb is dropped here)
+        // and apply the gen (needs to include the dropped msb as lsb)
+        if (key & (1 << 15))
+            key = (key << 1) ^ gen;
+        else
+            key = (key << 1);
+    }
+}
+*/
+
+// we could use popcount intrinsic, but don't actually need the performance
+int parity8(uint8_t byte)
+{
+    byte ^= byte >> 4;
+    byte &= 0xf;
+    return (0x6996 >> byte) & 1;
+}
+
+int parity_bytes(uint8_t const message[], unsigned num_bytes)
+{
+    int result = 0;
+    for (unsigned i = 0; i < num_bytes; ++i) {
+        result ^= parity8(message[i]);
+    }
+    return result;
+}
+
+uint8_t xor_bytes(uint8_t const message[], unsigned num_bytes)
+{
+    uint8_t result = 0;
+    for (unsigned i = 0; i < num_bytes; ++i) {
+        result ^= message[i];
+    }
+    return result;
+}
+
+int add_bytes(uint8_t const message[], unsigned num_bytes)
+{
+    int result = 0;
+    for (unsigned i = 0; i < num_bytes; ++i) {
+        result += message[i];
+    }
+    return result;
+}
+
+int add_nibbles(uint8_t const message[], unsigned num_bytes)
+{
+    int result = 0;
+    for (unsigned i = 0; i < num_bytes; ++i) {
+        result += (message[i] >> 4) + (message[i] & 0x0f);
+    }
+    return result;
+}
+
+// Unit testing
+#ifdef _TEST
+#define ASSERT_EQUALS(a, b) \
+    do { \
+        if ((a) == (b)) \
+            ++passed; \
+        else { \
+            ++failed; \
+            fprintf(stderr, "FAIL: %d <> %d\n", (a), (b)); \
+        } \
+    } while (0)
+#define ASSERT_MATCH(a, b, n) \
+    do { \
+        if (memcmp(a, b, n) == 0) \
+            ++passed; \
+        else { \
+            ++failed; \
+            fprintf(stderr, "FAIL:"); \
+            for (size_t i = 0; i < n; i++) { \
+                fprintf(stderr, " %02x", a[i]); \
+            } \
+            fprintf(stderr, "\n   <>"); \
+            for (size_t i = 0; i < n; i++) { \
+                fprintf(stderr, " %02x", b[i]); \
+            } \
+            fprintf(stderr, "\n"); \
+        } \
+    } while (0)
+
+/// The former bit by bit versions of the CRC and LFSR digests.
+static uint8_t ref_crc4(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uint8_t init)
 {
     unsigned remainder = init << 4; // LSBs are unused
     unsigned poly = polynomial << 4;
@@ -206,7 +667,7 @@ uint8_t crc4(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uint8
     return remainder >> 4 & 0x0f; // discard the LSBs
 }
 
-uint8_t crc7(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uint8_t init)
+static uint8_t ref_crc7(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uint8_t init)
 {
     unsigned remainder = init << 1; // LSB is unused
     unsigned poly = polynomial << 1;
@@ -225,7 +686,7 @@ uint8_t crc7(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uint8
     return remainder >> 1 & 0x7f; // discard the LSB
 }
 
-uint8_t crc8(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uint8_t init)
+static uint8_t ref_crc8(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uint8_t init)
 {
     uint8_t remainder = init;
     unsigned byte, bit;
@@ -243,7 +704,7 @@ uint8_t crc8(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uint8
     return remainder;
 }
 
-uint8_t crc8le(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uint8_t init)
+static uint8_t ref_crc8le(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uint8_t init)
 {
     uint8_t remainder = reverse8(init);
     unsigned byte, bit;
@@ -262,7 +723,7 @@ uint8_t crc8le(uint8_t const message[], unsigned nBytes, uint8_t polynomial, uin
     return remainder;
 }
 
-uint16_t crc16lsb(uint8_t const message[], unsigned nBytes, uint16_t polynomial, uint16_t init)
+static uint16_t ref_crc16lsb(uint8_t const message[], unsigned nBytes, uint16_t polynomial, uint16_t init)
 {
     uint16_t remainder = init;
     unsigned byte, bit;
@@ -281,7 +742,7 @@ uint16_t crc16lsb(uint8_t const message[], unsigned nBytes, uint16_t polynomial,
     return remainder;
 }
 
-uint16_t crc16(uint8_t const message[], unsigned nBytes, uint16_t polynomial, uint16_t init)
+static uint16_t ref_crc16(uint8_t const message[], unsigned nBytes, uint16_t polynomial, uint16_t init)
 {
     uint16_t remainder = init;
     unsigned byte, bit;
@@ -300,7 +761,7 @@ uint16_t crc16(uint8_t const message[], unsigned nBytes, uint16_t polynomial, ui
     return remainder;
 }
 
-uint8_t lfsr_digest8(uint8_t const message[], unsigned bytes, uint8_t gen, uint8_t key)
+static uint8_t ref_lfsr_digest8(uint8_t const message[], unsigned bytes, uint8_t gen, uint8_t key)
 {
     uint8_t sum = 0;
     // Process message from first byte to last byte
@@ -308,7 +769,6 @@ uint8_t lfsr_digest8(uint8_t const message[], unsigned bytes, uint8_t gen, uint8
         uint8_t data = message[k];
         // Process individual bits of each byte (MSB to LSB)
         for (int i = 7; i >= 0; --i) {
-            // fprintf(stderr, "key at %d.%d : %02x\n", k, i, key);
             // XOR key into sum if data bit is set
             if ((data >> i) & 1)
                 sum ^= key;
@@ -324,7 +784,7 @@ uint8_t lfsr_digest8(uint8_t const message[], unsigned bytes, uint8_t gen, uint8
     return sum;
 }
 
-uint8_t lfsr_digest8_reverse(uint8_t const *message, int bytes, uint8_t gen, uint8_t key)
+static uint8_t ref_lfsr_digest8_reverse(uint8_t const *message, int bytes, uint8_t gen, uint8_t key)
 {
     uint8_t sum = 0;
     // Process message from last byte to first byte (reflected)
@@ -332,7 +792,6 @@ uint8_t lfsr_digest8_reverse(uint8_t const *message, int bytes, uint8_t gen, uin
         uint8_t data = message[k];
         // Process individual bits of each byte (MSB to LSB)
         for (int i = 7; i >= 0; --i) {
-            // fprintf(stderr, "key at %d.%d : %02x\n", k, i, key);
             // XOR key into sum if data bit is set
             if ((data >> i) & 1) {
                 sum ^= key;
@@ -349,7 +808,7 @@ uint8_t lfsr_digest8_reverse(uint8_t const *message, int bytes, uint8_t gen, uin
     return sum;
 }
 
-uint8_t lfsr_digest8_reflect(uint8_t const message[], int bytes, uint8_t gen, uint8_t key)
+static uint8_t ref_lfsr_digest8_reflect(uint8_t const message[], int bytes, uint8_t gen, uint8_t key)
 {
     uint8_t sum = 0;
     // Process message from last byte to first byte (reflected)
@@ -357,7 +816,6 @@ uint8_t lfsr_digest8_reflect(uint8_t const message[], int bytes, uint8_t gen, ui
         uint8_t data = message[k];
         // Process individual bits of each byte (reflected)
         for (int i = 0; i < 8; ++i) {
-            // fprintf(stderr, "key at %d.%d : %02x\n", k, i, key);
             // XOR key into sum if data bit is set
             if ((data >> i) & 1) {
                 sum ^= key;
@@ -374,13 +832,12 @@ uint8_t lfsr_digest8_reflect(uint8_t const message[], int bytes, uint8_t gen, ui
     return sum;
 }
 
-uint16_t lfsr_digest16(uint8_t const message[], unsigned bytes, uint16_t gen, uint16_t key)
+static uint16_t ref_lfsr_digest16(uint8_t const message[], unsigned bytes, uint16_t gen, uint16_t key)
 {
     uint16_t sum = 0;
     for (unsigned k = 0; k < bytes; ++k) {
         uint8_t data = message[k];
         for (int i = 7; i >= 0; --i) {
-            // fprintf(stderr, "key at bit %d : %04x\n", i, key);
             // if data bit is set then xor with key
             if ((data >> i) & 1)
                 sum ^= key;
@@ -396,136 +853,35 @@ uint16_t lfsr_digest16(uint8_t const message[], unsigned bytes, uint16_t gen, ui
     return sum;
 }
 
-// The CCITT data whitening process is built around a 9-bit Linear Feedback Shift Register (LFSR).
-// The LFSR polynomial is the same polynomial as for IBM data whitening (x9 + x5 + 1).
-// The initial value of the data whitening key is set to all ones, 0x1FF.
-// s.a. https://www.nxp.com/docs/en/application-note/AN5070.pdf s.5.2
-void ccitt_whitening(uint8_t *buffer, unsigned buffer_size)
-{
-    uint8_t key_msb = 0x01;
-    uint8_t key_lsb = 0xff;
-
-    for (unsigned buffer_pos = 0; buffer_pos < buffer_size; buffer_pos++) {
-        uint8_t reflected_key_lsb;
-        reflected_key_lsb = (key_lsb & 0xf0) >> 4 | (key_lsb & 0x0f) << 4;
-        reflected_key_lsb = (reflected_key_lsb & 0xcc) >> 2 | (reflected_key_lsb & 0x33) << 2;
-        reflected_key_lsb = (reflected_key_lsb & 0xaa) >> 1 | (reflected_key_lsb & 0x55) << 1;
-
-        buffer[buffer_pos] ^= reflected_key_lsb;
-
-        for (uint8_t rol_counter = 0; rol_counter < 8; rol_counter++) {
-            uint8_t key_msb_previous;
-            key_msb_previous = key_msb;
-            key_msb          = (key_lsb & 0x01) ^ ((key_lsb >> 5) & 0x01);
-            key_lsb          = ((key_msb_previous << 7) & 0x80) | ((key_lsb >> 1) & 0xff);
-        }
-    }
-}
-
-/*
-void lfsr_keys_fwd16(int rounds, uint16_t gen, uint16_t key)
-{
-    for (int i = 0; i <= rounds; ++i) {
-        fprintf(stderr, "key at bit %d : %04x\n", i, key);
-
-        // roll the key right (actually the lsb is dropped here)
-        // and apply the gen (needs to include the dropped lsb as msb)
-        if (key & 1)
-            key = (key >> 1) ^ gen;
-        else
-            key = (key >> 1);
-    }
-}
-
-void lfsr_keys_rwd16(int rounds, uint16_t gen, uint16_t key)
-{
-    for (int i = 0; i <= rounds; ++i) {
-        fprintf(stderr, "key at bit -%d : %04x\n", i, key);
-
-        // roll the key left (actually the msb is dropped here)
-        // and apply the gen (needs to include the dropped msb as lsb)
-        if (key & (1 << 15))
-            key = (key << 1) ^ gen;
-        else
-            key = (key << 1);
-    }
-}
-*/
-
-// we could use popcount intrinsic, but don't actually need the performance
-int parity8(uint8_t byte)
-{
-    byte ^= byte >> 4;
-    byte &= 0xf;
-    return (0x6996 >> byte) & 1;
-}
-
-int parity_bytes(uint8_t const message[], unsigned num_bytes)
-{
-    int result = 0;
-    for (unsigned i = 0; i < num_bytes; ++i) {
-        result ^= parity8(message[i]);
-    }
-    return result;
-}
-
-uint8_t xor_bytes(uint8_t const message[], unsigned num_bytes)
+/// Empty the table caches of this thread.
+static void tables_reset(void)
 {
-    uint8_t result = 0;
-    for (unsigned i = 0; i < num_bytes; ++i) {
-        result ^= message[i];
-    }
-    return result;
+    memset(crc8_tables, 0, sizeof(crc8_tables));
+    memset(crc16_tables, 0, sizeof(crc16_tables));
+    memset(lfsr_tables, 0, sizeof(lfsr_tables));
 }
 
-int add_bytes(uint8_t const message[], unsigned num_bytes)
+static double now_ns(void)
 {
-    int result = 0;
-    for (unsigned i = 0; i < num_bytes; ++i) {
-        result += message[i];
-    }
-    return result;
+    return (double)clock() * 1e9 / CLOCKS_PER_SEC;
 }
 
-int add_nibbles(uint8_t const message[], unsigned num_bytes)
-{
-    int result = 0;
-    for (unsigned i = 0; i < num_bytes; ++i) {
-        result += (message[i] >> 4) + (message[i] & 0x0f);
-    }
-    return result;
-}
+#define BENCH_LEN 16 ///< bytes per message, a typical sensor message
 
-// Unit testing
-#ifdef _TEST
-#define ASSERT_EQUALS(a, b) \
-    do { \
-        if ((a) == (b)) \
-            ++passed; \
-        else { \
-            ++failed; \
-            fprintf(stderr, "FAIL: %d <> %d\n", (a), (b)); \
-        } \
-    } while (0)
-#define ASSERT_MATCH(a, b, n) \
+#define BENCH(label, call) \
     do { \
-        if (memcmp(a, b, n) == 0) \
-            ++passed; \
-        else { \
-            ++failed; \
-            fprintf(stderr, "FAIL:"); \
-            for (size_t i = 0; i < n; i++) { \
-                fprintf(stderr, " %02x", a[i]); \
-            } \
-            fprintf(stderr, "\n   <>"); \
-            for (size_t i = 0; i < n; i++) { \
-                fprintf(stderr, " %02x", b[i]); \
-            } \
-            fprintf(stderr, "\n"); \
+        unsigned sink = 0; \
+        double start  = now_ns(); \
+        for (unsigned r = 0; r < rounds; ++r) { \
+            uint8_t const *m = &data[r & 15]; \
+            sink += (call); \
         } \
+        fprintf(stderr, "%-24s %6.2f ns/byte (%u)\n", label, (now_ns() - start) / rounds / BENCH_LEN, sink & 1); \
     } while (0)
 
-int main(void) {
+int main(int argc, char *argv[]) {
+    unsigned rounds = argc > 1 ? (unsigned)atoi(argv[1]) : 20000;
+
     unsigned passed = 0;
     unsigned failed = 0;
 
@@ -558,14 +914,70 @@ int main(void) {
     ASSERT_EQUALS(bytes[3], 0x02);
     ASSERT_EQUALS(bytes[4], 0x03);
 
-    fprintf(stderr, "util:: test (%u/%u) passed, (%u) failed.\n", passed, passed + failed, failed);
-
     fprintf(stderr, "util::ccitt_whitening():\n");
     uint8_t buf[16] = {0};
     uint8_t chk[16] = {0xff, 0x87, 0xb8, 0x59, 0xb7, 0xa1, 0xcc, 0x24, 0x57, 0x5e, 0x4b, 0x9c, 0x0e, 0xe9, 0xea, 0x50};
     ccitt_whitening(buf, sizeof(buf)) ;
     ASSERT_MATCH(buf, chk, sizeof(buf));
 
+    // more polynomials and keys than cached tables, messages longer than the LFSR tables
+    fprintf(stderr, "util::crc*(), lfsr_digest*(): tables vs. bit by bit\n");
+    uint8_t data[80];
+    uint16_t params[12];
+    srand(1);
+    for (unsigned i = 0; i < sizeof(data); ++i)
+        data[i] = rand();
+    for (unsigned i = 0; i < 12; ++i)
+        params[i] = rand();
+    unsigned mismatches = 0;
+    for (unsigned i = 0; i < 3000; ++i) {
+        unsigned len  = rand() % sizeof(data);
+        uint16_t poly = params[rand() % 12];
+        uint16_t init = params[rand() % 12];
+        mismatches += crc4(data, len, poly, init) != ref_crc4(data, len, poly, init);
+        mismatches += crc7(data, len, poly, init) != ref_crc7(data, len, poly, init);
+        mismatches += crc8(data, len, poly, init) != ref_crc8(data, len, poly, init);
+        mismatches += crc8le(data, len, poly, init) != ref_crc8le(data, len, poly, init);
+        mismatches += crc16(data, len, poly, init) != ref_crc16(data, len, poly, init);
+        mismatches += crc16lsb(data, len, poly, init) != ref_crc16lsb(data, len, poly, init);
+        mismatches += lfsr_digest8(data, len, poly, init) != ref_lfsr_digest8(data, len, poly, init);
+        mismatches += lfsr_digest8_reverse(data, len, poly, init) != ref_lfsr_digest8_reverse(data, len, poly, init);
+        mismatches += lfsr_digest8_reflect(data, len, poly, init) != ref_lfsr_digest8_reflect(data, len, poly, init);
+        mismatches += lfsr_digest16(data, len, poly, init) != ref_lfsr_digest16(data, len, poly, init);
+    }
+    ASSERT_EQUALS(mismatches, 0);
+
+    fprintf(stderr, "util:: test (%u/%u) passed, (%u) failed.\n", passed, passed + failed, failed);
+
+    // throughput of the tables vs. bit by bit, usage as in the decoders
+    fprintf(stderr, "util:: benchmark, %u rounds of %d byte messages\n", rounds, BENCH_LEN);
+    tables_reset();
+    BENCH("crc8 bit by bit", ref_crc8(m, BENCH_LEN, 0x31, 0x00));
+    BENCH("crc8", crc8(m, BENCH_LEN, 0x31, 0x00));
+    BENCH("crc8le bit by bit", ref_crc8le(m, BENCH_LEN, 0x31, 0x00));
+    BENCH("crc8le", crc8le(m, BENCH_LEN, 0x31, 0x00));
+    BENCH("crc16 bit by bit", ref_crc16(m, BENCH_LEN, 0x3d65, 0x0000));
+    BENCH("crc16", crc16(m, BENCH_LEN, 0x3d65, 0x0000));
+    BENCH("crc16lsb bit by bit", ref_crc16lsb(m, BENCH_LEN, 0xa001, 0xffff));
+    BENCH("crc16lsb", crc16lsb(m, BENCH_LEN, 0xa001, 0xffff));
+    BENCH("lfsr_digest8 bit by bit", ref_lfsr_digest8(m, BENCH_LEN, 0x98, 0x3e));
+    BENCH("lfsr_digest8", lfsr_digest8(m, BENCH_LEN, 0x98, 0x3e));
+    BENCH("lfsr_digest16 bit by bit", ref_lfsr_digest16(m, BENCH_LEN, 0x8810, 0x5412));
+    BENCH("lfsr_digest16", lfsr_digest16(m, BENCH_LEN, 0x8810, 0x5412));
+
+    // many decoders in rotation, the configurations that don't fit the cache run bit by bit
+    uint8_t polys[3 * CRC_TABLES];
+    uint16_t keys[3 * CRC_TABLES];
+    for (unsigned i = 0; i < 3 * CRC_TABLES; ++i) {
+        polys[i] = rand();
+        keys[i]  = rand();
+    }
+    tables_reset();
+    BENCH("crc8 16 polynomials", crc8(m, BENCH_LEN, polys[r % 16], 0x00));
+    BENCH("crc8 48 polynomials", crc8(m, BENCH_LEN, polys[r % 48], 0x00));
+    BENCH("lfsr_digest16 16 keys", lfsr_digest16(m, BENCH_LEN, 0x8810, keys[r % 16]));
+    BENCH("lfsr_digest16 48 keys", lfsr_digest16(m, BENCH_LEN, 0x8810, keys[r % 48]));
+
     return failed;
 }
 #endif /* _TEST */
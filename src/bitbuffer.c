@@ -19,6 +19,26 @@ void bitbuffer_clear(bitbuffer_t *bits)
     memset(bits, 0, sizeof(*bits));
 }
 
+unsigned bitbuffer_rows_used(bitbuffer_t const *bits)
+{
+    unsigned rows = bits->free_row > bits->num_rows ? bits->free_row : bits->num_rows;
+    for (unsigned row = 0; row < bits->num_rows; ++row) {
+        unsigned end = row + (bits->bits_per_row[row] + BITBUF_COLS * 8 - 1) / (BITBUF_COLS * 8);
+        if (end > rows)
+            rows = end;
+    }
+    return rows < BITBUF_ROWS ? rows : BITBUF_ROWS;
+}
+
+void bitbuffer_reset(bitbuffer_t *bits)
+{
+    memset(bits->bb, 0, bitbuffer_rows_used(bits) * sizeof(bitrow_t));
+    memset(bits->bits_per_row, 0, sizeof(bits->bits_per_row));
+    memset(bits->syncs_before_row, 0, sizeof(bits->syncs_before_row));
+    bits->num_rows = 0;
+    bits->free_row = 0;
+}
+
 void bitbuffer_add_bit(bitbuffer_t *bits, int bit)
 {
     if (bits->num_rows == 0)
@@ -219,32 +239,158 @@ static inline uint8_t bit_at(const uint8_t *bytes, unsigned bit)
     return (uint8_t)(bytes[bit >> 3] >> (7 - (bit & 7)) & 1);
 }
 
-unsigned bitbuffer_search(bitbuffer_t *bitbuffer, unsigned row, unsigned start,
-        const uint8_t *pattern, unsigned pattern_bits_len)
+/// Load 8 bytes big-endian, bytes at or after @p len read as zero.
+static inline uint64_t load_be64(uint8_t const *bytes, unsigned pos, unsigned len)
 {
-    uint8_t *bits = bitbuffer->bb[row];
-    unsigned len  = bitbuffer->bits_per_row[row];
-    unsigned ipos = start;
-    unsigned ppos = 0; // cursor on init pattern
-
-    while (ipos < len && ppos < pattern_bits_len) {
-        if (bit_at(bits, ipos) == bit_at(pattern, ppos)) {
-            ppos++;
-            ipos++;
-            if (ppos == pattern_bits_len)
-                return ipos - pattern_bits_len;
+    if (pos + 8 <= len) {
+        uint8_t const *b = &bytes[pos];
+        // compilers turn this into a single load and byte swap
+        return (uint64_t)b[0] << 56 | (uint64_t)b[1] << 48 | (uint64_t)b[2] << 40 | (uint64_t)b[3] << 32
+                | (uint64_t)b[4] << 24 | (uint64_t)b[5] << 16 | (uint64_t)b[6] << 8 | (uint64_t)b[7];
+    }
+    uint64_t v = 0;
+    for (unsigned i = 0; i < 8; ++i)
+        v = v << 8 | (pos + i < len ? bytes[pos + i] : 0);
+    return v;
+}
+
+/// Get 64 bits starting at bit @p bit, bits in bytes at or after @p len read as zero.
+static inline uint64_t bits_at64(uint8_t const *bytes, unsigned bit, unsigned len)
+{
+    unsigned pos   = bit >> 3;
+    unsigned shift = bit & 7;
+    uint64_t v     = load_be64(bytes, pos, len);
+    if (shift && pos + 8 < len)
+        v = v << shift | bytes[pos + 8] >> (8 - shift);
+    else if (shift)
+        v = v << shift;
+    return v;
+}
+
+/// Mask for the first @p bits_len bits of a 64 bit window.
+static inline uint64_t prefix_mask(unsigned bits_len)
+{
+    return bits_len >= 64 ? ~(uint64_t)0 : ~(~(uint64_t)0 >> bits_len);
+}
+
+/// Compare the pattern bits after the first 64 bits.
+static int tail_matches(uint8_t const *bits, unsigned bytes_len, unsigned pos, bitbuffer_pattern_t const *p)
+{
+    unsigned pattern_bytes = (p->bits_len + 7) / 8;
+    for (unsigned off = 64; off < p->bits_len; off += 64) {
+        uint64_t mask = prefix_mask(p->bits_len - off);
+        if ((bits_at64(bits, pos + off, bytes_len) ^ bits_at64(p->bits, off, pattern_bytes)) & mask)
+            return 0;
+    }
+    return 1;
+}
+
+#define SEARCH_GROUP_LEN 16 ///< patterns matched per pass over a row
+
+#define LANES_LSB 0x0101010101010101ULL
+#define LANES_MSB 0x8080808080808080ULL
+
+/** Search for up to SEARCH_GROUP_LEN patterns starting before @p end.
+
+    A match at a bit position with offset s into a byte has the first full row byte
+    at the pattern bit offset (8 - s) & 7. These 8 possible pattern bytes of each
+    pattern are packed into a word and each row byte is compared against all of
+    them at once. Only the matching offsets are then compared in 64 bit windows.
+*/
+static unsigned search_group(uint8_t const *bits, unsigned len, unsigned start, unsigned end,
+        bitbuffer_pattern_t const *patterns, unsigned num_patterns, unsigned *match)
+{
+    uint64_t prefix[SEARCH_GROUP_LEN];
+    uint64_t mask[SEARCH_GROUP_LEN];
+    uint64_t keys[SEARCH_GROUP_LEN];      // the pattern byte for each of the 8 offsets
+    uint64_t key_masks[SEARCH_GROUP_LEN]; // the pattern bits in the key bytes
+    unsigned last_pos[SEARCH_GROUP_LEN];  // last position where the pattern fits, plus one
+    unsigned last = 0;                    // last possible match position, plus one
+    for (unsigned k = 0; k < num_patterns; ++k) {
+        unsigned pattern_len   = patterns[k].bits_len;
+        unsigned pattern_bytes = (pattern_len + 7) / 8;
+        mask[k]      = prefix_mask(pattern_len);
+        prefix[k]    = load_be64(patterns[k].bits, 0, pattern_bytes) & mask[k];
+        keys[k]      = 0;
+        key_masks[k] = 0;
+        for (unsigned shift = 0; shift < 8; ++shift) {
+            unsigned offset   = (8 - shift) & 7;
+            uint64_t key_mask = prefix_mask(pattern_len > offset ? pattern_len - offset : 0) >> 56;
+            uint64_t key      = prefix[k] << offset >> 56;
+            key_masks[k] |= key_mask << (shift * 8);
+            keys[k] |= (key & key_mask) << (shift * 8);
         }
-        else {
-            ipos -= ppos;
-            ipos++;
-            ppos = 0;
+        last_pos[k] = pattern_len && pattern_len <= len ? len - pattern_len + 1 : 0;
+        if (last_pos[k] > end)
+            last_pos[k] = end;
+        if (last_pos[k] > last)
+            last = last_pos[k];
+    }
+    if (start >= last)
+        return len; // Not found
+
+    unsigned bytes_len = (len + 7) / 8;
+    unsigned last_byte = (last - 1 + 7) / 8;
+    for (unsigned byte = (start + 7) / 8; byte <= last_byte; ++byte) {
+        uint64_t lanes = (byte < bytes_len ? bits[byte] : 0) * LANES_LSB;
+        unsigned best  = len;
+        for (unsigned k = 0; k < num_patterns; ++k) {
+            // flag the zero bytes, the flags can have false positives but no false negatives
+            uint64_t diff = (lanes ^ keys[k]) & key_masks[k];
+            uint64_t hits = (diff - LANES_LSB) & ~diff & LANES_MSB;
+            if (!hits)
+                continue;
+            // positions 8 * byte - 7 to 8 * byte - 1, then 8 * byte
+            for (unsigned i = 1; i <= 8; ++i) {
+                unsigned shift = i & 7;
+                unsigned pos   = shift ? byte * 8 - 8 + shift : byte * 8;
+                if (!(hits >> (shift * 8 + 7) & 1) || (shift && !byte) || pos < start || pos >= last_pos[k] || pos >= best)
+                    continue;
+                if ((bits_at64(bits, pos, bytes_len) & mask[k]) == prefix[k]
+                        && (patterns[k].bits_len <= 64 || tail_matches(bits, bytes_len, pos, &patterns[k]))) {
+                    best   = pos;
+                    *match = k;
+                    break;
+                }
+            }
         }
+        if (best < len)
+            return best;
     }
 
     // Not found
     return len;
 }
 
+unsigned bitbuffer_search(bitbuffer_t *bitbuffer, unsigned row, unsigned start,
+        const uint8_t *pattern, unsigned pattern_bits_len)
+{
+    bitbuffer_pattern_t p = {pattern, pattern_bits_len};
+    unsigned match;
+    unsigned len = bitbuffer->bits_per_row[row];
+    return search_group(bitbuffer->bb[row], len, start, len, &p, 1, &match);
+}
+
+unsigned bitbuffer_search_any(bitbuffer_t *bitbuffer, unsigned row, unsigned start,
+        bitbuffer_pattern_t const *patterns, unsigned num_patterns, unsigned *match)
+{
+    uint8_t *bits = bitbuffer->bb[row];
+    unsigned len  = bitbuffer->bits_per_row[row];
+    unsigned best = len;
+    for (unsigned i = 0; i < num_patterns; i += SEARCH_GROUP_LEN) {
+        unsigned group_len = num_patterns - i < SEARCH_GROUP_LEN ? num_patterns - i : SEARCH_GROUP_LEN;
+        unsigned k;
+        // a later group only needs to match before the best match so far
+        unsigned pos = search_group(bits, len, start, best, &patterns[i], group_len, &k);
+        if (pos < best) {
+            best = pos;
+            if (match)
+                *match = i + k;
+        }
+    }
+    return best;
+}
+
 unsigned bitbuffer_manchester_decode(bitbuffer_t *inbuf, unsigned row, unsigned start,
         bitbuffer_t *outbuf, unsigned max)
 {
@@ -580,6 +726,40 @@ int main(void)
     ASSERT(bits.bb[0][0] == 0xB1);
     ASSERT(bits.bb[0][1] == 0xA0);
 
+    fprintf(stderr, "TEST: bitbuffer:: search\n");
+    bitbuffer_parse(&bits, "{135}ffeaaaaabfac40051099858125e2403f00");
+    uint8_t const sync[]  = {0xaa, 0xbf, 0xac};
+    uint8_t const short_sync[] = {0xac}; // 101011xx
+    uint8_t const tail[]  = {0x25, 0xe2, 0x40, 0x3f};
+    uint8_t const end[]   = {0x3f, 0x00};
+    uint8_t const bad[]   = {0x12, 0x34};
+    ASSERT(bitbuffer_search(&bits, 0, 0, sync, 24) == 24);
+    ASSERT(bitbuffer_search(&bits, 0, 25, sync, 24) == 135);
+    ASSERT(bitbuffer_search(&bits, 0, 0, short_sync, 6) == 30);
+    ASSERT(bitbuffer_search(&bits, 0, 0, short_sync, 4) == 10);
+    ASSERT(bitbuffer_search(&bits, 0, 11, short_sync, 4) == 12);
+    ASSERT(bitbuffer_search(&bits, 0, 0, tail, 32) == 96);
+    ASSERT(bitbuffer_search(&bits, 0, 0, end, 15) == 120);
+    ASSERT(bitbuffer_search(&bits, 0, 0, end, 16) == 135); // would end past the row
+    ASSERT(bitbuffer_search(&bits, 0, 0, bad, 16) == 135);
+    ASSERT(bitbuffer_search(&bits, 0, 200, sync, 24) == 135);
+    ASSERT(bitbuffer_search(&bits, 0, 0, sync, 0) == 135);
+    // a pattern longer than 64 bits
+    uint8_t const long_sync[] = {0xaa, 0xaa, 0xbf, 0xac, 0x40, 0x05, 0x10, 0x99, 0x85, 0x81};
+    ASSERT(bitbuffer_search(&bits, 0, 0, long_sync, 80) == 16);
+    ASSERT(bitbuffer_search(&bits, 0, 17, long_sync, 80) == 135);
+
+    fprintf(stderr, "TEST: bitbuffer:: search_any\n");
+    bitbuffer_pattern_t const patterns[] = {{bad, 16}, {short_sync, 6}, {sync, 24}};
+    unsigned match = 99;
+    ASSERT(bitbuffer_search_any(&bits, 0, 0, patterns, 3, &match) == 24 && match == 2);
+    ASSERT(bitbuffer_search_any(&bits, 0, 0, patterns, 2, &match) == 30 && match == 1);
+    match = 99;
+    ASSERT(bitbuffer_search_any(&bits, 0, 0, patterns, 1, &match) == 135 && match == 99);
+    bitbuffer_pattern_t const same[] = {{short_sync, 6}, {short_sync, 6}, {short_sync, 4}};
+    ASSERT(bitbuffer_search_any(&bits, 0, 0, same, 2, &match) == 30 && match == 0);
+    ASSERT(bitbuffer_search_any(&bits, 0, 0, same, 3, &match) == 10 && match == 2);
+
     fprintf(stderr, "TEST: bitbuffer:: Clear\n");
     bitbuffer_clear(&bits);
     ASSERT(bits.num_rows == 0);
@@ -0,0 +1,217 @@
+/** @file
+    Frequency translating, decimating channelizer for wideband I/Q samples.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "channelizer.h"
+#include "fatal.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Mixing the input x[n] by exp(-jwn) and then filtering with h[k] is the same as
+// filtering with the rotated taps h[k]*exp(jwk) and rotating the output by exp(-jwn).
+// The output rotation is only computed at the decimated positions.
+
+struct channelizer {
+    unsigned num_channels;
+    unsigned decimation;
+    unsigned num_taps;
+    float *taps;         ///< per channel complex taps, time reversed, interleaved re/im
+    double *phase;       ///< per channel output rotation phase
+    double *phase_step;  ///< per channel output rotation step per output sample
+    float *buf;          ///< I/Q history of num_taps - 1 samples followed by the loaded frame
+    unsigned buf_size;   ///< allocated samples in buf
+    unsigned buf_len;    ///< valid samples in buf
+    unsigned out_pos;    ///< position in buf of the first output for the loaded frame
+    unsigned out_len;    ///< outputs for the loaded frame
+};
+
+channelizer_t *channelizer_create(unsigned num_channels, int32_t const *offsets_hz, uint32_t samp_rate, unsigned decimation)
+{
+    if (!num_channels || !samp_rate || !decimation)
+        return NULL;
+
+    channelizer_t *c = calloc(1, sizeof(*c));
+    if (!c) {
+        WARN_CALLOC("channelizer_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    c->num_channels = num_channels;
+    c->decimation   = decimation;
+    c->num_taps     = CHANNELIZER_TAPS_PER_PHASE * decimation;
+    c->taps         = calloc(num_channels * c->num_taps * 2, sizeof(*c->taps));
+    if (!c->taps) {
+        WARN_CALLOC("channelizer_create()");
+        channelizer_free(c);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    c->phase = calloc(num_channels * 2, sizeof(*c->phase));
+    if (!c->phase) {
+        WARN_CALLOC("channelizer_create()");
+        channelizer_free(c);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    c->phase_step = &c->phase[num_channels];
+    float *proto  = calloc(c->num_taps, sizeof(*proto));
+    if (!proto) {
+        WARN_CALLOC("channelizer_create()");
+        channelizer_free(c);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+
+    // Blackman windowed sinc low pass, cutoff at 0.4 of the channel sample rate
+    unsigned n     = c->num_taps;
+    double cutoff  = 0.4 / decimation;
+    double center  = (n - 1) / 2.0;
+    double sum     = 0.0;
+    for (unsigned k = 0; k < n; ++k) {
+        double t   = k - center;
+        double s   = t == 0.0 ? 2.0 * cutoff : sin(2.0 * M_PI * cutoff * t) / (M_PI * t);
+        double win = 0.42 - 0.5 * cos(2.0 * M_PI * k / (n - 1 ? n - 1 : 1)) + 0.08 * cos(4.0 * M_PI * k / (n - 1 ? n - 1 : 1));
+        proto[k]   = (float)(s * win);
+        sum += proto[k];
+    }
+
+    for (unsigned ch = 0; ch < num_channels; ++ch) {
+        double w   = 2.0 * M_PI * offsets_hz[ch] / samp_rate;
+        float *tap = &c->taps[ch * n * 2];
+        for (unsigned k = 0; k < n; ++k) {
+            // store time reversed to run forward over the input
+            unsigned j     = n - 1 - k;
+            tap[j * 2]     = (float)(proto[k] / sum * cos(w * k));
+            tap[j * 2 + 1] = (float)(proto[k] / sum * sin(w * k));
+        }
+        c->phase_step[ch] = fmod(-w * decimation, 2.0 * M_PI);
+    }
+    free(proto);
+
+    channelizer_reset(c);
+
+    return c;
+}
+
+void channelizer_free(channelizer_t *c)
+{
+    if (!c)
+        return;
+
+    free(c->taps);
+    free(c->phase); // also holds phase_step
+    free(c->buf);
+    free(c);
+}
+
+void channelizer_reset(channelizer_t *c)
+{
+    if (c->buf)
+        memset(c->buf, 0, c->buf_size * 2 * sizeof(*c->buf));
+    // the history starts as silence
+    c->buf_len = c->num_taps - 1;
+    c->out_pos = c->num_taps - 1;
+    c->out_len = 0;
+    for (unsigned ch = 0; ch < c->num_channels; ++ch) {
+        c->phase[ch] = 0.0;
+    }
+}
+
+/// Keep the history, make room for @p n_samples new samples, and return the load position.
+static float *load_begin(channelizer_t *c, unsigned n_samples)
+{
+    unsigned hist = c->num_taps - 1;
+    unsigned size = hist + n_samples;
+    if (size > c->buf_size) {
+        float *buf = realloc(c->buf, size * 2 * sizeof(*buf));
+        if (!buf)
+            FATAL_REALLOC("channelizer_load()");
+        if (!c->buf)
+            memset(buf, 0, hist * 2 * sizeof(*buf));
+        c->buf      = buf;
+        c->buf_size = size;
+    }
+
+    // skip the outputs of the previous frame, then keep the last num_taps - 1 samples
+    c->out_pos += c->out_len * c->decimation;
+    unsigned drop = c->buf_len - hist;
+    memmove(c->buf, &c->buf[drop * 2], hist * 2 * sizeof(*c->buf));
+    c->out_pos -= drop;
+
+    return &c->buf[hist * 2];
+}
+
+static unsigned load_end(channelizer_t *c, unsigned n_samples)
+{
+    c->buf_len = c->num_taps - 1 + n_samples;
+    c->out_len = c->out_pos < c->buf_len ? (c->buf_len - c->out_pos + c->decimation - 1) / c->decimation : 0;
+    return c->out_len;
+}
+
+unsigned channelizer_load_cu8(channelizer_t *c, uint8_t const *iq_buf, unsigned n_samples)
+{
+    float *x = load_begin(c, n_samples);
+    for (unsigned i = 0; i < n_samples * 2; ++i) {
+        x[i] = (iq_buf[i] - 128) * (1.0f / 128.0f); // scale from Q0.7
+    }
+    return load_end(c, n_samples);
+}
+
+unsigned channelizer_load_cs16(channelizer_t *c, int16_t const *iq_buf, unsigned n_samples)
+{
+    float *x = load_begin(c, n_samples);
+    for (unsigned i = 0; i < n_samples * 2; ++i) {
+        x[i] = iq_buf[i] * (1.0f / 32768.0f); // scale from Q0.15
+    }
+    return load_end(c, n_samples);
+}
+
+static int16_t clamp_s16(float v)
+{
+    v *= 32767.0f; // scale to Q0.15
+    return v > 32767.0f ? 32767 : v < -32768.0f ? -32768 : (int16_t)v;
+}
+
+void channelizer_run(channelizer_t *c, unsigned channel, int16_t *y_buf)
+{
+    unsigned n        = c->num_taps;
+    float const *tap  = &c->taps[channel * n * 2];
+    double phase      = c->phase[channel];
+    double phase_step = c->phase_step[channel];
+
+    for (unsigned m = 0; m < c->out_len; ++m) {
+        // window of num_taps samples ending at the output position
+        float const *x = &c->buf[(c->out_pos + m * c->decimation + 1 - n) * 2];
+        float acc_re = 0.0f;
+        float acc_im = 0.0f;
+        for (unsigned k = 0; k < n; ++k) {
+            float xr = x[k * 2];
+            float xi = x[k * 2 + 1];
+            float hr = tap[k * 2];
+            float hi = tap[k * 2 + 1];
+            acc_re += xr * hr - xi * hi;
+            acc_im += xr * hi + xi * hr;
+        }
+        float rot_re = (float)cos(phase);
+        float rot_im = (float)sin(phase);
+        y_buf[m * 2]     = clamp_s16(acc_re * rot_re - acc_im * rot_im);
+        y_buf[m * 2 + 1] = clamp_s16(acc_re * rot_im + acc_im * rot_re);
+
+        phase += phase_step;
+        if (phase > M_PI)
+            phase -= 2.0 * M_PI;
+        else if (phase < -M_PI)
+            phase += 2.0 * M_PI;
+    }
+
+    c->phase[channel] = phase;
+}
@@ -0,0 +1,413 @@
+/** @file
+    Multi-channel demodulation of one wideband capture.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "channels.h"
+#include "channelizer.h"
+#include "thread_pool.h"
+#include "r_private.h"
+#include "r_api.h"
+#include "rtl_433.h"
+#include "baseband.h"
+#include "pulse_detect.h"
+#include "pulse_data.h"
+#include "logger.h"
+#include "fatal.h"
+
+// The channelizer, AM/FM demod and pulse detection run on the thread pool, one task per channel.
+// Tasks must not output, log messages are held and detected packages are queued,
+// both are passed on afterwards on the calling thread.
+
+/// A package detected on a channel, waiting to be decoded.
+typedef struct channel_package {
+    int type;          ///< PULSE_DATA_OOK or PULSE_DATA_FSK
+    pulse_data_t data;
+} channel_package_t;
+
+/// Demodulation state of one channel.
+typedef struct dm_channel {
+    uint32_t frequency;
+    int32_t offset;      ///< offset from the capture center frequency in Hz
+    float noise_level;
+    float min_level_auto;
+    int level_changed;   ///< min_level_auto was adjusted in the last frame
+    float avg_db;
+    int noise_only;
+    int16_t *iq_buf;     ///< channelized CS16 samples
+    uint16_t *temp_buf;  ///< magnitude
+    int16_t *am_buf;     ///< AM demodulated signal
+    int16_t *fm_buf;     ///< FM demodulated signal
+    pulse_detect_t *pulse_detect;
+    filter_state_t lowpass_filter_state;
+    demodfm_state_t demod_FM_state;
+    pulse_data_t pulse_data;
+    pulse_data_t fsk_pulse_data;
+    channel_package_t *packages;
+    unsigned num_packages;
+    unsigned max_packages;
+    list_t logs;         ///< log messages held while demodulating on the pool
+} dm_channel_t;
+
+struct channels {
+    r_cfg_t *cfg;
+    thread_pool_t *pool;
+    channelizer_t *channelizer;
+    uint32_t samp_rate;        ///< input sample rate the channelizer is set up for
+    uint32_t center_frequency; ///< input center frequency the channelizer is set up for
+    int sample_size;           ///< input sample size the channelizer is set up for
+    unsigned decimation;
+    uint32_t channel_rate;
+    unsigned num_channels;
+    dm_channel_t *channel;
+    unsigned buf_len;          ///< allocated samples in each channel buffer
+    unsigned n_samples;        ///< channel samples in the current frame
+    uint64_t input_pos;        ///< channel samples processed
+};
+
+uint32_t channels_center_frequency(r_cfg_t *cfg)
+{
+    uint32_t lo = cfg->frequency[0];
+    uint32_t hi = cfg->frequency[0];
+    for (int i = 1; i < cfg->frequencies; ++i) {
+        if (cfg->frequency[i] < lo)
+            lo = cfg->frequency[i];
+        if (cfg->frequency[i] > hi)
+            hi = cfg->frequency[i];
+    }
+    return lo + (hi - lo) / 2;
+}
+
+channels_t *channels_create(r_cfg_t *cfg, unsigned threads)
+{
+    channels_t *chs = calloc(1, sizeof(*chs));
+    if (!chs) {
+        WARN_CALLOC("channels_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    chs->cfg          = cfg;
+    chs->num_channels = cfg->frequencies;
+    chs->channel      = calloc(chs->num_channels, sizeof(*chs->channel));
+    if (!chs->channel) {
+        WARN_CALLOC("channels_create()");
+        free(chs);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+
+    struct dm_state *demod = cfg->demod;
+    for (unsigned i = 0; i < chs->num_channels; ++i) {
+        dm_channel_t *ch  = &chs->channel[i];
+        ch->frequency     = cfg->frequency[i];
+        ch->pulse_detect  = pulse_detect_create();
+        if (!ch->pulse_detect) {
+            channels_free(chs);
+            return NULL;
+        }
+        // channels are CS16, the envelope is always a magnitude
+        pulse_detect_set_levels(ch->pulse_detect, 1, demod->level_limit, demod->min_level, demod->min_snr, demod->detect_verbosity);
+    }
+
+    if (!threads)
+        threads = thread_pool_cpu_count();
+    if (threads > chs->num_channels)
+        threads = chs->num_channels;
+    chs->pool = thread_pool_create(threads);
+
+    return chs;
+}
+
+void channels_free(channels_t *chs)
+{
+    if (!chs)
+        return;
+
+    thread_pool_free(chs->pool);
+    channelizer_free(chs->channelizer);
+    for (unsigned i = 0; i < chs->num_channels; ++i) {
+        dm_channel_t *ch = &chs->channel[i];
+        pulse_detect_free(ch->pulse_detect);
+        free(ch->iq_buf); // also holds the temp, AM, and FM buffers
+        free(ch->packages);
+    }
+    free(chs->channel);
+    free(chs);
+}
+
+void channels_reset(channels_t *chs)
+{
+    if (chs->channelizer)
+        channelizer_reset(chs->channelizer);
+    for (unsigned i = 0; i < chs->num_channels; ++i) {
+        dm_channel_t *ch    = &chs->channel[i];
+        ch->noise_level     = 0.0f;
+        ch->min_level_auto  = 0.0f;
+        ch->level_changed   = 0;
+        ch->num_packages    = 0;
+        baseband_low_pass_filter_reset(&ch->lowpass_filter_state);
+        baseband_demod_FM_reset(&ch->demod_FM_state);
+        pulse_detect_reset(ch->pulse_detect);
+    }
+}
+
+/// Set up the channelizer for the current input sample rate and center frequency.
+static int channels_setup(channels_t *chs)
+{
+    r_cfg_t *cfg = chs->cfg;
+
+    chs->samp_rate        = cfg->samp_rate;
+    chs->center_frequency = cfg->center_frequency;
+    chs->sample_size      = cfg->demod->sample_size;
+    chs->decimation       = cfg->samp_rate / CHANNEL_SAMPLE_RATE;
+    if (chs->decimation < 1)
+        chs->decimation = 1;
+    chs->channel_rate = cfg->samp_rate / chs->decimation;
+
+    int32_t offsets[MAX_FREQS];
+    int32_t max_offset = (int32_t)(cfg->samp_rate / 2 - chs->channel_rate / 2);
+    for (unsigned i = 0; i < chs->num_channels; ++i) {
+        dm_channel_t *ch = &chs->channel[i];
+        ch->offset       = (int32_t)(ch->frequency - chs->center_frequency);
+        offsets[i]       = ch->offset;
+        if (ch->offset > max_offset || ch->offset < -max_offset) {
+            print_logf(LOG_WARNING, "Channels", "Channel %.3f MHz is outside of the %.3f MHz wide capture at %.3f MHz",
+                    ch->frequency / 1e6, cfg->samp_rate / 1e6, chs->center_frequency / 1e6);
+        }
+    }
+
+    channelizer_free(chs->channelizer);
+    chs->channelizer = channelizer_create(chs->num_channels, offsets, chs->samp_rate, chs->decimation);
+    if (!chs->channelizer)
+        return -1;
+
+    channels_reset(chs);
+
+    print_logf(LOG_NOTICE, "Channels", "Demodulating %u channels at %u Hz from %u Hz sample rate on %u threads",
+            chs->num_channels, chs->channel_rate, chs->samp_rate, thread_pool_size(chs->pool));
+
+    return 0;
+}
+
+/// Grow the channel buffers to hold @p n_samples channel samples.
+static void channels_ensure_size(channels_t *chs, unsigned n_samples)
+{
+    if (n_samples <= chs->buf_len)
+        return;
+
+    for (unsigned i = 0; i < chs->num_channels; ++i) {
+        dm_channel_t *ch = &chs->channel[i];
+        free(ch->iq_buf);
+        // one allocation for I/Q, magnitude, AM, and FM buffers
+        ch->iq_buf = calloc(n_samples * 5, sizeof(*ch->iq_buf));
+        if (!ch->iq_buf)
+            FATAL_CALLOC("channels_ensure_size()");
+        ch->temp_buf = (uint16_t *)&ch->iq_buf[n_samples * 2];
+        ch->am_buf   = &ch->iq_buf[n_samples * 3];
+        ch->fm_buf   = &ch->iq_buf[n_samples * 4];
+    }
+    chs->buf_len = n_samples;
+}
+
+static void channel_queue_package(dm_channel_t *ch, int type, pulse_data_t const *data)
+{
+    if (ch->num_packages >= ch->max_packages) {
+        unsigned max = ch->max_packages ? ch->max_packages * 2 : 4;
+        channel_package_t *packages = realloc(ch->packages, max * sizeof(*packages));
+        if (!packages)
+            FATAL_REALLOC("channel_queue_package()");
+        ch->packages     = packages;
+        ch->max_packages = max;
+    }
+    channel_package_t *package = &ch->packages[ch->num_packages++];
+    package->type = type;
+    package->data = *data;
+}
+
+// note that this function is called on a pool thread
+static void demod_channel_run(channels_t *chs, dm_channel_t *ch, unsigned idx)
+{
+    r_cfg_t *cfg           = chs->cfg;
+    struct dm_state *demod = cfg->demod;
+    unsigned n_samples     = chs->n_samples;
+
+    ch->num_packages  = 0;
+    ch->level_changed = 0;
+
+    channelizer_run(chs->channelizer, idx, ch->iq_buf);
+
+    unsigned fpdm = cfg->fsk_pulse_detect_mode;
+    if (cfg->fsk_pulse_detect_mode == FSK_PULSE_DETECT_AUTO) {
+        if (ch->frequency > FSK_PULSE_DETECTOR_LIMIT)
+            fpdm = FSK_PULSE_DETECT_NEW;
+        else
+            fpdm = FSK_PULSE_DETECT_OLD;
+    }
+    float low_pass = demod->low_pass != 0.0f ? demod->low_pass : fpdm ? 0.2f : 0.1f;
+
+    // AM and FM demodulation, same noise level tracking as the single channel demod
+    int squelch = demod->squelch_offset > 0;
+    if (!squelch) {
+        // no frame is skipped, demodulate in a single pass
+        ch->avg_db = baseband_demod_AM_FM(&ch->lowpass_filter_state, demod->enable_FM_demod ? &ch->demod_FM_state : NULL,
+                (uint8_t const *)ch->iq_buf, 4, 1, ch->am_buf, demod->enable_FM_demod ? ch->fm_buf : NULL, n_samples, chs->channel_rate, low_pass);
+    }
+    else {
+        ch->avg_db = magnitude_est_cs16(ch->iq_buf, ch->temp_buf, n_samples);
+    }
+    if (ch->min_level_auto == 0.0f) {
+        ch->min_level_auto = demod->min_level;
+    }
+    if (ch->noise_level == 0.0f) {
+        ch->noise_level = ch->min_level_auto - 3.0f;
+    }
+    ch->noise_only = ch->avg_db < ch->noise_level + 3.0f;
+    if (ch->noise_only) {
+        ch->noise_level = (ch->noise_level * 7 + ch->avg_db) / 8; // fast fall over 8 frames
+        if (demod->auto_level > 0 && ch->noise_level < demod->min_level - 3.0f
+                && fabsf(ch->min_level_auto - ch->noise_level - 3.0f) > 1.0f) {
+            ch->min_level_auto = ch->noise_level + 3.0f;
+            ch->level_changed  = 1;
+            pulse_detect_set_levels(ch->pulse_detect, 1, demod->level_limit, ch->min_level_auto, demod->min_snr, demod->detect_verbosity);
+        }
+    } else {
+        ch->noise_level = (ch->noise_level * 31 + ch->avg_db) / 32; // slow rise over 32 frames
+    }
+
+    if (squelch && ch->noise_only)
+        return;
+
+    if (squelch) {
+        baseband_low_pass_filter(&ch->lowpass_filter_state, ch->temp_buf, ch->am_buf, n_samples);
+
+        // FM demodulation
+        if (demod->enable_FM_demod) {
+            baseband_demod_FM_cs16(&ch->demod_FM_state, ch->iq_buf, ch->fm_buf, n_samples, chs->channel_rate, low_pass);
+        }
+    }
+
+    if (!demod->r_devs.len)
+        return;
+
+    int package_type = PULSE_DATA_OOK; // Just to get us started
+    while (package_type) {
+        package_type = pulse_detect_package(ch->pulse_detect, ch->am_buf, ch->fm_buf, n_samples, chs->channel_rate, chs->input_pos, &ch->pulse_data, &ch->fsk_pulse_data, fpdm);
+        if (package_type == PULSE_DATA_OOK)
+            channel_queue_package(ch, package_type, &ch->pulse_data);
+        else if (package_type == PULSE_DATA_FSK)
+            channel_queue_package(ch, package_type, &ch->fsk_pulse_data);
+    }
+}
+
+static void demod_channel(void *ctx, unsigned idx)
+{
+    channels_t *chs  = ctx;
+    dm_channel_t *ch = &chs->channel[idx];
+
+    r_hold_logs(&ch->logs);
+    demod_channel_run(chs, ch, idx);
+    r_hold_logs(NULL);
+}
+
+/// Decode a package from a channel, the package is moved to the demod state for the output metadata.
+static int decode_package(r_cfg_t *cfg, channels_t *chs, dm_channel_t *ch, channel_package_t *package)
+{
+    struct dm_state *demod = cfg->demod;
+    pulse_data_t *pulses   = &package->data;
+    int p_events           = 0;
+    unsigned candidates;
+
+    calc_pulse_levels(pulses, ch->frequency, 4, 1); // CS16, magnitude
+    // report times in input samples
+    pulses->start_ago *= chs->decimation;
+    pulses->end_ago *= chs->decimation;
+
+    if (package->type == PULSE_DATA_OOK) {
+        demod->pulse_data = *pulses;
+        demod->fsk_pulse_data.fsk_f2_est = 0;
+        p_events += run_ook_demods(&demod->r_devs, &demod->pulse_data);
+        candidates = demod->pulse_data.num_candidates;
+        cfg->total_frames_ook += 1;
+        cfg->frames_ook += 1;
+    }
+    else {
+        demod->fsk_pulse_data = *pulses;
+        demod->pulse_data.start_ago = pulses->start_ago;
+        p_events += run_fsk_demods(&demod->r_devs, &demod->fsk_pulse_data);
+        candidates = demod->fsk_pulse_data.num_candidates;
+        cfg->total_frames_fsk += 1;
+        cfg->frames_fsk += 1;
+    }
+    cfg->total_frames_events += p_events > 0;
+    cfg->frames_events += p_events > 0;
+    cfg->frames_decoders += candidates;
+    if (cfg->verbosity >= LOG_DEBUG)
+        print_logf(LOG_DEBUG, "Demod", "%s package on %u Hz: ran %u of %u decoders", package->type == PULSE_DATA_OOK ? "OOK" : "FSK",
+                ch->frequency, candidates, (unsigned)demod->r_devs.len);
+
+    if (cfg->verbosity >= LOG_TRACE) pulse_data_print(pulses);
+    if (cfg->raw_mode == 1 || (cfg->raw_mode == 2 && p_events == 0) || (cfg->raw_mode == 3 && p_events > 0)) {
+        data_t *data = pulse_data_print_data(pulses);
+        event_occurred_handler(cfg, data);
+    }
+
+    return p_events;
+}
+
+int channels_process(r_cfg_t *cfg, uint8_t const *iq_buf, unsigned n_samples)
+{
+    struct dm_state *demod = cfg->demod;
+    channels_t *chs        = demod->channels;
+
+    if (!chs->channelizer
+            || chs->samp_rate != cfg->samp_rate
+            || chs->center_frequency != cfg->center_frequency
+            || chs->sample_size != demod->sample_size) {
+        if (channels_setup(chs) < 0)
+            return 0;
+    }
+
+    unsigned n_out;
+    if (demod->sample_size == 2) { // CU8
+        n_out = channelizer_load_cu8(chs->channelizer, iq_buf, n_samples);
+    } else { // CS16
+        n_out = channelizer_load_cs16(chs->channelizer, (int16_t const *)iq_buf, n_samples);
+    }
+    channels_ensure_size(chs, n_out);
+    chs->n_samples = n_out;
+
+    if (n_out) {
+        thread_pool_run(chs->pool, chs->num_channels, demod_channel, chs);
+    }
+
+    // decode on the calling thread, in channel order
+    int d_events   = 0;
+    int noise_only = 1;
+    for (unsigned i = 0; i < chs->num_channels; ++i) {
+        dm_channel_t *ch = &chs->channel[i];
+        noise_only &= ch->noise_only;
+        r_flush_held_logs(&ch->logs);
+        if (ch->level_changed) {
+            print_logf(LOG_WARNING, "Auto Level", "Channel %.3f MHz: estimated noise level is %.1f dB, adjusting minimum detection level to %.1f dB",
+                    ch->frequency / 1e6, ch->noise_level, ch->min_level_auto);
+        }
+        for (unsigned j = 0; j < ch->num_packages; ++j) {
+            d_events += decode_package(cfg, chs, ch, &ch->packages[j]);
+        }
+        ch->num_packages = 0;
+    }
+    cfg->total_frames_count += 1;
+    cfg->total_frames_squelch += noise_only;
+
+    chs->input_pos += n_out;
+
+    return d_events;
+}
@@ -33,6 +33,28 @@ int gettimeofday(struct timeval *tv, void *tz)
     return 0;
 }
 
+uint64_t time_monotonic_ns(void)
+{
+    static LARGE_INTEGER freq;
+    if (!freq.QuadPart)
+        QueryPerformanceFrequency(&freq);
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return (uint64_t)(now.QuadPart / freq.QuadPart) * 1000000000u
+            + (uint64_t)(now.QuadPart % freq.QuadPart) * 1000000000u / freq.QuadPart;
+}
+
+#else
+
+#include <time.h>
+
+uint64_t time_monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
 #endif // _WIN32
 
 int timeval_subtract(struct timeval *result, struct timeval const *x, struct timeval const *y)
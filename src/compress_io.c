@@ -0,0 +1,356 @@
+/** @file
+    Streaming gzip and zstd compression for sample files.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "compress_io.h"
+#include "fileformat.h"
+#include "logger.h"
+#include "fatal.h"
+
+#ifdef ZLIB
+#include <zlib.h>
+#endif
+#ifdef ZSTD
+#include <zstd.h>
+#endif
+
+#define COMPRESS_BUF_LEN (256 * 1024) ///< bytes of compressed data per read or write
+
+struct compress_reader {
+    FILE *file;
+    unsigned compression;
+    uint8_t *in;
+    int in_stream; ///< a gzip member or zstd frame is not complete
+    int done;      ///< the input ended or is corrupt
+#ifdef ZLIB
+    z_stream zs;
+#endif
+#ifdef ZSTD
+    ZSTD_DStream *zds;
+    ZSTD_inBuffer zin;
+#endif
+};
+
+struct compress_writer {
+    FILE *file;
+    unsigned compression;
+    uint8_t *out;
+    int error; ///< a write failed
+#ifdef ZLIB
+    z_stream zs;
+#endif
+#ifdef ZSTD
+    ZSTD_CStream *zcs;
+#endif
+};
+
+int compress_supported(unsigned compression)
+{
+    switch (compression) {
+    case FILE_COMPRESS_NONE: return 1;
+#ifdef ZLIB
+    case FILE_COMPRESS_GZIP: return 1;
+#endif
+#ifdef ZSTD
+    case FILE_COMPRESS_ZSTD: return 1;
+#endif
+    default: return 0;
+    }
+}
+
+char const *compress_name(unsigned compression)
+{
+    switch (compression) {
+    case FILE_COMPRESS_NONE: return "none";
+    case FILE_COMPRESS_GZIP: return "gzip";
+    case FILE_COMPRESS_ZSTD: return "zstd";
+    default: return "unknown";
+    }
+}
+
+/* reader */
+
+/// Refill the input buffer, returns the bytes read, 0 at the end of input.
+static size_t reader_fill(compress_reader_t *r)
+{
+    size_t n = fread(r->in, 1, COMPRESS_BUF_LEN, r->file);
+    if (!n) {
+        if (r->in_stream)
+            print_logf(LOG_WARNING, "Input", "Compressed %s input ended early", compress_name(r->compression));
+        r->done = 1;
+    }
+    return n;
+}
+
+compress_reader_t *compress_reader_create(FILE *file, unsigned compression)
+{
+    if (compression == FILE_COMPRESS_NONE || !compress_supported(compression))
+        return NULL;
+
+    compress_reader_t *r = calloc(1, sizeof(*r));
+    if (!r) {
+        WARN_CALLOC("compress_reader_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    r->file        = file;
+    r->compression = compression;
+    r->in = malloc(COMPRESS_BUF_LEN);
+    if (!r->in) {
+        WARN_MALLOC("compress_reader_create()");
+        free(r);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+
+#ifdef ZLIB
+    if (compression == FILE_COMPRESS_GZIP) {
+        // 16 + MAX_WBITS: expect a gzip header
+        if (inflateInit2(&r->zs, 16 + MAX_WBITS) != Z_OK) {
+            print_log(LOG_ERROR, __func__, "inflateInit2 failed");
+            free(r->in);
+            free(r);
+            return NULL;
+        }
+    }
+#endif
+#ifdef ZSTD
+    if (compression == FILE_COMPRESS_ZSTD) {
+        r->zds = ZSTD_createDStream();
+        if (!r->zds) {
+            WARN_MALLOC("compress_reader_create()");
+            free(r->in);
+            free(r);
+            return NULL; // NOTE: returns NULL on alloc failure.
+        }
+    }
+#endif
+
+    return r;
+}
+
+#ifdef ZLIB
+static size_t gzip_read(compress_reader_t *r, void *buf, size_t len)
+{
+    z_stream *zs  = &r->zs;
+    zs->next_out  = buf;
+    zs->avail_out = (uInt)len;
+    while (zs->avail_out && !r->done) {
+        if (!zs->avail_in) {
+            size_t n = reader_fill(r);
+            if (!n)
+                break;
+            zs->next_in  = r->in;
+            zs->avail_in = (uInt)n;
+        }
+        int ret = inflate(zs, Z_NO_FLUSH);
+        if (ret == Z_STREAM_END) {
+            // concatenated members continue the stream
+            r->in_stream = 0;
+            inflateReset(zs);
+        }
+        else if (ret == Z_OK) {
+            r->in_stream = 1;
+        }
+        else {
+            print_logf(LOG_ERROR, "Input", "Corrupt gzip input: %s", zs->msg ? zs->msg : "inflate failed");
+            r->done = 1;
+        }
+    }
+    return len - zs->avail_out;
+}
+#endif
+
+#ifdef ZSTD
+static size_t zstd_read(compress_reader_t *r, void *buf, size_t len)
+{
+    ZSTD_outBuffer out = {buf, len, 0};
+    while (out.pos < out.size && !r->done) {
+        if (r->zin.pos == r->zin.size) {
+            size_t n = reader_fill(r);
+            if (!n)
+                break;
+            r->zin = (ZSTD_inBuffer){r->in, n, 0};
+        }
+        size_t ret = ZSTD_decompressStream(r->zds, &out, &r->zin);
+        if (ZSTD_isError(ret)) {
+            print_logf(LOG_ERROR, "Input", "Corrupt zstd input: %s", ZSTD_getErrorName(ret));
+            r->done = 1;
+        }
+        else {
+            r->in_stream = ret != 0; // 0 when a frame is complete
+        }
+    }
+    return out.pos;
+}
+#endif
+
+size_t compress_reader_read(void *reader, void *buf, size_t len)
+{
+    compress_reader_t *r = reader;
+#ifdef ZLIB
+    if (r->compression == FILE_COMPRESS_GZIP)
+        return gzip_read(r, buf, len);
+#endif
+#ifdef ZSTD
+    if (r->compression == FILE_COMPRESS_ZSTD)
+        return zstd_read(r, buf, len);
+#endif
+    (void)buf;
+    (void)len;
+    return 0;
+}
+
+void compress_reader_free(compress_reader_t *r)
+{
+    if (!r)
+        return;
+
+#ifdef ZLIB
+    if (r->compression == FILE_COMPRESS_GZIP)
+        inflateEnd(&r->zs);
+#endif
+#ifdef ZSTD
+    if (r->compression == FILE_COMPRESS_ZSTD)
+        ZSTD_freeDStream(r->zds);
+#endif
+
+    free(r->in);
+    free(r);
+}
+
+/* writer */
+
+/// Write out compressed data, remembers a failed write.
+static void writer_put(compress_writer_t *w, size_t len)
+{
+    if (len && !w->error && fwrite(w->out, 1, len, w->file) != len)
+        w->error = 1;
+}
+
+compress_writer_t *compress_writer_create(FILE *file, unsigned compression)
+{
+    if (compression == FILE_COMPRESS_NONE || !compress_supported(compression))
+        return NULL;
+
+    compress_writer_t *w = calloc(1, sizeof(*w));
+    if (!w) {
+        WARN_CALLOC("compress_writer_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    w->file        = file;
+    w->compression = compression;
+    w->out = malloc(COMPRESS_BUF_LEN);
+    if (!w->out) {
+        WARN_MALLOC("compress_writer_create()");
+        free(w);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+
+#ifdef ZLIB
+    if (compression == FILE_COMPRESS_GZIP) {
+        // 16 + MAX_WBITS: write a gzip header
+        if (deflateInit2(&w->zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            print_log(LOG_ERROR, __func__, "deflateInit2 failed");
+            free(w->out);
+            free(w);
+            return NULL;
+        }
+    }
+#endif
+#ifdef ZSTD
+    if (compression == FILE_COMPRESS_ZSTD) {
+        w->zcs = ZSTD_createCStream();
+        if (!w->zcs) {
+            WARN_MALLOC("compress_writer_create()");
+            free(w->out);
+            free(w);
+            return NULL; // NOTE: returns NULL on alloc failure.
+        }
+    }
+#endif
+
+    return w;
+}
+
+#ifdef ZLIB
+static void gzip_write(compress_writer_t *w, void *buf, size_t len, int flush)
+{
+    z_stream *zs = &w->zs;
+    zs->next_in  = buf;
+    zs->avail_in = (uInt)len;
+    int ret;
+    do {
+        zs->next_out  = w->out;
+        zs->avail_out = COMPRESS_BUF_LEN;
+        ret = deflate(zs, flush);
+        writer_put(w, COMPRESS_BUF_LEN - zs->avail_out);
+    } while (zs->avail_out == 0 || (flush == Z_FINISH && ret == Z_OK));
+}
+#endif
+
+#ifdef ZSTD
+static void zstd_write(compress_writer_t *w, void *buf, size_t len, ZSTD_EndDirective end)
+{
+    ZSTD_inBuffer in = {buf, len, 0};
+    size_t ret;
+    do {
+        ZSTD_outBuffer out = {w->out, COMPRESS_BUF_LEN, 0};
+        ret = ZSTD_compressStream2(w->zcs, &out, &in, end);
+        if (ZSTD_isError(ret)) {
+            print_logf(LOG_ERROR, __func__, "zstd compression failed: %s", ZSTD_getErrorName(ret));
+            w->error = 1;
+            return;
+        }
+        writer_put(w, out.pos);
+    } while (in.pos < in.size || (end == ZSTD_e_end && ret != 0));
+}
+#endif
+
+size_t compress_writer_write(void *writer, void *buf, size_t len)
+{
+    compress_writer_t *w = writer;
+#ifdef ZLIB
+    if (w->compression == FILE_COMPRESS_GZIP)
+        gzip_write(w, buf, len, Z_NO_FLUSH);
+#endif
+#ifdef ZSTD
+    if (w->compression == FILE_COMPRESS_ZSTD)
+        zstd_write(w, buf, len, ZSTD_e_continue);
+#endif
+    (void)buf;
+    return w->error ? 0 : len;
+}
+
+void compress_writer_free(compress_writer_t *w)
+{
+    if (!w)
+        return;
+
+#ifdef ZLIB
+    if (w->compression == FILE_COMPRESS_GZIP) {
+        gzip_write(w, NULL, 0, Z_FINISH);
+        deflateEnd(&w->zs);
+    }
+#endif
+#ifdef ZSTD
+    if (w->compression == FILE_COMPRESS_ZSTD) {
+        zstd_write(w, NULL, 0, ZSTD_e_end);
+        ZSTD_freeCStream(w->zcs);
+    }
+#endif
+    if (w->error)
+        print_logf(LOG_ERROR, "Output", "Short write, compressed %s output is incomplete", compress_name(w->compression));
+
+    free(w->out);
+    free(w);
+}
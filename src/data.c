@@ -14,6 +14,7 @@
 
 #include "abuf.h"
 #include "fatal.h"
+#include "compat_atomic.h"
 
 #include <stdarg.h>
 #include <assert.h>
@@ -81,7 +82,7 @@ static data_meta_type_t dmt[DATA_COUNT] = {
       .array_is_boxed           = true,
       .array_elementwise_import = (array_elementwise_import_fn) strdup,
       .array_element_release    = (array_element_release_fn) free,
-      .value_release            = (value_release_fn) free },
+      .value_release            = NULL }, // string values live in the arena
 
     //  DATA_ARRAY
     { .array_element_size       = sizeof(data_array_t*),
@@ -115,6 +116,167 @@ static bool import_values(void *dst, void const *src, int num_values, data_type_
     return true; // error is returned early
 }
 
+/* interned keys */
+
+#define DATA_INTERN_BUCKETS 1024 ///< hash buckets, a power of two
+
+/// An interned string, entries are only ever added.
+typedef struct intern_entry {
+    struct intern_entry *next;
+    unsigned hash;
+    unsigned id;
+    char str[];
+} intern_entry_t;
+
+static intern_entry_t *intern_buckets[DATA_INTERN_BUCKETS];
+static unsigned intern_count;
+
+/// FNV-1a hash.
+static unsigned intern_hash(char const *str)
+{
+    unsigned hash = 2166136261u;
+    for (; *str; ++str) {
+        hash = (hash ^ (unsigned char)*str) * 16777619u;
+    }
+    return hash;
+}
+
+static intern_entry_t *intern_find(intern_entry_t *entry, intern_entry_t *end, unsigned hash, char const *str)
+{
+    for (; entry != end; entry = entry->next) {
+        if (entry->hash == hash && !strcmp(entry->str, str))
+            return entry;
+    }
+    return NULL;
+}
+
+R_API char const *data_intern(char const *str)
+{
+    if (!str)
+        return NULL;
+
+    unsigned hash = intern_hash(str);
+    intern_entry_t **bucket = &intern_buckets[hash & (DATA_INTERN_BUCKETS - 1)];
+    intern_entry_t *head    = compat_atomic_load_acq_ptr(bucket);
+    intern_entry_t *found   = intern_find(head, NULL, hash, str);
+    if (found)
+        return found->str;
+
+    size_t len = strlen(str) + 1;
+    intern_entry_t *entry = malloc(sizeof(*entry) + len);
+    if (!entry) {
+        WARN_MALLOC("data_intern()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    entry->hash = hash;
+    entry->id   = compat_atomic_fetch_add_u(&intern_count, 1) + 1;
+    memcpy(entry->str, str, len);
+
+    // lock-free insert, another thread might add the same string meanwhile
+    entry->next = head;
+    while (!compat_atomic_cas_ptr(bucket, entry->next, entry)) {
+        intern_entry_t *new_head = compat_atomic_load_acq_ptr(bucket);
+        found = intern_find(new_head, entry->next, hash, str);
+        if (found) {
+            free(entry);
+            return found->str;
+        }
+        entry->next = new_head;
+    }
+    return entry->str;
+}
+
+R_API unsigned data_key_id(char const *str)
+{
+    intern_entry_t const *entry = (intern_entry_t const *)(str - offsetof(intern_entry_t, str));
+    return entry->id;
+}
+
+/* arena */
+
+#define DATA_ARENA_SIZE 512 ///< first chunk size, holds a typical event
+#define DATA_ARENA_ALIGN sizeof(double)
+
+/// Memory for the elements and strings of an event, released when the last element is freed.
+typedef struct data_arena {
+    struct data_arena *next; ///< further chunks, newest first, owned by the first chunk
+    unsigned elems;          ///< number of live elements, first chunk only
+    size_t size;
+    size_t used;
+    data_t *json_data;       ///< the element rendered to json, first chunk only
+    char *json;              ///< the shared JSON rendering, first chunk only, see data_jsons()
+    size_t json_len;
+} data_arena_t;
+
+/// Chunk header size, the chunk memory follows aligned.
+#define DATA_ARENA_HEADER ((sizeof(data_arena_t) + DATA_ARENA_ALIGN - 1) & ~(DATA_ARENA_ALIGN - 1))
+
+static data_arena_t *arena_chunk(size_t size)
+{
+    data_arena_t *chunk = malloc(DATA_ARENA_HEADER + size);
+    if (!chunk) {
+        WARN_MALLOC("arena_chunk()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    chunk->next  = NULL;
+    chunk->elems = 0;
+    chunk->size  = size;
+    chunk->used  = 0;
+    chunk->json_data = NULL;
+    chunk->json      = NULL;
+    chunk->json_len  = 0;
+    return chunk;
+}
+
+static void *arena_bump(data_arena_t *arena, size_t size)
+{
+    size = (size + DATA_ARENA_ALIGN - 1) & ~(DATA_ARENA_ALIGN - 1);
+    // only the newest chunk is used, the first chunk is the newest until it is full
+    data_arena_t *chunk = arena->next ? arena->next : arena;
+    if (chunk->size - chunk->used < size) {
+        size_t chunk_size = chunk->size * 2 > size ? chunk->size * 2 : size;
+        chunk = arena_chunk(chunk_size);
+        if (!chunk)
+            return NULL;
+        chunk->next = arena->next;
+        arena->next = chunk;
+    }
+    void *p = (char *)chunk + DATA_ARENA_HEADER + chunk->used;
+    chunk->used += size;
+    return p;
+}
+
+static char *arena_strcpy(data_arena_t *arena, char const *str)
+{
+    if (!str)
+        return NULL;
+    size_t len = strlen(str) + 1;
+    char *copy = arena_bump(arena, len);
+    if (!copy)
+        return NULL;
+    return memcpy(copy, str, len);
+}
+
+/// Drop the JSON rendering, the elements of the event changed.
+static void arena_json_reset(data_arena_t *arena)
+{
+    free(arena->json);
+    arena->json_data = NULL;
+    arena->json      = NULL;
+    arena->json_len  = 0;
+}
+
+static void arena_free(data_arena_t *arena)
+{
+    if (arena)
+        free(arena->json);
+    while (arena) {
+        data_arena_t *chunk = arena;
+        arena = arena->next;
+        free(chunk);
+    }
+}
+
 /* data */
 
 R_API data_array_t *data_array(int num_values, data_type_t type, void const *values)
@@ -160,9 +322,14 @@ static data_t *vdata_make(data_t *first, const char *key, const char *pretty_key
 {
     data_type_t type;
     data_t *prev = first;
-    while (prev && prev->next)
-        prev = prev->next;
-    char *format = NULL;
+    // the JSON rendering of the event, or of any part, gets stale
+    for (data_t *iter = first; iter; iter = iter->next) {
+        arena_json_reset(iter->arena);
+        prev = iter;
+    }
+    // appended elements share the memory of the event
+    data_arena_t *arena = first ? first->arena : NULL;
+    char const *format = NULL;
     int skip = 0; // skip the data item if this is set
     type = va_arg(ap, data_type_t);
     do {
@@ -181,14 +348,7 @@ static data_t *vdata_make(data_t *first, const char *key, const char *pretty_key
                 fprintf(stderr, "vdata_make() format type used twice\n");
                 goto alloc_error;
             }
-            format = va_arg(ap, char *);
-            if (format) {
-                format = strdup(format);
-                if (!format) {
-                    WARN_STRDUP("vdata_make()");
-                    goto alloc_error;
-                }
-            }
+            format = va_arg(ap, char const *); // copied with the element
             type = va_arg(ap, data_type_t);
             continue;
         case DATA_COUNT:
@@ -205,10 +365,7 @@ static data_t *vdata_make(data_t *first, const char *key, const char *pretty_key
             value.v_dbl = va_arg(ap, double);
             break;
         case DATA_STRING:
-            value_release = (value_release_fn)free; // appease CSA checker
-            value.v_ptr = strdup(va_arg(ap, char const *));
-            if (!value.v_ptr)
-                WARN_STRDUP("vdata_make()");
+            value.v_ptr = (void *)va_arg(ap, char const *); // copied with the element
             break;
         case DATA_ARRAY:
             value_release = (value_release_fn)data_array_free; // appease CSA checker
@@ -222,21 +379,29 @@ static data_t *vdata_make(data_t *first, const char *key, const char *pretty_key
         if (skip) {
             if (value_release) // could use dmt[type].value_release
                 value_release(value.v_ptr);
-            free(format);
             format = NULL;
             skip = 0;
         }
         else {
-            current = calloc(1, sizeof(*current));
+            if (!arena) {
+                arena = arena_chunk(DATA_ARENA_SIZE);
+                if (!arena) {
+                    if (value_release) // could use dmt[type].value_release
+                        value_release(value.v_ptr);
+                    goto alloc_error;
+                }
+            }
+            current = arena_bump(arena, sizeof(*current));
             if (!current) {
-                WARN_CALLOC("vdata_make()");
+                WARN_MALLOC("vdata_make()");
                 if (value_release) // could use dmt[type].value_release
                     value_release(value.v_ptr);
                 goto alloc_error;
             }
+            memset(current, 0, sizeof(*current));
+            arena->elems += 1;
+            current->arena  = arena;
             current->type   = type;
-            current->format = format;
-            format          = NULL; // consumed
             current->value  = value;
             current->next   = NULL;
 
@@ -246,14 +411,27 @@ static data_t *vdata_make(data_t *first, const char *key, const char *pretty_key
             if (!first)
                 first = current;
 
-            current->key = strdup(key);
+            if (type == DATA_STRING) {
+                current->value.v_ptr = arena_strcpy(arena, value.v_ptr);
+                if (!current->value.v_ptr) {
+                    WARN_MALLOC("vdata_make()");
+                    goto alloc_error;
+                }
+            }
+            if (format) {
+                current->format = arena_strcpy(arena, format);
+                if (!current->format) {
+                    WARN_MALLOC("vdata_make()");
+                    goto alloc_error;
+                }
+                format = NULL; // consumed
+            }
+            current->key = data_intern(key);
             if (!current->key) {
-                WARN_STRDUP("vdata_make()");
                 goto alloc_error;
             }
-            current->pretty_key = strdup(pretty_key ? pretty_key : key);
+            current->pretty_key = pretty_key ? data_intern(pretty_key) : current->key;
             if (!current->pretty_key) {
-                WARN_STRDUP("vdata_make()");
                 goto alloc_error;
             }
         }
@@ -273,7 +451,8 @@ static data_t *vdata_make(data_t *first, const char *key, const char *pretty_key
     return first;
 
 alloc_error:
-    free(format); // if not consumed
+    if (arena && !arena->elems)
+        arena_free(arena); // no element was added
     data_free(first);
     return NULL;
 }
@@ -303,8 +482,10 @@ R_API data_t *data_prepend(data_t *tail, data_t *head)
     }
 
     data_t *prev = head;
+    arena_json_reset(prev->arena);
     while (prev->next) {
         prev = prev->next;
+        arena_json_reset(prev->arena);
     }
     prev->next = tail;
 
@@ -359,6 +540,14 @@ R_API void data_array_free(data_array_t *array)
     free(array);
 }
 
+R_API char *data_strcpy(data_t *data, char const *str)
+{
+    char *copy = arena_strcpy(data->arena, str);
+    if (!copy && str)
+        WARN_MALLOC("data_strcpy()");
+    return copy;
+}
+
 R_API data_t *data_retain(data_t *data)
 {
     if (data)
@@ -380,11 +569,12 @@ R_API void data_free(data_t *data)
         data_t *prev_data = data;
         if (dmt[data->type].value_release)
             dmt[data->type].value_release(data->value.v_ptr);
-        free(data->format);
-        free(data->pretty_key);
-        free(data->key);
         data = data->next;
-        free(prev_data);
+        // the arena goes with the last element of the event
+        data_arena_t *arena = prev_data->arena;
+        arena->elems -= 1;
+        if (!arena->elems)
+            arena_free(arena);
     }
 }
 
@@ -463,9 +653,13 @@ R_API void print_array_value(data_output_t *output, data_array_t *array, char co
 
 /* JSON string printer */
 
+#define DATA_JSONS_SIZE 2048        ///< first size tried for the shared rendering, holds a typical event
+#define DATA_JSONS_MAX (1024 * 1024) ///< largest size tried for the shared rendering
+
 typedef struct {
     struct data_output output;
     abuf_t msg;
+    int truncated; ///< a string did not fit
 } data_print_jsons_t;
 
 static void R_API_CALLCONV format_jsons_array(data_output_t *output, data_array_t *array, char const *format)
@@ -510,6 +704,7 @@ static void R_API_CALLCONV format_jsons_string(data_output_t *output, const char
 
     size_t str_len = strlen(str);
     if (size < str_len + 3) {
+        jsons->truncated = 1;
         return;
     }
 
@@ -586,7 +781,8 @@ static void R_API_CALLCONV format_jsons_int(data_output_t *output, int data, cha
     abuf_printf(&jsons->msg, "%d", data);
 }
 
-R_API size_t data_print_jsons(data_t *data, char *dst, size_t len)
+/// Print as JSON string, returns the length, @p truncated is set if the output did not fit.
+static size_t print_jsons(data_t *data, char *dst, size_t len, int *truncated)
 {
     data_print_jsons_t jsons = {
             .output = {
@@ -602,5 +798,44 @@ R_API size_t data_print_jsons(data_t *data, char *dst, size_t len)
 
     format_jsons_object(&jsons.output, data, NULL);
 
+    // the short tokens and numbers are dropped silently if there is not enough room
+    *truncated = jsons.truncated || jsons.msg.left < 32;
     return len - jsons.msg.left;
 }
+
+R_API size_t data_print_jsons(data_t *data, char *dst, size_t len)
+{
+    int truncated;
+    return print_jsons(data, dst, len, &truncated);
+}
+
+R_API char const *data_jsons(data_t *data, size_t *len)
+{
+    data_arena_t *arena = data->arena;
+    if (arena->json_data != data) {
+        arena_json_reset(arena);
+
+        size_t size = DATA_JSONS_SIZE;
+        for (;;) {
+            char *json = malloc(size);
+            if (!json) {
+                WARN_MALLOC("data_jsons()");
+                return NULL; // NOTE: returns NULL on alloc failure.
+            }
+            int truncated;
+            size_t json_len = print_jsons(data, json, size, &truncated);
+            if (!truncated || size >= DATA_JSONS_MAX) {
+                arena->json_data = data;
+                arena->json      = json;
+                arena->json_len  = json_len;
+                break;
+            }
+            free(json);
+            size *= 2;
+        }
+    }
+
+    if (len)
+        *len = arena->json_len;
+    return arena->json;
+}
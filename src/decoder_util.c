@@ -33,6 +33,7 @@ r_device *decoder_create(r_device const *dev_template, unsigned user_data_size)
             free(r_dev);
             return NULL; // NOTE: returns NULL on alloc failure.
         }
+        r_dev->decode_ctx_size = user_data_size;
     }
 
     return r_dev;
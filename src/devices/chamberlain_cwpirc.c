@@ -109,5 +109,8 @@ r_device const chamberlain_cwpirc = {
         .long_width  = 25,
         .reset_limit = 500,
         .decode_fn   = &chamberlain_cwpirc_decode,
+        .max_rows    = 1,
+        .min_bits    = 136,
+        .rows_reject = DECODE_ABORT_EARLY,
         .fields      = output_fields,
 };
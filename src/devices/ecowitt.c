@@ -119,5 +119,8 @@ r_device const ecowitt = {
         .reset_limit = 2000, // 31 ms packet distance (too far apart)
         .sync_width  = 0,
         .decode_fn   = &ecowitt_decode,
+        .max_rows    = 1,
+        .min_bits    = 52,
+        .bits_reject = DECODE_ABORT_EARLY, // no room for the preamble and message
         .fields      = output_fields,
 };
@@ -44,6 +44,9 @@ Format string:
 
 */
 
+// preamble/model/type and first flag bit
+static uint8_t const gasmate_ba1008_preamble[] = {0xf0};
+
 static int gasmate_ba1008_decode(r_device *decoder, bitbuffer_t *bitbuffer)
 {
     if (bitbuffer->num_rows != 1) {
@@ -107,5 +110,10 @@ r_device const gasmate_ba1008 = {
         .long_width  = 1668,
         .reset_limit = 2000,
         .decode_fn   = &gasmate_ba1008_decode,
+        .max_rows    = 1,
+        .min_bits    = 32,
+        .max_bits    = 32,
+        .preamble    = gasmate_ba1008_preamble,
+        .preamble_bits = 5,
         .fields      = output_fields,
 };
@@ -290,4 +290,5 @@ r_device const ikea_sparsnas = {
         .reset_limit = 3000,
         .decode_fn   = &ikea_sparsnas_decode,
         .fields      = output_fields,
+        .serial      = 1, // the sensor id found is kept for all messages
 };
@@ -147,5 +147,7 @@ r_device const inkbird_ith20r = {
         .long_width  = 100,  // Width of a '1' gap
         .reset_limit = 4000, // Maximum gap size before End Of Message [us]
         .decode_fn   = &inkbird_ith20r_callback,
+        .max_rows    = 1,
+        .min_bits    = 187,
         .fields      = output_fields,
 };
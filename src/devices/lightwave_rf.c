@@ -152,6 +152,9 @@ r_device const lightwave_rf = {
         .long_width  = 1250, //
         .reset_limit = 1500, // Gap between messages is unknown so let us get them individually
         .decode_fn   = &lightwave_rf_callback,
+        .max_rows    = 1,
+        .min_bits    = 71,
+        .max_bits    = 71,
         .disabled    = 1,
         .fields      = output_fields,
 };
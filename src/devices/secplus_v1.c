@@ -410,4 +410,5 @@ r_device const secplus_v1 = {
         .reset_limit = 80000,
         .decode_fn   = &secplus_v1_callback,
         .fields      = output_fields,
+        .serial      = 1, // the first half of a message is kept for the second
 };
@@ -0,0 +1,337 @@
+/** @file
+    DSP worker thread, runs the demodulation off the event loop.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+
+#include "dsp_worker.h"
+#include "sdr.h"
+#include "data.h"
+#include "logger.h"
+#include "fatal.h"
+#include "compat_pthread.h"
+#include "compat_atomic.h"
+
+// Only available if Threads are enabled.
+// The frame ring and the event queue are each single-producer/single-consumer:
+// head is only written by the producer, tail is only written by the consumer.
+// The mutex and condition are only used to sleep on an empty frame ring.
+// The state lock is held while a frame is processed, other threads take it to access the shared state.
+
+#ifdef THREADS
+
+typedef struct dsp_event {
+    data_t *data;
+    int level;
+} dsp_event_t;
+
+struct dsp_worker {
+    dsp_worker_process_fn process_fn;
+    dsp_worker_notify_fn notify_fn;
+    void *ctx;
+
+    unsigned slots;      ///< number of frame slots, a power of two
+    uint32_t slot_len;   ///< size in bytes of each frame slot
+    uint8_t *slot_buf;   ///< frame slot buffers
+    sdr_event_t *slot_ev; ///< frame slot events
+    unsigned head;       ///< frames pushed, written by the acquire thread
+    unsigned tail;       ///< frames processed, written by the worker thread
+
+    dsp_event_t events[DSP_WORKER_EVENTS];
+    unsigned ev_head;    ///< events emitted, written by the worker thread
+    unsigned ev_tail;    ///< events drained, written by the event loop
+
+    unsigned drops;
+    unsigned event_drops;
+    unsigned queue_max;
+    int stop;
+
+    pthread_t thread;
+    pthread_mutex_t lock;       ///< lock for the empty ring wait
+    pthread_cond_t cond;        ///< wait for frames
+    pthread_mutex_t state_lock; ///< lock for the state shared with the event loop
+};
+
+static THREAD_RETURN THREAD_CALL worker_thread(void *arg)
+{
+    dsp_worker_t *w = arg;
+
+    for (;;) {
+        unsigned tail = w->tail;
+        if (tail == compat_atomic_load_acq_u(&w->head)) {
+            pthread_mutex_lock(&w->lock);
+            while (tail == compat_atomic_load_acq_u(&w->head) && !compat_atomic_load_acq_u(&w->stop))
+                pthread_cond_wait(&w->cond, &w->lock);
+            pthread_mutex_unlock(&w->lock);
+            if (compat_atomic_load_acq_u(&w->stop))
+                break;
+        }
+
+        sdr_event_t *ev = &w->slot_ev[tail & (w->slots - 1)];
+        pthread_mutex_lock(&w->state_lock);
+        w->process_fn(ev, w->ctx);
+        pthread_mutex_unlock(&w->state_lock);
+        compat_atomic_store_rel_u(&w->tail, tail + 1);
+
+        if (w->notify_fn && w->ev_head != compat_atomic_load_acq_u(&w->ev_tail))
+            w->notify_fn(w->ctx);
+    }
+
+    return 0;
+}
+
+dsp_worker_t *dsp_worker_create(dsp_worker_process_fn process_fn, dsp_worker_notify_fn notify_fn, void *ctx, unsigned slots, uint32_t slot_len)
+{
+    dsp_worker_t *w = calloc(1, sizeof(*w));
+    if (!w) {
+        WARN_CALLOC("dsp_worker_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+
+    w->slots = 1;
+    while (w->slots < slots)
+        w->slots <<= 1;
+    w->slot_len   = slot_len;
+    w->process_fn = process_fn;
+    w->notify_fn  = notify_fn;
+    w->ctx        = ctx;
+
+    w->slot_buf = malloc((size_t)w->slots * slot_len);
+    if (!w->slot_buf) {
+        WARN_MALLOC("dsp_worker_create()");
+        free(w);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    w->slot_ev = calloc(w->slots, sizeof(*w->slot_ev));
+    if (!w->slot_ev) {
+        WARN_CALLOC("dsp_worker_create()");
+        free(w->slot_buf);
+        free(w);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+
+    pthread_mutex_init(&w->lock, NULL);
+    pthread_cond_init(&w->cond, NULL);
+    pthread_mutex_init(&w->state_lock, NULL);
+
+#ifndef _WIN32
+    // Block all signals from the worker thread
+    sigset_t sigset;
+    sigset_t oldset;
+    sigfillset(&sigset);
+    pthread_sigmask(SIG_SETMASK, &sigset, &oldset);
+#endif
+    int r = pthread_create(&w->thread, NULL, worker_thread, w);
+#ifndef _WIN32
+    pthread_sigmask(SIG_SETMASK, &oldset, NULL);
+#endif
+    if (r) {
+        print_logf(LOG_ERROR, __func__, "error in pthread_create, rc: %d", r);
+        pthread_mutex_destroy(&w->lock);
+        pthread_cond_destroy(&w->cond);
+        pthread_mutex_destroy(&w->state_lock);
+        free(w->slot_ev);
+        free(w->slot_buf);
+        free(w);
+        return NULL;
+    }
+
+    return w;
+}
+
+void dsp_worker_stop(dsp_worker_t *w)
+{
+    if (!w || compat_atomic_load_acq_u(&w->stop))
+        return;
+
+    pthread_mutex_lock(&w->lock);
+    compat_atomic_store_rel_u(&w->stop, 1);
+    pthread_mutex_unlock(&w->lock);
+    pthread_cond_signal(&w->cond);
+
+    pthread_join(w->thread, NULL);
+}
+
+void dsp_worker_free(dsp_worker_t *w)
+{
+    if (!w)
+        return;
+
+    dsp_worker_stop(w);
+
+    for (unsigned i = w->ev_tail; i != w->ev_head; ++i) {
+        data_free(w->events[i & (DSP_WORKER_EVENTS - 1)].data);
+    }
+
+    pthread_mutex_destroy(&w->lock);
+    pthread_cond_destroy(&w->cond);
+    pthread_mutex_destroy(&w->state_lock);
+    free(w->slot_ev);
+    free(w->slot_buf);
+    free(w);
+}
+
+int dsp_worker_push(dsp_worker_t *w, sdr_event_t const *ev)
+{
+    unsigned head  = w->head;
+    unsigned depth = head - compat_atomic_load_acq_u(&w->tail);
+    if (depth >= w->slots || ev->len < 0 || (uint32_t)ev->len > w->slot_len) {
+        compat_atomic_fetch_add_u(&w->drops, 1);
+        return -1;
+    }
+    if (depth + 1 > w->queue_max)
+        w->queue_max = depth + 1;
+
+    unsigned idx         = head & (w->slots - 1);
+    uint8_t *buf         = &w->slot_buf[(size_t)idx * w->slot_len];
+    w->slot_ev[idx]      = *ev;
+    w->slot_ev[idx].buf  = buf;
+    memcpy(buf, ev->buf, ev->len);
+
+    pthread_mutex_lock(&w->lock);
+    compat_atomic_store_rel_u(&w->head, head + 1);
+    pthread_mutex_unlock(&w->lock);
+    pthread_cond_signal(&w->cond);
+
+    return 0;
+}
+
+int dsp_worker_in_thread(dsp_worker_t *w)
+{
+    return pthread_equal(pthread_self(), w->thread);
+}
+
+void dsp_worker_lock(dsp_worker_t *w)
+{
+    if (w)
+        pthread_mutex_lock(&w->state_lock);
+}
+
+void dsp_worker_unlock(dsp_worker_t *w)
+{
+    if (w)
+        pthread_mutex_unlock(&w->state_lock);
+}
+
+void dsp_worker_emit(dsp_worker_t *w, data_t *data, int level)
+{
+    unsigned head = w->ev_head;
+    // never wait for a slow event loop, that would stall the demod
+    if (head - compat_atomic_load_acq_u(&w->ev_tail) >= DSP_WORKER_EVENTS) {
+        compat_atomic_fetch_add_u(&w->event_drops, 1);
+        data_free(data);
+        return;
+    }
+
+    w->events[head & (DSP_WORKER_EVENTS - 1)].data  = data;
+    w->events[head & (DSP_WORKER_EVENTS - 1)].level = level;
+    compat_atomic_store_rel_u(&w->ev_head, head + 1);
+}
+
+unsigned dsp_worker_drain(dsp_worker_t *w, dsp_worker_event_fn event_fn, void *ctx)
+{
+    unsigned tail = w->ev_tail;
+    unsigned head = compat_atomic_load_acq_u(&w->ev_head);
+    unsigned count = head - tail;
+
+    for (; tail != head; ++tail) {
+        dsp_event_t *ev = &w->events[tail & (DSP_WORKER_EVENTS - 1)];
+        event_fn(ctx, ev->data, ev->level);
+        compat_atomic_store_rel_u(&w->ev_tail, tail + 1);
+    }
+
+    return count;
+}
+
+void dsp_worker_get_stats(dsp_worker_t *w, dsp_worker_stats_t *stats)
+{
+    unsigned head = compat_atomic_load_acq_u(&w->head);
+    unsigned tail = compat_atomic_load_acq_u(&w->tail);
+    unsigned ev_head = compat_atomic_load_acq_u(&w->ev_head);
+    unsigned ev_tail = compat_atomic_load_acq_u(&w->ev_tail);
+
+    stats->frames         = head;
+    stats->drops          = compat_atomic_load_acq_u(&w->drops);
+    stats->queue_depth    = head - tail;
+    stats->queue_max      = w->queue_max;
+    stats->events         = ev_head;
+    stats->events_pending = ev_head - ev_tail;
+    stats->event_drops    = compat_atomic_load_acq_u(&w->event_drops);
+}
+
+#else
+
+dsp_worker_t *dsp_worker_create(dsp_worker_process_fn process_fn, dsp_worker_notify_fn notify_fn, void *ctx, unsigned slots, uint32_t slot_len)
+{
+    (void)process_fn;
+    (void)notify_fn;
+    (void)ctx;
+    (void)slots;
+    (void)slot_len;
+    return NULL;
+}
+
+void dsp_worker_stop(dsp_worker_t *w)
+{
+    (void)w;
+}
+
+void dsp_worker_free(dsp_worker_t *w)
+{
+    (void)w;
+}
+
+int dsp_worker_push(dsp_worker_t *w, struct sdr_event const *ev)
+{
+    (void)w;
+    (void)ev;
+    return -1;
+}
+
+int dsp_worker_in_thread(dsp_worker_t *w)
+{
+    (void)w;
+    return 0;
+}
+
+void dsp_worker_lock(dsp_worker_t *w)
+{
+    (void)w;
+}
+
+void dsp_worker_unlock(dsp_worker_t *w)
+{
+    (void)w;
+}
+
+void dsp_worker_emit(dsp_worker_t *w, data_t *data, int level)
+{
+    (void)w;
+    (void)level;
+    data_free(data);
+}
+
+unsigned dsp_worker_drain(dsp_worker_t *w, dsp_worker_event_fn event_fn, void *ctx)
+{
+    (void)w;
+    (void)event_fn;
+    (void)ctx;
+    return 0;
+}
+
+void dsp_worker_get_stats(dsp_worker_t *w, dsp_worker_stats_t *stats)
+{
+    (void)w;
+    memset(stats, 0, sizeof(*stats));
+}
+
+#endif
@@ -0,0 +1,379 @@
+/** @file
+    Parallel decoding of input files with output in file order.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "file_batch.h"
+#include "rtl_433.h"
+#include "r_api.h"
+#include "pulse_data.h"
+#include "fileformat.h"
+#include "list.h"
+#include "thread_pool.h"
+#include "logger.h"
+#include "fatal.h"
+#include "compat_pthread.h"
+#include "compat_atomic.h"
+
+/// An input file, or a chunk of an input file, of the batch.
+typedef struct batch_file {
+    char const *in_filename;
+    file_chunk_t *chunk;  ///< the part of the file to decode, NULL for the whole file
+    unsigned chunk_idx;   ///< index of the chunk in the file
+    unsigned chunk_count; ///< number of chunks of the file, 0 for a whole file
+    list_t held_events;   ///< events of the file, output once all previous files are output
+    int state;            ///< 0: pending, 1: decoded, -1: failed, guarded by the batch lock
+} batch_file_t;
+
+/// Warm-up differences at the chunk boundaries of a file.
+typedef struct batch_warmup {
+    unsigned packages; ///< packages near the boundaries
+    unsigned differ;   ///< packages not detected the same as by a continuous run
+    float noise_diff;  ///< largest difference of the noise estimate
+} batch_warmup_t;
+
+typedef struct file_batch {
+    r_cfg_t *cfg;
+    file_batch_decode_fn decode_fn;
+    void *ctx;
+    r_cfg_t **workers;
+    batch_file_t *files;
+    unsigned num_files;
+    unsigned next_file;   ///< atomic, the next file to claim
+    unsigned stop;        ///< atomic, set once a file failed
+    unsigned next_output; ///< the next file to output, guarded by the batch lock
+    batch_warmup_t warmup; ///< of the file being output, guarded by the batch lock
+#ifdef THREADS
+    pthread_mutex_t lock;
+#endif
+} file_batch_t;
+
+static void batch_lock(file_batch_t *batch)
+{
+#ifdef THREADS
+    pthread_mutex_lock(&batch->lock);
+#else
+    (void)batch;
+#endif
+}
+
+static void batch_unlock(file_batch_t *batch)
+{
+#ifdef THREADS
+    pthread_mutex_unlock(&batch->lock);
+#else
+    (void)batch;
+#endif
+}
+
+/* chunks */
+
+static void boundary_push(chunk_boundary_t *boundary, pulse_data_t const *package)
+{
+    if (boundary->count < FILE_CHUNK_PACKAGES) {
+        boundary->offset[boundary->count]     = package->offset;
+        boundary->num_pulses[boundary->count] = package->num_pulses;
+    }
+    boundary->count++;
+}
+
+int file_chunk_package(file_chunk_t *chunk, pulse_data_t const *package)
+{
+    uint64_t offset = package->offset;
+
+    if (chunk->own_start && offset >= chunk->own_start && offset < chunk->own_start + chunk->overlap)
+        boundary_push(&chunk->head, package);
+    if (chunk->own_end && offset >= chunk->own_end && offset < chunk->own_end + chunk->overlap)
+        boundary_push(&chunk->tail, package);
+
+    return offset >= chunk->own_start && (!chunk->own_end || offset < chunk->own_end);
+}
+
+void file_chunk_frame(file_chunk_t *chunk, uint64_t pos, float noise_level)
+{
+    if (chunk->own_start && pos == chunk->own_start) {
+        chunk->head.has_noise   = 1;
+        chunk->head.noise_level = noise_level;
+    }
+    if (chunk->own_end && pos == chunk->own_end) {
+        chunk->tail.has_noise   = 1;
+        chunk->tail.noise_level = noise_level;
+    }
+}
+
+/// Compare the packages after a boundary, seen by the chunk before it in a continuous run and by the chunk after it after the warm-up.
+static void boundary_compare(batch_warmup_t *warmup, chunk_boundary_t const *cont, chunk_boundary_t const *warm)
+{
+    unsigned n_cont = cont->count < FILE_CHUNK_PACKAGES ? cont->count : FILE_CHUNK_PACKAGES;
+    unsigned n_warm = warm->count < FILE_CHUNK_PACKAGES ? warm->count : FILE_CHUNK_PACKAGES;
+    unsigned found  = 0; // same offset
+    unsigned same   = 0; // same offset and length
+    for (unsigned i = 0; i < n_warm; ++i) {
+        for (unsigned j = 0; j < n_cont; ++j) {
+            if (warm->offset[i] == cont->offset[j]) {
+                found += 1;
+                same += warm->num_pulses[i] == cont->num_pulses[j];
+                break;
+            }
+        }
+    }
+    unsigned packages = n_cont + n_warm - found;
+    warmup->packages += packages;
+    warmup->differ += packages - same;
+
+    if (cont->has_noise && warm->has_noise) {
+        float noise_diff = fabsf(cont->noise_level - warm->noise_level);
+        if (noise_diff > warmup->noise_diff)
+            warmup->noise_diff = noise_diff;
+    }
+}
+
+/// Get the size of a regular file, -1 otherwise.
+static int64_t batch_file_size(char const *path)
+{
+#ifdef _WIN32
+    struct _stat64 st;
+    if (_stat64(path, &st) != 0 || (st.st_mode & _S_IFMT) != _S_IFREG)
+        return -1;
+#else
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISREG(st.st_mode))
+        return -1;
+#endif
+    return st.st_size;
+}
+
+/// Split a raw IQ input file into chunks, returns the number of chunks, 0 to decode the whole file.
+static unsigned batch_plan_chunks(r_cfg_t *cfg, char const *in_filename, unsigned chunks, file_chunk_t **out)
+{
+    if (chunks < 2)
+        return 0;
+
+    file_info_t info = {0};
+    file_info_parse_filename(&info, in_filename);
+    unsigned sample_size;
+    if (info.format == CU8_IQ || info.format == CS8_IQ)
+        sample_size = 2;
+    else if (info.format == CS16_IQ)
+        sample_size = 4;
+    else
+        return 0; // other formats are not read as plain blocks of samples
+    if (!info.path || !strcmp(info.path, "-") || info.compression)
+        return 0; // needs a seekable file
+    int64_t size = batch_file_size(info.path);
+    if (size <= 0)
+        return 0;
+
+    // chunks start on a block, the same blocks as in a continuous run
+    uint64_t sample_rate = info.sample_rate ? info.sample_rate : cfg->samp_rate;
+    uint64_t block       = DEFAULT_BUF_LENGTH / sample_size;
+    uint64_t overlap     = sample_rate * (PD_MAX_GAP_MS + FILE_CHUNK_PACKAGE_MS) / 1000;
+    overlap              = (overlap + block - 1) / block * block;
+    uint64_t samples     = (uint64_t)size / sample_size;
+    uint64_t min_len     = FILE_CHUNK_MIN_LENGTH / sample_size;
+    if (min_len < 8 * overlap)
+        min_len = 8 * overlap;
+    uint64_t len = (samples + chunks - 1) / chunks;
+    if (len < min_len)
+        len = min_len;
+    len = (len + block - 1) / block * block;
+    unsigned count = (unsigned)((samples + len - 1) / len);
+    if (count < 2)
+        return 0;
+
+    file_chunk_t *chunk = calloc(count, sizeof(*chunk));
+    if (!chunk) {
+        WARN_CALLOC("batch_plan_chunks()");
+        return 0; // NOTE: decodes the whole file on alloc failure.
+    }
+    for (unsigned i = 0; i < count; ++i) {
+        chunk[i].own_start  = i * len;
+        chunk[i].own_end    = i + 1 < count ? (i + 1) * len : 0;
+        // a lead-in to warm up, and a tail to end the last package and compare with the next chunk
+        chunk[i].read_start = i ? chunk[i].own_start - overlap : 0;
+        chunk[i].read_end   = chunk[i].own_end ? chunk[i].own_end + 2 * overlap : 0;
+        chunk[i].overlap    = overlap;
+    }
+    *out = chunk;
+    return count;
+}
+
+/// Log the warm-up differences of a chunked file, call with the batch lock held.
+static void batch_warmup_log(file_batch_t *batch, batch_file_t const *file)
+{
+    batch_warmup_t *warmup = &batch->warmup;
+    if (warmup->differ) {
+        print_logf(LOG_WARNING, "Input", "Decoded \"%s\" in %u chunks, %u of %u packages near chunk boundaries differ from a continuous run, the noise estimate differs by up to %.1f dB",
+                file->in_filename, file->chunk_count, warmup->differ, warmup->packages, warmup->noise_diff);
+    }
+    else if (batch->cfg->verbosity >= LOG_NOTICE) {
+        print_logf(LOG_NOTICE, "Input", "Decoded \"%s\" in %u chunks, all %u packages near chunk boundaries match a continuous run, the noise estimate differs by up to %.1f dB",
+                file->in_filename, file->chunk_count, warmup->packages, warmup->noise_diff);
+    }
+}
+
+/// Output all files that are done and next in order, call with the batch lock held.
+static void batch_output(file_batch_t *batch)
+{
+    while (batch->next_output < batch->num_files) {
+        batch_file_t *file = &batch->files[batch->next_output];
+        if (!file->state)
+            break;
+        r_output_held_events(batch->cfg, &file->held_events, file->in_filename);
+        if (file->chunk_count && file->state > 0) {
+            if (file->chunk_idx == 0)
+                batch->warmup = (batch_warmup_t){0};
+            else
+                boundary_compare(&batch->warmup, &file[-1].chunk->tail, &file->chunk->head);
+            if (file->chunk_idx + 1 == file->chunk_count)
+                batch_warmup_log(batch, file);
+        }
+        batch->next_output++;
+        if (file->state < 0) {
+            // like the sequential run, don't output anything past a failed file
+            compat_atomic_store_rel_u(&batch->stop, 1);
+            batch->next_output = batch->num_files;
+        }
+    }
+}
+
+static void batch_worker_run(void *ctx, unsigned task)
+{
+    file_batch_t *batch = ctx;
+    r_cfg_t *worker     = batch->workers[task];
+
+    while (!compat_atomic_load_acq_u(&batch->stop)) {
+        unsigned idx = compat_atomic_fetch_add_u(&batch->next_file, 1);
+        if (idx >= batch->num_files)
+            break;
+        batch_file_t *file = &batch->files[idx];
+
+        r_reset_batch_protocols(worker);
+        worker->held_events = &file->held_events;
+        r_redirect_batch_logging(worker);
+        int ret = batch->decode_fn(worker, file->in_filename, file->chunk, batch->ctx);
+        r_redirect_batch_logging(NULL);
+        worker->held_events = NULL;
+
+        batch_lock(batch);
+        file->state = ret ? -1 : 1;
+        batch_output(batch);
+        batch_unlock(batch);
+    }
+}
+
+static void batch_free_files(file_batch_t *batch, file_chunk_t **input_chunks, unsigned num_inputs)
+{
+    for (unsigned i = 0; i < num_inputs; ++i) {
+        free(input_chunks[i]);
+    }
+    free(input_chunks);
+    free(batch->files);
+}
+
+int file_batch_run(r_cfg_t *cfg, unsigned threads, unsigned chunks, file_batch_decode_fn decode_fn, void *ctx)
+{
+    file_batch_t batch = {0};
+    batch.cfg       = cfg;
+    batch.decode_fn = decode_fn;
+    batch.ctx       = ctx;
+
+    unsigned num_inputs = (unsigned)cfg->in_files.len;
+    file_chunk_t **input_chunks = calloc(num_inputs, sizeof(*input_chunks));
+    if (!input_chunks) {
+        WARN_CALLOC("file_batch_run()");
+        return -1; // NOTE: returns -1 on alloc failure.
+    }
+    unsigned *input_chunk_count = calloc(num_inputs, sizeof(*input_chunk_count));
+    if (!input_chunk_count) {
+        WARN_CALLOC("file_batch_run()");
+        free(input_chunks);
+        return -1; // NOTE: returns -1 on alloc failure.
+    }
+    for (unsigned i = 0; i < num_inputs; ++i) {
+        input_chunk_count[i] = batch_plan_chunks(cfg, cfg->in_files.elems[i], chunks, &input_chunks[i]);
+        batch.num_files += input_chunk_count[i] ? input_chunk_count[i] : 1;
+    }
+
+    batch.files = calloc(batch.num_files, sizeof(*batch.files));
+    if (!batch.files) {
+        WARN_CALLOC("file_batch_run()");
+        batch_free_files(&batch, input_chunks, num_inputs);
+        free(input_chunk_count);
+        return -1; // NOTE: returns -1 on alloc failure.
+    }
+    batch_file_t *file = batch.files;
+    for (unsigned i = 0; i < num_inputs; ++i) {
+        unsigned count = input_chunk_count[i] ? input_chunk_count[i] : 1;
+        for (unsigned j = 0; j < count; ++j) {
+            file->in_filename = cfg->in_files.elems[i];
+            file->chunk       = input_chunk_count[i] ? &input_chunks[i][j] : NULL;
+            file->chunk_idx   = j;
+            file->chunk_count = input_chunk_count[i];
+            file++;
+        }
+    }
+    free(input_chunk_count);
+
+    if (threads > batch.num_files)
+        threads = batch.num_files;
+    if (threads < 1)
+        threads = 1;
+
+    batch.workers = calloc(threads, sizeof(*batch.workers));
+    if (!batch.workers) {
+        WARN_CALLOC("file_batch_run()");
+        batch_free_files(&batch, input_chunks, num_inputs);
+        return -1; // NOTE: returns -1 on alloc failure.
+    }
+    for (unsigned i = 0; i < threads; ++i) {
+        batch.workers[i] = r_create_batch_cfg(cfg);
+        if (!batch.workers[i]) {
+            for (unsigned j = 0; j < i; ++j) {
+                r_free_batch_cfg(batch.workers[j]);
+            }
+            free(batch.workers);
+            batch_free_files(&batch, input_chunks, num_inputs);
+            return -1;
+        }
+    }
+
+    // without a pool the workers run one after the other, the first one decodes all files
+    thread_pool_t *pool = thread_pool_create(threads);
+    if (cfg->verbosity >= LOG_INFO) {
+        print_logf(LOG_INFO, "Input", "Decoding %u files in %u parts on %u threads", num_inputs, batch.num_files, thread_pool_size(pool));
+    }
+
+#ifdef THREADS
+    pthread_mutex_init(&batch.lock, NULL);
+#endif
+    thread_pool_run(pool, threads, batch_worker_run, &batch);
+#ifdef THREADS
+    pthread_mutex_destroy(&batch.lock);
+#endif
+    thread_pool_free(pool);
+
+    // files decoded past a failed file are never output
+    for (unsigned i = 0; i < batch.num_files; ++i) {
+        r_free_held_events(&batch.files[i].held_events);
+    }
+    for (unsigned i = 0; i < threads; ++i) {
+        r_free_batch_cfg(batch.workers[i]);
+    }
+    free(batch.workers);
+    batch_free_files(&batch, input_chunks, num_inputs);
+
+    return 0;
+}
@@ -50,7 +50,8 @@ void file_info_check_read(file_info_t *info)
             && info->format != CS16_IQ
             && info->format != CF32_IQ
             && info->format != S16_AM
-            && info->format != PULSE_OOK) {
+            && info->format != PULSE_OOK
+            && info->format != PULSE_BIN) {
         fprintf(stderr, "File type not supported as input (%s).\n", info->spec);
         exit(1);
     }
@@ -69,7 +70,8 @@ void file_info_check_write(file_info_t *info)
             && info->format != F32_I
             && info->format != F32_Q
             && info->format != U8_LOGIC
-            && info->format != VCD_LOGIC) {
+            && info->format != VCD_LOGIC
+            && info->format != PULSE_BIN) {
         fprintf(stderr, "File type not supported as output (%s).\n", info->spec);
         exit(1);
     }
@@ -90,6 +92,7 @@ char const *file_info_string(file_info_t *info)
     case VCD_LOGIC: return "VCD logic (text)";
     case U8_LOGIC:  return "U8 logic (1ch uint8)";
     case PULSE_OOK: return "OOK pulse data (text)";
+    case PULSE_BIN: return "Pulse data (binary)";
     default:        return "Unknown";
     }
 }
@@ -120,6 +123,7 @@ static uint32_t file_type_guess_auto_format(uint32_t type)
     else if (type == F_U8) return U8_LOGIC;
     else if (type == F_VCD) return VCD_LOGIC;
     else if (type == F_OOK) return PULSE_OOK;
+    else if (type == F_PULSE) return PULSE_BIN;
     else if (type == F_CS16) return CS16_IQ;
     else if (type == F_CF32) return CF32_IQ;
     else return type;
@@ -203,6 +207,11 @@ static void file_type(char const *filename, file_info_t *info)
             else if (len == 4 && !strncasecmp("cf32", t, 4)) file_type_set_format(&info->format, F_CF32);
             else if (len == 5 && !strncasecmp("cfile", t, 5)) file_type_set_format(&info->format, F_CF32); // compat
             else if (len == 5 && !strncasecmp("logic", t, 5)) file_type_set_content(&info->format, F_LOGIC);
+            else if (len == 5 && !strncasecmp("pulse", t, 5)) file_type_set_content(&info->format, F_PULSE);
+            else if (len == 2 && !strncasecmp("gz", t, 2)) info->compression = FILE_COMPRESS_GZIP;
+            else if (len == 4 && !strncasecmp("gzip", t, 4)) info->compression = FILE_COMPRESS_GZIP;
+            else if (len == 3 && !strncasecmp("zst", t, 3)) info->compression = FILE_COMPRESS_ZSTD;
+            else if (len == 4 && !strncasecmp("zstd", t, 4)) info->compression = FILE_COMPRESS_ZSTD;
             else if (len == 3 && !strncasecmp("complex16u", t, 10)) file_type_set_format(&info->format, F_CU8); // compat
             else if (len == 3 && !strncasecmp("complex16s", t, 10)) file_type_set_format(&info->format, F_CS8); // compat
             else if (len == 4 && !strncasecmp("complex", t, 7)) file_type_set_format(&info->format, F_CF32); // compat
@@ -237,7 +246,9 @@ Parse "[A-Za-z][0-9A-Za-z]+" as format or content specifier:
 2ch formats: "cu8", "cs8", "cs16", "cs32", "cf32"
 1ch formats: "u8", "s8", "s16", "u16", "s32", "u32", "f32"
 text formats: "vcd", "ook"
+binary pulse format: "pulse"
 content types: "iq", "i", "q", "am", "fm", "logic"
+compression: "gz", "zst"
 
 Parses left to right, with the exception of a prefix up to the last colon ":"
 This prefix is the forced override, parsed last and removed from the filename.
@@ -289,6 +300,17 @@ static void assert_file_type(int check, char const *spec)
     }
 }
 
+static void assert_compression(unsigned check, char const *spec)
+{
+    file_info_t info = {0};
+    file_info_parse_filename(&info, spec);
+    if (check != info.compression) {
+        fprintf(stderr, "\nTEST failed: compression of \"%s\" = %u == %u\n", spec, info.compression, check);
+    } else {
+        fprintf(stderr, ".");
+    }
+}
+
 static void assert_str_equal(char const *a, char const *b)
 {
     if (a != b && (!a || !b || strcmp(a, b))) {
@@ -351,6 +373,18 @@ int main(void)
     assert_file_type(S16_FM, ".s16_fm");
     assert_file_type(S16_FM, ".s16,fm");
 
+    assert_file_type(PULSE_OOK, ".ook");
+    assert_file_type(PULSE_BIN, ".pulse");
+    assert_file_type(PULSE_BIN, "pulse:path/file.bin");
+
+    assert_file_type(CU8_IQ, "file.cu8.zst");
+    assert_file_type(CS16_IQ, "file_250k.cs16.gz");
+    assert_compression(FILE_COMPRESS_NONE, "file.cu8");
+    assert_compression(FILE_COMPRESS_ZSTD, "file.cu8.zst");
+    assert_compression(FILE_COMPRESS_ZSTD, "zstd:cu8:-");
+    assert_compression(FILE_COMPRESS_GZIP, "file_250k.cs16.gz");
+    assert_compression(FILE_COMPRESS_GZIP, "gzip:file.bin");
+
     fprintf(stderr, "\nDone!\n");
 }
 #endif /* _TEST */
@@ -99,6 +99,7 @@ or `(echo "GET /stream HTTP/1.0\n"; sleep 600) | socat - tcp:127.0.0.1:8433`
 #include "r_api.h"
 #include "r_device.h" // used for protocols
 #include "r_private.h" // used for protocols
+#include "dsp_worker.h" // the worker shares the stats
 #include "r_util.h"
 #include "optparse.h"
 #include "abuf.h"
@@ -515,7 +516,7 @@ static int jsonrpc_parse(rpc_t *rpc, struct mg_str const *json)
     return 0;
 }
 
-static void rpc_exec(rpc_t *rpc, r_cfg_t *cfg)
+static void rpc_dispatch(rpc_t *rpc, r_cfg_t *cfg)
 {
     if (!rpc || !rpc->method || !*rpc->method) {
         rpc->response(rpc, -1, "Method invalid", 0);
@@ -671,6 +672,14 @@ static void rpc_exec(rpc_t *rpc, r_cfg_t *cfg)
     }
 }
 
+/// Run a command, the DSP worker shares the stats and frequencies and is held meanwhile.
+static void rpc_exec(rpc_t *rpc, r_cfg_t *cfg)
+{
+    dsp_worker_lock(cfg->dsp_worker);
+    rpc_dispatch(rpc, cfg);
+    dsp_worker_unlock(cfg->dsp_worker);
+}
+
 // http server
 
 #define KEEP_ALIVE 60 /* seconds */
@@ -749,6 +758,7 @@ static void handle_openmetrics(struct mg_connection *nc, struct http_message *hm
     time(&now);
 
     char buf[2000];
+    dsp_worker_lock(cfg->dsp_worker); // the frame counters are written by the DSP worker
     int len = snprintf(buf, sizeof(buf),
             "# TYPE uptime_seconds counter\n"
             "# UNIT uptime_seconds seconds\n"
@@ -794,6 +804,7 @@ static void handle_openmetrics(struct mg_connection *nc, struct http_message *hm
             cfg->total_frames_ook,             // input_ook_frames_total,
             cfg->total_frames_fsk,             // input_fsk_frames_total,
             cfg->total_frames_events);         // input_event_frames_total,
+    dsp_worker_unlock(cfg->dsp_worker);
 
     mg_printf(nc,
             "HTTP/1.1 200 OK\r\n"
@@ -1276,31 +1287,12 @@ static void R_API_CALLCONV print_http_data(data_output_t *output, data_t *data,
     UNUSED(format);
     data_output_http_t *http = (data_output_http_t *)output;
 
-    // collect well-known top level keys
-    data_t *data_model = NULL;
-    for (data_t *d = data; d; d = d->next) {
-        if (!strcmp(d->key, "model"))
-            data_model = d;
-    }
-
-    if (data_model) {
-        // "events"
-        char buf[2048]; // we expect the biggest strings to be around 500 bytes.
-        size_t len = data_print_jsons(data, buf, sizeof(buf));
-        http_broadcast_send(http->server, buf, len);
-    }
-    else {
-        // "states"
-        size_t buf_size = 20000; // state message need a large buffer
-        char *buf       = malloc(buf_size);
-        if (!buf) {
-            WARN_MALLOC("print_http_data()");
-            return; // NOTE: skip output on alloc failure.
-        }
-        size_t len = data_print_jsons(data, buf, buf_size);
-        http_broadcast_send(http->server, buf, len);
-        free(buf);
-    }
+    // "events" and "states" alike, the rendering is shared with the other outputs
+    size_t len;
+    char const *buf = data_jsons(data, &len);
+    if (!buf)
+        return; // NOTE: skip output on alloc failure.
+    http_broadcast_send(http->server, buf, len);
 }
 
 static void R_API_CALLCONV data_output_http_free(data_output_t *output)
@@ -38,6 +38,21 @@ int tls_param(tls_opts_t *tls_opts, char const *key, char const *val)
     return 0;
 }
 
+int spool_param(spool_opts_t *spool_opts, char const *key, char const *val)
+{
+    if (!spool_opts || !key || !*key)
+        return 1;
+    else if (!strcasecmp(key, "spool"))
+        spool_opts->spool_dir = val;
+    else if (!strcasecmp(key, "spool_size"))
+        spool_opts->spool_size = atouint32_metric(val, "spool_size= ");
+    else if (!strcasecmp(key, "spool_rate"))
+        spool_opts->spool_rate = atouint32_metric(val, "spool_rate= ");
+    else
+        return 1;
+    return 0;
+}
+
 int atobv(char const *arg, int def)
 {
     if (!arg)
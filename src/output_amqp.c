@@ -0,0 +1,821 @@
+/** @file
+    AMQP 0-9-1 output for rtl_433 events, e.g. to RabbitMQ.
+
+    Copyright (C) 2026 rtl_433 contributors
+    based on output_mqtt.c
+    Copyright (C) 2019 Christian Zuckschwerdt
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+// note: our unit header includes unistd.h for gethostname() via data.h
+#include "output_amqp.h"
+#include "output_mqtt.h" // for expand_topic()
+#include "optparse.h"
+#include "list.h"
+#include "logger.h"
+#include "fatal.h"
+#include "r_util.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "mongoose.h"
+
+/* AMQP 0-9-1 protocol */
+
+#define AMQP_FRAME_METHOD    1
+#define AMQP_FRAME_HEADER    2
+#define AMQP_FRAME_BODY      3
+#define AMQP_FRAME_HEARTBEAT 8
+#define AMQP_FRAME_END       0xce
+#define AMQP_FRAME_OVERHEAD  8      ///< frame header and frame end
+#define AMQP_FRAME_MAX       131072 ///< the largest frame we accept and send
+
+#define AMQP_METHOD(class_id, method_id) ((uint32_t)(class_id) << 16 | (method_id))
+
+#define AMQP_CONNECTION_START    AMQP_METHOD(10, 10)
+#define AMQP_CONNECTION_START_OK AMQP_METHOD(10, 11)
+#define AMQP_CONNECTION_TUNE     AMQP_METHOD(10, 30)
+#define AMQP_CONNECTION_TUNE_OK  AMQP_METHOD(10, 31)
+#define AMQP_CONNECTION_OPEN     AMQP_METHOD(10, 40)
+#define AMQP_CONNECTION_OPEN_OK  AMQP_METHOD(10, 41)
+#define AMQP_CONNECTION_CLOSE    AMQP_METHOD(10, 50)
+#define AMQP_CONNECTION_CLOSE_OK AMQP_METHOD(10, 51)
+#define AMQP_CHANNEL_OPEN        AMQP_METHOD(20, 10)
+#define AMQP_CHANNEL_OPEN_OK     AMQP_METHOD(20, 11)
+#define AMQP_CHANNEL_CLOSE       AMQP_METHOD(20, 40)
+#define AMQP_CHANNEL_CLOSE_OK    AMQP_METHOD(20, 41)
+#define AMQP_BASIC_PUBLISH       AMQP_METHOD(60, 40)
+#define AMQP_BASIC_ACK           AMQP_METHOD(60, 80)
+#define AMQP_BASIC_NACK          AMQP_METHOD(60, 120)
+#define AMQP_CONFIRM_SELECT      AMQP_METHOD(85, 10)
+#define AMQP_CONFIRM_SELECT_OK   AMQP_METHOD(85, 11)
+
+#define AMQP_CLASS_BASIC   60
+#define AMQP_CHANNEL       1 ///< the one channel we publish on
+#define AMQP_CONTENT_TYPE  0x8000 ///< basic properties flag
+#define AMQP_DELIVERY_MODE 0x1000 ///< basic properties flag
+
+static char const amqp_protocol_header[8] = {'A', 'M', 'Q', 'P', 0, 0, 9, 1};
+
+static void put_u8(struct mbuf *buf, uint8_t val)
+{
+    mbuf_append(buf, &val, 1);
+}
+
+static void put_u16(struct mbuf *buf, uint16_t val)
+{
+    uint8_t b[2] = {val >> 8, val & 0xff};
+    mbuf_append(buf, b, sizeof(b));
+}
+
+static void put_u32(struct mbuf *buf, uint32_t val)
+{
+    uint8_t b[4] = {val >> 24, (val >> 16) & 0xff, (val >> 8) & 0xff, val & 0xff};
+    mbuf_append(buf, b, sizeof(b));
+}
+
+static void put_u64(struct mbuf *buf, uint64_t val)
+{
+    put_u32(buf, (uint32_t)(val >> 32));
+    put_u32(buf, (uint32_t)val);
+}
+
+/// Append a short string, truncated to 255 chars.
+static void put_shortstr(struct mbuf *buf, char const *str)
+{
+    size_t len = strlen(str);
+    if (len > 255)
+        len = 255;
+    put_u8(buf, (uint8_t)len);
+    mbuf_append(buf, str, len);
+}
+
+static void put_longstr(struct mbuf *buf, char const *str, size_t len)
+{
+    put_u32(buf, (uint32_t)len);
+    mbuf_append(buf, str, len);
+}
+
+/// Start a frame, returns the position of the size to fill in with frame_end().
+static size_t frame_start(struct mbuf *buf, uint8_t type, uint16_t channel)
+{
+    put_u8(buf, type);
+    put_u16(buf, channel);
+    size_t size_pos = buf->len;
+    put_u32(buf, 0);
+    return size_pos;
+}
+
+static void frame_end(struct mbuf *buf, size_t size_pos)
+{
+    uint32_t size = (uint32_t)(buf->len - size_pos - 4);
+    uint8_t *p    = (uint8_t *)buf->buf + size_pos;
+    p[0]          = size >> 24;
+    p[1]          = (size >> 16) & 0xff;
+    p[2]          = (size >> 8) & 0xff;
+    p[3]          = size & 0xff;
+    put_u8(buf, AMQP_FRAME_END);
+}
+
+static size_t method_start(struct mbuf *buf, uint16_t channel, uint32_t method)
+{
+    size_t size_pos = frame_start(buf, AMQP_FRAME_METHOD, channel);
+    put_u32(buf, method);
+    return size_pos;
+}
+
+/// Bounds checked reader for received frames, reads past the end return zeros.
+typedef struct amqp_reader {
+    uint8_t const *p;
+    size_t left;
+} amqp_reader_t;
+
+static uint32_t get_uint(amqp_reader_t *r, unsigned bytes)
+{
+    uint32_t val = 0;
+    for (unsigned i = 0; i < bytes; ++i) {
+        val <<= 8;
+        if (r->left) {
+            val |= *r->p++;
+            r->left--;
+        }
+    }
+    return val;
+}
+
+static uint64_t get_u64(amqp_reader_t *r)
+{
+    uint64_t val = get_uint(r, 4);
+    return val << 32 | get_uint(r, 4);
+}
+
+/// Read a short string, returns the length and sets @p str.
+static unsigned get_shortstr(amqp_reader_t *r, char const **str)
+{
+    unsigned len = get_uint(r, 1);
+    if (len > r->left)
+        len = (unsigned)r->left;
+    *str = (char const *)r->p;
+    r->p += len;
+    r->left -= len;
+    return len;
+}
+
+/* AMQP client abstraction */
+
+/// A queued message, the routing key and body follow.
+typedef struct amqp_message {
+    uint64_t delivery_tag; ///< the publish sequence number on the current channel, 0 if not yet published
+    char const *routing_key;
+    size_t body_len;
+    char body[];
+} amqp_message_t;
+
+typedef struct amqp_client {
+    struct mg_connect_opts connect_opts;
+    struct mg_connection *conn;
+    struct mg_connection *timer;
+    int reconnect_delay; ///< kept until a message is confirmed again
+    int prev_status;
+    unsigned heartbeat; ///< the heartbeat interval in seconds tuned with the broker, 0 for none
+    double last_recv;   ///< time of the last frame from the broker
+    int ready; ///< the channel is open and in confirm mode
+    char address[253 + 6 + 1]; // dns max + port
+    char const *user;
+    char const *pass;
+    char const *vhost;
+    char const *exchange;
+    int persistent;
+    unsigned window;    ///< maximum number of unconfirmed messages
+    unsigned queue_max; ///< maximum number of queued messages
+    uint32_t frame_max;
+    list_t queue;       ///< messages in order, the first `sent` are published and unconfirmed
+    unsigned sent;
+    uint64_t next_tag;
+    unsigned dropped; ///< messages dropped since the last report
+    struct mbuf out;  ///< frames for the next write
+} amqp_client_t;
+
+static void amqp_client_send(amqp_client_t *ctx)
+{
+    if (ctx->conn && ctx->out.len)
+        mg_send(ctx->conn, ctx->out.buf, (int)ctx->out.len);
+    mbuf_clear(&ctx->out);
+}
+
+static void amqp_client_publish_frames(amqp_client_t *ctx, amqp_message_t *msg)
+{
+    struct mbuf *out = &ctx->out;
+
+    size_t pos = method_start(out, AMQP_CHANNEL, AMQP_BASIC_PUBLISH);
+    put_u16(out, 0); // reserved
+    put_shortstr(out, ctx->exchange);
+    put_shortstr(out, msg->routing_key);
+    put_u8(out, 0); // not mandatory, not immediate
+    frame_end(out, pos);
+
+    pos = frame_start(out, AMQP_FRAME_HEADER, AMQP_CHANNEL);
+    put_u16(out, AMQP_CLASS_BASIC);
+    put_u16(out, 0); // weight
+    put_u64(out, msg->body_len);
+    put_u16(out, AMQP_CONTENT_TYPE | AMQP_DELIVERY_MODE);
+    put_shortstr(out, "application/json");
+    put_u8(out, ctx->persistent ? 2 : 1);
+    frame_end(out, pos);
+
+    size_t chunk_max = ctx->frame_max - AMQP_FRAME_OVERHEAD;
+    for (size_t off = 0; off < msg->body_len; off += chunk_max) {
+        size_t chunk = msg->body_len - off < chunk_max ? msg->body_len - off : chunk_max;
+        pos = frame_start(out, AMQP_FRAME_BODY, AMQP_CHANNEL);
+        mbuf_append(out, msg->body + off, chunk);
+        frame_end(out, pos);
+    }
+}
+
+/// Publish queued messages up to the window of unconfirmed messages, all in one write.
+static void amqp_client_flush(amqp_client_t *ctx)
+{
+    if (!ctx->ready)
+        return;
+
+    while (ctx->sent < ctx->queue.len && ctx->sent < ctx->window) {
+        amqp_message_t *msg = ctx->queue.elems[ctx->sent];
+        msg->delivery_tag = ++ctx->next_tag;
+        amqp_client_publish_frames(ctx, msg);
+        ctx->sent++;
+    }
+    amqp_client_send(ctx);
+}
+
+/// Remove confirmed messages, returns the number of messages removed.
+static unsigned amqp_client_confirm(amqp_client_t *ctx, uint64_t delivery_tag, int multiple)
+{
+    unsigned count = 0;
+    for (unsigned i = 0; i < ctx->sent;) {
+        amqp_message_t *msg = ctx->queue.elems[i];
+        if (msg->delivery_tag == delivery_tag || (multiple && msg->delivery_tag < delivery_tag)) {
+            list_remove(&ctx->queue, i, free);
+            ctx->sent--;
+            count++;
+        }
+        else {
+            ++i;
+        }
+    }
+    return count;
+}
+
+/// Forget the channel state, unconfirmed messages will be published again.
+static void amqp_client_reset(amqp_client_t *ctx)
+{
+    for (unsigned i = 0; i < ctx->sent; ++i) {
+        amqp_message_t *msg = ctx->queue.elems[i];
+        msg->delivery_tag   = 0;
+    }
+    ctx->ready    = 0;
+    ctx->sent     = 0;
+    ctx->next_tag = 0;
+    mbuf_clear(&ctx->out);
+}
+
+static void amqp_client_method(amqp_client_t *ctx, struct mg_connection *nc, uint16_t channel, amqp_reader_t *r)
+{
+    struct mbuf *out = &ctx->out;
+    uint32_t method  = get_uint(r, 4);
+    size_t pos;
+
+    switch (method) {
+    case AMQP_CONNECTION_START: {
+        pos = method_start(out, 0, AMQP_CONNECTION_START_OK);
+        // client-properties table with a single "product" string
+        static char const product[] = "\x07product" "S\x00\x00\x00\x07rtl_433";
+        put_longstr(out, product, sizeof(product) - 1);
+        put_shortstr(out, "PLAIN");
+        size_t user_len = strlen(ctx->user);
+        size_t pass_len = strlen(ctx->pass);
+        put_u32(out, (uint32_t)(1 + user_len + 1 + pass_len));
+        put_u8(out, 0);
+        mbuf_append(out, ctx->user, user_len);
+        put_u8(out, 0);
+        mbuf_append(out, ctx->pass, pass_len);
+        put_shortstr(out, "en_US");
+        frame_end(out, pos);
+        break;
+    }
+    case AMQP_CONNECTION_TUNE: {
+        uint16_t channel_max = get_uint(r, 2);
+        uint32_t frame_max   = get_uint(r, 4);
+        uint16_t heartbeat   = get_uint(r, 2);
+        ctx->frame_max = frame_max && frame_max < AMQP_FRAME_MAX ? frame_max : AMQP_FRAME_MAX;
+        ctx->heartbeat = heartbeat; // as proposed by the broker, 0 for none
+        pos = method_start(out, 0, AMQP_CONNECTION_TUNE_OK);
+        put_u16(out, channel_max);
+        put_u32(out, ctx->frame_max);
+        put_u16(out, heartbeat);
+        frame_end(out, pos);
+        // heartbeats are sent at half the interval, see amqp_client_timer()
+        if (ctx->heartbeat)
+            mg_set_timer(ctx->timer, mg_time() + ctx->heartbeat / 2.0);
+        pos = method_start(out, 0, AMQP_CONNECTION_OPEN);
+        put_shortstr(out, ctx->vhost);
+        put_shortstr(out, ""); // reserved
+        put_u8(out, 0);        // reserved
+        frame_end(out, pos);
+        break;
+    }
+    case AMQP_CONNECTION_OPEN_OK:
+        pos = method_start(out, AMQP_CHANNEL, AMQP_CHANNEL_OPEN);
+        put_shortstr(out, ""); // reserved
+        frame_end(out, pos);
+        break;
+    case AMQP_CHANNEL_OPEN_OK:
+        pos = method_start(out, AMQP_CHANNEL, AMQP_CONFIRM_SELECT);
+        put_u8(out, 0); // wait for confirm.select-ok
+        frame_end(out, pos);
+        break;
+    case AMQP_CONFIRM_SELECT_OK:
+        print_log(LOG_NOTICE, "AMQP", "AMQP Connection established.");
+        ctx->ready = 1;
+        amqp_client_flush(ctx);
+        break;
+    case AMQP_BASIC_ACK: {
+        uint64_t delivery_tag = get_u64(r);
+        int multiple          = get_uint(r, 1) & 1;
+        if (amqp_client_confirm(ctx, delivery_tag, multiple))
+            ctx->reconnect_delay = 0; // the broker takes messages again
+        amqp_client_flush(ctx);
+        break;
+    }
+    case AMQP_BASIC_NACK: {
+        uint64_t delivery_tag = get_u64(r);
+        int multiple          = get_uint(r, 1) & 1;
+        unsigned count        = amqp_client_confirm(ctx, delivery_tag, multiple);
+        print_logf(LOG_WARNING, "AMQP", "AMQP broker rejected %u message(s)", count);
+        amqp_client_flush(ctx);
+        break;
+    }
+    case AMQP_CONNECTION_CLOSE:
+    case AMQP_CHANNEL_CLOSE: {
+        unsigned reply_code = get_uint(r, 2);
+        char const *reply_text;
+        unsigned reply_len = get_shortstr(r, &reply_text);
+        uint32_t failed    = get_uint(r, 4); // the method that caused the close
+        print_logf(LOG_WARNING, "AMQP", "AMQP %s closed by broker: %u %.*s",
+                method == AMQP_CHANNEL_CLOSE ? "Channel" : "Connection", reply_code, (int)reply_len, reply_text);
+        pos = method_start(out, channel, method == AMQP_CHANNEL_CLOSE ? AMQP_CHANNEL_CLOSE_OK : AMQP_CONNECTION_CLOSE_OK);
+        frame_end(out, pos);
+        amqp_client_send(ctx);
+        // a publish that closes the channel, e.g. to a missing exchange, would do so again
+        if (method == AMQP_CHANNEL_CLOSE && failed == AMQP_BASIC_PUBLISH && ctx->sent) {
+            print_log(LOG_WARNING, "AMQP", "AMQP dropping the oldest unconfirmed message");
+            list_remove(&ctx->queue, 0, free);
+            ctx->sent--;
+        }
+        // reconnect to get a fresh channel
+        amqp_client_reset(ctx);
+        nc->flags |= MG_F_SEND_AND_CLOSE;
+        return;
+    }
+    case AMQP_CONNECTION_CLOSE_OK:
+        nc->flags |= MG_F_CLOSE_IMMEDIATELY;
+        break;
+    default:
+        print_logf(LOG_DEBUG, "AMQP", "AMQP ignoring method %u.%u", method >> 16, method & 0xffff);
+        break;
+    }
+    amqp_client_send(ctx);
+}
+
+/// Handle all complete frames in the receive buffer.
+static void amqp_client_recv(amqp_client_t *ctx, struct mg_connection *nc)
+{
+    struct mbuf *in = &nc->recv_mbuf;
+
+    // a protocol header instead of a frame means the broker does not speak 0-9-1
+    if (in->len >= sizeof(amqp_protocol_header) && !memcmp(in->buf, "AMQP", 4)) {
+        print_log(LOG_WARNING, "AMQP", "AMQP broker does not support protocol version 0-9-1");
+        nc->flags |= MG_F_CLOSE_IMMEDIATELY;
+        return;
+    }
+
+    while (in->len >= AMQP_FRAME_OVERHEAD - 1) {
+        uint8_t const *p = (uint8_t const *)in->buf;
+        uint8_t type     = p[0];
+        uint16_t channel = (uint16_t)(p[1] << 8 | p[2]);
+        uint32_t size    = (uint32_t)p[3] << 24 | (uint32_t)p[4] << 16 | (uint32_t)p[5] << 8 | p[6];
+        if (size > AMQP_FRAME_MAX) {
+            print_logf(LOG_WARNING, "AMQP", "AMQP frame too large (%u bytes)", size);
+            nc->flags |= MG_F_CLOSE_IMMEDIATELY;
+            return;
+        }
+        if (in->len < size + AMQP_FRAME_OVERHEAD)
+            return; // wait for more data
+        if (p[size + AMQP_FRAME_OVERHEAD - 1] != AMQP_FRAME_END) {
+            print_log(LOG_WARNING, "AMQP", "AMQP frame end missing");
+            nc->flags |= MG_F_CLOSE_IMMEDIATELY;
+            return;
+        }
+        ctx->last_recv = mg_time();
+
+        // content and heartbeat frames are not expected or can be ignored
+        if (type == AMQP_FRAME_METHOD) {
+            amqp_reader_t r = {.p = p + 7, .left = size};
+            amqp_client_method(ctx, nc, channel, &r);
+        }
+        mbuf_remove(in, size + AMQP_FRAME_OVERHEAD);
+        if (nc->flags & (MG_F_SEND_AND_CLOSE | MG_F_CLOSE_IMMEDIATELY))
+            return;
+    }
+}
+
+static void amqp_client_event(struct mg_connection *nc, int ev, void *ev_data)
+{
+    // note that while shutting down the ctx is NULL
+    amqp_client_t *ctx = (amqp_client_t *)nc->user_data;
+
+    switch (ev) {
+    case MG_EV_CONNECT: {
+        int connect_status = *(int *)ev_data;
+        if (connect_status == 0) {
+            // Success
+            print_log(LOG_NOTICE, "AMQP", "AMQP Connected...");
+            mg_send(nc, amqp_protocol_header, sizeof(amqp_protocol_header));
+        }
+        else {
+            // Error, print only once
+            if (ctx && ctx->prev_status != connect_status) {
+                print_logf(LOG_WARNING, "AMQP", "AMQP connect error: %s", strerror(connect_status));
+            }
+        }
+        if (ctx) {
+            ctx->prev_status = connect_status;
+        }
+        break;
+    }
+    case MG_EV_RECV:
+        if (!ctx) {
+            mbuf_remove(&nc->recv_mbuf, nc->recv_mbuf.len);
+            break; // shutting down
+        }
+        amqp_client_recv(ctx, nc);
+        break;
+    case MG_EV_CLOSE:
+        if (!ctx) {
+            break; // shutting down
+        }
+        ctx->conn = NULL;
+        ctx->heartbeat = 0;
+        amqp_client_reset(ctx);
+        if (!ctx->timer) {
+            break; // shutting down
+        }
+        if (ctx->prev_status == 0) {
+            print_logf(LOG_WARNING, "AMQP", "AMQP Connection lost, reconnecting with %u message(s) queued...", (unsigned)ctx->queue.len);
+        }
+        // Timer for reconnect attempt, sends us MG_EV_TIMER event
+        mg_set_timer(ctx->timer, mg_time() + ctx->reconnect_delay);
+        if (ctx->reconnect_delay < 60) {
+            // 0, 1, 3, 6, 10, 16, 25, 39, 60
+            ctx->reconnect_delay = (ctx->reconnect_delay + 1) * 3 / 2;
+        }
+        break;
+    }
+}
+
+static void amqp_client_timer(struct mg_connection *nc, int ev, void *ev_data)
+{
+    // note that while shutting down the ctx is NULL
+    amqp_client_t *ctx = (amqp_client_t *)nc->user_data;
+    (void)ev_data;
+
+    switch (ev) {
+    case MG_EV_TIMER: {
+        if (!ctx) {
+            break; // shutting down
+        }
+        if (ctx->conn) {
+            if (!ctx->heartbeat) {
+                break; // heartbeats are off, see AMQP_CONNECTION_TUNE
+            }
+            // the broker is considered dead after two missed heartbeats
+            double now = mg_time();
+            if (now - ctx->last_recv > 2 * ctx->heartbeat) {
+                print_log(LOG_WARNING, "AMQP", "AMQP broker missed heartbeats");
+                ctx->conn->flags |= MG_F_CLOSE_IMMEDIATELY;
+                break;
+            }
+            size_t pos = frame_start(&ctx->out, AMQP_FRAME_HEARTBEAT, 0);
+            frame_end(&ctx->out, pos);
+            amqp_client_send(ctx);
+            mg_set_timer(nc, now + ctx->heartbeat / 2.0);
+            break;
+        }
+        // Try to reconnect
+        char const *error_string = NULL;
+        ctx->connect_opts.error_string = &error_string;
+        ctx->conn = mg_connect_opt(nc->mgr, ctx->address, amqp_client_event, ctx->connect_opts);
+        ctx->connect_opts.error_string = NULL;
+        if (!ctx->conn) {
+            print_logf(LOG_WARNING, "AMQP", "AMQP connect (%s) failed%s%s", ctx->address,
+                    error_string ? ": " : "", error_string ? error_string : "");
+        }
+        break;
+    }
+    }
+}
+
+static amqp_client_t *amqp_client_init(struct mg_mgr *mgr, tls_opts_t *tls_opts, char const *host, char const *port)
+{
+    amqp_client_t *ctx = calloc(1, sizeof(*ctx));
+    if (!ctx)
+        FATAL_CALLOC("amqp_client_init()");
+
+    ctx->frame_max = AMQP_FRAME_MAX;
+    mbuf_init(&ctx->out, 0);
+
+    // if the host is an IPv6 address it needs quoting
+    if (strchr(host, ':'))
+        snprintf(ctx->address, sizeof(ctx->address), "[%s]:%s", host, port);
+    else
+        snprintf(ctx->address, sizeof(ctx->address), "%s:%s", host, port);
+
+    ctx->connect_opts.user_data = ctx;
+    if (tls_opts && tls_opts->tls_ca_cert) {
+        print_logf(LOG_INFO, "AMQP", "amqps (TLS) parameters are: "
+                                       "tls_cert=%s "
+                                       "tls_key=%s "
+                                       "tls_ca_cert=%s "
+                                       "tls_cipher_suites=%s "
+                                       "tls_server_name=%s "
+                                       "tls_psk_identity=%s "
+                                       "tls_psk_key=%s ",
+                tls_opts->tls_cert,
+                tls_opts->tls_key,
+                tls_opts->tls_ca_cert,
+                tls_opts->tls_cipher_suites,
+                tls_opts->tls_server_name,
+                tls_opts->tls_psk_identity,
+                tls_opts->tls_psk_key);
+#if MG_ENABLE_SSL
+        ctx->connect_opts.ssl_cert          = tls_opts->tls_cert;
+        ctx->connect_opts.ssl_key           = tls_opts->tls_key;
+        ctx->connect_opts.ssl_ca_cert       = tls_opts->tls_ca_cert;
+        ctx->connect_opts.ssl_cipher_suites = tls_opts->tls_cipher_suites;
+        ctx->connect_opts.ssl_server_name   = tls_opts->tls_server_name;
+        ctx->connect_opts.ssl_psk_identity  = tls_opts->tls_psk_identity;
+        ctx->connect_opts.ssl_psk_key       = tls_opts->tls_psk_key;
+#else
+        print_log(LOG_FATAL, __func__, "amqps (TLS) not available");
+        exit(1);
+#endif
+    }
+
+    // add dummy socket to receive timer events
+    struct mg_add_sock_opts opts = {.user_data = ctx};
+    ctx->timer = mg_add_sock_opt(mgr, INVALID_SOCKET, amqp_client_timer, opts);
+
+    char const *error_string = NULL;
+    ctx->connect_opts.error_string = &error_string;
+    ctx->conn = mg_connect_opt(mgr, ctx->address, amqp_client_event, ctx->connect_opts);
+    ctx->connect_opts.error_string = NULL;
+    if (!ctx->conn) {
+        print_logf(LOG_FATAL, "AMQP", "AMQP connect (%s) failed%s%s", ctx->address,
+                error_string ? ": " : "", error_string ? error_string : "");
+        exit(1);
+    }
+
+    return ctx;
+}
+
+/// Queue a message and publish it if the window allows.
+static void amqp_client_publish(amqp_client_t *ctx, char const *routing_key, char const *body, size_t body_len)
+{
+    if (ctx->queue.len >= ctx->queue_max) {
+        if (!ctx->dropped)
+            print_logf(LOG_WARNING, "AMQP", "AMQP queue of %u messages full, dropping messages", ctx->queue_max);
+        ctx->dropped++;
+        return;
+    }
+    if (ctx->dropped && ctx->ready) {
+        print_logf(LOG_WARNING, "AMQP", "AMQP dropped %u message(s)", ctx->dropped);
+        ctx->dropped = 0;
+    }
+
+    size_t key_len      = strlen(routing_key);
+    amqp_message_t *msg = malloc(sizeof(*msg) + body_len + key_len + 1);
+    if (!msg) {
+        WARN_MALLOC("amqp_client_publish()");
+        return; // NOTE: skip output on alloc failure.
+    }
+    msg->delivery_tag = 0;
+    msg->body_len     = body_len;
+    memcpy(msg->body, body, body_len);
+    msg->routing_key = memcpy(msg->body + body_len, routing_key, key_len + 1);
+    list_push(&ctx->queue, msg);
+
+    amqp_client_flush(ctx);
+}
+
+static void amqp_client_free(amqp_client_t *ctx)
+{
+    if (!ctx)
+        return;
+    if (ctx->conn) {
+        ctx->conn->user_data = NULL;
+        ctx->conn->flags |= MG_F_CLOSE_IMMEDIATELY;
+    }
+    if (ctx->timer) {
+        ctx->timer->user_data = NULL;
+        ctx->timer->flags |= MG_F_CLOSE_IMMEDIATELY;
+    }
+    if (ctx->queue.len)
+        print_logf(LOG_NOTICE, "AMQP", "AMQP %u message(s) not confirmed", (unsigned)ctx->queue.len);
+    list_free_elems(&ctx->queue, free);
+    mbuf_free(&ctx->out);
+    free(ctx);
+}
+
+/* AMQP printer */
+
+typedef struct {
+    struct data_output output;
+    amqp_client_t *client;
+    char routing_key[256];
+    char hostname[64];
+    char *events;
+    char *states;
+} data_output_amqp_t;
+
+static void R_API_CALLCONV print_amqp_data(data_output_t *output, data_t *data, char const *format)
+{
+    UNUSED(format);
+    data_output_amqp_t *amqp = (data_output_amqp_t *)output;
+
+    // collect well-known top level keys
+    data_t *data_model = NULL;
+    for (data_t *d = data; d; d = d->next) {
+        if (!strcmp(d->key, "model"))
+            data_model = d;
+    }
+
+    // "events" or "states" routing key
+    char const *routing = data_model ? amqp->events : amqp->states;
+    if (!routing)
+        return;
+
+    size_t len;
+    char const *message = data_jsons(data, &len);
+    if (!message)
+        return; // NOTE: skip output on alloc failure.
+    expand_topic(amqp->routing_key, routing, data, amqp->hostname);
+    amqp_client_publish(amqp->client, amqp->routing_key, message, len);
+}
+
+static void R_API_CALLCONV data_output_amqp_free(data_output_t *output)
+{
+    data_output_amqp_t *amqp = (data_output_amqp_t *)output;
+
+    if (!amqp)
+        return;
+
+    free(amqp->events);
+    free(amqp->states);
+
+    amqp_client_free(amqp->client);
+
+    free(amqp);
+}
+
+static char *amqp_routing_default(char const *routing, char const *base, char const *suffix)
+{
+    char path[256];
+    char const *p;
+    if (routing) {
+        p = routing;
+    }
+    else {
+        snprintf(path, sizeof(path), "%s.%s", base, suffix);
+        p = path;
+    }
+
+    char *ret = strdup(p);
+    if (!ret)
+        WARN_STRDUP("amqp_routing_default()");
+    return ret;
+}
+
+struct data_output *data_output_amqp_create(struct mg_mgr *mgr, char *param)
+{
+    data_output_amqp_t *amqp = calloc(1, sizeof(data_output_amqp_t));
+    if (!amqp)
+        FATAL_CALLOC("data_output_amqp_create()");
+
+    gethostname(amqp->hostname, sizeof(amqp->hostname) - 1);
+    amqp->hostname[sizeof(amqp->hostname) - 1] = '\0';
+    // only use hostname, not domain part
+    char *dot = strchr(amqp->hostname, '.');
+    if (dot)
+        *dot = '\0';
+
+    // default base routing key
+    char default_base[8 + sizeof(amqp->hostname)];
+    snprintf(default_base, sizeof(default_base), "rtl_433.%s", amqp->hostname);
+    char const *base = default_base;
+
+    // default routing keys
+    char const *path_events = "events[.type][.model][.subtype][.channel][.id]";
+    char const *path_states = "states";
+
+    // get user and pass from env vars if available.
+    char const *user = getenv("AMQP_USERNAME");
+    char const *pass = getenv("AMQP_PASSWORD");
+    char const *vhost    = "/";
+    char const *exchange = "amq.topic";
+    int persistent       = 0;
+    unsigned window      = 256;
+    unsigned queue_max   = 10000;
+
+    // parse host and port
+    tls_opts_t tls_opts = {0};
+    if (param && strncmp(param, "amqps", 5) == 0) {
+        tls_opts.tls_ca_cert = "*"; // TLS is enabled but no cert verification is performed.
+    }
+    param      = arg_param(param); // strip scheme
+    char const *host = "localhost";
+    char const *port = tls_opts.tls_ca_cert ? "5671" : "5672";
+    char *opts = hostport_param(param, &host, &port);
+    print_logf(LOG_CRITICAL, "AMQP", "Publishing AMQP data to %s port %s%s", host, port, tls_opts.tls_ca_cert ? " (TLS)" : "");
+
+    // parse auth and format options
+    char *key, *val;
+    while (getkwargs(&opts, &key, &val)) {
+        key = remove_ws(key);
+        val = trim_ws(val);
+        if (!key || !*key)
+            continue;
+        else if (!strcasecmp(key, "u") || !strcasecmp(key, "user"))
+            user = val;
+        else if (!strcasecmp(key, "p") || !strcasecmp(key, "pass"))
+            pass = val;
+        else if (!strcasecmp(key, "v") || !strcasecmp(key, "vhost"))
+            vhost = val;
+        else if (!strcasecmp(key, "x") || !strcasecmp(key, "exchange"))
+            exchange = val;
+        else if (!strcasecmp(key, "b") || !strcasecmp(key, "base"))
+            base = val;
+        else if (!strcasecmp(key, "persistent"))
+            persistent = atobv(val, 1);
+        else if (!strcasecmp(key, "window"))
+            window = atoiv(val, 256);
+        else if (!strcasecmp(key, "queue"))
+            queue_max = atoiv(val, 10000);
+        // JSON events with expanded routing key
+        else if (!strcasecmp(key, "e") || !strcasecmp(key, "events"))
+            amqp->events = amqp_routing_default(val, base, path_events);
+        // JSON states with expanded routing key
+        else if (!strcasecmp(key, "s") || !strcasecmp(key, "states"))
+            amqp->states = amqp_routing_default(val, base, path_states);
+        else if (!tls_param(&tls_opts, key, val)) {
+            // ok
+        }
+        else {
+            print_logf(LOG_FATAL, __func__, "Invalid key \"%s\" option.", key);
+            exit(1);
+        }
+    }
+    if (!window || window > queue_max) {
+        print_log(LOG_FATAL, __func__, "AMQP window must be at least 1 and at most the queue size.");
+        exit(1);
+    }
+
+    // Default is to use all formats
+    if (!amqp->events && !amqp->states) {
+        amqp->events = amqp_routing_default(NULL, base, path_events);
+        amqp->states = amqp_routing_default(NULL, base, path_states);
+    }
+    if (amqp->events)
+        print_logf(LOG_NOTICE, "AMQP", "Publishing events to exchange \"%s\" with routing key \"%s\".", exchange, amqp->events);
+    if (amqp->states)
+        print_logf(LOG_NOTICE, "AMQP", "Publishing states to exchange \"%s\" with routing key \"%s\".", exchange, amqp->states);
+
+    amqp->output.print_data  = print_amqp_data;
+    amqp->output.output_free = data_output_amqp_free;
+
+    amqp->client = amqp_client_init(mgr, &tls_opts, host, port);
+    amqp->client->user       = user ? user : "guest";
+    amqp->client->pass       = pass ? pass : "guest";
+    amqp->client->vhost      = vhost;
+    amqp->client->exchange   = exchange;
+    amqp->client->persistent = persistent;
+    amqp->client->window     = window;
+    amqp->client->queue_max  = queue_max;
+
+    return (struct data_output *)amqp;
+}
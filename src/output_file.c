@@ -321,7 +321,7 @@ static void R_API_CALLCONV print_kv_data(data_output_t *output, data_t *data, ch
         }
 
         // print key
-        char *key = *data->pretty_key ? data->pretty_key : data->key;
+        char const *key = *data->pretty_key ? data->pretty_key : data->key;
         kv->column += fprintf(kv->file, "%-10s: ", key);
         // print value
         if (color)
@@ -538,7 +538,10 @@ static void R_API_CALLCONV data_output_csv_start(struct data_output *output, cha
                 compare_strings);
         int *field_use_count = use_count + (field - allowed);
         if (field && !*field_use_count) {
-            csv->fields[csv_fields] = fields[i];
+            // interned to match keys by pointer
+            csv->fields[csv_fields] = data_intern(fields[i]);
+            if (!csv->fields[csv_fields])
+                goto alloc_error;
             ++csv_fields;
             ++*field_use_count;
         }
@@ -584,9 +587,13 @@ static void R_API_CALLCONV data_output_csv_print(data_output_t *output, data_t *
 
     const char **fields = csv->fields;
 
+    char const *key_msg   = data_intern("msg");
+    char const *key_codes = data_intern("codes");
+    char const *key_model = data_intern("model");
+
     int regular = 0; // skip "states" output
     for (data_t *d = data; d; d = d->next) {
-        if (!strcmp(d->key, "msg") || !strcmp(d->key, "codes") || !strcmp(d->key, "model")) {
+        if (d->key == key_msg || d->key == key_codes || d->key == key_model) {
             regular = 1;
             break;
         }
@@ -600,7 +607,7 @@ static void R_API_CALLCONV data_output_csv_print(data_output_t *output, data_t *
         if (i)
             fprintf(csv->file, "%s", csv->separator);
         for (data_t *iter = data; !found && iter; iter = iter->next)
-            if (strcmp(iter->key, key) == 0)
+            if (iter->key == key)
                 found = iter;
 
         if (found)
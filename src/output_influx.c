@@ -17,6 +17,7 @@
 #include "logger.h"
 #include "fatal.h"
 #include "r_util.h"
+#include "spool.h"
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -41,11 +42,37 @@ typedef struct {
     tls_opts_t tls_opts;
     int databufidxfill;
     struct mbuf databufs[2];
+    spool_t *spool;     ///< spool for data that could not be written, optional
+    unsigned spool_rate;
+    int sent;           ///< the request in flight was written or rejected, don't spool it
+    uint64_t replay_id; ///< the spooled record in flight, 0 if none
+    double replay_next; ///< earliest time for the next replay request
 
 } influx_client_t;
 
 static void influx_client_send(influx_client_t *ctx);
 
+/// Settle the request in flight, data that was not written goes to the spool.
+static void influx_client_done(influx_client_t *ctx)
+{
+    struct mbuf *buf = &ctx->databufs[ctx->databufidxfill ^ 1];
+
+    if (ctx->replay_id) {
+        if (ctx->sent)
+            spool_pop(ctx->spool, ctx->replay_id);
+    }
+    else if (buf->len && !ctx->sent && ctx->spool) {
+        spool_write(ctx->spool, "", buf->buf, buf->len);
+    }
+    if (ctx->spool) {
+        buf->len = 0;
+        if (buf->size)
+            *buf->buf = '\0';
+    }
+    ctx->sent      = 0;
+    ctx->replay_id = 0;
+}
+
 static void influx_client_event(struct mg_connection *nc, int ev, void *ev_data)
 {
     // note that while shutting down the ctx is NULL
@@ -76,6 +103,10 @@ static void influx_client_event(struct mg_connection *nc, int ev, void *ev_data)
     case MG_EV_HTTP_CHUNK: // response is normally empty (so mongoose thinks we received a chunk only)
     case MG_EV_HTTP_REPLY:
         nc->flags |= MG_F_CLOSE_IMMEDIATELY;
+        // retry server errors from the spool, client errors would fail again
+        if (ctx && hm->resp_code < 500) {
+            ctx->sent = 1;
+        }
         if (hm->resp_code == 204) {
             // mark influx data as sent
         }
@@ -92,6 +123,7 @@ static void influx_client_event(struct mg_connection *nc, int ev, void *ev_data)
             break; // shutting down
         }
         ctx->conn = NULL;
+        influx_client_done(ctx);
         if (!ctx->timer) {
             break; // shutting down
         }
@@ -136,9 +168,30 @@ static void influx_client_send(influx_client_t *ctx)
             (void*)ctx, buf->buf, buf->len, buf->size,
             ctx->conn ? "buffering" : "to be sent");*/
 
-    if (ctx->conn || !buf->len)
+    if (ctx->conn)
         return;
 
+    // replay spooled data when there is no new data, at the rate limit
+    char const *post_data = buf->buf;
+    if (!buf->len) {
+        char const *key;
+        void const *data;
+        size_t len;
+        if (!ctx->spool || !(ctx->replay_id = spool_peek(ctx->spool, &key, &data, &len)))
+            return;
+        if (mg_time() < ctx->replay_next) {
+            ctx->replay_id = 0;
+            mg_set_timer(ctx->timer, ctx->replay_next);
+            return;
+        }
+        ctx->replay_next = mg_time() + 1.0 / ctx->spool_rate;
+        // the spooled data is text ending in a newline, post it as a string
+        mbuf_append(buf, data, len);
+        mbuf_append(buf, "", 1);
+        buf->len  = len;
+        post_data = buf->buf;
+    }
+
     char const *error_string = NULL;
     struct mg_connect_opts opts = {.user_data = ctx, .error_string = &error_string};
     if (ctx->tls_opts.tls_ca_cert) {
@@ -171,8 +224,18 @@ static void influx_client_send(influx_client_t *ctx)
         exit(1);
 #endif
     }
-    if ((ctx->conn = mg_connect_http_opt(ctx->mgr, influx_client_event, opts, ctx->url, ctx->extra_headers, buf->buf)) == NULL) {
+    if ((ctx->conn = mg_connect_http_opt(ctx->mgr, influx_client_event, opts, ctx->url, ctx->extra_headers, post_data)) == NULL) {
         print_logf(LOG_WARNING, "InfluxDB", "Connect to InfluxDB (%s) failed (%s)", ctx->url, error_string);
+        if (ctx->replay_id) {
+            ctx->replay_id = 0;
+            buf->len       = 0;
+            *buf->buf      = '\0';
+        }
+    }
+    else if (ctx->spool) {
+        // keep the data in flight to spool it if the write fails
+        ctx->databufidxfill ^= 1;
+        ctx->sent = 0;
     }
     else {
         ctx->databufidxfill ^= 1;
@@ -467,6 +530,17 @@ static void R_API_CALLCONV data_output_influx_free(data_output_t *output)
         influx->conn->flags |= MG_F_CLOSE_IMMEDIATELY;
     }
 
+    if (influx->spool) {
+        // data not yet written is kept for the next start
+        if (!influx->replay_id && influx->databufs[influx->databufidxfill].len)
+            spool_write(influx->spool, "", influx->databufs[influx->databufidxfill].buf, influx->databufs[influx->databufidxfill].len);
+        if (spool_depth(influx->spool))
+            print_logf(LOG_NOTICE, "InfluxDB", "InfluxDB %u records left in the spool for the next start.", spool_depth(influx->spool));
+        spool_free(influx->spool);
+    }
+    mbuf_free(&influx->databufs[0]);
+    mbuf_free(&influx->databufs[1]);
+
     free(influx);
 }
 
@@ -486,6 +560,7 @@ struct data_output *data_output_influx_create(struct mg_mgr *mgr, char *opts)
     influx_sanitize_tag(influx->hostname, NULL);
 
     char *token = NULL;
+    spool_opts_t spool_opts = {0};
 
     // param/opts starts with URL
     if (!opts) {
@@ -530,6 +605,9 @@ struct data_output *data_output_influx_create(struct mg_mgr *mgr, char *opts)
         else if (!tls_param(&influx->tls_opts, key, val)) {
             // ok
         }
+        else if (!spool_param(&spool_opts, key, val)) {
+            // ok
+        }
         else {
             print_logf(LOG_FATAL, __func__, "Invalid key \"%s\" option.", key);
             exit(1);
@@ -545,6 +623,19 @@ struct data_output *data_output_influx_create(struct mg_mgr *mgr, char *opts)
 
     print_logf(LOG_CRITICAL, "InfluxDB", "Publishing data to InfluxDB (%s)", url);
 
+    if (spool_opts.spool_dir) {
+        char name[80];
+        snprintf(name, sizeof(name), "influx-%.*s", (int)host.len, host.p);
+        size_t size        = spool_opts.spool_size ? spool_opts.spool_size : SPOOL_SIZE_DEFAULT;
+        influx->spool_rate = spool_opts.spool_rate ? spool_opts.spool_rate : SPOOL_RATE_DEFAULT;
+        influx->spool      = spool_create(spool_opts.spool_dir, name, size, SPOOL_SEGMENT_DEFAULT);
+        if (!influx->spool) {
+            print_logf(LOG_FATAL, "InfluxDB", "InfluxDB spool (%s) failed", spool_opts.spool_dir);
+            exit(1);
+        }
+        print_logf(LOG_NOTICE, "InfluxDB", "Spooling InfluxDB data that could not be written to \"%s\".", spool_opts.spool_dir);
+    }
+
     influx->mgr = mgr;
 
     // add dummy socket to receive timer events
@@ -16,6 +16,7 @@
 #include "logger.h"
 #include "fatal.h"
 #include "r_util.h"
+#include "spool.h"
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -36,8 +37,18 @@ typedef struct mqtt_client {
     char client_id[256];
     uint16_t message_id;
     int publish_flags; // MG_MQTT_RETAIN | MG_MQTT_QOS(0)
+    int connected;     ///< the broker accepted the connection
+    spool_t *spool;    ///< spool for messages while disconnected, optional
+    unsigned spool_rate;
+    int replaying;
+    struct mbuf batch; ///< encoded PUBLISH packets, sent with mqtt_client_flush()
 } mqtt_client_t;
 
+/// Unsent data above which messages are spooled instead, e.g. on a stalled connection.
+#define MQTT_SPOOL_BACKLOG (64 * 1024)
+/// Interval of the spool replay timer in seconds.
+#define MQTT_SPOOL_INTERVAL 0.1
+
 char const *mqtt_availability_online  = "online";
 char const *mqtt_availability_offline = "offline";
 
@@ -84,6 +95,12 @@ static void mqtt_client_event(struct mg_connection *nc, int ev, void *ev_data)
                 ctx->message_id++;
                 mg_mqtt_publish(ctx->conn, ctx->mqtt_opts.will_topic, ctx->message_id, MG_MQTT_QOS(0) | MG_MQTT_RETAIN, mqtt_availability_online, strlen(mqtt_availability_online));
             }
+            ctx->connected = 1;
+            if (ctx->spool && spool_depth(ctx->spool)) {
+                print_logf(LOG_NOTICE, "MQTT", "MQTT Replaying %u spooled messages.", spool_depth(ctx->spool));
+                ctx->replaying = 1;
+                mg_set_timer(ctx->timer, mg_time() + MQTT_SPOOL_INTERVAL);
+            }
         }
         break;
     case MG_EV_MQTT_PUBACK:
@@ -101,7 +118,9 @@ static void mqtt_client_event(struct mg_connection *nc, int ev, void *ev_data)
         if (!ctx) {
             break; // shutting down
         }
-        ctx->conn = NULL;
+        ctx->conn      = NULL;
+        ctx->connected = 0;
+        ctx->replaying = 0;
         if (!ctx->timer) {
             break; // shutting down
         }
@@ -118,6 +137,33 @@ static void mqtt_client_event(struct mg_connection *nc, int ev, void *ev_data)
     }
 }
 
+/// Publish spooled messages, at most the rate limit per timer interval and while the connection keeps up.
+static void mqtt_client_replay(mqtt_client_t *ctx)
+{
+    unsigned budget = (unsigned)(ctx->spool_rate * MQTT_SPOOL_INTERVAL);
+    if (budget < 1)
+        budget = 1;
+
+    char const *topic;
+    void const *payload;
+    size_t len;
+    uint64_t id;
+    while (budget-- && ctx->conn->send_mbuf.len < MQTT_SPOOL_BACKLOG
+            && (id = spool_peek(ctx->spool, &topic, &payload, &len))) {
+        ctx->message_id++;
+        mg_mqtt_publish(ctx->conn, topic, ctx->message_id, ctx->publish_flags, payload, len);
+        spool_pop(ctx->spool, id);
+    }
+
+    if (spool_depth(ctx->spool)) {
+        mg_set_timer(ctx->timer, mg_time() + MQTT_SPOOL_INTERVAL);
+    }
+    else {
+        print_log(LOG_NOTICE, "MQTT", "MQTT Spool replay done.");
+        ctx->replaying = 0;
+    }
+}
+
 static void mqtt_client_timer(struct mg_connection *nc, int ev, void *ev_data)
 {
     // note that while shutting down the ctx is NULL
@@ -129,6 +175,13 @@ static void mqtt_client_timer(struct mg_connection *nc, int ev, void *ev_data)
 
     switch (ev) {
     case MG_EV_TIMER: {
+        if (ctx->connected) {
+            mqtt_client_replay(ctx);
+            break;
+        }
+        if (ctx->conn) {
+            break; // already connecting
+        }
         // Try to reconnect
         char const *error_string = NULL;
         ctx->connect_opts.error_string = &error_string;
@@ -143,12 +196,23 @@ static void mqtt_client_timer(struct mg_connection *nc, int ev, void *ev_data)
     }
 }
 
-static mqtt_client_t *mqtt_client_init(struct mg_mgr *mgr, tls_opts_t *tls_opts, char const *host, char const *port, char const *user, char const *pass, char const *client_id, int retain, int qos, char const *availability)
+static mqtt_client_t *mqtt_client_init(struct mg_mgr *mgr, tls_opts_t *tls_opts, spool_opts_t *spool_opts, char const *host, char const *port, char const *user, char const *pass, char const *client_id, int retain, int qos, char const *availability)
 {
     mqtt_client_t *ctx = calloc(1, sizeof(*ctx));
     if (!ctx)
         FATAL_CALLOC("mqtt_client_init()");
 
+    if (spool_opts && spool_opts->spool_dir) {
+        size_t size     = spool_opts->spool_size ? spool_opts->spool_size : SPOOL_SIZE_DEFAULT;
+        ctx->spool_rate = spool_opts->spool_rate ? spool_opts->spool_rate : SPOOL_RATE_DEFAULT;
+        ctx->spool      = spool_create(spool_opts->spool_dir, client_id, size, SPOOL_SEGMENT_DEFAULT);
+        if (!ctx->spool) {
+            print_logf(LOG_FATAL, "MQTT", "MQTT spool (%s) failed", spool_opts->spool_dir);
+            exit(1);
+        }
+        print_logf(LOG_NOTICE, "MQTT", "Spooling MQTT messages while disconnected to \"%s\".", spool_opts->spool_dir);
+    }
+
     ctx->mqtt_opts.user_name = user;
     ctx->mqtt_opts.password  = pass;
     ctx->mqtt_opts.will_topic = availability;
@@ -215,13 +279,66 @@ static mqtt_client_t *mqtt_client_init(struct mg_mgr *mgr, tls_opts_t *tls_opts,
     return ctx;
 }
 
+void mqtt_publish_encode(struct mbuf *out, char const *topic, uint16_t message_id, int flags, void const *data, size_t len)
+{
+    size_t topic_len = strlen(topic);
+    size_t total_len = 2 + topic_len + len;
+    if (MG_MQTT_GET_QOS(flags) > 0)
+        total_len += 2;
+
+    uint8_t hdr[1 + 4 + 2];
+    uint8_t *p = hdr;
+    *p++       = (MG_MQTT_CMD_PUBLISH << 4) | (uint8_t)flags;
+    do {
+        *p = total_len % 0x80;
+        total_len /= 0x80;
+        if (total_len > 0)
+            *p |= 0x80;
+        p++;
+    } while (total_len > 0);
+    *p++ = (uint8_t)(topic_len >> 8);
+    *p++ = (uint8_t)topic_len;
+    mbuf_append(out, hdr, p - hdr);
+    mbuf_append(out, topic, topic_len);
+
+    if (MG_MQTT_GET_QOS(flags) > 0) {
+        uint8_t id[2] = {message_id >> 8, message_id & 0xff};
+        mbuf_append(out, id, 2);
+    }
+    mbuf_append(out, data, len);
+}
+
 static void mqtt_client_publish(mqtt_client_t *ctx, char const *topic, char const *str)
 {
+    // keep the order, spool while disconnected, stalled, or still replaying
+    if (ctx->spool && (!ctx->connected || ctx->replaying || ctx->conn->send_mbuf.len > MQTT_SPOOL_BACKLOG)) {
+        spool_write(ctx->spool, topic, str, strlen(str));
+        if (ctx->connected && !ctx->replaying) {
+            ctx->replaying = 1;
+            mg_set_timer(ctx->timer, mg_time() + MQTT_SPOOL_INTERVAL);
+        }
+        return;
+    }
+
     if (!ctx->conn || !ctx->conn->proto_handler)
         return;
 
     ctx->message_id++;
-    mg_mqtt_publish(ctx->conn, topic, ctx->message_id, ctx->publish_flags, str, strlen(str));
+    mqtt_publish_encode(&ctx->batch, topic, ctx->message_id, ctx->publish_flags, str, strlen(str));
+}
+
+/// Send all batched PUBLISH packets with a single write.
+static void mqtt_client_flush(mqtt_client_t *ctx)
+{
+    if (!ctx->batch.len)
+        return;
+
+    if (ctx->conn && ctx->conn->proto_data) {
+        mg_send(ctx->conn, ctx->batch.buf, (int)ctx->batch.len);
+        struct mg_mqtt_proto_data *pd = (struct mg_mqtt_proto_data *)ctx->conn->proto_data;
+        pd->last_control_time = mg_time();
+    }
+    mbuf_clear(&ctx->batch);
 }
 
 static void mqtt_client_free(mqtt_client_t *ctx)
@@ -230,6 +347,13 @@ static void mqtt_client_free(mqtt_client_t *ctx)
         ctx->conn->user_data = NULL;
         ctx->conn->flags |= MG_F_CLOSE_IMMEDIATELY;
     }
+    if (ctx && ctx->spool) {
+        if (spool_depth(ctx->spool))
+            print_logf(LOG_NOTICE, "MQTT", "MQTT %u messages left in the spool for the next start.", spool_depth(ctx->spool));
+        spool_free(ctx->spool);
+    }
+    if (ctx)
+        mbuf_free(&ctx->batch);
     free(ctx);
 }
 
@@ -245,6 +369,30 @@ static char *mqtt_sanitize_topic(char *topic)
     return topic;
 }
 
+/* Device topic cache */
+
+#define MQTT_DEVICE_BUCKETS 256
+#define MQTT_DEVICE_MAX     4096 ///< the cache is cleared when exceeded
+#define MQTT_TOKEN_KEYS     6
+
+/// Last published value of a device field.
+typedef struct mqtt_field {
+    struct mqtt_field *next;
+    time_t time;
+    char *value;
+    char topic[]; ///< the topic below the device prefix
+} mqtt_field_t;
+
+/// The expanded "devices" topic for one set of topic token values.
+typedef struct mqtt_device {
+    struct mqtt_device *next;
+    uint32_t hash;
+    mqtt_field_t *fields;
+    size_t prefix_len;
+    char *prefix;
+    char key[]; ///< the topic token values, followed by the prefix
+} mqtt_device_t;
+
 /* MQTT printer */
 
 typedef struct {
@@ -258,8 +406,137 @@ typedef struct {
     char *states;
     //char *homie;
     //char *hass;
+    int dedup;             ///< suppress unchanged device fields, republished after this many seconds
+    time_t now;            ///< time of the event being published
+    mqtt_device_t *device; ///< the device being published
+    mqtt_device_t *device_table[MQTT_DEVICE_BUCKETS];
+    unsigned device_count;
+    char const *token_keys[MQTT_TOKEN_KEYS]; ///< interned keys of the topic tokens
 } data_output_mqtt_t;
 
+static void mqtt_device_clear(data_output_mqtt_t *mqtt)
+{
+    for (int i = 0; i < MQTT_DEVICE_BUCKETS; ++i) {
+        mqtt_device_t *device = mqtt->device_table[i];
+        while (device) {
+            mqtt_device_t *next = device->next;
+            mqtt_field_t *field = device->fields;
+            while (field) {
+                mqtt_field_t *next_field = field->next;
+                free(field->value);
+                free(field);
+                field = next_field;
+            }
+            free(device);
+            device = next;
+        }
+        mqtt->device_table[i] = NULL;
+    }
+    mqtt->device_count = 0;
+}
+
+/// Build a key of the top level values which topics can expand, returns 0 if too long.
+static size_t mqtt_device_key(data_output_mqtt_t *mqtt, data_t *data, char *key, size_t size)
+{
+    size_t len = 0;
+    for (data_t *d = data; d; d = d->next) {
+        for (int i = 0; i < MQTT_TOKEN_KEYS; ++i) {
+            if (d->key != mqtt->token_keys[i])
+                continue;
+            int ret = 0;
+            if (d->type == DATA_STRING)
+                ret = snprintf(key + len, size - len, "\x1f%c%s", '0' + i, (char const *)d->value.v_ptr);
+            else if (d->type == DATA_INT)
+                ret = snprintf(key + len, size - len, "\x1f%c%d", '0' + i, d->value.v_int);
+            if (ret < 0 || (size_t)ret >= size - len)
+                return 0;
+            len += (size_t)ret;
+        }
+    }
+    key[len] = '\0';
+    return len;
+}
+
+/// Get the cached device for the topic token values of an event, NULL if the event can't be cached.
+static mqtt_device_t *mqtt_device_get(data_output_mqtt_t *mqtt, data_t *data)
+{
+    char key[256];
+    size_t key_len = mqtt_device_key(mqtt, data, key, sizeof(key));
+    if (!key_len)
+        return NULL;
+
+    uint32_t hash = 2166136261u; // FNV-1a
+    for (size_t i = 0; i < key_len; ++i)
+        hash = (hash ^ (uint8_t)key[i]) * 16777619u;
+
+    mqtt_device_t **bucket = &mqtt->device_table[hash % MQTT_DEVICE_BUCKETS];
+    for (mqtt_device_t *device = *bucket; device; device = device->next) {
+        if (device->hash == hash && !strcmp(device->key, key))
+            return device;
+    }
+
+    if (mqtt->device_count >= MQTT_DEVICE_MAX)
+        mqtt_device_clear(mqtt);
+
+    char *end         = expand_topic(mqtt->topic, mqtt->devices, data, mqtt->hostname);
+    size_t prefix_len = end - mqtt->topic;
+    mqtt_device_t *device = malloc(sizeof(*device) + key_len + 1 + prefix_len + 1);
+    if (!device) {
+        WARN_MALLOC("mqtt_device_get()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    device->hash       = hash;
+    device->fields     = NULL;
+    device->prefix_len = prefix_len;
+    memcpy(device->key, key, key_len + 1);
+    device->prefix = device->key + key_len + 1;
+    memcpy(device->prefix, mqtt->topic, prefix_len + 1);
+    device->next = *bucket;
+    *bucket      = device;
+    mqtt->device_count++;
+    return device;
+}
+
+/// Check if a device field changed or is due for a refresh, and remember the value.
+static int mqtt_field_changed(data_output_mqtt_t *mqtt, mqtt_device_t *device, char const *topic, char const *value)
+{
+    // only remember what was published or spooled
+    if (!mqtt->mqc->connected && !mqtt->mqc->spool)
+        return 1;
+
+    mqtt_field_t *field;
+    for (field = device->fields; field; field = field->next) {
+        if (!strcmp(field->topic, topic))
+            break;
+    }
+    if (field && field->value && !strcmp(field->value, value) && mqtt->now - field->time < mqtt->dedup)
+        return 0;
+
+    if (!field) {
+        size_t topic_len = strlen(topic);
+        field = malloc(sizeof(*field) + topic_len + 1);
+        if (!field) {
+            WARN_MALLOC("mqtt_field_changed()");
+            return 1; // NOTE: publishes without dedup on alloc failure.
+        }
+        memcpy(field->topic, topic, topic_len + 1);
+        field->value   = NULL;
+        field->next    = device->fields;
+        device->fields = field;
+    }
+    if (!field->value || strcmp(field->value, value)) {
+        free(field->value);
+        field->value = strdup(value);
+        if (!field->value) {
+            WARN_STRDUP("mqtt_field_changed()");
+            field->time = 0;
+            return 1; // NOTE: publishes without dedup on alloc failure.
+        }
+    }
+    field->time = mqtt->now;
+    return 1;
+}
+
 static void R_API_CALLCONV print_mqtt_array(data_output_t *output, data_array_t *array, char const *format)
 {
     data_output_mqtt_t *mqtt = (data_output_mqtt_t *)output;
@@ -290,7 +567,7 @@ static char *append_topic(char *topic, data_t *data)
     return topic;
 }
 
-static char *expand_topic(char *topic, char const *format, data_t *data, char const *hostname)
+char *expand_topic(char *topic, char const *format, data_t *data, char const *hostname)
 {
     // collect well-known top level keys
     data_t *data_type    = NULL;
@@ -397,9 +674,10 @@ static void R_API_CALLCONV print_mqtt_data(data_output_t *output, data_t *data,
 
     char *orig = mqtt->topic + strlen(mqtt->topic); // save current topic
     char *end  = orig;
+    int top    = !*mqtt->topic;
 
     // top-level only
-    if (!*mqtt->topic) {
+    if (top) {
         // collect well-known top level keys
         data_t *data_model = NULL;
         for (data_t *d = data; d; d = d->next) {
@@ -410,25 +688,22 @@ static void R_API_CALLCONV print_mqtt_data(data_output_t *output, data_t *data,
         // "states" topic
         if (!data_model) {
             if (mqtt->states) {
-                size_t message_size = 20000; // state message need a large buffer
-                char *message       = malloc(message_size);
-                if (!message) {
-                    WARN_MALLOC("print_mqtt_data()");
+                char const *message = data_jsons(data, NULL);
+                if (!message)
                     return; // NOTE: skip output on alloc failure.
-                }
-                data_print_jsons(data, message, message_size);
                 expand_topic(mqtt->topic, mqtt->states, data, mqtt->hostname);
                 mqtt_client_publish(mqtt->mqc, mqtt->topic, message);
+                mqtt_client_flush(mqtt->mqc);
                 *mqtt->topic = '\0'; // clear topic
-                free(message);
             }
             return;
         }
 
         // "events" topic
         if (mqtt->events) {
-            char message[2048]; // we expect the biggest strings to be around 500 bytes.
-            data_print_jsons(data, message, sizeof(message));
+            char const *message = data_jsons(data, NULL);
+            if (!message)
+                return; // NOTE: skip output on alloc failure.
             expand_topic(mqtt->topic, mqtt->events, data, mqtt->hostname);
             mqtt_client_publish(mqtt->mqc, mqtt->topic, message);
             *mqtt->topic = '\0'; // clear topic
@@ -436,10 +711,19 @@ static void R_API_CALLCONV print_mqtt_data(data_output_t *output, data_t *data,
 
         // "devices" topic
         if (!mqtt->devices) {
+            mqtt_client_flush(mqtt->mqc);
             return;
         }
 
-        end = expand_topic(mqtt->topic, mqtt->devices, data, mqtt->hostname);
+        mqtt->now    = time(NULL);
+        mqtt->device = mqtt_device_get(mqtt, data);
+        if (mqtt->device) {
+            memcpy(mqtt->topic, mqtt->device->prefix, mqtt->device->prefix_len + 1);
+            end = mqtt->topic + mqtt->device->prefix_len;
+        }
+        else {
+            end = expand_topic(mqtt->topic, mqtt->devices, data, mqtt->hostname);
+        }
     }
 
     while (data) {
@@ -458,12 +742,21 @@ static void R_API_CALLCONV print_mqtt_data(data_output_t *output, data_t *data,
         data = data->next;
     }
     *orig = '\0'; // restore topic
+
+    if (top) {
+        mqtt->device = NULL;
+        // all fields of the event in one write
+        mqtt_client_flush(mqtt->mqc);
+    }
 }
 
 static void R_API_CALLCONV print_mqtt_string(data_output_t *output, char const *str, char const *format)
 {
     UNUSED(format);
     data_output_mqtt_t *mqtt = (data_output_mqtt_t *)output;
+    if (mqtt->dedup && mqtt->device
+            && !mqtt_field_changed(mqtt, mqtt->device, mqtt->topic + mqtt->device->prefix_len, str))
+        return;
     mqtt_client_publish(mqtt->mqc, mqtt->topic, str);
 }
 
@@ -506,6 +799,7 @@ static void R_API_CALLCONV data_output_mqtt_free(data_output_t *output)
     free(mqtt->states);
     //free(mqtt->homie);
     //free(mqtt->hass);
+    mqtt_device_clear(mqtt);
 
     mqtt_client_free(mqtt->mqc);
 
@@ -574,6 +868,7 @@ struct data_output *data_output_mqtt_create(struct mg_mgr *mgr, char *param, cha
 
     // parse host and port
     tls_opts_t tls_opts = {0};
+    spool_opts_t spool_opts = {0};
     if (param && strncmp(param, "mqtts", 5) == 0) {
         tls_opts.tls_ca_cert = "*"; // TLS is enabled but no cert verification is performed.
     }
@@ -600,6 +895,8 @@ struct data_output *data_output_mqtt_create(struct mg_mgr *mgr, char *param, cha
             qos = atoiv(val, 1);
         else if (!strcasecmp(key, "b") || !strcasecmp(key, "base"))
             base_topic = val;
+        else if (!strcasecmp(key, "dedup"))
+            mqtt->dedup = atoiv(val, 600);
         // LWT availability status topic
         else if (!strcasecmp(key, "a") || !strcasecmp(key, "availability"))
             mqtt->availability = mqtt_topic_default(val, base_topic, path_availability);
@@ -630,6 +927,9 @@ struct data_output *data_output_mqtt_create(struct mg_mgr *mgr, char *param, cha
         else if (!tls_param(&tls_opts, key, val)) {
             // ok
         }
+        else if (!spool_param(&spool_opts, key, val)) {
+            // ok
+        }
         else {
             print_logf(LOG_FATAL, __func__, "Invalid key \"%s\" option.", key);
             exit(1);
@@ -654,6 +954,13 @@ struct data_output *data_output_mqtt_create(struct mg_mgr *mgr, char *param, cha
     if (mqtt->states)
         print_logf(LOG_NOTICE, "MQTT", "Publishing states info to MQTT topic \"%s\".", mqtt->states);
 
+    char const *token_keys[MQTT_TOKEN_KEYS] = {"type", "model", "subtype", "channel", "id", "protocol"};
+    for (int i = 0; i < MQTT_TOKEN_KEYS; ++i) {
+        mqtt->token_keys[i] = data_intern(token_keys[i]);
+    }
+    if (mqtt->dedup && mqtt->devices)
+        print_logf(LOG_NOTICE, "MQTT", "Publishing changed device info only, all every %d seconds.", mqtt->dedup);
+
     mqtt->output.print_data   = print_mqtt_data;
     mqtt->output.print_array  = print_mqtt_array;
     mqtt->output.print_string = print_mqtt_string;
@@ -661,7 +968,7 @@ struct data_output *data_output_mqtt_create(struct mg_mgr *mgr, char *param, cha
     mqtt->output.print_int    = print_mqtt_int;
     mqtt->output.output_free  = data_output_mqtt_free;
 
-    mqtt->mqc = mqtt_client_init(mgr, &tls_opts, host, port, user, pass, client_id, retain, qos, mqtt->availability);
+    mqtt->mqc = mqtt_client_init(mgr, &tls_opts, &spool_opts, host, port, user, pass, client_id, retain, qos, mqtt->availability);
 
     return (struct data_output *)mqtt;
 }
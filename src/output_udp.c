@@ -186,9 +186,12 @@ static void R_API_CALLCONV data_output_syslog_print(data_output_t *output, data_
 
     abuf_printf(&msg, "<%d>1 %s %s rtl_433 - - - ", syslog->pri, timestamp, syslog->hostname);
 
-    msg.tail += data_print_jsons(data, msg.tail, msg.left);
-    if (msg.tail >= msg.head + sizeof(message))
+    size_t json_len;
+    char const *json = data_jsons(data, &json_len);
+    if (!json || json_len >= msg.left)
         return; // abort on overflow, we don't actually want to send more than fits the MTU
+    memcpy(msg.tail, json, json_len);
+    msg.tail += json_len;
 
     size_t abuf_len = msg.tail - msg.head;
     datagram_client_send(&syslog->client, message, abuf_len);
@@ -23,13 +23,17 @@ void pulse_data_clear(pulse_data_t *data)
     *data = (pulse_data_t const){0};
 }
 
-void pulse_data_shift(pulse_data_t *data)
+void pulse_data_continue(pulse_data_t *data)
 {
-    int offs = PD_MAX_PULSES / 2; // shift out half the data
-    memmove(data->pulse, &data->pulse[offs], (PD_MAX_PULSES - offs) * sizeof(*data->pulse));
-    memmove(data->gap, &data->gap[offs], (PD_MAX_PULSES - offs) * sizeof(*data->gap));
-    data->num_pulses -= offs;
-    data->offset += offs;
+    unsigned last = data->num_pulses;
+    for (unsigned n = 0; n < last; ++n) {
+        data->offset += data->pulse[n] + data->gap[n];
+    }
+    data->pulse[0]   = data->pulse[last];
+    data->gap[0]     = data->gap[last];
+    data->num_pulses = 1;
+    data->segment += 1;
+    data->continued = 0;
 }
 
 void pulse_data_print(pulse_data_t const *data)
@@ -125,6 +129,15 @@ void pulse_data_load(FILE *file, pulse_data_t *data, uint32_t sample_rate)
     int i    = 0;
     int size = sizeof(data->pulse) / sizeof(*data->pulse);
 
+    // the offset is not stored, a segment continues at the end of the previous one
+    uint64_t next_offset = 0;
+    if (data->continued) {
+        next_offset = data->offset;
+        for (unsigned n = 0; n < data->num_pulses; ++n) {
+            next_offset += data->pulse[n] + data->gap[n];
+        }
+    }
+
     pulse_data_clear(data);
     data->sample_rate = sample_rate;
     double to_sample  = sample_rate / 1e6;
@@ -137,6 +150,13 @@ void pulse_data_load(FILE *file, pulse_data_t *data, uint32_t sample_rate)
         if (!strncmp(s, ";freq2", 6)) {
             data->freq2_hz = strtol(s + 6, NULL, 10);
         }
+        if (!strncmp(s, ";segment", 8)) {
+            data->segment = strtol(s + 8, NULL, 10);
+            data->offset  = next_offset;
+        }
+        if (!strncmp(s, ";continued", 10)) {
+            data->continued = 1;
+        }
         if (*s == ';') {
             if (i) {
                 break; // end or next header found
@@ -197,6 +217,12 @@ void pulse_data_dump(FILE *file, pulse_data_t const *data)
         chk_ret(fprintf(file, ";ook %u pulses\n", data->num_pulses));
         chk_ret(fprintf(file, ";freq1 %.0f\n", data->freq1_hz));
     }
+    if (data->segment) {
+        chk_ret(fprintf(file, ";segment %u\n", data->segment));
+    }
+    if (data->continued) {
+        chk_ret(fprintf(file, ";continued\n"));
+    }
     chk_ret(fprintf(file, ";centerfreq %.0f Hz\n", data->centerfreq_hz));
     chk_ret(fprintf(file, ";samplerate %u Hz\n", data->sample_rate));
     chk_ret(fprintf(file, ";sampledepth %u bits\n", data->depth_bits));
@@ -209,6 +209,12 @@ int pulse_detect_package(pulse_detect_t *pulse_detect, int16_t const *envelope_d
         fsk_pulses->start_ago += len;
     }
 
+    if (fsk_pulses->continued) {
+        // Continue a long FSK package with the next segment
+        pulse_data_continue(fsk_pulses);
+        fsk_pulses->start_ago = len - s->data_counter;
+    }
+
     int eop_on_spurious = 0;
     // Process all new samples
     while (s->data_counter < len) {
@@ -304,8 +310,8 @@ int pulse_detect_package(pulse_detect_t *pulse_detect, int16_t const *envelope_d
                 // Or this gap is for real?
                 else if (s->pulse_length >= PD_MIN_PULSE_SAMPLES) {
                     s->ook_state = PD_OOK_STATE_GAP;
-                    // Determine if FSK modulation is detected
-                    if (fsk_pulses->num_pulses > PD_MIN_PULSES) {
+                    // Determine if FSK modulation is detected, the last segment of a continued package might be short
+                    if (fsk_pulses->num_pulses > PD_MIN_PULSES || fsk_pulses->segment > 0) {
                         // Store last pulse/gap
                         if (fpdm == FSK_PULSE_DETECT_OLD)
                             pulse_detect_fsk_wrap_up(&s->pulse_detect_fsk, fsk_pulses);
@@ -392,6 +398,25 @@ int pulse_detect_package(pulse_detect_t *pulse_detect, int16_t const *envelope_d
                 fprintf(stderr, "demod_OOK(): Unknown state!!\n");
                 s->ook_state = PD_OOK_STATE_IDLE;
         } // switch
+
+        // FSK pulse buffer full? Hand out a segment, the package continues in the next one
+        if (fsk_pulses->num_pulses >= PD_MAX_PULSES
+                && (s->ook_state == PD_OOK_STATE_PULSE || s->ook_state == PD_OOK_STATE_GAP_START)) {
+            // The last pulse might still be rewound, it carries over to the next segment
+            fsk_pulses->num_pulses -= 1;
+            fsk_pulses->continued = 1;
+            // Store estimates
+            fsk_pulses->fsk_f1_est = s->pulse_detect_fsk.fm_f1_est;
+            fsk_pulses->fsk_f2_est = s->pulse_detect_fsk.fm_f2_est;
+            fsk_pulses->ook_low_estimate = s->ook_low_estimate;
+            fsk_pulses->ook_high_estimate = s->ook_high_estimate;
+            fsk_pulses->end_ago = len - s->data_counter;
+            s->data_counter += 1;    // This sample is done
+            if (pulse_detect->verbosity >= LOG_INFO) {
+                print_att_hist("PULSE_DATA_FSK MAX_PULSES", att_hist);
+            }
+            return PULSE_DATA_FSK;    // End Of Segment
+        }
         s->data_counter += 1;
     } // while
 
@@ -106,13 +106,7 @@ void pulse_detect_fsk_classic(pulse_detect_fsk_t *s, int16_t fm_n, pulse_data_t
                     fsk_pulses->gap[fsk_pulses->num_pulses] = s->fsk_pulse_length;    // Store gap width
                     fsk_pulses->num_pulses += 1;    // Go to next pulse
                     s->fsk_pulse_length = 0;
-                    // When pulse buffer is full go to error state
-                    if (fsk_pulses->num_pulses >= PD_MAX_PULSES) {
-                        //fprintf(stderr, "pulse_detect_fsk_classic(): Maximum number of pulses reached!\n");
-                        //s->fsk_state = PD_FSK_STATE_ERROR;
-                        // TODO: workaround, specifically for the Inkbird-ITH20R: free some of the buffer
-                        pulse_data_shift(fsk_pulses);
-                    }
+                    // A full pulse buffer is handed out as a segment, see pulse_detect_package()
                 }
                 // Else rewind to last pulse
                 else {
@@ -197,13 +191,7 @@ void pulse_detect_fsk_minmax(pulse_detect_fsk_t *s, int16_t fm_n, pulse_data_t *
                     fsk_pulses->gap[fsk_pulses->num_pulses] = s->fsk_pulse_length;
                     fsk_pulses->num_pulses += 1;
                     s->fsk_pulse_length = 0;
-                    // When pulse buffer is full go to error state
-                    if (fsk_pulses->num_pulses >= PD_MAX_PULSES) {
-                        //fprintf(stderr, "pulse_detect_fsk_minmax(): Maximum number of pulses reached!\n");
-                        //s->fsk_state = PD_FSK_STATE_ERROR;
-                        // TODO: workaround, specifically for the Inkbird-ITH20R: free some of the buffer
-                        pulse_data_shift(fsk_pulses);
-                    }
+                    // A full pulse buffer is handed out as a segment, see pulse_detect_package()
                 }
                 s->fm_f1_est += fm_n / FSK_EST_SLOW - s->fm_f1_est / FSK_EST_SLOW; // Slow estimator
                 break;
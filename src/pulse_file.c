@@ -0,0 +1,627 @@
+/** @file
+    Binary pulse data file format with a seek index.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+/*
+File layout:
+
+    header:  "RPLS" u32 version, u64 created (us), u32 header size, u32 index stride, u64 reserved
+    records: u32 record size, u16 num_pulses, u8 segment (bit 7 continued, bits 0-6 segment number mod 128), u8 depth_bits,
+             u64 received time (us), u64 offset, u32 sample_rate, u32 start_ago, u32 end_ago,
+             i32 ook_low_estimate, i32 ook_high_estimate, i32 fsk_f1_est, i32 fsk_f2_est,
+             f32 freq1_hz, freq2_hz, centerfreq_hz, range_db, rssi_db, snr_db, noise_db,
+             then per pulse: varint zigzag(pulse - last pulse), varint zigzag(gap - last gap)
+    index:   u64 file offset of every stride-th record
+    trailer: u64 index offset, u64 records, u32 index entries, u32 index stride, u32 reserved, "RPLX"
+*/
+
+#include "pulse_file.h"
+#include "compat_time.h"
+#include "logger.h"
+#include "fatal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define PULSE_FILE_VERSION 1
+#define PULSE_HEADER_SIZE  32
+#define PULSE_RECORD_SIZE  80 // fixed part of a record
+#define PULSE_TRAILER_SIZE 32
+#define PULSE_VARINT_MAX   5 // a zigzag delta of two ints needs 33 bits
+
+struct pulse_writer {
+    FILE *file;
+    uint64_t pos; ///< bytes written so far
+    uint64_t records;
+    uint64_t *index;
+    unsigned index_len;
+    unsigned index_size;
+    int error;
+    uint8_t buf[PULSE_RECORD_SIZE + PD_MAX_PULSES * 2 * PULSE_VARINT_MAX];
+};
+
+struct pulse_reader {
+    uint8_t *map;
+    size_t size;
+    int mapped; ///< map is mmap'ed, otherwise malloc'ed
+    size_t data_end;
+    size_t pos;
+    unsigned records;
+    unsigned stride;
+    uint64_t *index;
+    unsigned index_len;
+    unsigned segment;   ///< segment number of the last package read
+    unsigned continued; ///< the last package read continues in the next one
+};
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = v & 0xff;
+    p[1] = v >> 8;
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    put_u16(p, v & 0xffff);
+    put_u16(p + 2, v >> 16);
+}
+
+static void put_u64(uint8_t *p, uint64_t v)
+{
+    put_u32(p, v & 0xffffffff);
+    put_u32(p + 4, v >> 32);
+}
+
+static void put_f32(uint8_t *p, float v)
+{
+    uint32_t u;
+    memcpy(&u, &v, sizeof(u));
+    put_u32(p, u);
+}
+
+static uint16_t get_u16(uint8_t const *p)
+{
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static uint32_t get_u32(uint8_t const *p)
+{
+    return (uint32_t)get_u16(p) | (uint32_t)get_u16(p + 2) << 16;
+}
+
+static uint64_t get_u64(uint8_t const *p)
+{
+    return (uint64_t)get_u32(p) | (uint64_t)get_u32(p + 4) << 32;
+}
+
+static float get_f32(uint8_t const *p)
+{
+    uint32_t u = get_u32(p);
+    float v;
+    memcpy(&v, &u, sizeof(v));
+    return v;
+}
+
+static unsigned put_varint(uint8_t *p, int64_t delta)
+{
+    uint64_t v = ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63); // zigzag
+    unsigned n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+/// Returns the bytes used, 0 if the varint is truncated or too long.
+static unsigned get_varint(uint8_t const *p, uint8_t const *end, int64_t *delta)
+{
+    uint64_t v = 0;
+    for (unsigned n = 0; n < PULSE_VARINT_MAX && p + n < end; ++n) {
+        v |= (uint64_t)(p[n] & 0x7f) << (7 * n);
+        if (!(p[n] & 0x80)) {
+            *delta = (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+static void pulse_writer_emit(pulse_writer_t *writer, void const *buf, size_t len)
+{
+    if (writer->error) {
+        return;
+    }
+    if (fwrite(buf, 1, len, writer->file) != len) {
+        print_logf(LOG_ERROR, "Pulse file", "Writing pulse data failed");
+        writer->error = 1;
+        return;
+    }
+    writer->pos += len;
+}
+
+pulse_writer_t *pulse_writer_create(FILE *file)
+{
+    pulse_writer_t *writer = calloc(1, sizeof(*writer));
+    if (!writer) {
+        WARN_CALLOC("pulse_writer_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    writer->file = file;
+
+    uint8_t hdr[PULSE_HEADER_SIZE] = {'R', 'P', 'L', 'S'};
+    put_u32(&hdr[4], PULSE_FILE_VERSION);
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    put_u64(&hdr[8], (uint64_t)now.tv_sec * 1000000 + now.tv_usec);
+    put_u32(&hdr[16], PULSE_HEADER_SIZE);
+    put_u32(&hdr[20], PULSE_FILE_INDEX_STRIDE);
+    pulse_writer_emit(writer, hdr, sizeof(hdr));
+
+    return writer;
+}
+
+int pulse_writer_write(pulse_writer_t *writer, pulse_data_t const *data, struct timeval const *now)
+{
+    if (writer->records % PULSE_FILE_INDEX_STRIDE == 0) {
+        if (writer->index_len == writer->index_size) {
+            unsigned size = writer->index_size ? writer->index_size * 2 : 64;
+            uint64_t *index = realloc(writer->index, size * sizeof(*index));
+            if (!index) {
+                WARN_REALLOC("pulse_writer_write()");
+                return -1;
+            }
+            writer->index      = index;
+            writer->index_size = size;
+        }
+        writer->index[writer->index_len++] = writer->pos;
+    }
+
+    unsigned num_pulses = data->num_pulses < PD_MAX_PULSES ? data->num_pulses : PD_MAX_PULSES;
+    uint8_t *p = writer->buf;
+    put_u16(&p[4], (uint16_t)num_pulses);
+    p[6] = (uint8_t)((data->continued ? 0x80 : 0) | (data->segment & 0x7f));
+    p[7] = (uint8_t)data->depth_bits;
+    put_u64(&p[8], (uint64_t)now->tv_sec * 1000000 + now->tv_usec);
+    put_u64(&p[16], data->offset);
+    put_u32(&p[24], data->sample_rate);
+    put_u32(&p[28], data->start_ago);
+    put_u32(&p[32], data->end_ago);
+    put_u32(&p[36], (uint32_t)data->ook_low_estimate);
+    put_u32(&p[40], (uint32_t)data->ook_high_estimate);
+    put_u32(&p[44], (uint32_t)data->fsk_f1_est);
+    put_u32(&p[48], (uint32_t)data->fsk_f2_est);
+    put_f32(&p[52], data->freq1_hz);
+    put_f32(&p[56], data->freq2_hz);
+    put_f32(&p[60], data->centerfreq_hz);
+    put_f32(&p[64], data->range_db);
+    put_f32(&p[68], data->rssi_db);
+    put_f32(&p[72], data->snr_db);
+    put_f32(&p[76], data->noise_db);
+
+    unsigned len = PULSE_RECORD_SIZE;
+    int64_t last_pulse = 0;
+    int64_t last_gap   = 0;
+    for (unsigned i = 0; i < num_pulses; ++i) {
+        len += put_varint(&p[len], data->pulse[i] - last_pulse);
+        len += put_varint(&p[len], data->gap[i] - last_gap);
+        last_pulse = data->pulse[i];
+        last_gap   = data->gap[i];
+    }
+    put_u32(&p[0], len);
+
+    pulse_writer_emit(writer, p, len);
+    writer->records += 1;
+    return writer->error ? -1 : 0;
+}
+
+void pulse_writer_free(pulse_writer_t *writer)
+{
+    if (!writer) {
+        return;
+    }
+
+    uint64_t index_off = writer->pos;
+    for (unsigned i = 0; i < writer->index_len; ++i) {
+        uint8_t entry[8];
+        put_u64(entry, writer->index[i]);
+        pulse_writer_emit(writer, entry, sizeof(entry));
+    }
+    uint8_t trailer[PULSE_TRAILER_SIZE] = {0};
+    put_u64(&trailer[0], index_off);
+    put_u64(&trailer[8], writer->records);
+    put_u32(&trailer[16], writer->index_len);
+    put_u32(&trailer[20], PULSE_FILE_INDEX_STRIDE);
+    memcpy(&trailer[28], "RPLX", 4);
+    pulse_writer_emit(writer, trailer, sizeof(trailer));
+    fflush(writer->file);
+
+    free(writer->index);
+    free(writer);
+}
+
+/// Read all of a non-seekable stream, returns 0 on success.
+static int pulse_reader_slurp(pulse_reader_t *reader, FILE *file)
+{
+    size_t size = 0;
+    size_t alloc = 1024 * 1024;
+    uint8_t *buf = malloc(alloc);
+    if (!buf) {
+        WARN_MALLOC("pulse_reader_slurp()");
+        return -1;
+    }
+    size_t n;
+    while ((n = fread(buf + size, 1, alloc - size, file)) > 0) {
+        size += n;
+        if (size == alloc) {
+            alloc *= 2;
+            uint8_t *next = realloc(buf, alloc);
+            if (!next) {
+                WARN_REALLOC("pulse_reader_slurp()");
+                free(buf);
+                return -1;
+            }
+            buf = next;
+        }
+    }
+    reader->map  = buf;
+    reader->size = size;
+    return 0;
+}
+
+static int pulse_reader_map(pulse_reader_t *reader, FILE *file)
+{
+#ifndef _WIN32
+    struct stat st;
+    int fd = fileno(file);
+    if (fd >= 0 && fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+#ifdef MADV_SEQUENTIAL
+            madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+            reader->map    = map;
+            reader->size   = (size_t)st.st_size;
+            reader->mapped = 1;
+            return 0;
+        }
+    }
+#endif
+    return pulse_reader_slurp(reader, file);
+}
+
+static int pulse_reader_use_trailer(pulse_reader_t *reader)
+{
+    if (reader->size < PULSE_HEADER_SIZE + PULSE_TRAILER_SIZE) {
+        return -1;
+    }
+    uint8_t const *trailer = reader->map + reader->size - PULSE_TRAILER_SIZE;
+    if (memcmp(&trailer[28], "RPLX", 4)) {
+        return -1;
+    }
+    uint64_t index_off = get_u64(&trailer[0]);
+    uint64_t records   = get_u64(&trailer[8]);
+    uint32_t index_len = get_u32(&trailer[16]);
+    uint32_t stride    = get_u32(&trailer[20]);
+    uint64_t index_end = reader->size - PULSE_TRAILER_SIZE;
+    if (index_off < PULSE_HEADER_SIZE || index_off > index_end
+            || (uint64_t)index_len * 8 != index_end - index_off
+            || stride == 0 || records > UINT32_MAX
+            || index_len != (records + stride - 1) / stride) {
+        return -1;
+    }
+
+    if (index_len) {
+        reader->index = malloc(index_len * sizeof(*reader->index));
+        if (!reader->index) {
+            WARN_MALLOC("pulse_reader_use_trailer()");
+            return -1;
+        }
+    }
+    for (unsigned i = 0; i < index_len; ++i) {
+        reader->index[i] = get_u64(reader->map + index_off + i * 8);
+        if (reader->index[i] < PULSE_HEADER_SIZE || reader->index[i] >= index_off) {
+            free(reader->index);
+            reader->index = NULL;
+            return -1;
+        }
+    }
+    reader->index_len = index_len;
+    reader->stride    = stride;
+    reader->records   = (unsigned)records;
+    reader->data_end  = (size_t)index_off;
+    return 0;
+}
+
+/// Rebuild the index of a file without trailer, returns 0 on success.
+static int pulse_reader_scan(pulse_reader_t *reader)
+{
+    unsigned size = 0;
+    size_t pos    = PULSE_HEADER_SIZE;
+    reader->stride = PULSE_FILE_INDEX_STRIDE;
+    while (pos + PULSE_RECORD_SIZE <= reader->size) {
+        uint32_t len = get_u32(reader->map + pos);
+        if (len < PULSE_RECORD_SIZE || len > reader->size - pos) {
+            break;
+        }
+        if (reader->records % reader->stride == 0) {
+            if (reader->index_len == size) {
+                size = size ? size * 2 : 64;
+                uint64_t *index = realloc(reader->index, size * sizeof(*index));
+                if (!index) {
+                    WARN_REALLOC("pulse_reader_scan()");
+                    return -1;
+                }
+                reader->index = index;
+            }
+            reader->index[reader->index_len++] = pos;
+        }
+        reader->records += 1;
+        pos += len;
+    }
+    if (pos != reader->size) {
+        print_logf(LOG_WARNING, "Pulse file", "Pulse file is truncated, read %u packages", reader->records);
+    }
+    reader->data_end = pos;
+    return 0;
+}
+
+pulse_reader_t *pulse_reader_open(FILE *file)
+{
+    pulse_reader_t *reader = calloc(1, sizeof(*reader));
+    if (!reader) {
+        WARN_CALLOC("pulse_reader_open()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+
+    if (pulse_reader_map(reader, file)) {
+        pulse_reader_free(reader);
+        return NULL;
+    }
+    if (reader->size < PULSE_HEADER_SIZE
+            || memcmp(reader->map, "RPLS", 4)
+            || get_u32(reader->map + 4) != PULSE_FILE_VERSION
+            || get_u32(reader->map + 16) != PULSE_HEADER_SIZE) {
+        print_logf(LOG_ERROR, "Pulse file", "Not a pulse file (version %u)", PULSE_FILE_VERSION);
+        pulse_reader_free(reader);
+        return NULL;
+    }
+    if (pulse_reader_use_trailer(reader) && pulse_reader_scan(reader)) {
+        pulse_reader_free(reader);
+        return NULL;
+    }
+    reader->pos = PULSE_HEADER_SIZE;
+    return reader;
+}
+
+unsigned pulse_reader_count(pulse_reader_t const *reader)
+{
+    return reader->records;
+}
+
+int pulse_reader_seek(pulse_reader_t *reader, unsigned idx)
+{
+    if (idx > reader->records) {
+        return -1;
+    }
+    if (idx == reader->records) {
+        reader->pos = reader->data_end;
+        return 0;
+    }
+    size_t pos = (size_t)reader->index[idx / reader->stride];
+    for (unsigned n = idx % reader->stride; n > 0; --n) {
+        uint32_t len = get_u32(reader->map + pos);
+        if (len < PULSE_RECORD_SIZE || len > reader->data_end - pos) {
+            return -1;
+        }
+        pos += len;
+    }
+    reader->pos       = pos;
+    reader->continued = 0;
+    return 0;
+}
+
+int pulse_reader_read(pulse_reader_t *reader, pulse_data_t *data, struct timeval *now)
+{
+    *data = (pulse_data_t const){0};
+    if (reader->pos + PULSE_RECORD_SIZE > reader->data_end) {
+        return 0;
+    }
+    uint8_t const *p = reader->map + reader->pos;
+    uint32_t len     = get_u32(&p[0]);
+    if (len < PULSE_RECORD_SIZE || len > reader->data_end - reader->pos) {
+        return -1;
+    }
+    unsigned num_pulses = get_u16(&p[4]);
+    if (num_pulses > PD_MAX_PULSES) {
+        return -1;
+    }
+    if (now) {
+        uint64_t received = get_u64(&p[8]);
+        now->tv_sec       = (time_t)(received / 1000000);
+        now->tv_usec      = (long)(received % 1000000);
+    }
+    // segment numbers are stored modulo 128, count on through a long package
+    unsigned segment = p[6] & 0x7f;
+    if (reader->continued && segment == ((reader->segment + 1) & 0x7f))
+        segment = reader->segment + 1;
+    data->segment           = segment;
+    data->continued         = p[6] >> 7;
+    data->num_pulses        = num_pulses;
+    data->depth_bits        = p[7];
+    data->offset            = get_u64(&p[16]);
+    data->sample_rate       = get_u32(&p[24]);
+    data->start_ago         = get_u32(&p[28]);
+    data->end_ago           = get_u32(&p[32]);
+    data->ook_low_estimate  = (int32_t)get_u32(&p[36]);
+    data->ook_high_estimate = (int32_t)get_u32(&p[40]);
+    data->fsk_f1_est        = (int32_t)get_u32(&p[44]);
+    data->fsk_f2_est        = (int32_t)get_u32(&p[48]);
+    data->freq1_hz          = get_f32(&p[52]);
+    data->freq2_hz          = get_f32(&p[56]);
+    data->centerfreq_hz     = get_f32(&p[60]);
+    data->range_db          = get_f32(&p[64]);
+    data->rssi_db           = get_f32(&p[68]);
+    data->snr_db            = get_f32(&p[72]);
+    data->noise_db          = get_f32(&p[76]);
+
+    uint8_t const *v   = &p[PULSE_RECORD_SIZE];
+    uint8_t const *end = &p[len];
+    int64_t pulse      = 0;
+    int64_t gap        = 0;
+    for (unsigned i = 0; i < num_pulses; ++i) {
+        int64_t delta;
+        unsigned n = get_varint(v, end, &delta);
+        if (!n) {
+            return -1;
+        }
+        v += n;
+        pulse += delta;
+        n = get_varint(v, end, &delta);
+        if (!n) {
+            return -1;
+        }
+        v += n;
+        gap += delta;
+        data->pulse[i] = (int)pulse;
+        data->gap[i]   = (int)gap;
+    }
+
+    reader->pos += len;
+    reader->segment   = data->segment;
+    reader->continued = data->continued;
+    return 1;
+}
+
+void pulse_reader_free(pulse_reader_t *reader)
+{
+    if (!reader) {
+        return;
+    }
+#ifndef _WIN32
+    if (reader->mapped) {
+        munmap(reader->map, reader->size);
+    }
+    else
+#endif
+    {
+        free(reader->map);
+    }
+    free(reader->index);
+    free(reader);
+}
+
+#if defined(_TEST) && !defined(_WIN32)
+#include <unistd.h>
+
+#define ASSERT_EQUALS(a, b)                                                     \
+    do {                                                                        \
+        if ((a) == (b))                                                         \
+            ++passed;                                                           \
+        else {                                                                  \
+            ++failed;                                                           \
+            fprintf(stderr, "FAIL line %d: %ld <> %ld\n", __LINE__, (long)(a), (long)(b)); \
+        }                                                                       \
+    } while (0)
+
+int main(void)
+{
+    unsigned passed = 0;
+    unsigned failed = 0;
+    static pulse_data_t data;
+    static pulse_data_t back;
+
+    FILE *file = tmpfile();
+    if (!file) {
+        perror("tmpfile");
+        return 1;
+    }
+
+    fprintf(stderr, "pulse_file:: write\n");
+    pulse_writer_t *writer = pulse_writer_create(file);
+    ASSERT_EQUALS(writer != NULL, 1);
+    struct timeval now = {1700000000, 0};
+    struct timeval then;
+    for (int k = 0; k < 200; ++k) {
+        memset(&data, 0, sizeof(data));
+        data.num_pulses  = k % 2 ? PD_MAX_PULSES : (unsigned)k;
+        data.sample_rate = 250000;
+        data.offset      = 1000000ull * k;
+        data.fsk_f2_est  = k % 3 ? 0 : -1234;
+        data.rssi_db     = -k * 0.5f;
+        data.segment     = (unsigned)k; // a long package, past the 7 bits stored
+        data.continued   = k < 199;
+        for (unsigned i = 0; i < data.num_pulses; ++i) {
+            data.pulse[i] = 100 + (int)(i * 7 + k) % 500;
+            data.gap[i]   = i == data.num_pulses - 1 ? 250000 : 200 - (int)(i % 3) * 100;
+        }
+        now.tv_usec = k * 1000;
+        ASSERT_EQUALS(pulse_writer_write(writer, &data, &now), 0);
+    }
+    long data_end = ftell(file);
+    pulse_writer_free(writer);
+
+    fprintf(stderr, "pulse_file:: read back\n");
+    rewind(file);
+    pulse_reader_t *reader = pulse_reader_open(file);
+    ASSERT_EQUALS(reader != NULL, 1);
+    ASSERT_EQUALS(pulse_reader_count(reader), 200);
+    int k = 0;
+    while (pulse_reader_read(reader, &back, &then) > 0) {
+        ASSERT_EQUALS(then.tv_sec, 1700000000);
+        ASSERT_EQUALS(then.tv_usec, k * 1000);
+        ASSERT_EQUALS(back.num_pulses, k % 2 ? PD_MAX_PULSES : (unsigned)k);
+        ASSERT_EQUALS(back.offset, 1000000ull * k);
+        ASSERT_EQUALS(back.fsk_f2_est, k % 3 ? 0 : -1234);
+        ASSERT_EQUALS(back.rssi_db == -k * 0.5f, 1);
+        ASSERT_EQUALS(back.segment, (unsigned)k);
+        ASSERT_EQUALS(back.continued, k < 199);
+        int same = 1;
+        for (unsigned i = 0; i < back.num_pulses; ++i) {
+            same &= back.pulse[i] == 100 + (int)(i * 7 + k) % 500;
+            same &= back.gap[i] == (i == back.num_pulses - 1 ? 250000 : 200 - (int)(i % 3) * 100);
+        }
+        ASSERT_EQUALS(same, 1);
+        k++;
+    }
+    ASSERT_EQUALS(k, 200);
+
+    fprintf(stderr, "pulse_file:: seek\n");
+    ASSERT_EQUALS(pulse_reader_seek(reader, 131), 0);
+    ASSERT_EQUALS(pulse_reader_read(reader, &back, NULL), 1);
+    ASSERT_EQUALS(back.offset, 131000000ull);
+    ASSERT_EQUALS(pulse_reader_seek(reader, 200), 0);
+    ASSERT_EQUALS(pulse_reader_read(reader, &back, NULL), 0);
+    ASSERT_EQUALS(pulse_reader_seek(reader, 201), -1);
+    pulse_reader_free(reader);
+
+    fprintf(stderr, "pulse_file:: no trailer\n");
+    fflush(file);
+    ASSERT_EQUALS(ftruncate(fileno(file), data_end), 0);
+    rewind(file);
+    reader = pulse_reader_open(file);
+    ASSERT_EQUALS(reader != NULL, 1);
+    ASSERT_EQUALS(pulse_reader_count(reader), 200);
+    ASSERT_EQUALS(pulse_reader_seek(reader, 64), 0);
+    ASSERT_EQUALS(pulse_reader_read(reader, &back, NULL), 1);
+    ASSERT_EQUALS(back.offset, 64000000ull);
+    pulse_reader_free(reader);
+    fclose(file);
+
+    fprintf(stderr, "pulse_file:: test (%u/%u) passed, (%u) failed.\n", passed, passed + failed, failed);
+    return failed > 0;
+}
+#endif /* _TEST */
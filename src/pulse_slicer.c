@@ -14,11 +14,16 @@
 #include "pulse_slicer.h"
 #include "pulse_data.h"
 #include "bitbuffer.h"
-#include "c_util.h" // for MIN()
+#include "c_util.h" // for MIN(), MAX()
 #include "logger.h"
 #include "decoder_util.h" // TODO: this should be refactored
+#include "fatal.h"
+#include "compat_time.h"
+#include "compat_pthread.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
 #include <stdint.h>
 #include <math.h>
 #include <limits.h>
@@ -27,7 +32,12 @@ static int account_event(r_device *device, bitbuffer_t *bits, char const *demod_
 {
     // run decoder
     int ret = 0;
-    if (device->decode_fn) {
+    if (device->decode_fn && device->decode_timing) {
+        uint64_t start = time_monotonic_ns();
+        ret = device->decode_fn(device, bits);
+        device->decode_ns += time_monotonic_ns() - start;
+    }
+    else if (device->decode_fn) {
         ret = device->decode_fn(device, bits);
     }
 
@@ -62,7 +72,183 @@ static int account_event(r_device *device, bitbuffer_t *bits, char const *demod_
     return ret;
 }
 
-int pulse_slicer_pcm(pulse_data_t const *pulses, r_device *device)
+/// Account a message that can't meet the decoder limits as if the decoder returned @p ret.
+static int account_reject(r_device *device, int ret)
+{
+    device->decode_events += 1;
+    device->decode_fails[-ret] += 1;
+    return 0;
+}
+
+/// Check if the decoder limits apply, in verbose mode the decoder always runs.
+static int slice_limits_active(r_device const *device)
+{
+    return device->decode_fn && !device->verbose
+            && (device->min_rows || device->max_rows || device->min_bits || device->max_bits || device->preamble_bits);
+}
+
+/// Check the bits of a message against the decoder limits, returns the reject code if they can't be met.
+///
+/// The limits are checked in the order rows, bits, preamble, the code of the first
+/// failed limit is returned, see r_device::rows_reject etc.
+///
+/// While slicing (@p partial) more bits and rows may follow, only the limits that can't
+/// recover are checked, the bit count only on the last row. A failure is only final if
+/// no earlier limit with a different code could still fail once the message ends.
+static int slice_limits_fail(r_device const *device, bitbuffer_t const *bits, int partial)
+{
+    int const rows_reject     = device->rows_reject ? device->rows_reject : DECODE_ABORT_LENGTH;
+    int const bits_reject     = device->bits_reject ? device->bits_reject : DECODE_ABORT_LENGTH;
+    int const preamble_reject = device->preamble_reject ? device->preamble_reject : DECODE_ABORT_EARLY;
+    int const rows_open = partial && (device->min_rows || device->max_rows);
+    int const bits_open = partial && (device->min_bits || device->max_bits);
+
+    unsigned num_rows = bits->num_rows;
+    if (device->max_rows && num_rows > device->max_rows)
+        return rows_reject;
+    if (!partial && num_rows < device->min_rows)
+        return rows_reject;
+
+    if (device->max_bits || (!partial && device->min_bits)) {
+        unsigned longest = 0;
+        for (unsigned row = partial && num_rows ? num_rows - 1 : 0; row < num_rows; ++row)
+            longest = MAX(longest, bits->bits_per_row[row]);
+        if (device->max_bits && longest > device->max_bits
+                && !(rows_open && rows_reject != bits_reject))
+            return bits_reject;
+        if (!partial && longest < device->min_bits)
+            return bits_reject;
+    }
+
+    if (device->preamble_bits
+            && !(rows_open && rows_reject != preamble_reject)
+            && !(bits_open && bits_reject != preamble_reject)) {
+        unsigned len = num_rows ? bits->bits_per_row[0] : 0;
+        // the first row is complete once the next one started
+        if (len < device->preamble_bits && (!partial || num_rows > 1))
+            return preamble_reject;
+        len = MIN(len, device->preamble_bits);
+        uint8_t const *b = bits->bb[0];
+        unsigned bytes   = len / 8;
+        unsigned rest    = len % 8;
+        if (memcmp(b, device->preamble, bytes)
+                || (rest && (b[bytes] ^ device->preamble[bytes]) >> (8 - rest)))
+            return preamble_reject;
+    }
+
+    return 0;
+}
+
+/// Run the decoder on a message, unless the bits can't meet the decoder limits.
+static int slice_decode(r_device *device, bitbuffer_t *bits, char const *demod_name)
+{
+    int reject = slice_limits_active(device) ? slice_limits_fail(device, bits, 0) : 0;
+    if (reject)
+        return account_reject(device, reject);
+    return account_event(device, bits, demod_name);
+}
+
+/// Cached bits of all messages a slicer produced for one set of timings.
+struct slice_entry {
+    int (*slicer)(pulse_data_t const *pulses, r_device *device, slice_entry_t *rec);
+    float short_width;
+    float long_width;
+    float reset_limit;
+    float gap_limit;
+    float sync_width;
+    float tolerance;
+    char const *demod_name;
+    list_t bits; ///< copies of each bitbuffer_t passed to the decoder
+};
+
+/// Size of the used part of a bitbuffer, i.e. up to the last row including spilled bits.
+static size_t bitbuffer_used_size(bitbuffer_t const *bits)
+{
+    return offsetof(bitbuffer_t, bb) + bitbuffer_rows_used(bits) * sizeof(bitrow_t);
+}
+
+/// The bits of the slicers, one buffer per thread instead of clearing a new one on the stack.
+static THREAD_LOCAL bitbuffer_t slice_bits;
+
+/// Get the slicer bits, only the rows used before are cleared.
+///
+/// The slicers and the slice cache replay use the buffer, decoders must not reenter them.
+static bitbuffer_t *slice_bits_get(void)
+{
+    bitbuffer_reset(&slice_bits);
+    return &slice_bits;
+}
+
+/// Record a copy of the bits for decoders with the same timing, then run the decoder.
+static int slice_event(r_device *device, bitbuffer_t *bits, char const *demod_name, slice_entry_t *rec)
+{
+    if (rec) {
+        // the decoder is free to modify the bits, copy first, the slicers clear the bits for each event
+        size_t size = bitbuffer_used_size(bits);
+        bitbuffer_t *copy = malloc(size);
+        if (!copy)
+            FATAL_MALLOC("slice_event()");
+        memcpy(copy, bits, size);
+        list_push(&rec->bits, copy);
+        rec->demod_name = demod_name;
+    }
+    return slice_decode(device, bits, demod_name);
+}
+
+/// Slicer state of a message that continues in the next segment of a long package.
+struct slice_stream {
+    int pending;          ///< a message continues in the next segment
+    unsigned segment;     ///< the segment the message was left in
+    uint64_t next_offset; ///< offset of the next segment
+    int reject;           ///< the message can't meet the decoder limits
+    float f_short;        ///< PCM pulse width reciprocal, tuned at the start of the package
+    float f_long;         ///< PCM bit period reciprocal, tuned at the start of the package
+    int time_since_last;  ///< Manchester samples since the last data edge
+    bitbuffer_t bits;     ///< the bits of the message so far
+};
+
+/// Restore the message the decoder left at the end of the previous segment, returns NULL if there is none.
+static slice_stream_t *slice_stream_resume(pulse_data_t const *pulses, r_device *device, bitbuffer_t *bits)
+{
+    slice_stream_t *stream = device->slice_stream;
+    if (!stream || !stream->pending)
+        return NULL;
+
+    stream->pending = 0;
+    // the decoder might have been skipped for a segment or another package came in between
+    if (pulses->segment != stream->segment + 1 || pulses->offset != stream->next_offset)
+        return NULL;
+
+    memcpy(bits, &stream->bits, bitbuffer_used_size(&stream->bits));
+    return stream;
+}
+
+/// Keep the message in progress at the end of a continued segment, returns NULL on alloc failure.
+static slice_stream_t *slice_stream_save(pulse_data_t const *pulses, r_device *device, bitbuffer_t const *bits, int reject)
+{
+    slice_stream_t *stream = device->slice_stream;
+    if (!stream) {
+        stream = calloc(1, sizeof(*stream));
+        if (!stream) {
+            WARN_CALLOC("slice_stream_save()");
+            return NULL; // NOTE: returns NULL on alloc failure.
+        }
+        device->slice_stream = stream;
+    }
+
+    uint64_t next_offset = pulses->offset;
+    for (unsigned n = 0; n < pulses->num_pulses; ++n) {
+        next_offset += pulses->pulse[n] + pulses->gap[n];
+    }
+    stream->pending     = 1;
+    stream->segment     = pulses->segment;
+    stream->next_offset = next_offset;
+    stream->reject      = reject;
+    memcpy(&stream->bits, bits, bitbuffer_used_size(bits));
+    return stream;
+}
+
+static int slice_pcm(pulse_data_t const *pulses, r_device *device, slice_entry_t *rec)
 {
     float samples_per_us = pulses->sample_rate / 1.0e6f;
     int s_short = device->short_width * samples_per_us;
@@ -79,7 +265,7 @@ int pulse_slicer_pcm(pulse_data_t const *pulses, r_device *device)
             || (device->gap_limit > 0 && s_gap <= 0)
             || (device->sync_width > 0 && s_sync <= 0)
             || (device->tolerance > 0 && s_tolerance <= 0)) {
-        print_logf(LOG_WARNING, __func__, "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
+        print_logf(LOG_WARNING, "pulse_slicer_pcm", "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
         return 0;
     }
 
@@ -88,7 +274,16 @@ int pulse_slicer_pcm(pulse_data_t const *pulses, r_device *device)
     float f_long  = device->long_width > 0.0f ? 1.0f / (device->long_width * samples_per_us) : 0;
 
     int events = 0;
-    bitbuffer_t bits = {0};
+    bitbuffer_t *bits = slice_bits_get();
+    // continue a message from the previous segment with the bit period tuned there
+    slice_stream_t *stream = slice_stream_resume(pulses, device, bits);
+    if (stream) {
+        f_short = stream->f_short;
+        f_long  = stream->f_long;
+    }
+    // stop adding bits once a message can't meet the decoder limits, cached bits must be complete
+    int const early = !rec && slice_limits_active(device);
+    int reject      = stream ? stream->reject : 0;
 
     int const gap_limit = s_gap ? s_gap : s_reset;
     int const max_zeros = gap_limit / s_long;
@@ -99,7 +294,7 @@ int pulse_slicer_pcm(pulse_data_t const *pulses, r_device *device)
     int min_count = s_short == s_long ? 12 : 4;
     int preamble_len = 0;
     // RZ
-    for (unsigned n = 0; s_short != s_long && n < pulses->num_pulses; ++n) {
+    for (unsigned n = 0; !stream && s_short != s_long && n < pulses->num_pulses; ++n) {
         int swidth = 0;
         int lwidth = 0;
         int count = 0;
@@ -121,7 +316,7 @@ int pulse_slicer_pcm(pulse_data_t const *pulses, r_device *device)
             preamble_len = count;
             if (device->verbose > 1) {
                 float to_us = 1e6f / pulses->sample_rate;
-                print_logf(LOG_INFO, __func__, "Exact bit width (in us) is %.2f vs %.2f (pulse width %.2f vs %.2f), %d bit preamble",
+                print_logf(LOG_INFO, "pulse_slicer_pcm", "Exact bit width (in us) is %.2f vs %.2f (pulse width %.2f vs %.2f), %d bit preamble",
                         to_us / f_long, to_us * s_long,
                         to_us / f_short, to_us * s_short, count);
             }
@@ -131,7 +326,7 @@ int pulse_slicer_pcm(pulse_data_t const *pulses, r_device *device)
     int rzs_width = 0;
     int rzl_width = 0;
     int rz_count = 0;
-    for (unsigned n = 0; preamble_len == 0 && s_short != s_long && n < pulses->num_pulses; ++n) {
+    for (unsigned n = 0; !stream && preamble_len == 0 && s_short != s_long && n < pulses->num_pulses; ++n) {
         if (pulses->pulse[n] >= s_short - s_tolerance
                 && pulses->pulse[n] <= s_short + s_tolerance
                 && pulses->pulse[n] + pulses->gap[n] >= s_long - s_tolerance
@@ -147,13 +342,13 @@ int pulse_slicer_pcm(pulse_data_t const *pulses, r_device *device)
         f_short = (float)rz_count / rzs_width;
         if (device->verbose > 1) {
             float to_us = 1e6 / pulses->sample_rate;
-            print_logf(LOG_INFO, __func__, "Exact bit width (in us) is %.2f vs %.2f (pulse width %.2f vs %.2f), %d bit measured",
+            print_logf(LOG_INFO, "pulse_slicer_pcm", "Exact bit width (in us) is %.2f vs %.2f (pulse width %.2f vs %.2f), %d bit measured",
                     to_us / f_long, to_us * s_long,
                     to_us / f_short, to_us * s_short, rz_count);
         }
     }
     // NRZ
-    for (unsigned n = 0; s_short == s_long && n < pulses->num_pulses; ++n) {
+    for (unsigned n = 0; !stream && s_short == s_long && n < pulses->num_pulses; ++n) {
         int width = 0;
         int count = 0;
         while (n < pulses->num_pulses
@@ -170,7 +365,7 @@ int pulse_slicer_pcm(pulse_data_t const *pulses, r_device *device)
             preamble_len = count;
             if (device->verbose > 1) {
                 float to_us = 1e6f / pulses->sample_rate;
-                print_logf(LOG_INFO, __func__, "Exact bit width (in us) is %.2f vs %.2f, %d bit preamble",
+                print_logf(LOG_INFO, "pulse_slicer_pcm", "Exact bit width (in us) is %.2f vs %.2f, %d bit preamble",
                         to_us / f_short, to_us * s_short, count);
             }
         }
@@ -178,7 +373,7 @@ int pulse_slicer_pcm(pulse_data_t const *pulses, r_device *device)
     // NRZ pulse/gap of len 1 or 2 within tolerance anywhere
     int nrz_width = 0;
     int nrz_count = 0;
-    for (unsigned n = 0; preamble_len == 0 && s_short == s_long && n < pulses->num_pulses; ++n) {
+    for (unsigned n = 0; !stream && preamble_len == 0 && s_short == s_long && n < pulses->num_pulses; ++n) {
         if (pulses->pulse[n] >= s_short - s_tolerance
                 && pulses->pulse[n] <= s_short + s_tolerance) {
             nrz_width += pulses->pulse[n];
@@ -205,7 +400,7 @@ int pulse_slicer_pcm(pulse_data_t const *pulses, r_device *device)
         f_short = f_long = (float)nrz_count / nrz_width;
         if (device->verbose > 1) {
             float to_us = 1e6 / pulses->sample_rate;
-            print_logf(LOG_INFO, __func__, "%s: Exact bit width (in us) is %.2f vs %.2f, %d bit measured", device->name,
+            print_logf(LOG_INFO, "pulse_slicer_pcm", "%s: Exact bit width (in us) is %.2f vs %.2f, %d bit measured", device->name,
                     to_us / f_short, to_us * s_short, nrz_count);
         }
     }
@@ -217,14 +412,18 @@ int pulse_slicer_pcm(pulse_data_t const *pulses, r_device *device)
         // for RZ subtract the nominal bit-gap
         int lows = (pulses->gap[n] + s_short - s_long) * f_long + 0.5f;
 
-        // Add run of ones (1 for RZ, many for NRZ)
-        for (int i = 0; i < highs; ++i) {
-            bitbuffer_add_bit(&bits, 1);
-        }
-        // Add run of zeros, handle possibly negative "lows" gracefully
-        lows = MIN(lows, max_zeros); // Don't overflow at end of message
-        for (int i = 0; i < lows; ++i) {
-            bitbuffer_add_bit(&bits, 0);
+        if (!reject) {
+            // Add run of ones (1 for RZ, many for NRZ)
+            for (int i = 0; i < highs; ++i) {
+                bitbuffer_add_bit(bits, 1);
+            }
+            // Add run of zeros, handle possibly negative "lows" gracefully
+            lows = MIN(lows, max_zeros); // Don't overflow at end of message
+            for (int i = 0; i < lows; ++i) {
+                bitbuffer_add_bit(bits, 0);
+            }
+            if (early)
+                reject = slice_limits_fail(device, bits, 1);
         }
 
         // Validate data
@@ -233,30 +432,41 @@ int pulse_slicer_pcm(pulse_data_t const *pulses, r_device *device)
 
             // Data is corrupt
             if (device->verbose > 3) {
-                print_logf(LOG_TRACE, __func__, "bitbuffer cleared at %u: pulse %d, gap %d, period %d",
+                print_logf(LOG_TRACE, "pulse_slicer_pcm", "bitbuffer cleared at %u: pulse %d, gap %d, period %d",
                         n, pulses->pulse[n], pulses->gap[n],
                         pulses->pulse[n] + pulses->gap[n]);
             }
-            bitbuffer_clear(&bits);
+            bitbuffer_reset(bits);
+            reject = 0;
         }
 
         // Check for new packet in multipacket
         else if (pulses->gap[n] > gap_limit && pulses->gap[n] <= s_reset) {
-            bitbuffer_add_row(&bits);
+            bitbuffer_add_row(bits);
         }
         // End of Message?
-        if (((n == pulses->num_pulses - 1)                            // No more pulses? (FSK)
+        if (((n == pulses->num_pulses - 1 && !pulses->continued)      // No more pulses? (FSK)
                     || (pulses->gap[n] > s_reset))      // Long silence (OOK)
-                && (bits.bits_per_row[0] > 0 || bits.num_rows > 1)) { // Only if data has been accumulated
+                && (bits->bits_per_row[0] > 0 || bits->num_rows > 1)) { // Only if data has been accumulated
 
-            events += account_event(device, &bits, __func__);
-            bitbuffer_clear(&bits);
+            events += reject ? account_reject(device, reject) : slice_event(device, bits, "pulse_slicer_pcm", rec);
+            bitbuffer_reset(bits);
+            reject = 0;
         }
     } // for
+
+    // The message continues in the next segment
+    if (pulses->continued && (bits->bits_per_row[0] > 0 || bits->num_rows > 1)) {
+        stream = slice_stream_save(pulses, device, bits, reject);
+        if (stream) {
+            stream->f_short = f_short;
+            stream->f_long  = f_long;
+        }
+    }
     return events;
 }
 
-int pulse_slicer_ppm(pulse_data_t const *pulses, r_device *device)
+static int slice_ppm(pulse_data_t const *pulses, r_device *device, slice_entry_t *rec)
 {
     float samples_per_us = pulses->sample_rate / 1.0e6f;
 
@@ -274,12 +484,15 @@ int pulse_slicer_ppm(pulse_data_t const *pulses, r_device *device)
             || (device->gap_limit > 0 && s_gap <= 0)
             || (device->sync_width > 0 && s_sync <= 0)
             || (device->tolerance > 0 && s_tolerance <= 0)) {
-        print_logf(LOG_WARNING, __func__, "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
+        print_logf(LOG_WARNING, "pulse_slicer_ppm", "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
         return 0;
     }
 
     int events = 0;
-    bitbuffer_t bits = {0};
+    bitbuffer_t *bits = slice_bits_get();
+    // stop adding bits once a message can't meet the decoder limits, cached bits must be complete
+    int const early = !rec && slice_limits_active(device);
+    int reject      = 0;
 
     // lower and upper bounds (non inclusive)
     int zero_l, zero_u;
@@ -306,36 +519,42 @@ int pulse_slicer_ppm(pulse_data_t const *pulses, r_device *device)
     }
 
     for (unsigned n = 0; n < pulses->num_pulses; ++n) {
-        if (pulses->gap[n] > zero_l && pulses->gap[n] < zero_u) {
+        if (reject) {
+            // Skip to the end of the message
+        }
+        else if (pulses->gap[n] > zero_l && pulses->gap[n] < zero_u) {
             // Short gap
-            bitbuffer_add_bit(&bits, 0);
+            bitbuffer_add_bit(bits, 0);
         }
         else if (pulses->gap[n] > one_l && pulses->gap[n] < one_u) {
             // Long gap
-            bitbuffer_add_bit(&bits, 1);
+            bitbuffer_add_bit(bits, 1);
         }
         else if (pulses->gap[n] > sync_l && pulses->gap[n] < sync_u) {
             // Sync gap
-            bitbuffer_add_sync(&bits);
+            bitbuffer_add_sync(bits);
         }
 
         // Check for new packet in multipacket
         else if (pulses->gap[n] < s_reset) {
-            bitbuffer_add_row(&bits);
+            bitbuffer_add_row(bits);
         }
+        if (early && !reject)
+            reject = slice_limits_fail(device, bits, 1);
         // End of Message?
         if (((n == pulses->num_pulses - 1)                            // No more pulses? (FSK)
                     || (pulses->gap[n] >= s_reset))     // Long silence (OOK)
-                && (bits.bits_per_row[0] > 0 || bits.num_rows > 1)) { // Only if data has been accumulated
+                && (bits->bits_per_row[0] > 0 || bits->num_rows > 1)) { // Only if data has been accumulated
 
-            events += account_event(device, &bits, __func__);
-            bitbuffer_clear(&bits);
+            events += reject ? account_reject(device, reject) : slice_event(device, bits, "pulse_slicer_ppm", rec);
+            bitbuffer_reset(bits);
+            reject = 0;
         }
     } // for pulses
     return events;
 }
 
-int pulse_slicer_pwm(pulse_data_t const *pulses, r_device *device)
+static int slice_pwm(pulse_data_t const *pulses, r_device *device, slice_entry_t *rec)
 {
     float samples_per_us = pulses->sample_rate / 1.0e6f;
 
@@ -353,12 +572,17 @@ int pulse_slicer_pwm(pulse_data_t const *pulses, r_device *device)
             || (device->gap_limit > 0 && s_gap <= 0)
             || (device->sync_width > 0 && s_sync <= 0)
             || (device->tolerance > 0 && s_tolerance <= 0)) {
-        print_logf(LOG_WARNING, __func__, "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
+        print_logf(LOG_WARNING, "pulse_slicer_pwm", "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
         return 0;
     }
 
     int events = 0;
-    bitbuffer_t bits = {0};
+    bitbuffer_t *bits = slice_bits_get();
+    // continue a message from the previous segment
+    slice_stream_t *stream = slice_stream_resume(pulses, device, bits);
+    // stop adding bits once a message can't meet the decoder limits, cached bits must be complete
+    int const early = !rec && slice_limits_active(device);
+    int reject      = stream ? stream->reject : 0;
 
     // lower and upper bounds (non inclusive)
     int one_l, one_u;
@@ -412,43 +636,53 @@ int pulse_slicer_pwm(pulse_data_t const *pulses, r_device *device)
     }
 
     for (unsigned n = 0; n < pulses->num_pulses; ++n) {
-        if (pulses->pulse[n] > one_l && pulses->pulse[n] < one_u) {
+        if (reject) {
+            // Skip to the end of the message
+        }
+        else if (pulses->pulse[n] > one_l && pulses->pulse[n] < one_u) {
             // 'Short' 1 pulse
-            bitbuffer_add_bit(&bits, 1);
+            bitbuffer_add_bit(bits, 1);
         }
         else if (pulses->pulse[n] > zero_l && pulses->pulse[n] < zero_u) {
             // 'Long' 0 pulse
-            bitbuffer_add_bit(&bits, 0);
+            bitbuffer_add_bit(bits, 0);
         }
         else if (pulses->pulse[n] > sync_l && pulses->pulse[n] < sync_u) {
             // Sync pulse
-            bitbuffer_add_sync(&bits);
+            bitbuffer_add_sync(bits);
         }
         else if (pulses->pulse[n] <= one_l) {
             // Ignore spurious short pulses
         }
         else {
             // Pulse outside specified timing
-            bitbuffer_add_row(&bits);
+            bitbuffer_add_row(bits);
         }
+        if (early && !reject)
+            reject = slice_limits_fail(device, bits, 1);
 
         // End of Message?
-        if (((n == pulses->num_pulses - 1)                       // No more pulses? (FSK)
+        if (((n == pulses->num_pulses - 1 && !pulses->continued) // No more pulses? (FSK)
                     || (pulses->gap[n] > s_reset)) // Long silence (OOK)
-                && (bits.num_rows > 0)) {                        // Only if data has been accumulated
-            events += account_event(device, &bits, __func__);
-            bitbuffer_clear(&bits);
+                && (bits->num_rows > 0)) {                        // Only if data has been accumulated
+            events += reject ? account_reject(device, reject) : slice_event(device, bits, "pulse_slicer_pwm", rec);
+            bitbuffer_reset(bits);
+            reject = 0;
         }
         else if (s_gap > 0 && pulses->gap[n] > s_gap
-                && bits.num_rows > 0 && bits.bits_per_row[bits.num_rows - 1] > 0) {
+                && bits->num_rows > 0 && bits->bits_per_row[bits->num_rows - 1] > 0) {
             // New packet in multipacket
-            bitbuffer_add_row(&bits);
+            bitbuffer_add_row(bits);
         }
     }
+
+    // The message continues in the next segment
+    if (pulses->continued && bits->num_rows > 0)
+        slice_stream_save(pulses, device, bits, reject);
     return events;
 }
 
-int pulse_slicer_manchester_zerobit(pulse_data_t const *pulses, r_device *device)
+static int slice_manchester_zerobit(pulse_data_t const *pulses, r_device *device, slice_entry_t *rec)
 {
     float samples_per_us = pulses->sample_rate / 1.0e6f;
 
@@ -466,16 +700,19 @@ int pulse_slicer_manchester_zerobit(pulse_data_t const *pulses, r_device *device
             || (device->gap_limit > 0 && s_gap <= 0)
             || (device->sync_width > 0 && s_sync <= 0)
             || (device->tolerance > 0 && s_tolerance <= 0)) {
-        print_logf(LOG_WARNING, __func__, "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
+        print_logf(LOG_WARNING, "pulse_slicer_manchester_zerobit", "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
         return 0;
     }
 
     int events = 0;
-    int time_since_last = 0;
-    bitbuffer_t bits = {0};
+    bitbuffer_t *bits = slice_bits_get();
+    // continue a message from the previous segment
+    slice_stream_t *stream = slice_stream_resume(pulses, device, bits);
+    int time_since_last = stream ? stream->time_since_last : 0;
 
     // First rising edge is always counted as a zero (Seems to be hardcoded policy for the Oregon Scientific sensors...)
-    bitbuffer_add_bit(&bits, 0);
+    if (!stream)
+        bitbuffer_add_bit(bits, 0);
 
     for (unsigned n = 0; n < pulses->num_pulses; ++n) {
         // The pulse or gap is too long or too short, thus invalid
@@ -487,17 +724,17 @@ int pulse_slicer_manchester_zerobit(pulse_data_t const *pulses, r_device *device
             if (pulses->pulse[n] > s_short * 1.5
                     && pulses->pulse[n] <= s_short * 2 + s_tolerance) {
                 // Long last pulse means with the gap this is a [1]10 transition, add a one
-                bitbuffer_add_bit(&bits, 1);
+                bitbuffer_add_bit(bits, 1);
             }
-            bitbuffer_add_row(&bits);
-            bitbuffer_add_bit(&bits, 0); // Prepare for new message with hardcoded 0
+            bitbuffer_add_row(bits);
+            bitbuffer_add_bit(bits, 0); // Prepare for new message with hardcoded 0
             time_since_last = 0;
         }
         // Falling edge is on end of pulse
         else if (pulses->pulse[n] + time_since_last > (s_short * 1.5)) {
             // Last bit was recorded more than short_width*1.5 samples ago
             // so this pulse start must be a data edge (falling data edge means bit = 1)
-            bitbuffer_add_bit(&bits, 1);
+            bitbuffer_add_bit(bits, 1);
             time_since_last = 0;
         }
         else {
@@ -505,25 +742,32 @@ int pulse_slicer_manchester_zerobit(pulse_data_t const *pulses, r_device *device
         }
 
         // End of Message?
-        if (((n == pulses->num_pulses - 1)                       // No more pulses? (FSK)
+        if (((n == pulses->num_pulses - 1 && !pulses->continued) // No more pulses? (FSK)
                     || (pulses->gap[n] > s_reset)) // Long silence (OOK)
-                && (bits.num_rows > 0)) {                        // Only if data has been accumulated
-            events += account_event(device, &bits, __func__);
-            bitbuffer_clear(&bits);
-            bitbuffer_add_bit(&bits, 0); // Prepare for new message with hardcoded 0
+                && (bits->num_rows > 0)) {                        // Only if data has been accumulated
+            events += slice_event(device, bits, "pulse_slicer_manchester_zerobit", rec);
+            bitbuffer_reset(bits);
+            bitbuffer_add_bit(bits, 0); // Prepare for new message with hardcoded 0
             time_since_last = 0;
         }
         // Rising edge is on end of gap
         else if (pulses->gap[n] + time_since_last > (s_short * 1.5)) {
             // Last bit was recorded more than short_width*1.5 samples ago
             // so this pulse end is a data edge (rising data edge means bit = 0)
-            bitbuffer_add_bit(&bits, 0);
+            bitbuffer_add_bit(bits, 0);
             time_since_last = 0;
         }
         else {
             time_since_last += pulses->gap[n];
         }
     }
+
+    // The message continues in the next segment
+    if (pulses->continued && bits->num_rows > 0) {
+        stream = slice_stream_save(pulses, device, bits, 0);
+        if (stream)
+            stream->time_since_last = time_since_last;
+    }
     return events;
 }
 
@@ -535,7 +779,7 @@ static inline int pulse_slicer_get_symbol(pulse_data_t const *pulses, unsigned i
         return pulses->gap[n / 2];
 }
 
-int pulse_slicer_dmc(pulse_data_t const *pulses, r_device *device)
+static int slice_dmc(pulse_data_t const *pulses, r_device *device, slice_entry_t *rec)
 {
     float samples_per_us = pulses->sample_rate / 1.0e6f;
 
@@ -553,11 +797,11 @@ int pulse_slicer_dmc(pulse_data_t const *pulses, r_device *device)
             || (device->gap_limit > 0 && s_gap <= 0)
             || (device->sync_width > 0 && s_sync <= 0)
             || (device->tolerance > 0 && s_tolerance <= 0)) {
-        print_logf(LOG_WARNING, __func__, "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
+        print_logf(LOG_WARNING, "pulse_slicer_dmc", "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
         return 0;
     }
 
-    bitbuffer_t bits = {0};
+    bitbuffer_t *bits = slice_bits_get();
     int events = 0;
 
     for (unsigned int n = 0; n < pulses->num_pulses * 2; ++n) {
@@ -565,17 +809,17 @@ int pulse_slicer_dmc(pulse_data_t const *pulses, r_device *device)
 
         if (abs(symbol - s_short) < s_tolerance) {
             // Short - 1
-            bitbuffer_add_bit(&bits, 1);
+            bitbuffer_add_bit(bits, 1);
             symbol = n + 1 < pulses->num_pulses * 2 ? pulse_slicer_get_symbol(pulses, ++n) : 0;
             if (abs(symbol - s_short) > s_tolerance) {
                 if (symbol >= s_reset - s_tolerance) {
                     // Don't expect another short gap at end of message
                     n--;
                 }
-                else if (bits.num_rows > 0 && bits.bits_per_row[bits.num_rows - 1] > 0) {
-                    bitbuffer_add_row(&bits);
+                else if (bits->num_rows > 0 && bits->bits_per_row[bits->num_rows - 1] > 0) {
+                    bitbuffer_add_row(bits);
 /*
-                    print_logf(LOG_WARNING, __func__, "Detected error during pulse_slicer_dmc(): %s",
+                    print_logf(LOG_WARNING, "pulse_slicer_dmc", "Detected error during pulse_slicer_dmc(): %s",
                             device->name);
 */
                 }
@@ -583,19 +827,19 @@ int pulse_slicer_dmc(pulse_data_t const *pulses, r_device *device)
         }
         else if (abs(symbol - s_long) < s_tolerance) {
             // Long - 0
-            bitbuffer_add_bit(&bits, 0);
+            bitbuffer_add_bit(bits, 0);
         }
         else if (symbol >= s_reset - s_tolerance
-                && bits.num_rows > 0) { // Only if data has been accumulated
+                && bits->num_rows > 0) { // Only if data has been accumulated
             //END message ?
-            events += account_event(device, &bits, __func__);
+            events += slice_event(device, bits, "pulse_slicer_dmc", rec);
         }
     }
 
     return events;
 }
 
-int pulse_slicer_piwm_raw(pulse_data_t const *pulses, r_device *device)
+static int slice_piwm_raw(pulse_data_t const *pulses, r_device *device, slice_entry_t *rec)
 {
     float samples_per_us = pulses->sample_rate / 1.0e6f;
 
@@ -613,7 +857,7 @@ int pulse_slicer_piwm_raw(pulse_data_t const *pulses, r_device *device)
             || (device->gap_limit > 0 && s_gap <= 0)
             || (device->sync_width > 0 && s_sync <= 0)
             || (device->tolerance > 0 && s_tolerance <= 0)) {
-        print_logf(LOG_WARNING, __func__, "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
+        print_logf(LOG_WARNING, "pulse_slicer_piwm_raw", "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
         return 0;
     }
 
@@ -622,42 +866,42 @@ int pulse_slicer_piwm_raw(pulse_data_t const *pulses, r_device *device)
 
     int w;
 
-    bitbuffer_t bits = {0};
+    bitbuffer_t *bits = slice_bits_get();
     int events = 0;
 
     for (unsigned int n = 0; n < pulses->num_pulses * 2; ++n) {
         int symbol = pulse_slicer_get_symbol(pulses, n);
         w = symbol * f_short + 0.5;
         if (symbol > s_long) {
-            bitbuffer_add_row(&bits);
+            bitbuffer_add_row(bits);
         }
         else if (abs(symbol - w * s_short) < s_tolerance) {
             // Add w symbols
             for (; w > 0; --w)
-                bitbuffer_add_bit(&bits, 1 - n % 2);
+                bitbuffer_add_bit(bits, 1 - n % 2);
         }
         else if (symbol < s_reset
-                && bits.num_rows > 0
-                && bits.bits_per_row[bits.num_rows - 1] > 0) {
-            bitbuffer_add_row(&bits);
+                && bits->num_rows > 0
+                && bits->bits_per_row[bits->num_rows - 1] > 0) {
+            bitbuffer_add_row(bits);
 /*
-            print_logf(LOG_WARNING, __func__, "Detected error during pulse_slicer_piwm_raw(): %s",
+            print_logf(LOG_WARNING, "pulse_slicer_piwm_raw", "Detected error during pulse_slicer_piwm_raw(): %s",
                     device->name);
 */
         }
 
         if (((n == pulses->num_pulses * 2 - 1)              // No more pulses? (FSK)
                     || (symbol > s_reset)) // Long silence (OOK)
-                && (bits.num_rows > 0)) {                   // Only if data has been accumulated
+                && (bits->num_rows > 0)) {                   // Only if data has been accumulated
             //END message ?
-            events += account_event(device, &bits, __func__);
+            events += slice_event(device, bits, "pulse_slicer_piwm_raw", rec);
         }
     }
 
     return events;
 }
 
-int pulse_slicer_piwm_dc(pulse_data_t const *pulses, r_device *device)
+static int slice_piwm_dc(pulse_data_t const *pulses, r_device *device, slice_entry_t *rec)
 {
     float samples_per_us = pulses->sample_rate / 1.0e6f;
 
@@ -675,45 +919,45 @@ int pulse_slicer_piwm_dc(pulse_data_t const *pulses, r_device *device)
             || (device->gap_limit > 0 && s_gap <= 0)
             || (device->sync_width > 0 && s_sync <= 0)
             || (device->tolerance > 0 && s_tolerance <= 0)) {
-        print_logf(LOG_WARNING, __func__, "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
+        print_logf(LOG_WARNING, "pulse_slicer_piwm_dc", "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
         return 0;
     }
 
-    bitbuffer_t bits = {0};
+    bitbuffer_t *bits = slice_bits_get();
     int events = 0;
 
     for (unsigned int n = 0; n < pulses->num_pulses * 2; ++n) {
         int symbol = pulse_slicer_get_symbol(pulses, n);
         if (abs(symbol - s_short) < s_tolerance) {
             // Short - 1
-            bitbuffer_add_bit(&bits, 1);
+            bitbuffer_add_bit(bits, 1);
         }
         else if (abs(symbol - s_long) < s_tolerance) {
             // Long - 0
-            bitbuffer_add_bit(&bits, 0);
+            bitbuffer_add_bit(bits, 0);
         }
         else if (symbol < s_reset
-                && bits.num_rows > 0
-                && bits.bits_per_row[bits.num_rows - 1] > 0) {
-            bitbuffer_add_row(&bits);
+                && bits->num_rows > 0
+                && bits->bits_per_row[bits->num_rows - 1] > 0) {
+            bitbuffer_add_row(bits);
 /*
-            print_logf(LOG_WARNING, __func__, "Detected error during pulse_slicer_piwm_dc(): %s",
+            print_logf(LOG_WARNING, "pulse_slicer_piwm_dc", "Detected error during pulse_slicer_piwm_dc(): %s",
                     device->name);
 */
         }
 
         if (((n == pulses->num_pulses * 2 - 1)              // No more pulses? (FSK)
                     || (symbol > s_reset)) // Long silence (OOK)
-                && (bits.num_rows > 0)) {                   // Only if data has been accumulated
+                && (bits->num_rows > 0)) {                   // Only if data has been accumulated
             //END message ?
-            events += account_event(device, &bits, __func__);
+            events += slice_event(device, bits, "pulse_slicer_piwm_dc", rec);
         }
     }
 
     return events;
 }
 
-int pulse_slicer_nrzs(pulse_data_t const *pulses, r_device *device)
+static int slice_nrzs(pulse_data_t const *pulses, r_device *device, slice_entry_t *rec)
 {
     float samples_per_us = pulses->sample_rate / 1.0e6f;
 
@@ -731,28 +975,28 @@ int pulse_slicer_nrzs(pulse_data_t const *pulses, r_device *device)
             || (device->gap_limit > 0 && s_gap <= 0)
             || (device->sync_width > 0 && s_sync <= 0)
             || (device->tolerance > 0 && s_tolerance <= 0)) {
-        print_logf(LOG_WARNING, __func__, "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
+        print_logf(LOG_WARNING, "pulse_slicer_nrzs", "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
         return 0;
     }
 
     int events = 0;
-    bitbuffer_t bits = {0};
+    bitbuffer_t *bits = slice_bits_get();
     int limit = s_short;
 
     for (unsigned n = 0; n < pulses->num_pulses; ++n) {
         if (pulses->pulse[n] > limit) {
             for (int i = 0 ; i < (pulses->pulse[n]/limit) ; i++) {
-                bitbuffer_add_bit(&bits, 1);
+                bitbuffer_add_bit(bits, 1);
             }
-            bitbuffer_add_bit(&bits, 0);
+            bitbuffer_add_bit(bits, 0);
         } else if (pulses->pulse[n] < limit) {
-            bitbuffer_add_bit(&bits, 0);
+            bitbuffer_add_bit(bits, 0);
         }
 
         if (n == pulses->num_pulses - 1
                     || pulses->gap[n] >= s_reset) {
 
-            events += account_event(device, &bits, __func__);
+            events += slice_event(device, bits, "pulse_slicer_nrzs", rec);
         }
     }
 
@@ -773,7 +1017,7 @@ int pulse_slicer_nrzs(pulse_data_t const *pulses, r_device *device)
  * bit is discarded.
  */
 
-int pulse_slicer_osv1(pulse_data_t const *pulses, r_device *device)
+static int slice_osv1(pulse_data_t const *pulses, r_device *device, slice_entry_t *rec)
 {
     float samples_per_us = pulses->sample_rate / 1.0e6f;
 
@@ -791,7 +1035,7 @@ int pulse_slicer_osv1(pulse_data_t const *pulses, r_device *device)
             || (device->gap_limit > 0 && s_gap <= 0)
             || (device->sync_width > 0 && s_sync <= 0)
             || (device->tolerance > 0 && s_tolerance <= 0)) {
-        print_logf(LOG_WARNING, __func__, "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
+        print_logf(LOG_WARNING, "pulse_slicer_osv1", "sample rate too low for protocol %u \"%s\"", device->protocol_num, device->name);
         return 0;
     }
 
@@ -799,7 +1043,7 @@ int pulse_slicer_osv1(pulse_data_t const *pulses, r_device *device)
     int preamble = 0;
     int events = 0;
     int manbit = 0;
-    bitbuffer_t bits = {0};
+    bitbuffer_t *bits = slice_bits_get();
     int halfbit_min = s_short / 2;
     int halfbit_max = s_short * 3 / 2;
     int sync_min = 2 * halfbit_max;
@@ -816,7 +1060,7 @@ int pulse_slicer_osv1(pulse_data_t const *pulses, r_device *device)
     }
     if (preamble != 12) {
         if (device->verbose)
-            print_logf(LOG_WARNING, __func__, "preamble %d  %d %d", preamble, pulses->pulse[0], pulses->gap[0]);
+            print_logf(LOG_WARNING, "pulse_slicer_osv1", "preamble %d  %d %d", preamble, pulses->pulse[0], pulses->gap[0]);
         return events;
     }
 
@@ -832,38 +1076,296 @@ int pulse_slicer_osv1(pulse_data_t const *pulses, r_device *device)
     if (pulses->gap[n] > pulses->pulse[n]) {
         manbit ^= 1;
         if (manbit)
-            bitbuffer_add_bit(&bits, 0);
+            bitbuffer_add_bit(bits, 0);
     }
 
     /* remaining data bits */
     for (n++; n < pulses->num_pulses; ++n) {
         manbit ^= 1;
         if (manbit)
-            bitbuffer_add_bit(&bits, 1);
+            bitbuffer_add_bit(bits, 1);
         if (pulses->pulse[n] > halfbit_max) {
             manbit ^= 1;
             if (manbit)
-                bitbuffer_add_bit(&bits, 1);
+                bitbuffer_add_bit(bits, 1);
         }
         if ((n == pulses->num_pulses - 1
                     || pulses->gap[n] > s_reset)
-                && (bits.num_rows > 0)) { // Only if data has been accumulated
+                && (bits->num_rows > 0)) { // Only if data has been accumulated
             //END message ?
-            events += account_event(device, &bits, __func__);
+            events += slice_event(device, bits, "pulse_slicer_osv1", rec);
             return events;
         }
         manbit ^= 1;
         if (manbit)
-            bitbuffer_add_bit(&bits, 0);
+            bitbuffer_add_bit(bits, 0);
         if (pulses->gap[n] > halfbit_max) {
             manbit ^= 1;
             if (manbit)
-                bitbuffer_add_bit(&bits, 0);
+                bitbuffer_add_bit(bits, 0);
         }
     }
     return events;
 }
 
+int pulse_slicer_pcm(pulse_data_t const *pulses, r_device *device)
+{
+    return slice_pcm(pulses, device, NULL);
+}
+
+int pulse_slicer_ppm(pulse_data_t const *pulses, r_device *device)
+{
+    return slice_ppm(pulses, device, NULL);
+}
+
+int pulse_slicer_pwm(pulse_data_t const *pulses, r_device *device)
+{
+    return slice_pwm(pulses, device, NULL);
+}
+
+int pulse_slicer_manchester_zerobit(pulse_data_t const *pulses, r_device *device)
+{
+    return slice_manchester_zerobit(pulses, device, NULL);
+}
+
+int pulse_slicer_dmc(pulse_data_t const *pulses, r_device *device)
+{
+    return slice_dmc(pulses, device, NULL);
+}
+
+int pulse_slicer_piwm_raw(pulse_data_t const *pulses, r_device *device)
+{
+    return slice_piwm_raw(pulses, device, NULL);
+}
+
+int pulse_slicer_piwm_dc(pulse_data_t const *pulses, r_device *device)
+{
+    return slice_piwm_dc(pulses, device, NULL);
+}
+
+int pulse_slicer_nrzs(pulse_data_t const *pulses, r_device *device)
+{
+    return slice_nrzs(pulses, device, NULL);
+}
+
+int pulse_slicer_osv1(pulse_data_t const *pulses, r_device *device)
+{
+    return slice_osv1(pulses, device, NULL);
+}
+
+/// Half octave width class of a width in samples, see pulse_slicer_width_classes().
+static inline unsigned width_class(int width)
+{
+    if (width < 2)
+        return 0;
+#ifdef __GNUC__
+    unsigned msb = 31 - __builtin_clz((unsigned)width);
+#else
+    unsigned msb = 0;
+    for (unsigned w = (unsigned)width; w > 1; w >>= 1)
+        msb++;
+#endif
+    return 2 * msb + ((width >> (msb - 1)) & 1);
+}
+
+/// Set of width classes for the widths in the exclusive bounds @p lower to @p upper.
+static uint64_t width_classes_between(int lower, int upper)
+{
+    if (upper - lower < 2)
+        return 0; // no width between
+    unsigned lo = width_class(lower + 1 > 0 ? lower + 1 : 0);
+    unsigned hi = width_class(upper - 1);
+    return (UINT64_MAX >> (63 - hi)) & ~((UINT64_C(1) << lo) - 1);
+}
+
+void pulse_slicer_width_classes(pulse_data_t const *pulses, uint64_t *pulse_classes, uint64_t *gap_classes)
+{
+    uint64_t pc = 0;
+    uint64_t gc = 0;
+    for (unsigned n = 0; n < pulses->num_pulses; ++n) {
+        pc |= UINT64_C(1) << width_class(pulses->pulse[n]);
+        gc |= UINT64_C(1) << width_class(pulses->gap[n]);
+    }
+    *pulse_classes = pc;
+    *gap_classes   = gc;
+}
+
+void pulse_slicer_prefilter_init(r_device *device, uint32_t sample_rate)
+{
+    float samples_per_us = sample_rate / 1.0e6f;
+
+    // same rounding as the slicers
+    int s_short = device->short_width * samples_per_us;
+    int s_long  = device->long_width * samples_per_us;
+    int s_reset = device->reset_limit * samples_per_us;
+    int s_gap   = device->gap_limit * samples_per_us;
+    int s_sync  = device->sync_width * samples_per_us;
+    int s_tolerance = device->tolerance * samples_per_us;
+
+    device->prefilter_rate   = sample_rate;
+    device->prefilter_pulses = UINT64_MAX;
+    device->prefilter_gaps   = UINT64_MAX;
+
+    // let the slicer warn on rounding to zero
+    if ((device->short_width > 0 && s_short <= 0)
+            || (device->long_width > 0 && s_long <= 0)
+            || (device->reset_limit > 0 && s_reset <= 0)
+            || (device->gap_limit > 0 && s_gap <= 0)
+            || (device->sync_width > 0 && s_sync <= 0)
+            || (device->tolerance > 0 && s_tolerance <= 0)) {
+        return;
+    }
+
+    switch (device->modulation) {
+    case OOK_PULSE_PPM:
+        // only gaps in the bit and sync windows produce bits
+        if (s_tolerance > 0) {
+            device->prefilter_gaps = width_classes_between(s_short - s_tolerance, s_short + s_tolerance)
+                    | width_classes_between(s_long - s_tolerance, s_long + s_tolerance);
+            if (s_sync > 0)
+                device->prefilter_gaps |= width_classes_between(s_sync - s_tolerance, s_sync + s_tolerance);
+        }
+        else {
+            device->prefilter_gaps = width_classes_between(0, s_gap ? s_gap : s_reset);
+        }
+        break;
+    case OOK_PULSE_PWM:
+    case FSK_PULSE_PWM:
+        // only pulses in the bit and sync windows produce bits, without tolerance all pulses do
+        if (s_tolerance > 0) {
+            device->prefilter_pulses = width_classes_between(s_short - s_tolerance, s_short + s_tolerance)
+                    | width_classes_between(s_long - s_tolerance, s_long + s_tolerance);
+            if (s_sync > 0)
+                device->prefilter_pulses |= width_classes_between(s_sync - s_tolerance, s_sync + s_tolerance);
+        }
+        break;
+    default:
+        // other slicers adapt to the timing or produce bits from any width
+        break;
+    }
+}
+
+int pulse_slicer_prefilter(pulse_data_t const *pulses, uint64_t pulse_classes, uint64_t gap_classes, r_device *device)
+{
+    if (!pulses->sample_rate)
+        return 1; // unknown timing, let the slicer decide
+    if (device->prefilter_rate != pulses->sample_rate)
+        pulse_slicer_prefilter_init(device, pulses->sample_rate);
+
+    return (pulse_classes & device->prefilter_pulses) && (gap_classes & device->prefilter_gaps);
+}
+
+typedef int (*slicer_fn)(pulse_data_t const *pulses, r_device *device, slice_entry_t *rec);
+
+static slicer_fn slicer_for(unsigned modulation)
+{
+    switch (modulation) {
+    case OOK_PULSE_PCM:
+    // case OOK_PULSE_RZ:
+    case FSK_PULSE_PCM:
+        return slice_pcm;
+    case OOK_PULSE_PPM:
+        return slice_ppm;
+    case OOK_PULSE_PWM:
+    case FSK_PULSE_PWM:
+        return slice_pwm;
+    case OOK_PULSE_MANCHESTER_ZEROBIT:
+    case FSK_PULSE_MANCHESTER_ZEROBIT:
+        return slice_manchester_zerobit;
+    case OOK_PULSE_PIWM_RAW:
+        return slice_piwm_raw;
+    case OOK_PULSE_PIWM_DC:
+        return slice_piwm_dc;
+    case OOK_PULSE_DMC:
+        return slice_dmc;
+    case OOK_PULSE_PWM_OSV1:
+        return slice_osv1;
+    case OOK_PULSE_NRZS:
+        return slice_nrzs;
+    default:
+        return NULL;
+    }
+}
+
+static void slice_entry_free(slice_entry_t *entry)
+{
+    list_free_elems(&entry->bits, free);
+    free(entry);
+}
+
+void slice_cache_free(slice_cache_t *cache)
+{
+    list_free_elems(&cache->entries, (list_elem_free_fn)slice_entry_free);
+}
+
+int pulse_slicer_known(unsigned modulation)
+{
+    return slicer_for(modulation) != NULL;
+}
+
+int pulse_slicer_share(r_device *a, r_device *b)
+{
+    slicer_fn slicer = slicer_for(a->modulation);
+    if (!slicer || slicer != slicer_for(b->modulation)
+            || a->short_width != b->short_width
+            || a->long_width != b->long_width
+            || a->reset_limit != b->reset_limit
+            || a->gap_limit != b->gap_limit
+            || a->sync_width != b->sync_width
+            || a->tolerance != b->tolerance)
+        return 0;
+
+    a->slice_shared = 1;
+    b->slice_shared = 1;
+    return 1;
+}
+
+int pulse_slicer_run(pulse_data_t const *pulses, r_device *device, slice_cache_t *cache)
+{
+    slicer_fn slicer = slicer_for(device->modulation);
+    if (!slicer) {
+        fprintf(stderr, "Unknown modulation %u in protocol!\n", device->modulation);
+        return 0;
+    }
+    if (!cache || !device->slice_shared) {
+        return slicer(pulses, device, NULL);
+    }
+
+    // replay the bits if a decoder with the same slicer and timing already ran
+    for (void **iter = cache->entries.elems; iter && *iter; ++iter) {
+        slice_entry_t *entry = *iter;
+        if (entry->slicer == slicer
+                && entry->short_width == device->short_width
+                && entry->long_width == device->long_width
+                && entry->reset_limit == device->reset_limit
+                && entry->gap_limit == device->gap_limit
+                && entry->sync_width == device->sync_width
+                && entry->tolerance == device->tolerance) {
+            int events = 0;
+            for (void **bits_iter = entry->bits.elems; bits_iter && *bits_iter; ++bits_iter) {
+                bitbuffer_t *bits = slice_bits_get(); // fresh copy for each decoder
+                memcpy(bits, *bits_iter, bitbuffer_used_size(*bits_iter));
+                events += slice_decode(device, bits, entry->demod_name);
+            }
+            return events;
+        }
+    }
+
+    slice_entry_t *entry = calloc(1, sizeof(*entry));
+    if (!entry)
+        FATAL_CALLOC("pulse_slicer_run()");
+    entry->slicer      = slicer;
+    entry->short_width = device->short_width;
+    entry->long_width  = device->long_width;
+    entry->reset_limit = device->reset_limit;
+    entry->gap_limit   = device->gap_limit;
+    entry->sync_width  = device->sync_width;
+    entry->tolerance   = device->tolerance;
+    list_push(&cache->entries, entry);
+
+    return slicer(pulses, device, entry);
+}
+
 int pulse_slicer_string(const char *code, r_device *device)
 {
     int events = 0;
@@ -14,6 +14,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
+#include <limits.h>
 #include <math.h>
 
 #include "r_api.h"
@@ -28,20 +29,30 @@
 #include "data.h"
 #include "data_tag.h"
 #include "list.h"
+#include "thread_pool.h"
+#include "compat_atomic.h"
+#include "compat_pthread.h"
 #include "optparse.h"
 #include "output_file.h"
 #include "output_log.h"
 #include "output_udp.h"
 #include "output_mqtt.h"
+#include "output_amqp.h"
 #include "output_influx.h"
 #include "output_trigger.h"
 #include "output_rtltcp.h"
 #include "write_sigrok.h"
+#include "pulse_file.h"
+#include "async_io.h"
+#include "compress_io.h"
+#include "spool.h"
 #include "mongoose.h"
 #include "compat_time.h"
 #include "logger.h"
 #include "fatal.h"
 #include "http_server.h"
+#include "dsp_worker.h"
+#include "bench.h"
 
 #ifndef _WIN32
 #include <sys/stat.h>
@@ -155,6 +166,9 @@ void r_init_cfg(r_cfg_t *cfg)
     // Default log level is to show all LOG_FATAL, LOG_ERROR, LOG_WARNING
     // abnormal messages and LOG_CRITICAL information.
     cfg->verbosity = LOG_WARNING;
+    cfg->decoder_threads = 1;
+    cfg->file_threads    = 1;
+    cfg->chunk_threads   = 1;
 
     list_ensure_size(&cfg->in_files, 100);
     list_ensure_size(&cfg->output_handler, 16);
@@ -210,6 +224,125 @@ r_cfg_t *r_create_cfg(void)
     return cfg;
 }
 
+static int dumper_is_sample_format(file_info_t const *dumper)
+{
+    return dumper->format != VCD_LOGIC
+            && dumper->format != PULSE_OOK
+            && dumper->format != PULSE_BIN;
+}
+
+/// Start write-behind for a sample dumper to a file, or with compression.
+/// Uncompressed output to stdout stays unbuffered for pipes.
+static void dumper_start_sample_writer(r_cfg_t *cfg, file_info_t *dumper)
+{
+    if (!dumper_is_sample_format(dumper) || (dumper->file == stdout && !dumper->compression))
+        return;
+
+    async_io_fn write_fn = async_io_fwrite;
+    void *write_ctx      = dumper->file;
+    if (dumper->compression) {
+        dumper->compress_writer = compress_writer_create(dumper->file, dumper->compression);
+        if (!dumper->compress_writer)
+            FATAL_CALLOC("dumper_start_sample_writer()");
+        write_fn  = compress_writer_write;
+        write_ctx = dumper->compress_writer;
+    }
+    dumper->sample_writer = async_writer_create(write_fn, write_ctx, &cfg->io_stats);
+    if (!dumper->sample_writer)
+        FATAL_CALLOC("dumper_start_sample_writer()");
+}
+
+/// Write out all queued samples and end the compressed stream.
+static void dumper_stop_sample_writer(file_info_t *dumper)
+{
+    async_writer_free(dumper->sample_writer);
+    dumper->sample_writer = NULL;
+    compress_writer_free(dumper->compress_writer);
+    dumper->compress_writer = NULL;
+}
+
+/// Check if a sample dumper needs the format conversion buffer.
+static int dumper_needs_conversion(file_info_t const *dumper, int sample_size)
+{
+    switch (dumper->format) {
+    case CU8_IQ: return sample_size != 2;
+    case CS16_IQ: return sample_size != 4;
+    case CS8_IQ:
+    case CF32_IQ:
+    case F32_AM:
+    case F32_FM:
+    case F32_I:
+    case F32_Q: return 1;
+    default: return 0;
+    }
+}
+
+static void free_demod_buffers(struct dm_state *demod)
+{
+    free(demod->am_buf);
+    demod->am_buf = NULL;
+    free(demod->buf.fm);
+    demod->buf.fm = NULL;
+    free(demod->u8_buf);
+    demod->u8_buf = NULL;
+    free(demod->f32_buf);
+    demod->f32_buf = NULL;
+    demod->buf_len = 0;
+}
+
+int r_reserve_demod_buffers(r_cfg_t *cfg, unsigned n_samples)
+{
+    struct dm_state *demod = cfg->demod;
+
+    int need_u8  = 0;
+    int need_f32 = 0;
+    for (void **iter = demod->dumper.elems; iter && *iter; ++iter) {
+        file_info_t const *dumper = *iter;
+        need_u8 |= dumper->format == U8_LOGIC;
+        need_f32 |= dumper_needs_conversion(dumper, demod->sample_size);
+    }
+    if (n_samples <= demod->buf_len && (!need_u8 || demod->u8_buf) && (!need_f32 || demod->f32_buf))
+        return 0;
+
+    // the buffers only hold one block, there is nothing to keep
+    if (n_samples < demod->buf_len)
+        n_samples = demod->buf_len;
+    free_demod_buffers(demod);
+
+    int16_t *am_buf = calloc(n_samples, sizeof(*am_buf));
+    if (!am_buf) {
+        WARN_CALLOC("r_reserve_demod_buffers()");
+        return -1; // NOTE: returns -1 on alloc failure.
+    }
+    demod->am_buf = am_buf;
+    int16_t *fm_buf = calloc(n_samples, sizeof(*fm_buf));
+    if (!fm_buf) {
+        WARN_CALLOC("r_reserve_demod_buffers()");
+        free_demod_buffers(demod);
+        return -1; // NOTE: returns -1 on alloc failure.
+    }
+    demod->buf.fm = fm_buf;
+    if (need_u8) {
+        demod->u8_buf = calloc(n_samples, sizeof(*demod->u8_buf));
+        if (!demod->u8_buf) {
+            WARN_CALLOC("r_reserve_demod_buffers()");
+            free_demod_buffers(demod);
+            return -1; // NOTE: returns -1 on alloc failure.
+        }
+    }
+    if (need_f32) {
+        demod->f32_buf = calloc(n_samples * 2, sizeof(*demod->f32_buf));
+        if (!demod->f32_buf) {
+            WARN_CALLOC("r_reserve_demod_buffers()");
+            free_demod_buffers(demod);
+            return -1; // NOTE: returns -1 on alloc failure.
+        }
+    }
+    demod->buf_len = n_samples;
+
+    return 0;
+}
+
 void r_free_cfg(r_cfg_t *cfg)
 {
     if (cfg->dev) {
@@ -222,12 +355,25 @@ void r_free_cfg(r_cfg_t *cfg)
     cfg->gain_str = NULL;
 
     for (void **iter = cfg->demod->dumper.elems; iter && *iter; ++iter) {
-        file_info_t const *dumper = *iter;
+        file_info_t *dumper = *iter;
+        pulse_writer_free(dumper->pulse_writer);
+        dumper->pulse_writer = NULL;
+        dumper_stop_sample_writer(dumper);
         if (dumper->file && (dumper->file != stdout))
             fclose(dumper->file);
     }
     list_free_elems(&cfg->demod->dumper, free);
 
+    thread_pool_free(cfg->decoder_pool);
+    cfg->decoder_pool = NULL;
+
+    free(cfg->unit_keys);
+    cfg->unit_keys     = NULL;
+    cfg->unit_keys_len = 0;
+
+    bench_free(cfg->bench);
+    cfg->bench = NULL;
+
     list_free_elems(&cfg->demod->r_devs, (list_elem_free_fn)free_protocol);
 
     if (cfg->demod->am_analyze)
@@ -237,8 +383,16 @@ void r_free_cfg(r_cfg_t *cfg)
     pulse_detect_free(cfg->demod->pulse_detect);
     cfg->demod->pulse_detect = NULL;
 
+    channels_free(cfg->demod->channels);
+    cfg->demod->channels = NULL;
+
+    free_demod_buffers(cfg->demod);
+
     list_free_elems(&cfg->raw_handler, (list_elem_free_fn)raw_output_free);
 
+    dsp_worker_free(cfg->dsp_worker);
+    cfg->dsp_worker = NULL;
+
     r_logger_set_log_handler(NULL, NULL);
 
     list_free_elems(&cfg->output_handler, (list_elem_free_fn)data_output_free);
@@ -260,6 +414,77 @@ void r_free_cfg(r_cfg_t *cfg)
     //free(cfg);
 }
 
+r_cfg_t *r_create_batch_cfg(r_cfg_t *cfg)
+{
+    r_cfg_t *worker = malloc(sizeof(*worker));
+    if (!worker) {
+        WARN_MALLOC("r_create_batch_cfg()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    *worker = *cfg; // copy the settings
+
+    // the parent owns the inputs, outputs and the devices list
+    worker->in_files       = (list_t){0};
+    worker->data_tags      = (list_t){0};
+    worker->output_handler = (list_t){0};
+    worker->raw_handler    = (list_t){0};
+    worker->dev            = NULL;
+    worker->gain_str       = NULL;
+    worker->unit_keys      = NULL;
+    worker->unit_keys_len  = 0;
+    worker->dsp_worker     = NULL;
+    worker->decoder_pool   = NULL;
+    worker->bench          = NULL;
+    worker->mgr            = NULL;
+    worker->stats_now      = 0;
+    worker->exit_async     = 0;
+    worker->batch_parent   = cfg;
+    worker->held_events    = NULL;
+
+    worker->demod = malloc(sizeof(*worker->demod));
+    if (!worker->demod) {
+        WARN_MALLOC("r_create_batch_cfg()");
+        free(worker);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    struct dm_state *demod = worker->demod;
+    *demod = *cfg->demod; // copy the settings
+
+    demod->samp_grab  = NULL;
+    demod->am_analyze = NULL;
+    demod->channels   = NULL;
+    demod->dumper     = (list_t){0};
+    demod->r_devs     = (list_t){0};
+    demod->buf_len    = 0;
+    demod->am_buf     = NULL;
+    demod->buf.fm     = NULL;
+    demod->u8_buf     = NULL;
+    demod->f32_buf    = NULL;
+
+    demod->pulse_detect = pulse_detect_create();
+    if (!demod->pulse_detect) {
+        free(demod);
+        free(worker);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    pulse_detect_set_levels(demod->pulse_detect, demod->use_mag_est, demod->level_limit, demod->min_level, demod->min_snr, demod->detect_verbosity);
+
+    return worker;
+}
+
+void r_free_batch_cfg(r_cfg_t *worker)
+{
+    if (!worker)
+        return;
+
+    free(worker->unit_keys);
+    list_free_elems(&worker->demod->r_devs, (list_elem_free_fn)free_protocol);
+    pulse_detect_free(worker->demod->pulse_detect);
+    free_demod_buffers(worker->demod);
+    free(worker->demod);
+    free(worker);
+}
+
 /* device decoder protocols */
 
 void register_protocol(r_cfg_t *cfg, r_device *r_dev, char *arg)
@@ -297,6 +522,12 @@ void register_protocol(r_cfg_t *cfg, r_device *r_dev, char *arg)
     p->output_fn  = data_acquired_handler;
     p->output_ctx = cfg;
 
+    pulse_slicer_prefilter_init(p, cfg->samp_rate);
+    // decoders with the same slicer and timing share the bits of each package
+    for (size_t i = 0; i < cfg->demod->r_devs.len; ++i) {
+        pulse_slicer_share(p, cfg->demod->r_devs.elems[i]);
+    }
+
     list_push(&cfg->demod->r_devs, p);
 
     if (cfg->verbosity >= LOG_INFO) {
@@ -308,9 +539,36 @@ void free_protocol(r_device *r_dev)
 {
     // free(r_dev->name);
     free(r_dev->decode_ctx);
+    free(r_dev->slice_stream);
     free(r_dev);
 }
 
+void r_reset_batch_protocols(r_cfg_t *worker)
+{
+    list_t *r_devs = &worker->demod->r_devs;
+    list_t *parent_devs = &worker->batch_parent->demod->r_devs;
+
+    list_clear(r_devs, (list_elem_free_fn)free_protocol);
+    list_ensure_size(r_devs, parent_devs->len + 1);
+    for (size_t i = 0; i < parent_devs->len; ++i) {
+        r_device *r_dev = parent_devs->elems[i];
+        r_device *p = malloc(sizeof(*p));
+        if (!p)
+            FATAL_MALLOC("r_reset_batch_protocols()");
+        *p = *r_dev; // copy, the prefilter and slicer sharing carry over
+        p->slice_stream = NULL;
+        if (r_dev->decode_ctx_size) {
+            // stateful decoders start from the registered state
+            p->decode_ctx = malloc(r_dev->decode_ctx_size);
+            if (!p->decode_ctx)
+                FATAL_MALLOC("r_reset_batch_protocols()");
+            memcpy(p->decode_ctx, r_dev->decode_ctx, r_dev->decode_ctx_size);
+        }
+        p->output_ctx = worker;
+        list_push(r_devs, p);
+    }
+}
+
 void unregister_protocol(r_cfg_t *cfg, r_device *r_dev)
 {
     for (size_t i = 0; i < cfg->demod->r_devs.len; ++i) { // list might contain NULLs
@@ -334,21 +592,21 @@ void register_all_protocols(r_cfg_t *cfg, unsigned disabled)
 
 /* output helper */
 
-void calc_rssi_snr(r_cfg_t *cfg, pulse_data_t *pulse_data)
+void calc_pulse_levels(pulse_data_t *pulse_data, uint32_t center_frequency, int sample_size, int use_mag_est)
 {
     float ook_high_estimate = pulse_data->ook_high_estimate > 0 ? pulse_data->ook_high_estimate : 1;
     float ook_low_estimate = pulse_data->ook_low_estimate > 0 ? pulse_data->ook_low_estimate : 1;
     int const OOK_MAX_HIGH_LEVEL = DB_TO_AMP(0); // Maximum estimate for high level (-0 dB)
     float ook_max_estimate = ook_high_estimate < OOK_MAX_HIGH_LEVEL ? ook_high_estimate : OOK_MAX_HIGH_LEVEL;
     float asnr   = ook_max_estimate / ook_low_estimate;
-    float foffs1 = (float)pulse_data->fsk_f1_est / INT16_MAX * cfg->samp_rate / 2.0f;
-    float foffs2 = (float)pulse_data->fsk_f2_est / INT16_MAX * cfg->samp_rate / 2.0f;
-    pulse_data->freq1_hz = (foffs1 + cfg->center_frequency);
-    pulse_data->freq2_hz = (foffs2 + cfg->center_frequency);
-    pulse_data->centerfreq_hz = cfg->center_frequency;
-    pulse_data->depth_bits    = cfg->demod->sample_size * 4;
+    float foffs1 = (float)pulse_data->fsk_f1_est / INT16_MAX * pulse_data->sample_rate / 2.0f;
+    float foffs2 = (float)pulse_data->fsk_f2_est / INT16_MAX * pulse_data->sample_rate / 2.0f;
+    pulse_data->freq1_hz = (foffs1 + center_frequency);
+    pulse_data->freq2_hz = (foffs2 + center_frequency);
+    pulse_data->centerfreq_hz = center_frequency;
+    pulse_data->depth_bits    = sample_size * 4;
     // NOTE: for (CU8) amplitude is 10x (because it's squares)
-    if (cfg->demod->sample_size == 2 && !cfg->demod->use_mag_est) { // amplitude (CU8)
+    if (sample_size == 2 && !use_mag_est) { // amplitude (CU8)
         pulse_data->range_db = 42.1442f; // 10*log10f(16384.0f) == 20*log10f(128.0f)
         pulse_data->rssi_db  = 10.0f * log10f(ook_high_estimate) - 42.1442f; // 10*log10f(16384.0f)
         pulse_data->noise_db = 10.0f * log10f(ook_low_estimate) - 42.1442f; // 10*log10f(16384.0f)
@@ -365,6 +623,11 @@ void calc_rssi_snr(r_cfg_t *cfg, pulse_data_t *pulse_data)
     }
 }
 
+void calc_rssi_snr(r_cfg_t *cfg, pulse_data_t *pulse_data)
+{
+    calc_pulse_levels(pulse_data, cfg->center_frequency, cfg->demod->sample_size, cfg->demod->use_mag_est);
+}
+
 char *time_pos_str(r_cfg_t *cfg, unsigned samples_ago, char *buf)
 {
     if (cfg->report_time == REPORT_TIME_SAMPLES) {
@@ -495,10 +758,157 @@ char const **determine_csv_fields(r_cfg_t *cfg, char const *const *well_known, i
     return (char const **)field_list.elems;
 }
 
+/* parallel decoders */
+
+/// Decoder output (level 0) or decoder log data captured on the decoder pool.
+typedef struct decode_capture {
+    data_t *data;
+    int level;
+} decode_capture_t;
+
+/// A decoder of the priority running on the decoder pool.
+typedef struct decode_task {
+    r_device *r_dev;
+    void (*log_fn)(r_device *decoder, int level, data_t *data);
+    void (*output_fn)(r_device *decoder, data_t *data);
+    void *output_ctx;
+    list_t captures; ///< decode_capture_t in the order emitted
+    list_t logs;     ///< held_log_t in the order emitted
+    int events;
+} decode_task_t;
+
+/// The decoders of one priority running on the decoder pool.
+typedef struct decode_tier {
+    pulse_data_t const *pulse_data;
+    decode_task_t *tasks;
+} decode_tier_t;
+
+static void capture_push(decode_task_t *task, data_t *data, int level)
+{
+    decode_capture_t *capture = malloc(sizeof(*capture));
+    if (!capture)
+        FATAL_MALLOC("capture_push()");
+    capture->data  = data;
+    capture->level = level;
+    list_push(&task->captures, capture);
+}
+
+static void capture_output(r_device *r_dev, data_t *data)
+{
+    capture_push(r_dev->output_ctx, data, 0);
+}
+
+static void capture_log(r_device *r_dev, int level, data_t *data)
+{
+    capture_push(r_dev->output_ctx, data, level);
+}
+
+static void decode_task_exec(decode_tier_t *tier, decode_task_t *task)
+{
+    r_hold_logs(&task->logs);
+    task->events = pulse_slicer_run(tier->pulse_data, task->r_dev, NULL);
+    r_hold_logs(NULL);
+}
+
+static void decode_task_run(void *ctx, unsigned task_idx)
+{
+    decode_tier_t *tier  = ctx;
+    decode_task_t *task  = &tier->tasks[task_idx];
+    if (!task->r_dev->serial)
+        decode_task_exec(tier, task);
+}
+
+/// Run the decoders of one priority, on the decoder pool if there is one.
+///
+/// Each decoder slices its own copy of the bits, the per decoder statistics are
+/// only touched by the thread running the decoder. Decoders marked r_device::serial
+/// run on this thread once the pool is done. The captured logs and outputs are
+/// passed on in protocol number order once all decoders completed.
+static int run_priority(list_t *tier_devs, pulse_data_t const *pulse_data, slice_cache_t *cache)
+{
+    int p_events = 0;
+    unsigned count = tier_devs->len;
+    r_device *first = count ? tier_devs->elems[0] : NULL;
+    r_cfg_t *cfg = first ? first->output_ctx : NULL; // set by register_protocol()
+
+    unsigned pooled = 0;
+    for (unsigned i = 0; i < count; ++i) {
+        r_device *r_dev = tier_devs->elems[i];
+        pooled += !r_dev->serial;
+    }
+
+    if (pooled < 2 || !cfg || !cfg->decoder_pool) {
+        for (unsigned i = 0; i < count; ++i) {
+            p_events += pulse_slicer_run(pulse_data, tier_devs->elems[i], cache);
+        }
+        return p_events;
+    }
+
+    decode_tier_t tier = {0};
+    tier.pulse_data = pulse_data;
+    tier.tasks = calloc(count, sizeof(*tier.tasks));
+    if (!tier.tasks)
+        FATAL_CALLOC("run_priority()");
+
+    // insertion sort keeps the registration order for equal protocol numbers
+    for (unsigned i = 0; i < count; ++i) {
+        r_device *r_dev = tier_devs->elems[i];
+        unsigned j = i;
+        for (; j > 0 && tier.tasks[j - 1].r_dev->protocol_num > r_dev->protocol_num; --j) {
+            tier.tasks[j] = tier.tasks[j - 1];
+        }
+        tier.tasks[j].r_dev = r_dev;
+    }
+    for (unsigned i = 0; i < count; ++i) {
+        decode_task_t *task = &tier.tasks[i];
+        task->log_fn         = task->r_dev->log_fn;
+        task->output_fn      = task->r_dev->output_fn;
+        task->output_ctx     = task->r_dev->output_ctx;
+        task->r_dev->log_fn     = capture_log;
+        task->r_dev->output_fn  = capture_output;
+        task->r_dev->output_ctx = task;
+    }
+
+    thread_pool_run(cfg->decoder_pool, count, decode_task_run, &tier);
+    for (unsigned i = 0; i < count; ++i) {
+        if (tier.tasks[i].r_dev->serial)
+            decode_task_exec(&tier, &tier.tasks[i]);
+    }
+
+    for (unsigned i = 0; i < count; ++i) {
+        decode_task_t *task = &tier.tasks[i];
+        r_device *r_dev     = task->r_dev;
+        r_dev->log_fn     = task->log_fn;
+        r_dev->output_fn  = task->output_fn;
+        r_dev->output_ctx = task->output_ctx;
+        r_flush_held_logs(&task->logs);
+        for (void **iter = task->captures.elems; iter && *iter; ++iter) {
+            decode_capture_t *capture = *iter;
+            if (capture->level)
+                r_dev->log_fn(r_dev, capture->level, capture->data);
+            else
+                r_dev->output_fn(r_dev, capture->data);
+        }
+        list_free_elems(&task->captures, free);
+        p_events += task->events;
+    }
+    free(tier.tasks);
+
+    return p_events;
+}
+
 int run_ook_demods(list_t *r_devs, pulse_data_t *pulse_data)
 {
     int p_events = 0;
 
+    // skip decoders whose timing can't match any pulse or gap
+    uint64_t pulse_classes, gap_classes;
+    pulse_slicer_width_classes(pulse_data, &pulse_classes, &gap_classes);
+    pulse_data->num_candidates = 0;
+    // decoders with the same slicer and timing share the bits
+    slice_cache_t cache = {0};
+    list_t tier_devs    = {0};
+
     unsigned next_priority = 0; // next smallest on each loop through decoders
     // run all decoders of each priority, stop if an event is produced
     for (unsigned priority = 0; !p_events && priority < UINT_MAX; priority = next_priority) {
@@ -512,46 +922,21 @@ int run_ook_demods(list_t *r_devs, pulse_data_t *pulse_data)
             // Run only current priority
             if (r_dev->priority != priority)
                 continue;
-
-            switch (r_dev->modulation) {
-            case OOK_PULSE_PCM:
-            // case OOK_PULSE_RZ:
-                p_events += pulse_slicer_pcm(pulse_data, r_dev);
-                break;
-            case OOK_PULSE_PPM:
-                p_events += pulse_slicer_ppm(pulse_data, r_dev);
-                break;
-            case OOK_PULSE_PWM:
-                p_events += pulse_slicer_pwm(pulse_data, r_dev);
-                break;
-            case OOK_PULSE_MANCHESTER_ZEROBIT:
-                p_events += pulse_slicer_manchester_zerobit(pulse_data, r_dev);
-                break;
-            case OOK_PULSE_PIWM_RAW:
-                p_events += pulse_slicer_piwm_raw(pulse_data, r_dev);
-                break;
-            case OOK_PULSE_PIWM_DC:
-                p_events += pulse_slicer_piwm_dc(pulse_data, r_dev);
-                break;
-            case OOK_PULSE_DMC:
-                p_events += pulse_slicer_dmc(pulse_data, r_dev);
-                break;
-            case OOK_PULSE_PWM_OSV1:
-                p_events += pulse_slicer_osv1(pulse_data, r_dev);
-                break;
-            case OOK_PULSE_NRZS:
-                p_events += pulse_slicer_nrzs(pulse_data, r_dev);
-                break;
-            // FSK decoders
-            case FSK_PULSE_PCM:
-            case FSK_PULSE_PWM:
-            case FSK_PULSE_MANCHESTER_ZEROBIT:
-                break;
-            default:
+            if (!pulse_slicer_known(r_dev->modulation)) {
                 fprintf(stderr, "Unknown modulation %u in protocol!\n", r_dev->modulation);
+                continue;
             }
+            if (r_dev->modulation >= FSK_DEMOD_MIN_VAL
+                    || !pulse_slicer_prefilter(pulse_data, pulse_classes, gap_classes, r_dev))
+                continue;
+            pulse_data->num_candidates += 1;
+            list_push(&tier_devs, r_dev);
         }
+        p_events += run_priority(&tier_devs, pulse_data, &cache);
+        list_clear(&tier_devs, NULL);
     }
+    list_free_elems(&tier_devs, NULL);
+    slice_cache_free(&cache);
 
     return p_events;
 }
@@ -560,6 +945,14 @@ int run_fsk_demods(list_t *r_devs, pulse_data_t *fsk_pulse_data)
 {
     int p_events = 0;
 
+    // skip decoders whose timing can't match any pulse or gap
+    uint64_t pulse_classes, gap_classes;
+    pulse_slicer_width_classes(fsk_pulse_data, &pulse_classes, &gap_classes);
+    fsk_pulse_data->num_candidates = 0;
+    // decoders with the same slicer and timing share the bits
+    slice_cache_t cache = {0};
+    list_t tier_devs    = {0};
+
     unsigned next_priority = 0; // next smallest on each loop through decoders
     // run all decoders of each priority, stop if an event is produced
     for (unsigned priority = 0; !p_events && priority < UINT_MAX; priority = next_priority) {
@@ -573,47 +966,160 @@ int run_fsk_demods(list_t *r_devs, pulse_data_t *fsk_pulse_data)
             // Run only current priority
             if (r_dev->priority != priority)
                 continue;
-
-            switch (r_dev->modulation) {
-            // OOK decoders
-            case OOK_PULSE_PCM:
-            // case OOK_PULSE_RZ:
-            case OOK_PULSE_PPM:
-            case OOK_PULSE_PWM:
-            case OOK_PULSE_MANCHESTER_ZEROBIT:
-            case OOK_PULSE_PIWM_RAW:
-            case OOK_PULSE_PIWM_DC:
-            case OOK_PULSE_DMC:
-            case OOK_PULSE_PWM_OSV1:
-            case OOK_PULSE_NRZS:
-                break;
-            case FSK_PULSE_PCM:
-                p_events += pulse_slicer_pcm(fsk_pulse_data, r_dev);
-                break;
-            case FSK_PULSE_PWM:
-                p_events += pulse_slicer_pwm(fsk_pulse_data, r_dev);
-                break;
-            case FSK_PULSE_MANCHESTER_ZEROBIT:
-                p_events += pulse_slicer_manchester_zerobit(fsk_pulse_data, r_dev);
-                break;
-            default:
+            if (!pulse_slicer_known(r_dev->modulation)) {
                 fprintf(stderr, "Unknown modulation %u in protocol!\n", r_dev->modulation);
+                continue;
             }
+            if (r_dev->modulation < FSK_DEMOD_MIN_VAL
+                    || !pulse_slicer_prefilter(fsk_pulse_data, pulse_classes, gap_classes, r_dev))
+                continue;
+            fsk_pulse_data->num_candidates += 1;
+            list_push(&tier_devs, r_dev);
         }
+        p_events += run_priority(&tier_devs, fsk_pulse_data, &cache);
+        list_clear(&tier_devs, NULL);
     }
+    list_free_elems(&tier_devs, NULL);
+    slice_cache_free(&cache);
 
     return p_events;
 }
 
 /* handlers */
 
+// pseudo log levels to pass events to the output handlers
+#define OUTPUT_EVENT 0         ///< event for all outputs
+#define OUTPUT_DEVICE_EVENT -1 ///< device event for all outputs, data tags not yet applied
+
+/// Pass the data structure to all output handlers, or those accepting @p level. Frees data afterwards.
+static void output_data(r_cfg_t *cfg, data_t *data, int level)
+{
+    if (level == OUTPUT_DEVICE_EVENT) {
+        // apply all tags
+        for (void **iter = cfg->data_tags.elems; iter && *iter; ++iter) {
+            data_tag_t *tag = *iter;
+            data            = data_tag_apply(tag, data, cfg->in_filename);
+        }
+    }
+
+    uint64_t start = bench_now(cfg->bench);
+    for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
+        data_output_t *output = cfg->output_handler.elems[i];
+        if (level <= OUTPUT_EVENT || (output && output->log_level >= level)) {
+            data_output_print(output, data);
+        }
+    }
+    data_free(data);
+    bench_add(cfg->bench, BENCH_OUTPUT, start);
+}
+
+/// An event or log message held by a batch worker.
+typedef struct held_event {
+    data_t *data;
+    int level;
+} held_event_t;
+
+/// Hand the data structure to the event loop if called on the DSP worker,
+/// hold it if called on a batch worker, output it directly otherwise.
+static void dispatch_data(r_cfg_t *cfg, data_t *data, int level)
+{
+    if (cfg->held_events) {
+        held_event_t *event = malloc(sizeof(*event));
+        if (!event)
+            FATAL_MALLOC("dispatch_data()");
+        event->data  = data;
+        event->level = level;
+        list_push(cfg->held_events, event);
+        return;
+    }
+    if (cfg->dsp_worker && dsp_worker_in_thread(cfg->dsp_worker)) {
+        dsp_worker_emit(cfg->dsp_worker, data, level);
+        return;
+    }
+    output_data(cfg, data, level);
+}
+
+static void drain_dsp_event(void *ctx, data_t *data, int level)
+{
+    output_data(ctx, data, level);
+}
+
+void flush_dsp_events(r_cfg_t *cfg)
+{
+    if (cfg->dsp_worker) {
+        dsp_worker_drain(cfg->dsp_worker, drain_dsp_event, cfg);
+    }
+}
+
+void r_output_held_events(r_cfg_t *cfg, list_t *held_events, char const *in_filename)
+{
+    char const *in_filename_0 = cfg->in_filename;
+    cfg->in_filename = in_filename; // for the data tags
+
+    for (size_t i = 0; i < held_events->len; ++i) {
+        held_event_t *event = held_events->elems[i];
+        output_data(cfg, event->data, event->level);
+    }
+    list_free_elems(held_events, free);
+
+    cfg->in_filename = in_filename_0;
+}
+
+static void held_event_free(held_event_t *event)
+{
+    data_free(event->data);
+    free(event);
+}
+
+void r_free_held_events(list_t *held_events)
+{
+    list_free_elems(held_events, (list_elem_free_fn)held_event_free);
+}
+
+/// The batch worker running on this thread, see r_redirect_batch_logging().
+static THREAD_LOCAL r_cfg_t *batch_worker;
+
+/// A log message from a pool thread, see r_hold_logs().
+typedef struct held_log {
+    log_level_t level;
+    char const *src;
+    char *msg;
+} held_log_t;
+
+/// The list holding the log messages of this thread, see r_hold_logs().
+static THREAD_LOCAL list_t *held_logs;
+
+static void held_log_push(log_level_t level, char const *src, char const *msg)
+{
+    held_log_t *log = malloc(sizeof(*log));
+    if (!log)
+        FATAL_MALLOC("held_log_push()");
+    log->level = level;
+    log->src   = src;
+    log->msg   = strdup(msg);
+    if (!log->msg)
+        FATAL_STRDUP("held_log_push()");
+    list_push(held_logs, log);
+}
+
+static void held_log_free(held_log_t *log)
+{
+    free(log->msg);
+    free(log);
+}
+
 static void log_handler(log_level_t level, char const *src, char const *msg, void *userdata)
 {
-    r_cfg_t *cfg = userdata;
+    r_cfg_t *cfg = batch_worker ? batch_worker : userdata;
 
     if (cfg->verbosity < (int)level) {
         return;
     }
+    // outputs are not thread-safe, hold messages from pool threads
+    if (held_logs) {
+        held_log_push(level, src, msg);
+        return;
+    }
     /* clang-format off */
     data_t *data = data_make(
             "src",     "",     DATA_STRING, src,
@@ -630,13 +1136,7 @@ static void log_handler(log_level_t level, char const *src, char const *msg, voi
                 data_str(NULL, "time", "", NULL, time_str));
     }
 
-    for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
-        data_output_t *output = cfg->output_handler.elems[i];
-        if (output && output->log_level >= (int)level) {
-            data_output_print(output, data);
-        }
-    }
-    data_free(data);
+    dispatch_data(cfg, data, level);
 }
 
 void r_redirect_logging(r_cfg_t *cfg)
@@ -644,6 +1144,25 @@ void r_redirect_logging(r_cfg_t *cfg)
     r_logger_set_log_handler(log_handler, cfg);
 }
 
+void r_redirect_batch_logging(r_cfg_t *worker)
+{
+    batch_worker = worker;
+}
+
+void r_hold_logs(list_t *logs)
+{
+    held_logs = logs;
+}
+
+void r_flush_held_logs(list_t *logs)
+{
+    for (void **iter = logs->elems; iter && *iter; ++iter) {
+        held_log_t *log = *iter;
+        print_log(log->level, log->src, log->msg);
+    }
+    list_free_elems(logs, (list_elem_free_fn)held_log_free);
+}
+
 /** Pass the data structure to all output handlers. Frees data afterwards. */
 void event_occurred_handler(r_cfg_t *cfg, data_t *data)
 {
@@ -655,11 +1174,7 @@ void event_occurred_handler(r_cfg_t *cfg, data_t *data)
                 data_str(NULL, "time", "", NULL, time_str));
     }
 
-    for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
-        data_output_t *output = cfg->output_handler.elems[i];
-        data_output_print(output, data);
-    }
-    data_free(data);
+    dispatch_data(cfg, data, OUTPUT_EVENT);
 }
 
 /** Pass the data structure to all output handlers. Frees data afterwards. */
@@ -675,13 +1190,76 @@ void log_device_handler(r_device *r_dev, int level, data_t *data)
                 data_str(NULL, "time", "", NULL, time_str));
     }
 
-    for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
-        data_output_t *output = cfg->output_handler.elems[i];
-        if (output && output->log_level >= level) {
-            data_output_print(output, data);
+    dispatch_data(cfg, data, level);
+}
+
+/* unit conversion */
+
+/// Conversion of double fields by key suffix, the first match for the conversion mode applies.
+typedef struct unit_conversion {
+    conversion_mode_t mode;
+    char const *suffix;    ///< key suffix to convert
+    char const *to_suffix; ///< replacement for every occurrence of the suffix in the key
+    char const *unit;      ///< unit in the format
+    char const *to_unit;   ///< replacement for every occurrence of the unit in the format
+    int last_only;         ///< only replace the last unit character in the format
+    float (*convert)(float);
+} unit_conversion_t;
+
+static unit_conversion_t const unit_conversions[] = {
+        {CONVERT_SI, "_F", "_C", "F", "C", 1, fahrenheit2celsius},
+        {CONVERT_SI, "_mi_h", "_km_h", "mi/h", "km/h", 0, mph2kmph},
+        {CONVERT_SI, "_in", "_mm", "in", "mm", 0, inch2mm},
+        {CONVERT_SI, "_in_h", "_mm_h", "in/h", "mm/h", 0, inch2mm},
+        {CONVERT_SI, "_inHg", "_hPa", "inHg", "hPa", 0, inhg2hpa},
+        {CONVERT_SI, "_PSI", "_kPa", "PSI", "kPa", 0, psi2kpa},
+        {CONVERT_CUSTOMARY, "_C", "_F", "C", "F", 1, celsius2fahrenheit},
+        {CONVERT_CUSTOMARY, "_km_h", "_mi_h", "km/h", "mi/h", 0, kmph2mph},
+        {CONVERT_CUSTOMARY, "_mm", "_in", "mm", "in", 0, mm2inch},
+        {CONVERT_CUSTOMARY, "_mm_h", "_in_h", "mm/h", "in/h", 0, mm2inch},
+        {CONVERT_CUSTOMARY, "_hPa", "_inHg", "hPa", "inHg", 0, hpa2inhg},
+        {CONVERT_CUSTOMARY, "_kPa", "_PSI", "kPa", "PSI", 0, kpa2psi},
+};
+
+/// The unit conversions of an interned key, indexed by the key ID.
+typedef struct unit_key {
+    int resolved;
+    unsigned char conversion[2]; ///< 1 + index into unit_conversions for SI and customary, 0 for none
+    char const *key[2];          ///< the interned converted key for SI and customary
+} unit_key_t;
+
+static unit_key_t const *unit_key_resolve(r_cfg_t *cfg, char const *key)
+{
+    unsigned id = data_key_id(key);
+    if (id >= cfg->unit_keys_len) {
+        unsigned len = id + 1 > cfg->unit_keys_len * 2 ? id + 1 : cfg->unit_keys_len * 2;
+        unit_key_t *unit_keys = realloc(cfg->unit_keys, len * sizeof(*unit_keys));
+        if (!unit_keys)
+            FATAL_REALLOC("unit_key_resolve()");
+        memset(&unit_keys[cfg->unit_keys_len], 0, (len - cfg->unit_keys_len) * sizeof(*unit_keys));
+        cfg->unit_keys     = unit_keys;
+        cfg->unit_keys_len = len;
+    }
+
+    unit_key_t *unit_key = &cfg->unit_keys[id];
+    if (!unit_key->resolved) {
+        unit_key->resolved = 1;
+        for (int customary = 0; customary < 2; ++customary) {
+            conversion_mode_t mode = customary ? CONVERT_CUSTOMARY : CONVERT_SI;
+            for (unsigned i = 0; i < sizeof(unit_conversions) / sizeof(*unit_conversions); ++i) {
+                unit_conversion_t const *conv = &unit_conversions[i];
+                if (conv->mode == mode && str_endswith(key, conv->suffix)) {
+                    char *new_label = str_replace(key, conv->suffix, conv->to_suffix);
+                    unit_key->key[customary] = data_intern(new_label);
+                    free(new_label);
+                    if (unit_key->key[customary])
+                        unit_key->conversion[customary] = i + 1;
+                    break;
+                }
+            }
         }
     }
-    data_free(data);
+    return unit_key;
 }
 
 /** Pass the data structure to all output handlers. Frees data afterwards. */
@@ -705,133 +1283,27 @@ void data_acquired_handler(r_device *r_dev, data_t *data)
     }
 #endif
 
-    if (cfg->conversion_mode == CONVERT_SI) {
-        for (data_t *d = data; d; d = d->next) {
-            // Convert double type fields ending in _F to _C
-            if ((d->type == DATA_DOUBLE) && str_endswith(d->key, "_F")) {
-                d->value.v_dbl = fahrenheit2celsius(d->value.v_dbl);
-                char *new_label = str_replace(d->key, "_F", "_C");
-                free(d->key);
-                d->key = new_label;
-                char *pos;
-                if (d->format && (pos = strrchr(d->format, 'F'))) {
-                    *pos = 'C';
-                }
-            }
-            // Convert double type fields ending in _mi_h to _km_h
-            else if ((d->type == DATA_DOUBLE) && str_endswith(d->key, "_mi_h")) {
-                d->value.v_dbl = mph2kmph(d->value.v_dbl);
-                char *new_label = str_replace(d->key, "_mi_h", "_km_h");
-                free(d->key);
-                d->key = new_label;
-                char *new_format_label = str_replace(d->format, "mi/h", "km/h");
-                free(d->format);
-                d->format = new_format_label;
-            }
-            // Convert double type fields ending in _in to _mm
-            else if ((d->type == DATA_DOUBLE) && str_endswith(d->key, "_in")) {
-                d->value.v_dbl = inch2mm(d->value.v_dbl);
-                char *new_label = str_replace(d->key, "_in", "_mm");
-                free(d->key);
-                d->key = new_label;
-                char *new_format_label = str_replace(d->format, "in", "mm");
-                free(d->format);
-                d->format = new_format_label;
-            }
-            // Convert double type fields ending in _in_h to _mm_h
-            else if ((d->type == DATA_DOUBLE) && str_endswith(d->key, "_in_h")) {
-                d->value.v_dbl = inch2mm(d->value.v_dbl);
-                char *new_label = str_replace(d->key, "_in_h", "_mm_h");
-                free(d->key);
-                d->key = new_label;
-                char *new_format_label = str_replace(d->format, "in/h", "mm/h");
-                free(d->format);
-                d->format = new_format_label;
-            }
-            // Convert double type fields ending in _inHg to _hPa
-            else if ((d->type == DATA_DOUBLE) && str_endswith(d->key, "_inHg")) {
-                d->value.v_dbl = inhg2hpa(d->value.v_dbl);
-                char *new_label = str_replace(d->key, "_inHg", "_hPa");
-                free(d->key);
-                d->key = new_label;
-                char *new_format_label = str_replace(d->format, "inHg", "hPa");
-                free(d->format);
-                d->format = new_format_label;
-            }
-            // Convert double type fields ending in _PSI to _kPa
-            else if ((d->type == DATA_DOUBLE) && str_endswith(d->key, "_PSI")) {
-                d->value.v_dbl = psi2kpa(d->value.v_dbl);
-                char *new_label = str_replace(d->key, "_PSI", "_kPa");
-                free(d->key);
-                d->key = new_label;
-                char *new_format_label = str_replace(d->format, "PSI", "kPa");
-                free(d->format);
-                d->format = new_format_label;
-            }
-        }
-    }
-    if (cfg->conversion_mode == CONVERT_CUSTOMARY) {
+    if (cfg->conversion_mode == CONVERT_SI || cfg->conversion_mode == CONVERT_CUSTOMARY) {
+        int customary = cfg->conversion_mode == CONVERT_CUSTOMARY;
         for (data_t *d = data; d; d = d->next) {
-            // Convert double type fields ending in _C to _F
-            if ((d->type == DATA_DOUBLE) && str_endswith(d->key, "_C")) {
-                d->value.v_dbl = celsius2fahrenheit(d->value.v_dbl);
-                char *new_label = str_replace(d->key, "_C", "_F");
-                free(d->key);
-                d->key = new_label;
+            if (d->type != DATA_DOUBLE)
+                continue;
+            unit_key_t const *unit_key = unit_key_resolve(cfg, d->key);
+            if (!unit_key->conversion[customary])
+                continue;
+            unit_conversion_t const *conv = &unit_conversions[unit_key->conversion[customary] - 1];
+            d->value.v_dbl = conv->convert(d->value.v_dbl);
+            d->key = unit_key->key[customary];
+            if (conv->last_only) {
                 char *pos;
-                if (d->format && (pos = strrchr(d->format, 'C'))) {
-                    *pos = 'F';
+                if (d->format && (pos = strrchr(d->format, conv->unit[0]))) {
+                    *pos = conv->to_unit[0];
                 }
             }
-            // Convert double type fields ending in _km_h to _mi_h
-            else if ((d->type == DATA_DOUBLE) && str_endswith(d->key, "_km_h")) {
-                d->value.v_dbl = kmph2mph(d->value.v_dbl);
-                char *new_label = str_replace(d->key, "_km_h", "_mi_h");
-                free(d->key);
-                d->key = new_label;
-                char *new_format_label = str_replace(d->format, "km/h", "mi/h");
-                free(d->format);
-                d->format = new_format_label;
-            }
-            // Convert double type fields ending in _mm to _in
-            else if ((d->type == DATA_DOUBLE) && str_endswith(d->key, "_mm")) {
-                d->value.v_dbl = mm2inch(d->value.v_dbl);
-                char *new_label = str_replace(d->key, "_mm", "_in");
-                free(d->key);
-                d->key = new_label;
-                char *new_format_label = str_replace(d->format, "mm", "in");
-                free(d->format);
-                d->format = new_format_label;
-            }
-            // Convert double type fields ending in _mm_h to _in_h
-            else if ((d->type == DATA_DOUBLE) && str_endswith(d->key, "_mm_h")) {
-                d->value.v_dbl = mm2inch(d->value.v_dbl);
-                char *new_label = str_replace(d->key, "_mm_h", "_in_h");
-                free(d->key);
-                d->key = new_label;
-                char *new_format_label = str_replace(d->format, "mm/h", "in/h");
-                free(d->format);
-                d->format = new_format_label;
-            }
-            // Convert double type fields ending in _hPa to _inHg
-            else if ((d->type == DATA_DOUBLE) && str_endswith(d->key, "_hPa")) {
-                d->value.v_dbl = hpa2inhg(d->value.v_dbl);
-                char *new_label = str_replace(d->key, "_hPa", "_inHg");
-                free(d->key);
-                d->key = new_label;
-                char *new_format_label = str_replace(d->format, "hPa", "inHg");
-                free(d->format);
-                d->format = new_format_label;
-            }
-            // Convert double type fields ending in _kPa to _PSI
-            else if ((d->type == DATA_DOUBLE) && str_endswith(d->key, "_kPa")) {
-                d->value.v_dbl = kpa2psi(d->value.v_dbl);
-                char *new_label = str_replace(d->key, "_kPa", "_PSI");
-                free(d->key);
-                d->key = new_label;
-                char *new_format_label = str_replace(d->format, "kPa", "PSI");
-                free(d->format);
-                d->format = new_format_label;
+            else {
+                char *new_format_label = str_replace(d->format, conv->unit, conv->to_unit);
+                d->format = data_strcpy(d, new_format_label);
+                free(new_format_label);
             }
         }
     }
@@ -872,17 +1344,8 @@ void data_acquired_handler(r_device *r_dev, data_t *data)
                 data_str(NULL, "time", "", NULL, time_str));
     }
 
-    // apply all tags
-    for (void **iter = cfg->data_tags.elems; iter && *iter; ++iter) {
-        data_tag_t *tag = *iter;
-        data            = data_tag_apply(tag, data, cfg->in_filename);
-    }
-
-    for (size_t i = 0; i < cfg->output_handler.len; ++i) { // list might contain NULLs
-        data_output_t *output = cfg->output_handler.elems[i];
-        data_output_print(output, data);
-    }
-    data_free(data);
+    // tags are applied on output, data tags might not be safe to read from the DSP worker
+    dispatch_data(cfg, data, OUTPUT_DEVICE_EVENT);
 }
 
 // level 0: do not report (don't call this), 1: report successful devices, 2: report active devices, 3: report all
@@ -928,6 +1391,7 @@ data_t *create_report_data(r_cfg_t *cfg, int level)
             "count",            "", DATA_INT, cfg->frames_ook,
             "fsk",              "", DATA_INT, cfg->frames_fsk,
             "events",           "", DATA_INT, cfg->frames_events,
+            "decoders",         "", DATA_INT, cfg->frames_decoders,
             NULL);
 
     char since_str[LOCAL_TIME_BUFLEN];
@@ -940,6 +1404,53 @@ data_t *create_report_data(r_cfg_t *cfg, int level)
             "stats",            "", DATA_ARRAY, data_array(dev_data_list.len, DATA_DATA, dev_data_list.elems),
             NULL);
 
+    if (cfg->dsp_worker) {
+        dsp_worker_stats_t stats;
+        dsp_worker_get_stats(cfg->dsp_worker, &stats);
+        data_t *dsp_data = data_make(
+                "frames",           "", DATA_INT, stats.frames,
+                "drops",            "", DATA_INT, stats.drops,
+                "queue_depth",      "", DATA_INT, stats.queue_depth,
+                "queue_max",        "", DATA_INT, stats.queue_max,
+                "events",           "", DATA_INT, stats.events,
+                "events_pending",   "", DATA_INT, stats.events_pending,
+                "event_drops",      "", DATA_INT, stats.event_drops,
+                NULL);
+        data = data_dat(data, "dsp", "", NULL, dsp_data);
+    }
+
+    // sample file read-ahead and write-behind, the wait times show if the storage keeps up
+    async_io_stats_t const *io = &cfg->io_stats;
+    if (io->read_bytes || io->write_bytes) {
+        data_t *io_data = data_make(
+                "read_mb",          "", DATA_FORMAT, "%.1f", DATA_DOUBLE, io->read_bytes / 1048576.0,
+                "read_wait_ms",     "", DATA_INT, (int)(io->read_wait_ns / 1000000),
+                "write_mb",         "", DATA_FORMAT, "%.1f", DATA_DOUBLE, io->write_bytes / 1048576.0,
+                "write_wait_ms",    "", DATA_INT, (int)(io->write_wait_ns / 1000000),
+                NULL);
+        data = data_dat(data, "io", "", NULL, io_data);
+    }
+
+    // depth and age of the network output spools
+    list_t spool_data_list = {0};
+    time_t now = time(NULL);
+    spool_t *spool;
+    for (unsigned i = 0; (spool = spool_at(i)); ++i) {
+        spool_stats_t stats;
+        spool_get_stats(spool, &stats);
+        list_push(&spool_data_list, data_make(
+                "name",             "", DATA_STRING, stats.name,
+                "records",          "", DATA_INT, stats.records,
+                "bytes",            "", DATA_INT, stats.bytes > INT_MAX ? INT_MAX : (int)stats.bytes,
+                "age_sec",          "", DATA_INT, stats.oldest ? (int)(now - stats.oldest) : 0,
+                "segments",         "", DATA_INT, stats.segments,
+                "dropped",          "", DATA_INT, stats.dropped,
+                NULL));
+    }
+    if (spool_data_list.len)
+        data = data_ary(data, "spool", "", NULL, data_array(spool_data_list.len, DATA_DATA, spool_data_list.elems));
+    list_free_elems(&spool_data_list, NULL);
+
     list_free_elems(&dev_data_list, NULL);
     return data;
 }
@@ -952,6 +1463,8 @@ void flush_report_data(r_cfg_t *cfg)
     cfg->frames_ook = 0;
     cfg->frames_fsk = 0;
     cfg->frames_events = 0;
+    cfg->frames_decoders = 0;
+    cfg->io_stats = (async_io_stats_t){0};
 
     for (void **iter = r_devs->elems; iter && *iter; ++iter) {
         r_device *r_dev = *iter;
@@ -1076,6 +1589,11 @@ void add_influx_output(r_cfg_t *cfg, char *param)
     list_push(&cfg->output_handler, data_output_influx_create(get_mgr(cfg), param));
 }
 
+void add_amqp_output(r_cfg_t *cfg, char *param)
+{
+    list_push(&cfg->output_handler, data_output_amqp_create(get_mgr(cfg), param));
+}
+
 void add_syslog_output(r_cfg_t *cfg, char *param)
 {
     int log_level = lvlarg_param(&param, LOG_WARNING);
@@ -1165,6 +1683,9 @@ void reopen_dumpers(struct r_cfg *cfg)
 
             // Reopen the file
             print_logf(LOG_INFO, "Dumper", "Reopening \"%s\"", dumper->path);
+            pulse_writer_free(dumper->pulse_writer);
+            dumper->pulse_writer = NULL;
+            dumper_stop_sample_writer(dumper);
             fclose(dumper->file);
             dumper->file = fopen(dumper->path, "wb");
             if (!dumper->file) {
@@ -1177,6 +1698,10 @@ void reopen_dumpers(struct r_cfg *cfg)
             if (dumper->format == PULSE_OOK) {
                 pulse_data_print_pulse_header(dumper->file);
             }
+            if (dumper->format == PULSE_BIN) {
+                dumper->pulse_writer = pulse_writer_create(dumper->file);
+            }
+            dumper_start_sample_writer(cfg, dumper);
         }
     }
 #endif
@@ -1186,6 +1711,9 @@ void close_dumpers(struct r_cfg *cfg)
 {
     for (void **iter = cfg->demod->dumper.elems; iter && *iter; ++iter) {
         file_info_t *dumper = *iter;
+        pulse_writer_free(dumper->pulse_writer);
+        dumper->pulse_writer = NULL;
+        dumper_stop_sample_writer(dumper);
         if (dumper->file && (dumper->file != stdout)) {
             fclose(dumper->file);
             dumper->file = NULL;
@@ -1223,6 +1751,14 @@ void add_dumper(r_cfg_t *cfg, char const *spec, int overwrite)
     list_push(&cfg->demod->dumper, dumper);
 
     file_info_parse_filename(dumper, spec);
+    if (dumper->compression && !dumper_is_sample_format(dumper)) {
+        fprintf(stderr, "Compressed output is only supported for sample files (%s)\n", spec);
+        exit(1);
+    }
+    if (!compress_supported(dumper->compression)) {
+        fprintf(stderr, "Writing %s compressed output is not supported by this build (%s)\n", compress_name(dumper->compression), spec);
+        exit(1);
+    }
     if (strcmp(dumper->path, "-") == 0) { /* Write samples to stdout */
         dumper->file = stdout;
 #ifdef _WIN32
@@ -1246,6 +1782,12 @@ void add_dumper(r_cfg_t *cfg, char const *spec, int overwrite)
     if (dumper->format == PULSE_OOK) {
         pulse_data_print_pulse_header(dumper->file);
     }
+    if (dumper->format == PULSE_BIN) {
+        dumper->pulse_writer = pulse_writer_create(dumper->file);
+        if (!dumper->pulse_writer)
+            FATAL_CALLOC("add_dumper()");
+    }
+    dumper_start_sample_writer(cfg, dumper);
 }
 
 void add_infile(r_cfg_t *cfg, char *in_file)
@@ -45,6 +45,9 @@
 #include "optparse.h"
 #include "abuf.h"
 #include "fileformat.h"
+#include "pulse_file.h"
+#include "async_io.h"
+#include "compress_io.h"
 #include "samp_grab.h"
 #include "am_analyze.h"
 #include "confparse.h"
@@ -53,8 +56,16 @@
 #include "logger.h"
 #include "fatal.h"
 #include "write_sigrok.h"
+#include "dsp_worker.h"
+#include "channels.h"
+#include "thread_pool.h"
+#include "file_batch.h"
+#include "bench.h"
 #include "mongoose.h"
 
+#include <sys/types.h>
+#include <sys/stat.h>
+
 #ifdef _WIN32
 #include <io.h>
 #include <fcntl.h>
@@ -171,6 +182,13 @@ static void usage(int exit_code)
             "  [-Y autolevel] Set minlevel automatically based on average estimated noise.\n"
             "  [-Y squelch] Skip frames below estimated noise level to reduce cpu load.\n"
             "  [-Y ampest | magest] Choose amplitude or magnitude level estimator.\n"
+            "  [-Y channels] Demodulate all frequencies as channels of one wideband capture instead of hopping.\n"
+            "  [-j <threads>] Number of threads for multi-channel demodulation (default: one per CPU)\n"
+            "  [-j decoders=<threads>] Number of threads to run the decoders of each priority in parallel (default: 1, 0 for one per CPU)\n"
+            "  [-j files=<threads>] Number of threads to decode input files in parallel, output stays in file order (default: 1, 0 for one per CPU)\n"
+            "  [-j chunks=<threads>] Number of threads to decode overlapping chunks of each raw IQ input file in parallel (default: 1, 0 for one per CPU)\n",
+            DEFAULT_FREQUENCY, DEFAULT_HOP_TIME, DEFAULT_SAMPLE_RATE);
+    term_help_fprintf(exit_code ? stderr : stdout,
             "\t\t= Analyze/Debug options =\n"
             "  [-A] Pulse Analyzer. Enable pulse analysis and decode attempt.\n"
             "       Disable all decoders with -R 0 if you want analyzer output only.\n"
@@ -182,7 +200,7 @@ static void usage(int exit_code)
             "  [-w <filename> | help] Save data stream to output file (a '-' dumps samples to stdout)\n"
             "  [-W <filename> | help] Save data stream to output file, overwrite existing file\n"
             "\t\t= Data output options =\n"
-            "  [-F log | kv | json | csv | mqtt | influx | syslog | trigger | rtl_tcp | http | null | help] Produce decoded output in given format.\n"
+            "  [-F log | kv | json | csv | mqtt | influx | amqp | syslog | trigger | rtl_tcp | http | null | help] Produce decoded output in given format.\n"
             "       Append output to file with :<filename> (e.g. -F csv:log.csv), defaults to stdout.\n"
             "       Specify host/port for syslog with e.g. -F syslog:127.0.0.1:1514\n"
             "  [-M time[:<options>] | protocol | level | noise[:<secs>] | stats | bits | help] Add various meta data to each output.\n"
@@ -192,8 +210,7 @@ static void usage(int exit_code)
             "  [-T <seconds>] Specify number of seconds to run, also 12:34 or 1h23m45s\n"
             "  [-E hop | quit] Hop/Quit after outputting successful event(s)\n"
             "  [-h] Output this usage help and exit\n"
-            "       Use -d, -g, -R, -X, -F, -M, -r, -w, or -W without argument for more help\n\n",
-            DEFAULT_FREQUENCY, DEFAULT_HOP_TIME, DEFAULT_SAMPLE_RATE);
+            "       Use -d, -g, -R, -X, -F, -M, -r, -w, or -W without argument for more help\n\n");
     exit(exit_code);
 }
 
@@ -275,7 +292,7 @@ static void help_output(void)
 {
     term_help_fprintf(stdout,
             "\t\t= Output format option =\n"
-            "  [-F log|kv|json|csv|mqtt|influx|syslog|trigger|rtl_tcp|http|null] Produce decoded output in given format.\n"
+            "  [-F log|kv|json|csv|mqtt|influx|amqp|syslog|trigger|rtl_tcp|http|null] Produce decoded output in given format.\n"
             "\tWithout this option the default is LOG and KV output. Use \"-F null\" to remove the default.\n"
             "\tAppend output to file with :<filename> (e.g. -F csv:log.csv), defaults to stdout.\n"
             "  [-F mqtt[s][:[//]host[:port][,<options>]] (default: localhost:1883)\n"
@@ -291,6 +308,7 @@ static void help_output(void)
             "\t           default \"<base>/devices[/type][/model][/subtype][/channel][/id]\"\n"
             "\tA base topic can be set with base=<topic>, default is \"rtl_433/HOSTNAME\".\n"
             "\tAny topic string overrides the base topic and will expand keys like [/model]\n"
+            "\tWith dedup[=<seconds>] device fields are only published if changed, all fields again after seconds (default: 600)\n"
             "\tE.g. -F \"mqtt://localhost:1883,user=USERNAME,pass=PASSWORD,retain=0,devices=rtl_433[/id]\"\n"
             "\tFor TLS use e.g. -F \"mqtts://host,tls_cert=<path>,tls_key=<path>,tls_ca_cert=<path>\"\n"
             "\tWith MQTT each rtl_433 instance needs a distinct driver selection. The MQTT Client-ID is computed from the driver string.\n"
@@ -299,6 +317,18 @@ static void help_output(void)
             "\tSpecify InfluxDB 2.0 server with e.g. -F \"influx://localhost:9999/api/v2/write?org=<org>&bucket=<bucket>,token=<authtoken>\"\n"
             "\tSpecify InfluxDB 1.x server with e.g. -F \"influx://localhost:8086/write?db=<db>&p=<password>&u=<user>\"\n"
             "\t  Additional parameter -M time:unix:usec:utc for correct timestamps in InfluxDB recommended\n"
+            "  [-F amqp[s][:[//]host[:port][,<options>]] (default: localhost:5672)\n"
+            "\tSpecify AMQP 0-9-1 broker (e.g. RabbitMQ) with e.g. -F amqp://localhost:5672\n"
+            "\tDefault user and password are read from AMQP_USERNAME and AMQP_PASSWORD env vars, else guest.\n"
+            "\tAMQP options are: user=foo, pass=bar, vhost=/, exchange=amq.topic, persistent[=0|1],\n"
+            "\t  window=<n> unconfirmed messages (default 256), queue=<n> buffered messages (default 10000),\n"
+            "\t  events[=routing key], states[=routing key], base=<routing key>\n"
+            "\tThe default base is \"rtl_433.HOSTNAME\", events default to\n"
+            "\t  \"<base>.events[.type][.model][.subtype][.channel][.id]\" and states to \"<base>.states\".\n"
+            "\tMessages are published with confirms and resent after a reconnect if unconfirmed.\n"
+            "\tMQTT and InfluxDB outputs can spool data to disk while the server is unreachable:\n"
+            "\t  spool=<dir>, spool_size=<bytes> (default 64M), spool_rate=<records per second> for replay (default 100)\n"
+            "\tE.g. -F \"mqtt://host:1883,spool=/var/spool/rtl_433\"\n"
             "  [-F syslog[:[//]host[:port] (default: localhost:514)\n"
             "\tSpecify host/port for syslog with e.g. -F syslog:127.0.0.1:1514\n"
             "  [-F trigger:/path/to/file]\n"
@@ -348,6 +378,7 @@ static void help_meta(void)
             "\t\t(this may also be accomplished by invocation with TZ environment variable set).\n"
             "\t\t\"usec\" and \"utc\" can be combined with other options, eg. \"time:iso:utc\" or \"time:unix:usec\".\n"
             "\tUse \"replay[:N]\" to replay file inputs at (N-times) realtime.\n"
+            "\tUse \"bench\" to report the decoding speed and per stage time of each file input and in total.\n"
             "\tUse \"protocol\" / \"noprotocol\" to output the decoder protocol number meta data.\n"
             "\tUse \"level\" to add Modulation, Frequency, RSSI, SNR, and Noise meta data.\n"
             "\tUse \"noise[:<secs>]\" to report estimated noise level at intervals (default: 10 seconds).\n"
@@ -369,7 +400,8 @@ static void help_read(void)
             "\tA sample rate is detected as (fractional) number suffixed with 'k',\n"
             "\t'sps', 'ksps', 'Msps', or 'Gsps'.\n\n"
             "\tFile content and format are detected as parameters, possible options are:\n"
-            "\t'cu8', 'cs16', 'cf32' ('IQ' implied), and 'am.s16'.\n\n"
+            "\t'cu8', 'cs16', 'cf32' ('IQ' implied), 'am.s16', 'ook', and 'pulse'.\n\n"
+            "\tSample files compressed with gzip or zstd are detected by 'gz' or 'zst'.\n\n"
             "\tParameters must be separated by non-alphanumeric chars and are case-insensitive.\n"
             "\tOverrides can be prefixed, separated by colon (':')\n\n"
             "\tE.g. default detection by extension: path/filename.am.s16\n"
@@ -390,7 +422,8 @@ static void help_write(void)
             "\tFile content and format are detected as parameters, possible options are:\n"
             "\t'cu8', 'cs8', 'cs16', 'cf32' ('IQ' implied),\n"
             "\t'am.s16', 'am.f32', 'fm.s16', 'fm.f32',\n"
-            "\t'i.f32', 'q.f32', 'logic.u8', 'ook', and 'vcd'.\n\n"
+            "\t'i.f32', 'q.f32', 'logic.u8', 'ook', 'pulse', and 'vcd'.\n\n"
+            "\tSample files are compressed with gzip or zstd by 'gz' or 'zst'.\n\n"
             "\tParameters must be separated by non-alphanumeric chars and are case-insensitive.\n"
             "\tOverrides can be prefixed, separated by colon (':')\n\n"
             "\tE.g. default detection by extension: path/filename.am.s16\n"
@@ -398,6 +431,8 @@ static void help_write(void)
     exit(0);
 }
 
+static volatile sig_atomic_t sig_hup;
+
 static void reset_sdr_callback(r_cfg_t *cfg)
 {
     struct dm_state *demod = cfg->demod;
@@ -410,11 +445,64 @@ static void reset_sdr_callback(r_cfg_t *cfg)
 
     demod->min_level_auto = 0.0f;
     demod->noise_level    = 0.0f;
+    // drop the levels adjusted by autolevel, the next input starts with the configured levels
+    pulse_detect_set_levels(demod->pulse_detect, demod->use_mag_est, demod->level_limit, demod->min_level, demod->min_snr, demod->detect_verbosity);
 
     baseband_low_pass_filter_reset(&demod->lowpass_filter_state);
     baseband_demod_FM_reset(&demod->demod_FM_state);
 
     pulse_detect_reset(demod->pulse_detect);
+
+    if (demod->channels)
+        channels_reset(demod->channels);
+}
+
+/// Advance the input position, check the hop, duration, and stats timers after a frame.
+static void sdr_callback_done(r_cfg_t *cfg, uint32_t len, unsigned long n_samples, int d_events)
+{
+    cfg->input_pos += n_samples;
+    if (cfg->bytes_to_read > 0)
+        cfg->bytes_to_read -= len;
+
+    if (cfg->bench)
+        cfg->bench->events += d_events;
+
+    if (cfg->after_successful_events_flag && (d_events > 0)) {
+        if (cfg->after_successful_events_flag == 1) {
+            cfg->exit_async = 1;
+        }
+        else {
+            cfg->hop_now = 1;
+        }
+    }
+
+    time_t rawtime;
+    time(&rawtime);
+    // choose hop_index as frequency_index, if there are too few hop_times use the last one
+    int hop_index = cfg->hop_times > cfg->frequency_index ? cfg->frequency_index : cfg->hop_times - 1;
+    if (cfg->hop_times > 0 && cfg->frequencies > 1
+            && difftime(rawtime, cfg->hop_start_time) >= cfg->hop_time[hop_index]) {
+        cfg->hop_now = 1;
+    }
+    if (cfg->duration > 0 && rawtime >= cfg->stop_time) {
+        cfg->exit_async = 1;
+        print_log(LOG_CRITICAL, __func__, "Time expired, exiting!");
+    }
+    if (cfg->stats_now || (cfg->report_stats && cfg->stats_interval && rawtime >= cfg->stats_time)) {
+        event_occurred_handler(cfg, create_report_data(cfg, cfg->stats_now ? 3 : cfg->report_stats));
+        flush_report_data(cfg);
+        if (rawtime >= cfg->stats_time)
+            cfg->stats_time += cfg->stats_interval;
+        if (cfg->stats_now)
+            cfg->stats_now--;
+    }
+
+    if (cfg->hop_now && !cfg->exit_async) {
+        cfg->hop_now = 0;
+        time(&cfg->hop_start_time);
+        cfg->frequency_index = (cfg->frequency_index + 1) % cfg->frequencies;
+        sdr_set_center_freq(cfg->dev, cfg->frequency[cfg->frequency_index], 1);
+    }
 }
 
 static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
@@ -430,6 +518,12 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
         return; // ignore the data
     }
 
+    // with a DSP worker the dumpers are only safe to reopen here
+    if (sig_hup && cfg->dsp_worker) {
+        reopen_dumpers(cfg);
+        sig_hup = 0;
+    }
+
     // do this here and not in sdr_handler so realtime replay can use rtl_tcp output
     for (void **iter = cfg->raw_handler.elems; iter && *iter; ++iter) {
         raw_output_t *output = *iter;
@@ -466,9 +560,40 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
         samp_grab_push(demod->samp_grab, iq_buf, len);
     }
 
-    // AM demodulation
+    // multi-channel mode replaces the single channel demod
+    if (demod->channels && demod->load_info.format != S16_AM && demod->load_info.format != S16_FM) {
+        int d_events = channels_process(cfg, iq_buf, n_samples);
+        sdr_callback_done(cfg, len, n_samples, d_events);
+        return;
+    }
+
+    if (r_reserve_demod_buffers(cfg, n_samples)) {
+        print_log(LOG_ERROR, __func__, "Out of memory for the demodulator buffers, exiting!");
+        cfg->exit_async = 1;
+        return;
+    }
+
+    // Select the correct fsk pulse detector
+    unsigned fpdm = cfg->fsk_pulse_detect_mode;
+    if (cfg->fsk_pulse_detect_mode == FSK_PULSE_DETECT_AUTO) {
+        if (cfg->frequency[cfg->frequency_index] > FSK_PULSE_DETECTOR_LIMIT)
+            fpdm = FSK_PULSE_DETECT_NEW;
+        else
+            fpdm = FSK_PULSE_DETECT_OLD;
+    }
+    float low_pass = demod->low_pass != 0.0f ? demod->low_pass : fpdm ? 0.2f : 0.1f;
+
+    // always process frames if loader, dumper, or analyzers are in use, otherwise skip silent frames
+    int process_always = demod->squelch_offset <= 0 || demod->load_info.format || demod->analyze_pulses || demod->dumper.len || demod->samp_grab;
+
+    // AM and FM demodulation
+    uint64_t demod_start = bench_now(cfg->bench);
     float avg_db;
-    if (demod->sample_size == 2) { // CU8
+    if (process_always) {
+        // the frame is not squelched, demodulate in a single pass, buf.temp is not used
+        avg_db = baseband_demod_AM_FM(&demod->lowpass_filter_state, demod->enable_FM_demod ? &demod->demod_FM_state : NULL,
+                iq_buf, demod->sample_size, demod->use_mag_est, demod->am_buf, demod->buf.fm, n_samples, cfg->samp_rate, low_pass);
+    } else if (demod->sample_size == 2) { // CU8
         if (demod->use_mag_est) {
             //magnitude_true_cu8(iq_buf, demod->buf.temp, n_samples);
             avg_db = magnitude_est_cu8(iq_buf, demod->buf.temp, n_samples);
@@ -489,8 +614,7 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
         demod->noise_level = demod->min_level_auto - 3.0f;
     }
     int noise_only = avg_db < demod->noise_level + 3.0f; // or demod->min_level_auto?
-    // always process frames if loader, dumper, or analyzers are in use, otherwise skip silent frames
-    int process_frame = demod->squelch_offset <= 0 || !noise_only || demod->load_info.format || demod->analyze_pulses || demod->dumper.len || demod->samp_grab;
+    int process_frame = process_always || !noise_only;
     cfg->total_frames_count += 1;
     if (noise_only) {
         cfg->total_frames_squelch += 1;
@@ -506,43 +630,37 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
     } else {
         demod->noise_level = (demod->noise_level * 31 + avg_db) / 32; // slow rise over 32 frames
     }
+    if (demod->chunk) {
+        file_chunk_frame(demod->chunk, cfg->input_pos, demod->noise_level);
+    }
     // Report noise every report_noise seconds, but only for the first frame that second
     if (cfg->report_noise && last_frame_sec != demod->now.tv_sec && demod->now.tv_sec % cfg->report_noise == 0) {
         print_logf(LOG_WARNING, "Auto Level", "Current %s level %.1f dB, estimated noise %.1f dB",
                 noise_only ? "noise" : "signal", avg_db, demod->noise_level);
     }
 
-    if (process_frame) {
+    if (process_frame && !process_always) {
         baseband_low_pass_filter(&demod->lowpass_filter_state, demod->buf.temp, demod->am_buf, n_samples);
     }
 
     // FM demodulation
-    // Select the correct fsk pulse detector
-    unsigned fpdm = cfg->fsk_pulse_detect_mode;
-    if (cfg->fsk_pulse_detect_mode == FSK_PULSE_DETECT_AUTO) {
-        if (cfg->frequency[cfg->frequency_index] > FSK_PULSE_DETECTOR_LIMIT)
-            fpdm = FSK_PULSE_DETECT_NEW;
-        else
-            fpdm = FSK_PULSE_DETECT_OLD;
-    }
-
-    if (demod->enable_FM_demod && process_frame) {
-        float low_pass = demod->low_pass != 0.0f ? demod->low_pass : fpdm ? 0.2f : 0.1f;
+    if (demod->enable_FM_demod && process_frame && !process_always) {
         if (demod->sample_size == 2) { // CU8
             baseband_demod_FM(&demod->demod_FM_state, iq_buf, demod->buf.fm, n_samples, cfg->samp_rate, low_pass);
         } else { // CS16
             baseband_demod_FM_cs16(&demod->demod_FM_state, (int16_t *)iq_buf, demod->buf.fm, n_samples, cfg->samp_rate, low_pass);
         }
     }
+    bench_add(cfg->bench, BENCH_DEMOD, demod_start);
 
     // Handle special input formats
     if (demod->load_info.format == S16_AM) { // The IQ buffer is really AM demodulated data
-        if (len > sizeof(demod->am_buf))
+        if (len > demod->buf_len * sizeof(*demod->am_buf))
             FATAL("Buffer too small");
         memcpy(demod->am_buf, iq_buf, len);
     } else if (demod->load_info.format == S16_FM) { // The IQ buffer is really FM demodulated data
         // we would need AM for the envelope too
-        if (len > sizeof(demod->buf.fm))
+        if (len > demod->buf_len * sizeof(*demod->buf.fm))
             FATAL("Buffer too small");
         memcpy(demod->buf.fm, iq_buf, len);
     }
@@ -560,7 +678,15 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
         }
         while (package_type && process_frame) {
             int p_events = 0; // Sensor events successfully detected per package
+            uint64_t detect_start = bench_now(cfg->bench);
             package_type = pulse_detect_package(demod->pulse_detect, demod->am_buf, demod->buf.fm, n_samples, cfg->samp_rate, cfg->input_pos, &demod->pulse_data, &demod->fsk_pulse_data, fpdm);
+            bench_add(cfg->bench, BENCH_DETECT, detect_start);
+            if (package_type && cfg->bench)
+                cfg->bench->packages += 1;
+            if (package_type && demod->chunk
+                    && !file_chunk_package(demod->chunk, package_type == PULSE_DATA_FSK ? &demod->fsk_pulse_data : &demod->pulse_data)) {
+                continue; // the package is decoded with the neighbouring chunk
+            }
             if (package_type) {
                 // new package: set a first frame start if we are not tracking one already
                 if (!demod->frame_start_ago)
@@ -572,17 +698,23 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
                 calc_rssi_snr(cfg, &demod->pulse_data);
                 if (demod->analyze_pulses) fprintf(stderr, "Detected OOK package\t%s\n", time_pos_str(cfg, demod->pulse_data.start_ago, time_str));
 
+                uint64_t decoders_start = bench_decoders_start(cfg->bench);
                 p_events += run_ook_demods(&demod->r_devs, &demod->pulse_data);
+                bench_decoders_end(cfg->bench, decoders_start);
                 cfg->total_frames_ook += 1;
                 cfg->total_frames_events += p_events > 0;
                 cfg->frames_ook +=1;
                 cfg->frames_events += p_events > 0;
+                cfg->frames_decoders += demod->pulse_data.num_candidates;
+                if (cfg->verbosity >= LOG_DEBUG)
+                    print_logf(LOG_DEBUG, "Demod", "OOK package: ran %u of %u decoders", demod->pulse_data.num_candidates, (unsigned)demod->r_devs.len);
 
                 for (void **iter = demod->dumper.elems; iter && *iter; ++iter) {
                     file_info_t const *dumper = *iter;
                     if (dumper->format == VCD_LOGIC) pulse_data_print_vcd(dumper->file, &demod->pulse_data, '\'');
                     if (dumper->format == U8_LOGIC) pulse_data_dump_raw(demod->u8_buf, n_samples, cfg->input_pos, &demod->pulse_data, 0x02);
                     if (dumper->format == PULSE_OOK) pulse_data_dump(dumper->file, &demod->pulse_data);
+                    if (dumper->format == PULSE_BIN) pulse_writer_write(dumper->pulse_writer, &demod->pulse_data, &demod->now);
                 }
 
                 if (cfg->verbosity >= LOG_TRACE) pulse_data_print(&demod->pulse_data);
@@ -599,17 +731,23 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
                 calc_rssi_snr(cfg, &demod->fsk_pulse_data);
                 if (demod->analyze_pulses) fprintf(stderr, "Detected FSK package\t%s\n", time_pos_str(cfg, demod->fsk_pulse_data.start_ago, time_str));
 
+                uint64_t decoders_start = bench_decoders_start(cfg->bench);
                 p_events += run_fsk_demods(&demod->r_devs, &demod->fsk_pulse_data);
+                bench_decoders_end(cfg->bench, decoders_start);
                 cfg->total_frames_fsk +=1;
                 cfg->total_frames_events += p_events > 0;
                 cfg->frames_fsk += 1;
                 cfg->frames_events += p_events > 0;
+                cfg->frames_decoders += demod->fsk_pulse_data.num_candidates;
+                if (cfg->verbosity >= LOG_DEBUG)
+                    print_logf(LOG_DEBUG, "Demod", "FSK package: ran %u of %u decoders", demod->fsk_pulse_data.num_candidates, (unsigned)demod->r_devs.len);
 
                 for (void **iter = demod->dumper.elems; iter && *iter; ++iter) {
                     file_info_t const *dumper = *iter;
                     if (dumper->format == VCD_LOGIC) pulse_data_print_vcd(dumper->file, &demod->fsk_pulse_data, '"');
                     if (dumper->format == U8_LOGIC) pulse_data_dump_raw(demod->u8_buf, n_samples, cfg->input_pos, &demod->fsk_pulse_data, 0x04);
                     if (dumper->format == PULSE_OOK) pulse_data_dump(dumper->file, &demod->fsk_pulse_data);
+                    if (dumper->format == PULSE_BIN) pulse_writer_write(dumper->pulse_writer, &demod->fsk_pulse_data, &demod->now);
                 }
 
                 if (cfg->verbosity >= LOG_TRACE) pulse_data_print(&demod->fsk_pulse_data);
@@ -664,7 +802,8 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
         file_info_t const *dumper = *iter;
         if (!dumper->file
                 || dumper->format == VCD_LOGIC
-                || dumper->format == PULSE_OOK)
+                || dumper->format == PULSE_OOK
+                || dumper->format == PULSE_BIN)
             continue;
         uint8_t *out_buf = iq_buf;  // Default is to dump IQ samples
         unsigned long out_len = n_samples * demod->sample_size;
@@ -672,41 +811,41 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
         if (dumper->format == CU8_IQ) {
             if (demod->sample_size == 4) {
                 for (unsigned long n = 0; n < n_samples * 2; ++n)
-                    ((uint8_t *)demod->buf.temp)[n] = (((int16_t *)iq_buf)[n] / 256) + 128; // scale Q0.15 to Q0.7
-                out_buf = (uint8_t *)demod->buf.temp;
+                    ((uint8_t *)demod->f32_buf)[n] = (((int16_t *)iq_buf)[n] / 256) + 128; // scale Q0.15 to Q0.7
+                out_buf = (uint8_t *)demod->f32_buf;
                 out_len = n_samples * 2 * sizeof(uint8_t);
             }
         }
         else if (dumper->format == CS16_IQ) {
             if (demod->sample_size == 2) {
                 for (unsigned long n = 0; n < n_samples * 2; ++n)
-                    ((int16_t *)demod->buf.temp)[n] = (iq_buf[n] * 256) - 32768; // scale Q0.7 to Q0.15
-                out_buf = (uint8_t *)demod->buf.temp; // this buffer is too small if out_block_size is large
+                    ((int16_t *)demod->f32_buf)[n] = (iq_buf[n] * 256) - 32768; // scale Q0.7 to Q0.15
+                out_buf = (uint8_t *)demod->f32_buf;
                 out_len = n_samples * 2 * sizeof(int16_t);
             }
         }
         else if (dumper->format == CS8_IQ) {
             if (demod->sample_size == 2) {
                 for (unsigned long n = 0; n < n_samples * 2; ++n)
-                    ((int8_t *)demod->buf.temp)[n] = (iq_buf[n] - 128);
+                    ((int8_t *)demod->f32_buf)[n] = (iq_buf[n] - 128);
             }
             else if (demod->sample_size == 4) {
                 for (unsigned long n = 0; n < n_samples * 2; ++n)
-                    ((int8_t *)demod->buf.temp)[n] = ((int16_t *)iq_buf)[n] >> 8;
+                    ((int8_t *)demod->f32_buf)[n] = ((int16_t *)iq_buf)[n] >> 8;
             }
-            out_buf = (uint8_t *)demod->buf.temp;
+            out_buf = (uint8_t *)demod->f32_buf;
             out_len = n_samples * 2 * sizeof(int8_t);
         }
         else if (dumper->format == CF32_IQ) {
             if (demod->sample_size == 2) {
                 for (unsigned long n = 0; n < n_samples * 2; ++n)
-                    ((float *)demod->buf.temp)[n] = (iq_buf[n] - 128) / 128.0f;
+                    demod->f32_buf[n] = (iq_buf[n] - 128) / 128.0f;
             }
             else if (demod->sample_size == 4) {
                 for (unsigned long n = 0; n < n_samples * 2; ++n)
-                    ((float *)demod->buf.temp)[n] = ((int16_t *)iq_buf)[n] / 32768.0f;
+                    demod->f32_buf[n] = ((int16_t *)iq_buf)[n] / 32768.0f;
             }
-            out_buf = (uint8_t *)demod->buf.temp; // this buffer is too small if out_block_size is large
+            out_buf = (uint8_t *)demod->f32_buf;
             out_len = n_samples * 2 * sizeof(float);
         }
         else if (dumper->format == S16_AM) {
@@ -754,52 +893,16 @@ static void sdr_callback(unsigned char *iq_buf, uint32_t len, void *ctx)
             out_len = n_samples;
         }
 
-        if (fwrite(out_buf, 1, out_len, dumper->file) != out_len) {
+        int write_err = dumper->sample_writer
+                ? async_writer_write(dumper->sample_writer, out_buf, out_len)
+                : fwrite(out_buf, 1, out_len, dumper->file) != out_len;
+        if (write_err) {
             print_log(LOG_ERROR, __func__, "Short write, samples lost, exiting!");
             cfg->exit_async = 1;
         }
     }
 
-    cfg->input_pos += n_samples;
-    if (cfg->bytes_to_read > 0)
-        cfg->bytes_to_read -= len;
-
-    if (cfg->after_successful_events_flag && (d_events > 0)) {
-        if (cfg->after_successful_events_flag == 1) {
-            cfg->exit_async = 1;
-        }
-        else {
-            cfg->hop_now = 1;
-        }
-    }
-
-    time_t rawtime;
-    time(&rawtime);
-    // choose hop_index as frequency_index, if there are too few hop_times use the last one
-    int hop_index = cfg->hop_times > cfg->frequency_index ? cfg->frequency_index : cfg->hop_times - 1;
-    if (cfg->hop_times > 0 && cfg->frequencies > 1
-            && difftime(rawtime, cfg->hop_start_time) >= cfg->hop_time[hop_index]) {
-        cfg->hop_now = 1;
-    }
-    if (cfg->duration > 0 && rawtime >= cfg->stop_time) {
-        cfg->exit_async = 1;
-        print_log(LOG_CRITICAL, __func__, "Time expired, exiting!");
-    }
-    if (cfg->stats_now || (cfg->report_stats && cfg->stats_interval && rawtime >= cfg->stats_time)) {
-        event_occurred_handler(cfg, create_report_data(cfg, cfg->stats_now ? 3 : cfg->report_stats));
-        flush_report_data(cfg);
-        if (rawtime >= cfg->stats_time)
-            cfg->stats_time += cfg->stats_interval;
-        if (cfg->stats_now)
-            cfg->stats_now--;
-    }
-
-    if (cfg->hop_now && !cfg->exit_async) {
-        cfg->hop_now = 0;
-        time(&cfg->hop_start_time);
-        cfg->frequency_index = (cfg->frequency_index + 1) % cfg->frequencies;
-        sdr_set_center_freq(cfg->dev, cfg->frequency[cfg->frequency_index], 1);
-    }
+    sdr_callback_done(cfg, len, n_samples, d_events);
 }
 
 static int hasopt(int test, int argc, char *argv[], char const *optstring)
@@ -816,7 +919,7 @@ static int hasopt(int test, int argc, char *argv[], char const *optstring)
 
 static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg);
 
-#define OPTSTRING "hVvqD:c:x:z:p:a:AI:S:m:M:r:w:W:l:d:t:f:H:g:s:b:n:R:X:F:K:C:T:UGy:E:Y:"
+#define OPTSTRING "hVvqD:c:x:z:p:a:AI:S:m:M:r:w:W:l:d:t:f:H:g:s:b:n:R:X:F:K:C:T:UGy:E:Y:j:"
 
 // these should match the short options exactly
 static struct conf_keywords const conf_keywords[] = {
@@ -855,6 +958,7 @@ static struct conf_keywords const conf_keywords[] = {
         {"duration", 'T'},
         {"test_data", 'y'},
         {"stop_after_successful_events", 'E'},
+        {"threads", 'j'},
         {NULL, 0}};
 
 static void parse_conf_text(r_cfg_t *cfg, char *conf)
@@ -1154,6 +1258,8 @@ static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg)
         }
         else if (!strncasecmp(arg, "replay", 6))
             cfg->in_replay = atobv(arg_param(arg), 1);
+        else if (!strcasecmp(arg, "bench"))
+            cfg->report_bench = 1;
         else
             cfg->report_meta = atobv(arg, 1);
         break;
@@ -1237,6 +1343,9 @@ static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg)
         else if (strncmp(arg, "influx", 6) == 0) {
             add_influx_output(cfg, arg);
         }
+        else if (strncmp(arg, "amqp", 4) == 0) {
+            add_amqp_output(cfg, arg);
+        }
         else if (strncmp(arg, "syslog", 6) == 0) {
             add_syslog_output(cfg, arg_param(arg));
         }
@@ -1322,6 +1431,8 @@ static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg)
                 cfg->demod->min_snr = arg_float(val, "-Y minsnr: ");
             else if (kwargs_match(p, "filter", &val))
                 cfg->demod->low_pass = arg_float(val, "-Y filter: ");
+            else if (kwargs_match(p, "channels", &val))
+                cfg->channel_mode = atobv(val, 1);
             else {
                 fprintf(stderr, "Unknown pulse detector setting: %s\n", p);
                 usage(1);
@@ -1329,6 +1440,37 @@ static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg)
             p = kwargs_skip(p);
         }
         break;
+    case 'j':
+        if (arg && !strncmp(arg, "decoders=", 9)) {
+            cfg->decoder_threads = atoiv(arg + 9, 0);
+            if (cfg->decoder_threads < 0) {
+                fprintf(stderr, "Number of threads must be positive\n");
+                usage(1);
+            }
+            break;
+        }
+        if (arg && !strncmp(arg, "chunks=", 7)) {
+            cfg->chunk_threads = atoiv(arg + 7, 0);
+            if (cfg->chunk_threads < 0) {
+                fprintf(stderr, "Number of threads must be positive\n");
+                usage(1);
+            }
+            break;
+        }
+        if (arg && !strncmp(arg, "files=", 6)) {
+            cfg->file_threads = atoiv(arg + 6, 0);
+            if (cfg->file_threads < 0) {
+                fprintf(stderr, "Number of threads must be positive\n");
+                usage(1);
+            }
+            break;
+        }
+        cfg->threads = atoiv(arg, 0);
+        if (cfg->threads < 0) {
+            fprintf(stderr, "Number of threads must be positive\n");
+            usage(1);
+        }
+        break;
     case 'E':
         if (arg && !strcmp(arg, "hop")) {
             cfg->after_successful_events_flag = 2;
@@ -1347,7 +1489,6 @@ static void parse_conf_option(r_cfg_t *cfg, int opt, char *arg)
 }
 
 static r_cfg_t g_cfg;
-static volatile sig_atomic_t sig_hup;
 
 // TODO: SIGINFO is not in POSIX...
 #ifndef SIGINFO
@@ -1459,6 +1600,7 @@ static void sdr_handler(struct mg_connection *nc, int ev_type, void *ev_data)
         event_occurred_handler(cfg, data);
     }
 
+    // data frames only get here without a DSP worker, otherwise dsp_process() runs them
     if (ev->ev == SDR_EV_DATA) {
         cfg->samp_rate        = ev->sample_rate;
         cfg->center_frequency = ev->center_frequency;
@@ -1473,6 +1615,44 @@ static void sdr_handler(struct mg_connection *nc, int ev_type, void *ev_data)
     }
 }
 
+// called by mg_mgr_poll() for each connection.
+// drains the events queued by the DSP worker.
+static void dsp_handler(struct mg_connection *nc, int ev_type, void *ev_data)
+{
+    UNUSED(ev_data);
+    // only process polls on the dummy nc
+    if (nc->sock != INVALID_SOCKET || ev_type != MG_EV_POLL) {
+        return;
+    }
+    // only process a broadcast on our defined timer nc
+    if (nc->handler != timer_handler) {
+        return;
+    }
+
+    r_cfg_t *cfg = nc->user_data;
+    flush_dsp_events(cfg);
+}
+
+// note that this function is called on the DSP worker thread,
+// the worker holds the state lock, see dsp_worker_lock()
+static void dsp_process(sdr_event_t *ev, void *ctx)
+{
+    r_cfg_t *cfg = ctx;
+
+    cfg->samp_rate        = ev->sample_rate;
+    cfg->center_frequency = ev->center_frequency;
+    sdr_callback((unsigned char *)ev->buf, ev->len, cfg);
+}
+
+// note that this function is called on the DSP worker thread
+static void dsp_notify(void *ctx)
+{
+    r_cfg_t *cfg = ctx;
+
+    // thread-safe wake up of the event loop to drain the events
+    mg_broadcast(cfg->mgr, dsp_handler, NULL, 0);
+}
+
 // note that this function is called in a different thread
 static void acquire_callback(sdr_event_t *ev, void *ctx)
 {
@@ -1480,9 +1660,14 @@ static void acquire_callback(sdr_event_t *ev, void *ctx)
     //get_time_now(&now);
     //fprintf(stderr, "%ld.%06ld acquire_callback...\n", (long)now.tv_sec, (long)now.tv_usec);
 
-    struct mg_mgr *mgr = ctx;
+    r_cfg_t *cfg = ctx;
+    struct mg_mgr *mgr = cfg->mgr;
 
-    // TODO: We should run the demod here to unblock the event loop
+    // run the demod on the DSP worker to unblock the event loop, the frame is copied
+    if (cfg->dsp_worker && ev->ev == SDR_EV_DATA) {
+        dsp_worker_push(cfg->dsp_worker, ev);
+        return;
+    }
 
     // thread-safe dispatch, ev_data is the iq buffer pointer and length
     // mg_mgr_poll() calls specified callback for each connection.
@@ -1537,7 +1722,7 @@ static int start_sdr(r_cfg_t *cfg)
 
     sdr_set_center_freq(cfg->dev, cfg->center_frequency, 1); // always verbose
 
-    r = sdr_start(cfg->dev, acquire_callback, (void *)get_mgr(cfg),
+    r = sdr_start(cfg->dev, acquire_callback, (void *)cfg,
             DEFAULT_ASYNC_BUF_NUMBER, cfg->out_block_size);
     if (r < 0) {
         print_logf(LOG_ERROR, "Input", "async start failed (%d).", r);
@@ -1551,7 +1736,7 @@ static void timer_handler(struct mg_connection *nc, int ev, void *ev_data)
 {
     //fprintf(stderr, "%s: %d, %d, %p, %p\n", __func__, nc->sock, ev, nc->user_data, ev_data);
     r_cfg_t *cfg = (r_cfg_t *)nc->user_data;
-    if (sig_hup) {
+    if (sig_hup && !cfg->dsp_worker) {
         reopen_dumpers(cfg);
         sig_hup = 0;
     }
@@ -1563,14 +1748,17 @@ static void timer_handler(struct mg_connection *nc, int ev, void *ev_data)
         //fprintf(stderr, "timer event, current time: %.2lf, next timer: %.2lf\n", now, next);
         mg_set_timer(nc, next); // Send us timer event again after 1.5 seconds
 
-        // Did we acquire data frames in the last interval?
-        if (cfg->watchdog != 0) {
+        // Did we acquire data frames in the last interval? The DSP worker counts them
+        dsp_worker_lock(cfg->dsp_worker);
+        int watchdog  = cfg->watchdog;
+        cfg->watchdog = 0;
+        dsp_worker_unlock(cfg->dsp_worker);
+        if (watchdog != 0) {
             if (cfg->dev_state == DEVICE_STATE_STARTING
                     || cfg->dev_state == DEVICE_STATE_GRACE) {
                 cfg->dev_state = DEVICE_STATE_STARTED;
                 time(&cfg->sdr_since);
             }
-            cfg->watchdog = 0;
             break;
         }
 
@@ -1612,7 +1800,10 @@ static void timer_handler(struct mg_connection *nc, int ev, void *ev_data)
             cfg->exit_async = 1;
         }
         if (cfg->dev_mode == DEVICE_MODE_RESTART) {
+            // the DSP worker uses the device and sets the sample rate and frequency
+            dsp_worker_lock(cfg->dsp_worker);
             start_sdr(cfg);
+            dsp_worker_unlock(cfg->dsp_worker);
         }
         // do nothing for DEVICE_MODE_PAUSE or DEVICE_MODE_MANUAL
 
@@ -1621,6 +1812,332 @@ static void timer_handler(struct mg_connection *nc, int ev, void *ev_data)
     }
 }
 
+/// Check if the input is a pipe or a device rather than a regular file.
+static int input_is_live(FILE *file)
+{
+#ifdef _WIN32
+    struct _stat64 st;
+    return _fstat64(_fileno(file), &st) != 0 || (st.st_mode & _S_IFMT) != _S_IFREG;
+#else
+    struct stat st;
+    return fstat(fileno(file), &st) != 0 || !S_ISREG(st.st_mode);
+#endif
+}
+
+/// Decode one input file, or a chunk of it, returns 0 on success, -1 if the file could not be read.
+static int process_input_file(r_cfg_t *cfg, char const *in_filename, file_chunk_t *chunk, uint32_t sample_rate_0, unsigned char *test_mode_buf, float *test_mode_float_buf)
+{
+    struct dm_state *demod = cfg->demod;
+
+    cfg->in_filename = in_filename;
+
+    file_info_clear(&demod->load_info); // reset all info
+    file_info_parse_filename(&demod->load_info, cfg->in_filename);
+    // apply file info or default
+    cfg->samp_rate        = demod->load_info.sample_rate ? demod->load_info.sample_rate : sample_rate_0;
+    cfg->center_frequency = demod->load_info.center_frequency ? demod->load_info.center_frequency
+            : cfg->channel_mode ? channels_center_frequency(cfg) : cfg->frequency[0];
+
+    if (demod->load_info.compression
+            && (demod->load_info.format == PULSE_OOK || demod->load_info.format == PULSE_BIN)) {
+        print_logf(LOG_ERROR, "Input", "Compressed input is only supported for sample files \"%s\"", cfg->in_filename);
+        return -1;
+    }
+    if (!compress_supported(demod->load_info.compression)) {
+        print_logf(LOG_ERROR, "Input", "Reading %s compressed input is not supported by this build \"%s\"", compress_name(demod->load_info.compression), cfg->in_filename);
+        return -1;
+    }
+
+    FILE *in_file;
+    if (strcmp(demod->load_info.path, "-") == 0) { // read samples from stdin
+        in_file = stdin;
+        cfg->in_filename = "<stdin>";
+    } else {
+        in_file = fopen(demod->load_info.path, "rb");
+        if (!in_file) {
+            print_logf(LOG_ERROR, "Input", "Opening file \"%s\" failed!", cfg->in_filename);
+            return -1;
+        }
+    }
+    if (!chunk || !chunk->read_start) {
+        print_logf(LOG_CRITICAL, "Input", "Test mode active. Reading samples from file: %s", cfg->in_filename); // Essential information (not quiet)
+    }
+    if (demod->load_info.format == CU8_IQ
+            || demod->load_info.format == CS8_IQ
+            || demod->load_info.format == S16_AM
+            || demod->load_info.format == S16_FM) {
+        demod->sample_size = sizeof(uint8_t) * 2; // CU8, AM, FM
+    } else if (demod->load_info.format == CS16_IQ
+            || demod->load_info.format == CF32_IQ) {
+        demod->sample_size = sizeof(int16_t) * 2; // CS16, CF32 (after conversion)
+    } else if (demod->load_info.format == PULSE_OOK
+            || demod->load_info.format == PULSE_BIN) {
+        // ignore
+    } else {
+        print_logf(LOG_ERROR, "Input", "Input format invalid \"%s\"", file_info_string(&demod->load_info));
+        return -1;
+    }
+    if (cfg->verbosity >= LOG_NOTICE && (!chunk || !chunk->read_start)) {
+        if (demod->load_info.compression)
+            print_logf(LOG_NOTICE, "Input", "Input format \"%s\", %s compressed", file_info_string(&demod->load_info), compress_name(demod->load_info.compression));
+        else
+            print_logf(LOG_NOTICE, "Input", "Input format \"%s\"", file_info_string(&demod->load_info));
+    }
+    demod->sample_file_pos = 0.0;
+    if (cfg->bench) {
+        bench_input_start(cfg->bench, cfg->in_filename, &demod->r_devs);
+    }
+
+    // special case for pulse data file-inputs
+    if (demod->load_info.format == PULSE_OOK
+            || demod->load_info.format == PULSE_BIN) {
+        pulse_reader_t *pulse_reader = NULL;
+        uint64_t package_offset      = 0; // offset of the first segment of the package
+        if (demod->load_info.format == PULSE_BIN) {
+            pulse_reader = pulse_reader_open(in_file);
+            if (!pulse_reader) {
+                print_logf(LOG_ERROR, "Input", "Reading pulse file \"%s\" failed!", cfg->in_filename);
+                if (in_file != stdin) {
+                    fclose(in_file);
+                }
+                return -1;
+            }
+            if (cfg->verbosity >= LOG_NOTICE) {
+                print_logf(LOG_NOTICE, "Input", "Pulse file has %u packages", pulse_reader_count(pulse_reader));
+            }
+        }
+        while (!cfg->exit_async) {
+            if (pulse_reader) {
+                int ret = pulse_reader_read(pulse_reader, &demod->pulse_data, &demod->now);
+                if (ret < 0)
+                    print_logf(LOG_ERROR, "Input", "Pulse file \"%s\" is corrupt", cfg->in_filename);
+                if (ret <= 0)
+                    break;
+                // restore the sample rate and stream position for the time of events
+                if (demod->pulse_data.sample_rate)
+                    cfg->samp_rate = demod->pulse_data.sample_rate;
+                // events of a long package are timed at its start, as when decoding the samples
+                if (!demod->pulse_data.segment)
+                    package_offset = demod->pulse_data.offset;
+                demod->sample_file_pos = (float)(package_offset + demod->pulse_data.start_ago) / cfg->samp_rate;
+            }
+            else {
+                pulse_data_load(in_file, &demod->pulse_data, cfg->samp_rate);
+                if (!demod->pulse_data.num_pulses)
+                    break;
+            }
+            if (cfg->bench)
+                cfg->bench->packages += 1;
+
+            for (void **iter2 = demod->dumper.elems; iter2 && *iter2; ++iter2) {
+                file_info_t const *dumper = *iter2;
+                if (dumper->format == VCD_LOGIC) {
+                    pulse_data_print_vcd(dumper->file, &demod->pulse_data, '\'');
+                } else if (dumper->format == PULSE_OOK) {
+                    pulse_data_dump(dumper->file, &demod->pulse_data);
+                } else if (dumper->format == PULSE_BIN) {
+                    pulse_writer_write(dumper->pulse_writer, &demod->pulse_data, &demod->now);
+                } else {
+                    print_logf(LOG_ERROR, "Input", "Dumper (%s) not supported on pulse input", dumper->spec);
+                    exit(1);
+                }
+            }
+
+            uint64_t decoders_start = bench_decoders_start(cfg->bench);
+            if (demod->pulse_data.fsk_f2_est) {
+                int p_events = run_fsk_demods(&demod->r_devs, &demod->pulse_data);
+                bench_decoders_end(cfg->bench, decoders_start);
+                if (cfg->bench)
+                    cfg->bench->events += p_events;
+            }
+            else {
+                int p_events = run_ook_demods(&demod->r_devs, &demod->pulse_data);
+                bench_decoders_end(cfg->bench, decoders_start);
+                if (cfg->bench)
+                    cfg->bench->events += p_events;
+                if (cfg->verbosity >= LOG_DEBUG)
+                    pulse_data_print(&demod->pulse_data);
+                if (demod->analyze_pulses && (cfg->grab_mode <= 1 || (cfg->grab_mode == 2 && p_events == 0) || (cfg->grab_mode == 3 && p_events > 0))) {
+                    r_device device = {.log_fn = log_device_handler, .output_ctx = cfg};
+                    pulse_analyzer(&demod->pulse_data, PULSE_DATA_OOK, &device);
+                }
+            }
+        }
+
+        pulse_reader_free(pulse_reader);
+        if (in_file != stdin) {
+            fclose(in_file);
+        }
+        if (cfg->bench) {
+            event_occurred_handler(cfg, bench_input_end(cfg->bench, &demod->r_devs));
+        }
+
+        return 0;
+    }
+
+    // default case for file-inputs
+    int n_blocks = 0;
+    int end_block = 0; // stop reading at this block if not 0
+    if (chunk) {
+        // chunks start on a block, in a raw IQ format the blocks map directly to the file
+        uint64_t start = chunk->read_start * demod->sample_size;
+#ifdef _WIN32
+        int seek_err = _fseeki64(in_file, (int64_t)start, SEEK_SET);
+#else
+        int seek_err = fseeko(in_file, (off_t)start, SEEK_SET);
+#endif
+        if (seek_err) {
+            print_logf(LOG_ERROR, "Input", "Seeking in file \"%s\" failed!", cfg->in_filename);
+            fclose(in_file);
+            return -1;
+        }
+        n_blocks  = (int)(start / DEFAULT_BUF_LENGTH);
+        end_block = (int)(chunk->read_end * demod->sample_size / DEFAULT_BUF_LENGTH);
+        cfg->input_pos = chunk->read_start;
+        demod->chunk   = chunk;
+    }
+    // read ahead (and decompress) while the samples are demodulated
+    compress_reader_t *decompress = NULL;
+    if (demod->load_info.compression) {
+        decompress = compress_reader_create(in_file, demod->load_info.compression);
+        if (!decompress) {
+            if (in_file != stdin) {
+                fclose(in_file);
+            }
+            return -1;
+        }
+    }
+    // a pipe delivers the samples as they arrive, reading ahead there only adds latency
+    async_io_fn read_fn    = decompress ? compress_reader_read : async_io_fread;
+    void *read_ctx         = decompress ? (void *)decompress : (void *)in_file;
+    async_reader_t *reader = input_is_live(in_file)
+            ? async_reader_create_direct(read_fn, read_ctx, &cfg->io_stats)
+            : async_reader_create(read_fn, read_ctx, &cfg->io_stats);
+    if (!reader) {
+        compress_reader_free(decompress);
+        if (in_file != stdin) {
+            fclose(in_file);
+        }
+        return -1;
+    }
+    unsigned long n_read;
+    delay_timer_t delay_timer;
+    delay_timer_init(&delay_timer);
+    do {
+        // Replay in realtime if requested
+        if (cfg->in_replay) {
+            // per block delay
+            unsigned delay_us = (unsigned)(1000000llu * DEFAULT_BUF_LENGTH / cfg->samp_rate / demod->sample_size / cfg->in_replay);
+            if (demod->load_info.format == CF32_IQ)
+                delay_us /= 2; // adjust for float only reading half as many samples
+            delay_timer_wait(&delay_timer, delay_us);
+        }
+        // Convert CF32 file to CS16 buffer
+        if (demod->load_info.format == CF32_IQ) {
+            n_read = async_reader_read(reader, test_mode_float_buf, sizeof(float), DEFAULT_BUF_LENGTH / 2);
+            // clamp float to [-1,1] and scale to Q0.15
+            for (unsigned long n = 0; n < n_read; n++) {
+                int s_tmp = test_mode_float_buf[n] * INT16_MAX;
+                if (s_tmp < -INT16_MAX)
+                    s_tmp = -INT16_MAX;
+                else if (s_tmp > INT16_MAX)
+                    s_tmp = INT16_MAX;
+                ((int16_t *)test_mode_buf)[n] = s_tmp;
+            }
+            n_read *= 2; // convert to byte count
+        } else {
+            n_read = async_reader_read(reader, test_mode_buf, 1, DEFAULT_BUF_LENGTH);
+
+            // Convert CS8 file to CU8 buffer
+            if (demod->load_info.format == CS8_IQ) {
+                for (unsigned long n = 0; n < n_read; n++) {
+                    test_mode_buf[n] = ((int8_t)test_mode_buf[n]) + 128;
+                }
+            }
+        }
+        if (n_read == 0) break;  // sdr_callback() will Segmentation Fault with len=0
+        demod->sample_file_pos = ((float)n_blocks * DEFAULT_BUF_LENGTH + n_read) / cfg->samp_rate / demod->sample_size;
+        n_blocks++; // this assumes n_read == DEFAULT_BUF_LENGTH
+        sdr_callback(test_mode_buf, n_read, cfg);
+        if (cfg->bench)
+            cfg->bench->samples += n_read / demod->sample_size; // not the flush block below
+    } while (n_read != 0 && !cfg->exit_async && n_blocks != end_block);
+
+    // Call a last time with cleared samples to ensure EOP detection
+    if (demod->sample_size == 2) { // CU8
+        memset(test_mode_buf, 128, DEFAULT_BUF_LENGTH); // 128 is 0 in unsigned data
+        // or is 127.5 a better 0 in cu8 data?
+        //for (unsigned long n = 0; n < DEFAULT_BUF_LENGTH/2; n++)
+        //    ((uint16_t *)test_mode_buf)[n] = 0x807f;
+    }
+    else { // CF32, CS16
+            memset(test_mode_buf, 0, DEFAULT_BUF_LENGTH);
+    }
+    demod->sample_file_pos = ((float)n_blocks + 1) * DEFAULT_BUF_LENGTH / cfg->samp_rate / demod->sample_size;
+    sdr_callback(test_mode_buf, DEFAULT_BUF_LENGTH, cfg);
+
+    //Always classify a signal at the end of the file
+    if (demod->am_analyze)
+        am_analyze_classify(demod->am_analyze);
+    if (cfg->verbosity >= LOG_NOTICE && (!chunk || !chunk->own_end)) {
+        print_logf(LOG_NOTICE, "Input", "Test mode file issued %d packets", n_blocks);
+    }
+    reset_sdr_callback(cfg);
+    demod->chunk = NULL;
+
+    async_reader_free(reader);
+    compress_reader_free(decompress);
+    if (in_file != stdin) {
+        fclose(in_file);
+    }
+    if (cfg->bench) {
+        event_occurred_handler(cfg, bench_input_end(cfg->bench, &demod->r_devs));
+    }
+
+    return 0;
+}
+
+/// Check if the input files can be decoded in parallel with the same output as in order.
+static int batch_decode_supported(r_cfg_t *cfg)
+{
+    struct dm_state *demod = cfg->demod;
+
+    // state or limits spanning all inputs, or outputs of the demodulator
+    if (cfg->duration > 0 || cfg->bytes_to_read > 0 || cfg->after_successful_events_flag
+            || cfg->in_replay || cfg->report_stats || cfg->report_bench || cfg->channel_mode || cfg->frequencies > 1)
+        return 0;
+    if (demod->dumper.len || demod->am_analyze || demod->analyze_pulses || demod->samp_grab || cfg->raw_handler.len)
+        return 0;
+    for (void **iter = cfg->in_files.elems; iter && *iter; ++iter) {
+        if (!strcmp(*iter, "-"))
+            return 0;
+    }
+    return 1;
+}
+
+typedef struct batch_decode {
+    uint32_t sample_rate_0;
+} batch_decode_t;
+
+/// Decode one input file, or a chunk of it, on a batch worker, see file_batch_run().
+static int batch_decode_file(r_cfg_t *worker, char const *in_filename, file_chunk_t *chunk, void *ctx)
+{
+    batch_decode_t *batch = ctx;
+
+    unsigned char *test_mode_buf = malloc(DEFAULT_BUF_LENGTH * sizeof(unsigned char));
+    if (!test_mode_buf)
+        FATAL_MALLOC("test_mode_buf");
+    float *test_mode_float_buf = malloc(DEFAULT_BUF_LENGTH / sizeof(int16_t) * sizeof(float));
+    if (!test_mode_float_buf)
+        FATAL_MALLOC("test_mode_float_buf");
+
+    int ret = process_input_file(worker, in_filename, chunk, batch->sample_rate_0, test_mode_buf, test_mode_float_buf);
+
+    free(test_mode_buf);
+    free(test_mode_float_buf);
+    return ret;
+}
+
 int main(int argc, char **argv) {
     int r = 0;
     struct dm_state *demod;
@@ -1647,8 +2164,22 @@ int main(int argc, char **argv) {
         cfg->frequency[0] = DEFAULT_FREQUENCY;
         cfg->frequencies  = 1;
     }
-    cfg->center_frequency = cfg->frequency[cfg->frequency_index];
-    if (cfg->frequencies > 1 && cfg->hop_times == 0) {
+    if (cfg->channel_mode) {
+        // all frequencies are received at once, tune to the middle
+        cfg->center_frequency = channels_center_frequency(cfg);
+        if (cfg->hop_times > 0 || cfg->after_successful_events_flag == 2) {
+            fprintf(stderr, "Hopping is not possible with \"-Y channels\".\n");
+            exit(1);
+        }
+        if (demod->dumper.len || demod->samp_grab || demod->am_analyze || demod->analyze_pulses) {
+            fprintf(stderr, "Dumpers, signal grabber, and analyzers are not available with \"-Y channels\".\n");
+            exit(1);
+        }
+    }
+    else {
+        cfg->center_frequency = cfg->frequency[cfg->frequency_index];
+    }
+    if (cfg->frequencies > 1 && cfg->hop_times == 0 && !cfg->channel_mode) {
         cfg->hop_time[cfg->hop_times++] = DEFAULT_HOP_TIME;
     }
     // save sample rate, this should be a hop config too
@@ -1719,6 +2250,21 @@ int main(int argc, char **argv) {
         demod->enable_FM_demod = 1;
     }
 
+    if (cfg->decoder_threads != 1) {
+        unsigned threads  = cfg->decoder_threads ? (unsigned)cfg->decoder_threads : thread_pool_cpu_count();
+        cfg->decoder_pool = thread_pool_create(threads);
+        if (cfg->decoder_pool)
+            print_logf(LOG_INFO, "Decoders", "Running the decoders of each priority on %u threads", threads);
+    }
+
+    if (cfg->channel_mode) {
+        demod->channels = channels_create(cfg, cfg->threads);
+        if (!demod->channels) {
+            fprintf(stderr, "Failed to set up the channels.\n");
+            exit(1);
+        }
+    }
+
     {
         char decoders_str[1024];
         decoders_str[0] = '\0';
@@ -1878,153 +2424,31 @@ int main(int argc, char **argv) {
             cfg->stop_time += cfg->duration;
         }
 
-        for (void **iter = cfg->in_files.elems; iter && *iter; ++iter) {
-            cfg->in_filename = *iter;
-
-            file_info_clear(&demod->load_info); // reset all info
-            file_info_parse_filename(&demod->load_info, cfg->in_filename);
-            // apply file info or default
-            cfg->samp_rate        = demod->load_info.sample_rate ? demod->load_info.sample_rate : sample_rate_0;
-            cfg->center_frequency = demod->load_info.center_frequency ? demod->load_info.center_frequency : cfg->frequency[0];
+        if (cfg->report_bench) {
+            cfg->bench = bench_create();
+        }
 
-            FILE *in_file;
-            if (strcmp(demod->load_info.path, "-") == 0) { // read samples from stdin
-                in_file = stdin;
-                cfg->in_filename = "<stdin>";
-            } else {
-                in_file = fopen(demod->load_info.path, "rb");
-                if (!in_file) {
-                    print_logf(LOG_ERROR, "Input", "Opening file \"%s\" failed!", cfg->in_filename);
-                    break;
-                }
-            }
-            print_logf(LOG_CRITICAL, "Input", "Test mode active. Reading samples from file: %s", cfg->in_filename); // Essential information (not quiet)
-            if (demod->load_info.format == CU8_IQ
-                    || demod->load_info.format == CS8_IQ
-                    || demod->load_info.format == S16_AM
-                    || demod->load_info.format == S16_FM) {
-                demod->sample_size = sizeof(uint8_t) * 2; // CU8, AM, FM
-            } else if (demod->load_info.format == CS16_IQ
-                    || demod->load_info.format == CF32_IQ) {
-                demod->sample_size = sizeof(int16_t) * 2; // CS16, CF32 (after conversion)
-            } else if (demod->load_info.format == PULSE_OOK) {
-                // ignore
-            } else {
-                print_logf(LOG_ERROR, "Input", "Input format invalid \"%s\"", file_info_string(&demod->load_info));
+        unsigned file_threads  = cfg->file_threads ? (unsigned)cfg->file_threads : thread_pool_cpu_count();
+        unsigned chunk_threads = cfg->chunk_threads ? (unsigned)cfg->chunk_threads : thread_pool_cpu_count();
+        if (cfg->in_files.len < 2)
+            file_threads = 1;
+        unsigned batch_threads = file_threads > chunk_threads ? file_threads : chunk_threads;
+        if (batch_threads > 1 && !batch_decode_supported(cfg)) {
+            print_log(LOG_WARNING, "Input", "Decoding input files in order, the options in use need sequential input");
+            batch_threads = 1;
+        }
+        int batch_done = 0;
+        if (batch_threads > 1) {
+            batch_decode_t batch = {sample_rate_0};
+            batch_done = file_batch_run(cfg, batch_threads, chunk_threads, batch_decode_file, &batch) == 0;
+        }
+        for (void **iter = cfg->in_files.elems; !batch_done && iter && *iter; ++iter) {
+            if (process_input_file(cfg, *iter, NULL, sample_rate_0, test_mode_buf, test_mode_float_buf))
                 break;
-            }
-            if (cfg->verbosity >= LOG_NOTICE) {
-                print_logf(LOG_NOTICE, "Input", "Input format \"%s\"", file_info_string(&demod->load_info));
-            }
-            demod->sample_file_pos = 0.0;
-
-            // special case for pulse data file-inputs
-            if (demod->load_info.format == PULSE_OOK) {
-                while (!cfg->exit_async) {
-                    pulse_data_load(in_file, &demod->pulse_data, cfg->samp_rate);
-                    if (!demod->pulse_data.num_pulses)
-                        break;
-
-                    for (void **iter2 = demod->dumper.elems; iter2 && *iter2; ++iter2) {
-                        file_info_t const *dumper = *iter2;
-                        if (dumper->format == VCD_LOGIC) {
-                            pulse_data_print_vcd(dumper->file, &demod->pulse_data, '\'');
-                        } else if (dumper->format == PULSE_OOK) {
-                            pulse_data_dump(dumper->file, &demod->pulse_data);
-                        } else {
-                            print_logf(LOG_ERROR, "Input", "Dumper (%s) not supported on OOK input", dumper->spec);
-                            exit(1);
-                        }
-                    }
-
-                    if (demod->pulse_data.fsk_f2_est) {
-                        run_fsk_demods(&demod->r_devs, &demod->pulse_data);
-                    }
-                    else {
-                        int p_events = run_ook_demods(&demod->r_devs, &demod->pulse_data);
-                        if (cfg->verbosity >= LOG_DEBUG)
-                            pulse_data_print(&demod->pulse_data);
-                        if (demod->analyze_pulses && (cfg->grab_mode <= 1 || (cfg->grab_mode == 2 && p_events == 0) || (cfg->grab_mode == 3 && p_events > 0))) {
-                            r_device device = {.log_fn = log_device_handler, .output_ctx = cfg};
-                            pulse_analyzer(&demod->pulse_data, PULSE_DATA_OOK, &device);
-                        }
-                    }
-                }
-
-                if (in_file != stdin) {
-                    fclose(in_file);
-                }
-
-                continue;
-            }
-
-            // default case for file-inputs
-            int n_blocks = 0;
-            unsigned long n_read;
-            delay_timer_t delay_timer;
-            delay_timer_init(&delay_timer);
-            do {
-                // Replay in realtime if requested
-                if (cfg->in_replay) {
-                    // per block delay
-                    unsigned delay_us = (unsigned)(1000000llu * DEFAULT_BUF_LENGTH / cfg->samp_rate / demod->sample_size / cfg->in_replay);
-                    if (demod->load_info.format == CF32_IQ)
-                        delay_us /= 2; // adjust for float only reading half as many samples
-                    delay_timer_wait(&delay_timer, delay_us);
-                }
-                // Convert CF32 file to CS16 buffer
-                if (demod->load_info.format == CF32_IQ) {
-                    n_read = fread(test_mode_float_buf, sizeof(float), DEFAULT_BUF_LENGTH / 2, in_file);
-                    // clamp float to [-1,1] and scale to Q0.15
-                    for (unsigned long n = 0; n < n_read; n++) {
-                        int s_tmp = test_mode_float_buf[n] * INT16_MAX;
-                        if (s_tmp < -INT16_MAX)
-                            s_tmp = -INT16_MAX;
-                        else if (s_tmp > INT16_MAX)
-                            s_tmp = INT16_MAX;
-                        ((int16_t *)test_mode_buf)[n] = s_tmp;
-                    }
-                    n_read *= 2; // convert to byte count
-                } else {
-                    n_read = fread(test_mode_buf, 1, DEFAULT_BUF_LENGTH, in_file);
-
-                    // Convert CS8 file to CU8 buffer
-                    if (demod->load_info.format == CS8_IQ) {
-                        for (unsigned long n = 0; n < n_read; n++) {
-                            test_mode_buf[n] = ((int8_t)test_mode_buf[n]) + 128;
-                        }
-                    }
-                }
-                if (n_read == 0) break;  // sdr_callback() will Segmentation Fault with len=0
-                demod->sample_file_pos = ((float)n_blocks * DEFAULT_BUF_LENGTH + n_read) / cfg->samp_rate / demod->sample_size;
-                n_blocks++; // this assumes n_read == DEFAULT_BUF_LENGTH
-                sdr_callback(test_mode_buf, n_read, cfg);
-            } while (n_read != 0 && !cfg->exit_async);
-
-            // Call a last time with cleared samples to ensure EOP detection
-            if (demod->sample_size == 2) { // CU8
-                memset(test_mode_buf, 128, DEFAULT_BUF_LENGTH); // 128 is 0 in unsigned data
-                // or is 127.5 a better 0 in cu8 data?
-                //for (unsigned long n = 0; n < DEFAULT_BUF_LENGTH/2; n++)
-                //    ((uint16_t *)test_mode_buf)[n] = 0x807f;
-            }
-            else { // CF32, CS16
-                    memset(test_mode_buf, 0, DEFAULT_BUF_LENGTH);
-            }
-            demod->sample_file_pos = ((float)n_blocks + 1) * DEFAULT_BUF_LENGTH / cfg->samp_rate / demod->sample_size;
-            sdr_callback(test_mode_buf, DEFAULT_BUF_LENGTH, cfg);
-
-            //Always classify a signal at the end of the file
-            if (demod->am_analyze)
-                am_analyze_classify(demod->am_analyze);
-            if (cfg->verbosity >= LOG_NOTICE) {
-                print_logf(LOG_NOTICE, "Input", "Test mode file issued %d packets", n_blocks);
-            }
-            reset_sdr_callback(cfg);
+        }
 
-            if (in_file != stdin) {
-                fclose(in_file);
-            }
+        if (cfg->bench) {
+            event_occurred_handler(cfg, bench_total_data(cfg->bench));
         }
 
         close_dumpers(cfg);
@@ -2059,6 +2483,13 @@ int main(int argc, char **argv) {
     // TODO: remove this before next release
     print_log(LOG_NOTICE, "Input", "The internals of input handling changed, read about and report problems on PR #1978");
 
+    // run the demod on a DSP worker thread if threads are available
+    get_mgr(cfg); // the worker will wake the event loop
+    cfg->dsp_worker = dsp_worker_create(dsp_process, dsp_notify, cfg, DSP_WORKER_SLOTS, cfg->out_block_size);
+    if (cfg->dsp_worker && cfg->verbosity >= LOG_INFO) {
+        print_log(LOG_INFO, "Input", "Demodulating on a DSP worker thread");
+    }
+
     if (cfg->dev_mode != DEVICE_MODE_MANUAL) {
         r = start_sdr(cfg);
         if (r < 0) {
@@ -2089,6 +2520,9 @@ int main(int argc, char **argv) {
     //    mg_mgr_poll(cfg->mgr, 100);
     //}
     sdr_stop(cfg->dev);
+    // stop the DSP worker and pass on any events still queued
+    dsp_worker_stop(cfg->dsp_worker);
+    flush_dsp_events(cfg);
     //print_log(LOG_INFO, "rtl_433", "stopped.");
 
     if (cfg->report_stats > 0) {
@@ -0,0 +1,604 @@
+/** @file
+    Disk-backed store-and-forward spool for network outputs.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include "spool.h"
+#include "list.h"
+#include "logger.h"
+#include "fatal.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+/* Segment file layout, in host byte order:
+   a header, then records of a record header, the key with a terminating
+   zero, and the payload, padded to 8 bytes. Unused space is zero.
+*/
+
+#define SPOOL_MAGIC   0x4c505352 // "RSPL"
+#define SPOOL_VERSION 1
+#define SPOOL_ALIGN   8
+
+typedef struct spool_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t read_off;  ///< offset of the oldest record not yet replayed
+    uint32_t write_off; ///< offset after the last complete record
+    uint32_t reserved[4];
+} spool_header_t;
+
+typedef struct spool_record {
+    uint32_t size; ///< size of the record including this header and padding
+    uint32_t time; ///< time the record was spooled, unix seconds
+    uint32_t key_len;
+    uint32_t data_len;
+} spool_record_t;
+
+typedef struct spool_segment {
+    unsigned seq;
+    size_t size;
+    unsigned records; ///< records not yet replayed
+    uint64_t bytes;   ///< size of the records not yet replayed
+    uint8_t *map;     ///< only the head and the tail segment are mapped
+} spool_segment_t;
+
+struct spool {
+    char *dir;
+    char *name;
+    size_t max_size;
+    size_t segment_size;
+    list_t segments; ///< segments in order, the head is read, the tail is written
+    unsigned next_seq;
+    unsigned records;
+    uint64_t bytes;
+    unsigned dropped;
+};
+
+static list_t spool_registry;
+
+static size_t record_size(size_t key_len, size_t data_len)
+{
+    size_t size = sizeof(spool_record_t) + key_len + 1 + data_len;
+    return (size + SPOOL_ALIGN - 1) & ~(size_t)(SPOOL_ALIGN - 1);
+}
+
+spool_t *spool_at(unsigned idx)
+{
+    return idx < spool_registry.len ? spool_registry.elems[idx] : NULL;
+}
+
+unsigned spool_depth(spool_t const *spool)
+{
+    return spool->records;
+}
+
+#ifndef _WIN32
+
+static void segment_path(spool_t const *spool, unsigned seq, char *path, size_t path_size)
+{
+    snprintf(path, path_size, "%s/%s.%08u.spool", spool->dir, spool->name, seq);
+}
+
+/// Map a segment, a new segment is created with an empty header. Returns 0 on success.
+static int segment_map(spool_t *spool, spool_segment_t *seg, int create)
+{
+    if (seg->map)
+        return 0;
+
+    char path[1024];
+    segment_path(spool, seg->seq, path, sizeof(path));
+
+    int fd = open(path, create ? O_RDWR | O_CREAT | O_TRUNC : O_RDWR, 0644);
+    if (fd < 0) {
+        print_logf(LOG_ERROR, "Spool", "Can't open \"%s\": %s", path, strerror(errno));
+        return -1;
+    }
+    if (create && ftruncate(fd, (off_t)spool->segment_size) < 0) {
+        print_logf(LOG_ERROR, "Spool", "Can't size \"%s\": %s", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size <= sizeof(spool_header_t) || st.st_size > UINT32_MAX) {
+        print_logf(LOG_ERROR, "Spool", "Invalid segment \"%s\"", path);
+        close(fd);
+        return -1;
+    }
+    seg->size = (size_t)st.st_size;
+    void *map = mmap(NULL, seg->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        print_logf(LOG_ERROR, "Spool", "Can't map \"%s\": %s", path, strerror(errno));
+        return -1;
+    }
+    seg->map = map;
+
+    spool_header_t *hdr = (spool_header_t *)seg->map;
+    if (create) {
+        hdr->magic     = SPOOL_MAGIC;
+        hdr->version   = SPOOL_VERSION;
+        hdr->read_off  = sizeof(spool_header_t);
+        hdr->write_off = sizeof(spool_header_t);
+    }
+    return 0;
+}
+
+static void segment_unmap(spool_segment_t *seg)
+{
+    if (!seg->map)
+        return;
+    munmap(seg->map, seg->size);
+    seg->map = NULL;
+}
+
+/// Count the records to replay, returns -1 if the segment is invalid.
+static int segment_scan(spool_segment_t *seg)
+{
+    spool_header_t *hdr = (spool_header_t *)seg->map;
+    if (hdr->magic != SPOOL_MAGIC || hdr->version != SPOOL_VERSION
+            || hdr->read_off < sizeof(spool_header_t) || hdr->read_off > hdr->write_off || hdr->write_off > seg->size)
+        return -1;
+
+    seg->records = 0;
+    seg->bytes   = 0;
+    for (uint32_t off = hdr->read_off; off < hdr->write_off;) {
+        spool_record_t *rec = (spool_record_t *)(seg->map + off);
+        if (rec->size < sizeof(spool_record_t) || rec->size > hdr->write_off - off
+                || rec->size < record_size(rec->key_len, rec->data_len)) {
+            // keep the valid records before a damaged record
+            hdr->write_off = off;
+            break;
+        }
+        seg->records += 1;
+        seg->bytes += rec->size;
+        off += rec->size;
+    }
+    return 0;
+}
+
+static void segment_delete(spool_t *spool, size_t idx)
+{
+    spool_segment_t *seg = spool->segments.elems[idx];
+    char path[1024];
+    segment_path(spool, seg->seq, path, sizeof(path));
+
+    segment_unmap(seg);
+    if (unlink(path) < 0)
+        print_logf(LOG_WARNING, "Spool", "Can't remove \"%s\": %s", path, strerror(errno));
+    spool->records -= seg->records;
+    spool->bytes -= seg->bytes;
+    list_remove(&spool->segments, idx, free);
+}
+
+static int compare_seq(void const *a, void const *b)
+{
+    spool_segment_t const *sa = *(spool_segment_t *const *)a;
+    spool_segment_t const *sb = *(spool_segment_t *const *)b;
+    return sa->seq < sb->seq ? -1 : sa->seq > sb->seq;
+}
+
+/// Find and recover the segments of an existing spool.
+static void spool_recover(spool_t *spool)
+{
+    DIR *dir = opendir(spool->dir);
+    if (!dir)
+        return;
+
+    size_t name_len = strlen(spool->name);
+    struct dirent *entry;
+    while ((entry = readdir(dir))) {
+        unsigned seq;
+        char tail[8];
+        if (strncmp(entry->d_name, spool->name, name_len) || entry->d_name[name_len] != '.'
+                || sscanf(entry->d_name + name_len + 1, "%8u%7s", &seq, tail) != 2 || strcmp(tail, ".spool"))
+            continue;
+        spool_segment_t *seg = calloc(1, sizeof(*seg));
+        if (!seg) {
+            WARN_CALLOC("spool_recover()");
+            break; // NOTE: ignores old segments on alloc failure.
+        }
+        seg->seq = seq;
+        list_push(&spool->segments, seg);
+    }
+    closedir(dir);
+
+    if (spool->segments.len)
+        qsort(spool->segments.elems, spool->segments.len, sizeof(*spool->segments.elems), compare_seq);
+
+    for (size_t i = 0; i < spool->segments.len;) {
+        spool_segment_t *seg = spool->segments.elems[i];
+        spool->next_seq      = seg->seq + 1;
+        if (segment_map(spool, seg, 0) < 0 || segment_scan(seg) < 0 || !seg->records) {
+            print_logf(LOG_DEBUG, "Spool", "Removing empty or invalid segment \"%s.%08u\"", spool->name, seg->seq);
+            segment_delete(spool, i);
+            continue;
+        }
+        spool->records += seg->records;
+        spool->bytes += seg->bytes;
+        // only the head and the tail stay mapped
+        if (i > 0)
+            segment_unmap(seg);
+        ++i;
+    }
+    if (spool->segments.len > 1)
+        segment_map(spool, spool->segments.elems[spool->segments.len - 1], 0);
+}
+
+spool_t *spool_create(char const *dir, char const *name, size_t max_size, size_t segment_size)
+{
+    if (segment_size < 4096)
+        segment_size = 4096;
+    if (max_size < segment_size)
+        max_size = segment_size;
+
+    if (mkdir(dir, 0755) < 0 && errno != EEXIST) {
+        print_logf(LOG_ERROR, "Spool", "Can't create spool directory \"%s\": %s", dir, strerror(errno));
+        return NULL;
+    }
+
+    spool_t *spool = calloc(1, sizeof(*spool));
+    if (!spool) {
+        WARN_CALLOC("spool_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    spool->dir = strdup(dir);
+    if (!spool->dir) {
+        WARN_STRDUP("spool_create()");
+        free(spool);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    spool->name = strdup(name);
+    if (!spool->name) {
+        WARN_STRDUP("spool_create()");
+        free(spool->dir);
+        free(spool);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    // the name is used for file names, e.g. with a host and port
+    for (char *p = spool->name; *p; ++p) {
+        if (*p != '-' && *p != '_' && (*p < 'A' || *p > 'Z') && (*p < 'a' || *p > 'z') && (*p < '0' || *p > '9'))
+            *p = '_';
+    }
+    spool->max_size     = max_size;
+    spool->segment_size = segment_size;
+
+    spool_recover(spool);
+    if (spool->records)
+        print_logf(LOG_NOTICE, "Spool", "Recovered %u spooled records in %u segments of \"%s/%s\"",
+                spool->records, (unsigned)spool->segments.len, dir, name);
+
+    list_push(&spool_registry, spool);
+    return spool;
+}
+
+void spool_free(spool_t *spool)
+{
+    if (!spool)
+        return;
+
+    for (size_t i = 0; i < spool_registry.len; ++i) {
+        if (spool_registry.elems[i] == spool) {
+            list_remove(&spool_registry, i, NULL);
+            break;
+        }
+    }
+    if (!spool_registry.len)
+        list_free_elems(&spool_registry, NULL);
+
+    for (size_t i = 0; i < spool->segments.len; ++i) {
+        spool_segment_t *seg = spool->segments.elems[i];
+        segment_unmap(seg);
+    }
+    list_free_elems(&spool->segments, free);
+    free(spool->dir);
+    free(spool->name);
+    free(spool);
+}
+
+/// Start a new tail segment, evicting the oldest segments to stay within the size limit.
+static spool_segment_t *spool_rotate(spool_t *spool)
+{
+    while (spool->segments.len && (spool->segments.len + 1) * spool->segment_size > spool->max_size) {
+        spool_segment_t *head = spool->segments.elems[0];
+        if (head->records) {
+            // warn once, the dropped count is in the stats
+            print_logf(spool->dropped ? LOG_DEBUG : LOG_WARNING, "Spool", "Spool \"%s\" full, dropping %u oldest records", spool->name, head->records);
+            spool->dropped += head->records;
+        }
+        segment_delete(spool, 0);
+        if (spool->segments.len) {
+            head = spool->segments.elems[0];
+            segment_map(spool, head, 0);
+        }
+    }
+
+    // the previous tail stays mapped only if it is the head
+    if (spool->segments.len > 1)
+        segment_unmap(spool->segments.elems[spool->segments.len - 1]);
+
+    spool_segment_t *seg = calloc(1, sizeof(*seg));
+    if (!seg) {
+        WARN_CALLOC("spool_rotate()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    seg->seq = spool->next_seq++;
+    if (segment_map(spool, seg, 1) < 0) {
+        free(seg);
+        return NULL;
+    }
+    list_push(&spool->segments, seg);
+    return seg;
+}
+
+int spool_write(spool_t *spool, char const *key, void const *data, size_t len)
+{
+    size_t key_len = strlen(key);
+    size_t size    = record_size(key_len, len);
+    if (size > spool->segment_size - sizeof(spool_header_t)) {
+        print_logf(LOG_WARNING, "Spool", "Record of %zu bytes too large for spool \"%s\"", len, spool->name);
+        spool->dropped += 1;
+        return -1;
+    }
+
+    spool_segment_t *seg = spool->segments.len ? spool->segments.elems[spool->segments.len - 1] : NULL;
+    spool_header_t *hdr  = seg ? (spool_header_t *)seg->map : NULL;
+    if (!seg || !hdr || seg->size - hdr->write_off < size) {
+        seg = spool_rotate(spool);
+        if (!seg) {
+            spool->dropped += 1;
+            return -1;
+        }
+        hdr = (spool_header_t *)seg->map;
+    }
+
+    uint8_t *p          = seg->map + hdr->write_off;
+    spool_record_t *rec = (spool_record_t *)p;
+    rec->time           = (uint32_t)time(NULL);
+    rec->key_len        = (uint32_t)key_len;
+    rec->data_len       = (uint32_t)len;
+    memcpy(p + sizeof(*rec), key, key_len + 1);
+    memcpy(p + sizeof(*rec) + key_len + 1, data, len);
+    // commit the record only once it is complete
+    rec->size = (uint32_t)size;
+    hdr->write_off += (uint32_t)size;
+
+    seg->records += 1;
+    seg->bytes += size;
+    spool->records += 1;
+    spool->bytes += size;
+    return 0;
+}
+
+uint64_t spool_peek(spool_t *spool, char const **key, void const **data, size_t *len)
+{
+    if (!spool->records)
+        return 0;
+
+    spool_segment_t *seg = spool->segments.elems[0];
+    if (segment_map(spool, seg, 0) < 0)
+        return 0;
+    spool_header_t *hdr = (spool_header_t *)seg->map;
+    spool_record_t *rec = (spool_record_t *)(seg->map + hdr->read_off);
+    uint8_t *p          = (uint8_t *)rec + sizeof(*rec);
+
+    *key  = (char const *)p;
+    *data = p + rec->key_len + 1;
+    *len  = rec->data_len;
+    return (uint64_t)seg->seq << 32 | hdr->read_off;
+}
+
+void spool_pop(spool_t *spool, uint64_t id)
+{
+    if (!spool->records)
+        return;
+
+    spool_segment_t *seg = spool->segments.elems[0];
+    spool_header_t *hdr  = (spool_header_t *)seg->map;
+    if (!hdr || ((uint64_t)seg->seq << 32 | hdr->read_off) != id)
+        return; // the record was evicted
+
+    spool_record_t *rec = (spool_record_t *)(seg->map + hdr->read_off);
+    hdr->read_off += rec->size;
+    seg->records -= 1;
+    seg->bytes -= rec->size;
+    spool->records -= 1;
+    spool->bytes -= rec->size;
+
+    if (seg->records)
+        return;
+    if (spool->segments.len > 1) {
+        segment_delete(spool, 0);
+        segment_map(spool, spool->segments.elems[0], 0);
+    }
+    else {
+        // reuse the single segment from the start
+        memset(seg->map + sizeof(*hdr), 0, hdr->write_off - sizeof(*hdr));
+        hdr->read_off  = sizeof(*hdr);
+        hdr->write_off = sizeof(*hdr);
+    }
+}
+
+void spool_get_stats(spool_t const *spool, spool_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->name     = spool->name;
+    stats->records  = spool->records;
+    stats->bytes    = spool->bytes;
+    stats->segments = (unsigned)spool->segments.len;
+    stats->dropped  = spool->dropped;
+
+    spool_segment_t const *seg = spool->records ? spool->segments.elems[0] : NULL;
+    if (seg && seg->map) {
+        spool_header_t const *hdr = (spool_header_t const *)seg->map;
+        spool_record_t const *rec = (spool_record_t const *)(seg->map + hdr->read_off);
+        stats->oldest = (time_t)rec->time;
+    }
+}
+
+#else /* _WIN32 */
+
+spool_t *spool_create(char const *dir, char const *name, size_t max_size, size_t segment_size)
+{
+    (void)name;
+    (void)max_size;
+    (void)segment_size;
+    print_logf(LOG_ERROR, "Spool", "Spooling to \"%s\" is not available on this platform", dir);
+    return NULL;
+}
+
+void spool_free(spool_t *spool)
+{
+    (void)spool;
+}
+
+int spool_write(spool_t *spool, char const *key, void const *data, size_t len)
+{
+    (void)spool;
+    (void)key;
+    (void)data;
+    (void)len;
+    return -1;
+}
+
+uint64_t spool_peek(spool_t *spool, char const **key, void const **data, size_t *len)
+{
+    (void)spool;
+    (void)key;
+    (void)data;
+    (void)len;
+    return 0;
+}
+
+void spool_pop(spool_t *spool, uint64_t id)
+{
+    (void)spool;
+    (void)id;
+}
+
+void spool_get_stats(spool_t const *spool, spool_stats_t *stats)
+{
+    (void)spool;
+    memset(stats, 0, sizeof(*stats));
+}
+
+#endif /* _WIN32 */
+
+#if defined(_TEST) && !defined(_WIN32)
+#define ASSERT_EQUALS(a, b)                                                     \
+    do {                                                                        \
+        if ((a) == (b))                                                         \
+            ++passed;                                                           \
+        else {                                                                  \
+            ++failed;                                                           \
+            fprintf(stderr, "FAIL line %d: %ld <> %ld\n", __LINE__, (long)(a), (long)(b)); \
+        }                                                                       \
+    } while (0)
+
+int main(void)
+{
+    unsigned passed = 0;
+    unsigned failed = 0;
+    char data[1000];
+    char const *key;
+    void const *ptr;
+    size_t len;
+    uint64_t id;
+
+    char dir[] = "/tmp/spool-test-XXXXXX";
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    memset(data, 'x', sizeof(data));
+
+    fprintf(stderr, "spool:: write and replay\n");
+    spool_t *spool = spool_create(dir, "test", 16 * 4096, 4096);
+    ASSERT_EQUALS(spool != NULL, 1);
+    ASSERT_EQUALS(spool_peek(spool, &key, &ptr, &len), 0);
+    for (int i = 0; i < 10; ++i) {
+        snprintf(data, sizeof(data), "%d", i);
+        ASSERT_EQUALS(spool_write(spool, "topic", data, 1000), 0);
+    }
+    ASSERT_EQUALS(spool_depth(spool), 10);
+    id = spool_peek(spool, &key, &ptr, &len);
+    ASSERT_EQUALS(id != 0, 1);
+    ASSERT_EQUALS(strcmp(key, "topic"), 0);
+    ASSERT_EQUALS(len, 1000);
+    ASSERT_EQUALS(strcmp(ptr, "0"), 0);
+    spool_pop(spool, id);
+    spool_pop(spool, id); // stale id is ignored
+    ASSERT_EQUALS(spool_depth(spool), 9);
+
+    fprintf(stderr, "spool:: recover\n");
+    spool_free(spool);
+    spool = spool_create(dir, "test", 16 * 4096, 4096);
+    ASSERT_EQUALS(spool_depth(spool), 9);
+    spool_stats_t stats;
+    spool_get_stats(spool, &stats);
+    ASSERT_EQUALS(stats.segments, 4); // 3 records per segment
+    ASSERT_EQUALS(stats.oldest != 0, 1);
+    for (int i = 1; i < 10; ++i) {
+        id = spool_peek(spool, &key, &ptr, &len);
+        snprintf(data, sizeof(data), "%d", i);
+        ASSERT_EQUALS(strcmp(ptr, data), 0);
+        spool_pop(spool, id);
+    }
+    ASSERT_EQUALS(spool_depth(spool), 0);
+    spool_get_stats(spool, &stats);
+    ASSERT_EQUALS(stats.segments, 1);
+    ASSERT_EQUALS(stats.bytes, 0);
+
+    fprintf(stderr, "spool:: evict oldest\n");
+    for (int i = 0; i < 100; ++i) {
+        snprintf(data, sizeof(data), "%d", i);
+        spool_write(spool, "topic", data, 1000);
+    }
+    spool_get_stats(spool, &stats);
+    ASSERT_EQUALS(stats.segments, 16);
+    ASSERT_EQUALS(stats.records + stats.dropped, 100);
+    id = spool_peek(spool, &key, &ptr, &len);
+    snprintf(data, sizeof(data), "%u", stats.dropped);
+    ASSERT_EQUALS(strcmp(ptr, data), 0);
+    ASSERT_EQUALS(spool_write(spool, "topic", data, 4096), -1);
+
+    spool_free(spool);
+    // clean up
+    spool = spool_create(dir, "test", 4096, 4096);
+    while ((id = spool_peek(spool, &key, &ptr, &len)))
+        spool_pop(spool, id);
+    spool_free(spool);
+    char path[1024];
+    DIR *d = opendir(dir);
+    struct dirent *entry;
+    while (d && (entry = readdir(d))) {
+        snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+        if (entry->d_name[0] != '.')
+            unlink(path);
+    }
+    if (d)
+        closedir(d);
+    rmdir(dir);
+
+    fprintf(stderr, "spool:: test (%u/%u) passed, (%u) failed.\n", passed, passed + failed, failed);
+
+    return failed;
+}
+#endif /* _TEST */
@@ -0,0 +1,233 @@
+/** @file
+    Fork-join thread pool for parallel demodulation.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdlib.h>
+#include <signal.h>
+
+#include "thread_pool.h"
+#include "logger.h"
+#include "fatal.h"
+#include "compat_pthread.h"
+#include "compat_atomic.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+unsigned thread_pool_cpu_count(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (unsigned)n : 1;
+#else
+    return 1;
+#endif
+}
+
+// Only available if Threads are enabled.
+// Each run is a generation: workers wake on a new generation, claim task indices
+// from a shared counter, the caller waits until no worker is active on the run.
+
+#ifdef THREADS
+
+struct thread_pool {
+    unsigned num_threads;  ///< number of worker threads, not counting the caller
+    pthread_t *threads;
+
+    pthread_mutex_t lock;
+    pthread_cond_t work;   ///< wait for a new generation
+    pthread_cond_t done;   ///< wait for all tasks to finish
+    unsigned generation;
+    unsigned active;       ///< workers currently running tasks
+    int stop;
+
+    thread_pool_task_fn task_fn;
+    void *ctx;
+    unsigned tasks;
+    unsigned next_task;    ///< next task index to claim
+};
+
+static void run_tasks(thread_pool_t *pool)
+{
+    for (;;) {
+        unsigned task = compat_atomic_fetch_add_u(&pool->next_task, 1);
+        if (task >= pool->tasks)
+            break;
+        pool->task_fn(pool->ctx, task);
+    }
+}
+
+static THREAD_RETURN THREAD_CALL pool_thread(void *arg)
+{
+    thread_pool_t *pool = arg;
+    unsigned seen = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while (pool->generation == seen && !pool->stop)
+            pthread_cond_wait(&pool->work, &pool->lock);
+        seen = pool->generation;
+        int stop = pool->stop;
+        if (!stop)
+            pool->active++;
+        pthread_mutex_unlock(&pool->lock);
+        if (stop)
+            break;
+
+        run_tasks(pool);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->active == 0)
+            pthread_cond_signal(&pool->done);
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    return 0;
+}
+
+thread_pool_t *thread_pool_create(unsigned threads)
+{
+    if (threads < 2)
+        return NULL;
+
+    thread_pool_t *pool = calloc(1, sizeof(*pool));
+    if (!pool) {
+        WARN_CALLOC("thread_pool_create()");
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+    pool->threads = calloc(threads - 1, sizeof(*pool->threads));
+    if (!pool->threads) {
+        WARN_CALLOC("thread_pool_create()");
+        free(pool);
+        return NULL; // NOTE: returns NULL on alloc failure.
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work, NULL);
+    pthread_cond_init(&pool->done, NULL);
+
+#ifndef _WIN32
+    // Block all signals from the worker threads
+    sigset_t sigset;
+    sigset_t oldset;
+    sigfillset(&sigset);
+    pthread_sigmask(SIG_SETMASK, &sigset, &oldset);
+#endif
+    for (unsigned i = 0; i < threads - 1; ++i) {
+        int r = pthread_create(&pool->threads[i], NULL, pool_thread, pool);
+        if (r) {
+            print_logf(LOG_ERROR, __func__, "error in pthread_create, rc: %d", r);
+            break;
+        }
+        pool->num_threads++;
+    }
+#ifndef _WIN32
+    pthread_sigmask(SIG_SETMASK, &oldset, NULL);
+#endif
+
+    if (!pool->num_threads) {
+        thread_pool_free(pool);
+        return NULL;
+    }
+
+    return pool;
+}
+
+void thread_pool_free(thread_pool_t *pool)
+{
+    if (!pool)
+        return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (unsigned i = 0; i < pool->num_threads; ++i) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work);
+    pthread_cond_destroy(&pool->done);
+    free(pool->threads);
+    free(pool);
+}
+
+unsigned thread_pool_size(thread_pool_t *pool)
+{
+    return pool ? pool->num_threads + 1 : 1;
+}
+
+void thread_pool_run(thread_pool_t *pool, unsigned tasks, thread_pool_task_fn task_fn, void *ctx)
+{
+    if (!pool || tasks < 2) {
+        for (unsigned task = 0; task < tasks; ++task) {
+            task_fn(ctx, task);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    // a worker waking late for the previous run might still be checking for tasks
+    while (pool->active)
+        pthread_cond_wait(&pool->done, &pool->lock);
+    pool->task_fn   = task_fn;
+    pool->ctx       = ctx;
+    pool->tasks     = tasks;
+    pool->next_task = 0;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+
+    run_tasks(pool);
+
+    // all tasks are claimed, wait for the workers to finish theirs
+    pthread_mutex_lock(&pool->lock);
+    while (pool->active)
+        pthread_cond_wait(&pool->done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+#else
+
+thread_pool_t *thread_pool_create(unsigned threads)
+{
+    (void)threads;
+    return NULL;
+}
+
+void thread_pool_free(thread_pool_t *pool)
+{
+    (void)pool;
+}
+
+unsigned thread_pool_size(thread_pool_t *pool)
+{
+    (void)pool;
+    return 1;
+}
+
+void thread_pool_run(thread_pool_t *pool, unsigned tasks, thread_pool_task_fn task_fn, void *ctx)
+{
+    (void)pool;
+    for (unsigned task = 0; task < tasks; ++task) {
+        task_fn(ctx, task);
+    }
+}
+
+#endif
@@ -0,0 +1,304 @@
+/** @file
+    AMQP output test with a scripted fake broker.
+
+    The broker runs on the same event manager as the client. It plays the
+    connection handshake, then confirms, rejects, and closes the channel on
+    the published events and checks the frames the client sends back.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "output_amqp.h"
+#include "data.h"
+#include "mongoose.h"
+
+#define ASSERT_EQUALS(a, b)                                                     \
+    do {                                                                        \
+        if ((a) == (b))                                                         \
+            ++passed;                                                           \
+        else {                                                                  \
+            ++failed;                                                           \
+            fprintf(stderr, "FAIL line %d: %ld <> %ld\n", __LINE__, (long)(a), (long)(b)); \
+        }                                                                       \
+    } while (0)
+
+#define METHOD(class_id, method_id) ((uint32_t)(class_id) << 16 | (method_id))
+
+#define CONNECTION_START    METHOD(10, 10)
+#define CONNECTION_START_OK METHOD(10, 11)
+#define CONNECTION_TUNE     METHOD(10, 30)
+#define CONNECTION_TUNE_OK  METHOD(10, 31)
+#define CONNECTION_OPEN     METHOD(10, 40)
+#define CONNECTION_OPEN_OK  METHOD(10, 41)
+#define CHANNEL_OPEN        METHOD(20, 10)
+#define CHANNEL_OPEN_OK     METHOD(20, 11)
+#define CHANNEL_CLOSE       METHOD(20, 40)
+#define CHANNEL_CLOSE_OK    METHOD(20, 41)
+#define BASIC_PUBLISH       METHOD(60, 40)
+#define BASIC_ACK           METHOD(60, 80)
+#define BASIC_NACK          METHOD(60, 120)
+#define CONFIRM_SELECT      METHOD(85, 10)
+#define CONFIRM_SELECT_OK   METHOD(85, 11)
+
+#define FRAME_METHOD    1
+#define FRAME_BODY      3
+#define FRAME_HEARTBEAT 8
+
+/// A frame received by the broker.
+typedef struct frame {
+    uint8_t type;
+    uint16_t channel;
+    uint32_t method; ///< for method frames
+    size_t len;
+    uint8_t payload[4096];
+} frame_t;
+
+/// The fake broker, one client connection at a time.
+typedef struct broker {
+    struct mg_connection *conn;
+    int connects;
+    int closed;
+    frame_t frames[64]; ///< received and not yet taken by wait_frame()
+    unsigned count;
+} broker_t;
+
+static struct mg_mgr mgr;
+static broker_t broker;
+static unsigned passed;
+static unsigned failed;
+
+static void broker_event(struct mg_connection *nc, int ev, void *ev_data)
+{
+    (void)ev_data;
+
+    switch (ev) {
+    case MG_EV_ACCEPT:
+        broker.conn = nc;
+        broker.connects++;
+        break;
+    case MG_EV_RECV: {
+        struct mbuf *in = &nc->recv_mbuf;
+        if (in->len >= 8 && !memcmp(in->buf, "AMQP", 4))
+            mbuf_remove(in, 8); // the protocol header
+        while (in->len >= 8) {
+            uint8_t const *p = (uint8_t const *)in->buf;
+            uint32_t size    = (uint32_t)p[3] << 24 | (uint32_t)p[4] << 16 | (uint32_t)p[5] << 8 | p[6];
+            if (in->len < size + 8)
+                break;
+            if (broker.count < sizeof(broker.frames) / sizeof(*broker.frames) && size <= sizeof(broker.frames[0].payload)) {
+                frame_t *f = &broker.frames[broker.count++];
+                f->type    = p[0];
+                f->channel = (uint16_t)(p[1] << 8 | p[2]);
+                f->method  = f->type == FRAME_METHOD && size >= 4 ? (uint32_t)p[7] << 24 | (uint32_t)p[8] << 16 | (uint32_t)p[9] << 8 | p[10] : 0;
+                f->len     = size;
+                memcpy(f->payload, p + 7, size);
+            }
+            mbuf_remove(in, size + 8);
+        }
+        break;
+    }
+    case MG_EV_CLOSE:
+        if (broker.conn == nc) {
+            broker.conn = NULL;
+            broker.closed++;
+        }
+        break;
+    }
+}
+
+/// Poll until the broker received a frame of @p type (and @p method), returns a copy or NULL on timeout.
+static frame_t *wait_frame(uint8_t type, uint32_t method, double timeout)
+{
+    static frame_t frame;
+    double end = mg_time() + timeout;
+    while (mg_time() < end) {
+        for (unsigned i = 0; i < broker.count; ++i) {
+            if (broker.frames[i].type == type && (!method || broker.frames[i].method == method)) {
+                frame = broker.frames[i];
+                // drop this and all earlier frames
+                memmove(&broker.frames[0], &broker.frames[i + 1], (broker.count - i - 1) * sizeof(frame_t));
+                broker.count -= i + 1;
+                return &frame;
+            }
+        }
+        mg_mgr_poll(&mgr, 10);
+    }
+    return NULL;
+}
+
+static void poll_for(double secs)
+{
+    double end = mg_time() + secs;
+    while (mg_time() < end)
+        mg_mgr_poll(&mgr, 10);
+}
+
+static void send_method(uint16_t channel, uint32_t method, void const *args, size_t args_len)
+{
+    uint32_t size = (uint32_t)(4 + args_len);
+    uint8_t hdr[11] = {FRAME_METHOD, channel >> 8, channel & 0xff,
+            size >> 24, (size >> 16) & 0xff, (size >> 8) & 0xff, size & 0xff,
+            method >> 24, (method >> 16) & 0xff, (method >> 8) & 0xff, method & 0xff};
+    mg_send(broker.conn, hdr, sizeof(hdr));
+    if (args_len)
+        mg_send(broker.conn, args, (int)args_len);
+    uint8_t end = 0xce;
+    mg_send(broker.conn, &end, 1);
+}
+
+static void send_confirm(uint32_t method, uint8_t delivery_tag)
+{
+    uint8_t args[9] = {0, 0, 0, 0, 0, 0, 0, delivery_tag, 0};
+    send_method(1, method, args, sizeof(args));
+}
+
+/// Play the handshake up to confirm.select-ok, returns the heartbeat in tune-ok.
+static int handshake(uint16_t heartbeat)
+{
+    frame_t *f;
+    int tuned_heartbeat = -1;
+
+    double end = mg_time() + 5;
+    while (!broker.conn && mg_time() < end)
+        mg_mgr_poll(&mgr, 10);
+    ASSERT_EQUALS(broker.conn != NULL, 1);
+    if (!broker.conn)
+        return -1;
+
+    // version 0-9, empty server-properties, mechanisms "PLAIN", locales "en_US"
+    static uint8_t const start[] = {0, 9, 0, 0, 0, 0, 0, 0, 0, 5, 'P', 'L', 'A', 'I', 'N', 0, 0, 0, 5, 'e', 'n', '_', 'U', 'S'};
+    send_method(0, CONNECTION_START, start, sizeof(start));
+    f = wait_frame(FRAME_METHOD, CONNECTION_START_OK, 2);
+    ASSERT_EQUALS(f != NULL, 1);
+
+    // channel-max 0, frame-max 4096, heartbeat
+    uint8_t tune[8] = {0, 0, 0, 0, 0x10, 0, heartbeat >> 8, heartbeat & 0xff};
+    send_method(0, CONNECTION_TUNE, tune, sizeof(tune));
+    f = wait_frame(FRAME_METHOD, CONNECTION_TUNE_OK, 2);
+    ASSERT_EQUALS(f != NULL, 1);
+    if (f && f->len == 12) {
+        ASSERT_EQUALS(f->payload[6] << 24 | f->payload[7] << 16 | f->payload[8] << 8 | f->payload[9], 4096);
+        tuned_heartbeat = f->payload[10] << 8 | f->payload[11];
+    }
+
+    f = wait_frame(FRAME_METHOD, CONNECTION_OPEN, 2);
+    ASSERT_EQUALS(f != NULL, 1);
+    static uint8_t const open_ok[] = {0};
+    send_method(0, CONNECTION_OPEN_OK, open_ok, sizeof(open_ok));
+
+    f = wait_frame(FRAME_METHOD, CHANNEL_OPEN, 2);
+    ASSERT_EQUALS(f != NULL, 1);
+    ASSERT_EQUALS(f ? f->channel : 0, 1);
+    static uint8_t const channel_open_ok[] = {0, 0, 0, 0};
+    send_method(1, CHANNEL_OPEN_OK, channel_open_ok, sizeof(channel_open_ok));
+
+    f = wait_frame(FRAME_METHOD, CONFIRM_SELECT, 2);
+    ASSERT_EQUALS(f != NULL, 1);
+    send_method(1, CONFIRM_SELECT_OK, NULL, 0);
+    mg_mgr_poll(&mgr, 10);
+
+    return tuned_heartbeat;
+}
+
+static void publish_event(struct data_output *output, int id)
+{
+    data_t *data = data_make(
+            "model", "", DATA_STRING, "Test",
+            "id",    "", DATA_INT,    id,
+            NULL);
+    data_output_print(output, data);
+    data_free(data);
+}
+
+/// Wait for a published message, returns the id in the body or -1.
+static int wait_publish(void)
+{
+    frame_t *f = wait_frame(FRAME_METHOD, BASIC_PUBLISH, 2);
+    if (!f)
+        return -1;
+    f = wait_frame(FRAME_BODY, 0, 2);
+    if (!f)
+        return -1;
+    char body[4097];
+    memcpy(body, f->payload, f->len);
+    body[f->len] = '\0';
+    char const *id = strstr(body, "\"id\"");
+    id = id ? strchr(id, ':') : NULL;
+    return id ? atoi(id + 1) : -1;
+}
+
+int main(void)
+{
+    mg_mgr_init(&mgr, NULL);
+    struct mg_connection *listener = mg_bind(&mgr, "127.0.0.1:0", broker_event);
+    if (!listener) {
+        fprintf(stderr, "amqp:: can't listen\n");
+        return 1;
+    }
+    char port[16];
+    mg_conn_addr_to_str(listener, port, sizeof(port), MG_SOCK_STRINGIFY_PORT);
+    char param[64];
+    snprintf(param, sizeof(param), "amqp://127.0.0.1:%s,window=4", port);
+    struct data_output *output = data_output_amqp_create(&mgr, param);
+
+    fprintf(stderr, "amqp:: handshake and heartbeat\n");
+    ASSERT_EQUALS(handshake(1), 1);
+    ASSERT_EQUALS(wait_frame(FRAME_HEARTBEAT, 0, 2) != NULL, 1);
+
+    fprintf(stderr, "amqp:: ack and nack\n");
+    publish_event(output, 1);
+    ASSERT_EQUALS(wait_publish(), 1);
+    send_confirm(BASIC_ACK, 1);
+    publish_event(output, 2);
+    ASSERT_EQUALS(wait_publish(), 2);
+    send_confirm(BASIC_NACK, 2);
+    poll_for(0.1);
+
+    fprintf(stderr, "amqp:: channel close on publish drops the message\n");
+    publish_event(output, 3);
+    ASSERT_EQUALS(wait_publish(), 3);
+    // 404 NOT_FOUND, caused by basic.publish
+    static uint8_t const close[] = {0x01, 0x94, 9, 'N', 'O', 'T', '_', 'F', 'O', 'U', 'N', 'D', 0, 60, 0, 40};
+    send_method(1, CHANNEL_CLOSE, close, sizeof(close));
+    ASSERT_EQUALS(wait_frame(FRAME_METHOD, CHANNEL_CLOSE_OK, 2) != NULL, 1);
+    double end = mg_time() + 2;
+    while (!broker.closed && mg_time() < end)
+        mg_mgr_poll(&mgr, 10);
+    ASSERT_EQUALS(broker.closed, 1);
+
+    // reconnects right away, nacked and dropped messages are not published again
+    publish_event(output, 4);
+    ASSERT_EQUALS(handshake(0), 0);
+    ASSERT_EQUALS(broker.connects, 2);
+    ASSERT_EQUALS(wait_publish(), 4);
+
+    fprintf(stderr, "amqp:: backoff is kept until a message is confirmed\n");
+    send_method(1, CHANNEL_CLOSE, close, sizeof(close));
+    ASSERT_EQUALS(wait_frame(FRAME_METHOD, CHANNEL_CLOSE_OK, 2) != NULL, 1);
+    publish_event(output, 5);
+    // the second reconnect waits a second
+    poll_for(0.5);
+    ASSERT_EQUALS(broker.connects, 2);
+    ASSERT_EQUALS(handshake(0), 0);
+    ASSERT_EQUALS(broker.connects, 3);
+    ASSERT_EQUALS(wait_publish(), 5);
+    send_confirm(BASIC_ACK, 1);
+    poll_for(0.1);
+
+    data_output_free(output);
+    mg_mgr_free(&mgr);
+
+    fprintf(stderr, "amqp:: test (%u/%u) passed, (%u) failed.\n", passed, passed + failed, failed);
+
+    return failed > 0;
+}
@@ -2,6 +2,7 @@
  * Baseband Evaluation
  *
  * Functional and speed test for various baseband functions.
+ * Without an input file the SIMD kernels are checked against the scalar ones.
  *
  * Copyright (C) 2018 by Christian Zuckschwerdt <zany@triq.net>
  *
@@ -13,6 +14,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <fcntl.h>
 #include <sys/types.h>
 #ifdef _MSC_VER
@@ -70,6 +72,210 @@ static int write_buf(const char *filename, const void *buf, size_t nbyte)
     return ret;
 }
 
+#define SIMD_TEST_SAMPLES 1000003 // odd to exercise the scalar tail
+
+/// Run a kernel repeatedly for about 100 ms and return the throughput in samples/s.
+static double throughput(int kernel, uint8_t const *cu8_buf, int16_t const *cs16_buf, uint16_t *y16_buf, unsigned n)
+{
+    demodfm_state_t fm_state = {0};
+    unsigned runs = 0;
+    clock_t start = clock();
+    clock_t stop  = start;
+    while (stop - start < CLOCKS_PER_SEC / 10) {
+        switch (kernel) {
+        case 0: envelope_detect(cu8_buf, y16_buf, n); break;
+        case 1: magnitude_est_cu8(cu8_buf, y16_buf, n); break;
+        case 2: magnitude_est_cs16(cs16_buf, y16_buf, n); break;
+        case 3: baseband_demod_FM(&fm_state, cu8_buf, (int16_t *)y16_buf, n, 250000, 0.1f); break;
+        }
+        runs++;
+        stop = clock();
+    }
+    return (double)runs * n * CLOCKS_PER_SEC / (stop - start);
+}
+
+/// Check that the SIMD kernels are bit-exact with the scalar kernels, and report the throughput.
+static int simd_test(void)
+{
+    unsigned n = SIMD_TEST_SAMPLES;
+    uint8_t *cu8_buf   = malloc(sizeof(uint8_t) * 2 * n);
+    if (!cu8_buf) {
+        FATAL_MALLOC("simd_test()");
+    }
+    int16_t *cs16_buf  = malloc(sizeof(int16_t) * 2 * n);
+    if (!cs16_buf) {
+        FATAL_MALLOC("simd_test()");
+    }
+    uint16_t *ref_buf  = malloc(sizeof(uint16_t) * n * 4);
+    if (!ref_buf) {
+        FATAL_MALLOC("simd_test()");
+    }
+    uint16_t *y16_buf  = malloc(sizeof(uint16_t) * n * 4);
+    if (!y16_buf) {
+        FATAL_MALLOC("simd_test()");
+    }
+
+    // noise with full scale peaks, including the extreme values
+    srand(433);
+    for (unsigned i = 0; i < 2 * n; i++) {
+        int r = rand();
+        cu8_buf[i]  = (i / 4096) % 5 == 0 ? (r & 1) * 255 : (uint8_t)(r >> 3);
+        cs16_buf[i] = (i / 4096) % 5 == 0 ? (r & 1 ? 32767 : -32768) : (int16_t)(r >> 2);
+    }
+
+    int failed = 0;
+    for (int simd = BASEBAND_SIMD_NONE; simd < BASEBAND_SIMD_END; ++simd) {
+        if (!baseband_simd_supported(simd))
+            continue;
+        float ref_db[4];
+        float db[4];
+        demodfm_state_t fm_state = {0};
+
+        baseband_simd_select(BASEBAND_SIMD_NONE);
+        ref_db[0] = envelope_detect(cu8_buf, &ref_buf[0], n);
+        ref_db[1] = magnitude_est_cu8(cu8_buf, &ref_buf[n], n);
+        ref_db[2] = magnitude_est_cs16(cs16_buf, &ref_buf[2 * n], n);
+        // two calls to check the state handover
+        baseband_demod_FM(&fm_state, cu8_buf, (int16_t *)&ref_buf[3 * n], n / 2, 250000, 0.1f);
+        baseband_demod_FM(&fm_state, &cu8_buf[n / 2 * 2], (int16_t *)&ref_buf[3 * n + n / 2], n - n / 2, 250000, 0.1f);
+
+        baseband_simd_select(simd);
+        fm_state = (demodfm_state_t){0};
+        db[0] = envelope_detect(cu8_buf, &y16_buf[0], n);
+        db[1] = magnitude_est_cu8(cu8_buf, &y16_buf[n], n);
+        db[2] = magnitude_est_cs16(cs16_buf, &y16_buf[2 * n], n);
+        baseband_demod_FM(&fm_state, cu8_buf, (int16_t *)&y16_buf[3 * n], n / 2, 250000, 0.1f);
+        baseband_demod_FM(&fm_state, &cu8_buf[n / 2 * 2], (int16_t *)&y16_buf[3 * n + n / 2], n - n / 2, 250000, 0.1f);
+
+        char const *names[] = {"envelope_detect", "magnitude_est_cu8", "magnitude_est_cs16", "baseband_demod_FM"};
+        for (int k = 0; k < 4; ++k) {
+            for (unsigned i = 0; i < n; ++i) {
+                if (ref_buf[k * n + i] != y16_buf[k * n + i]) {
+                    fprintf(stderr, "%s %s: mismatch at %u: %u != %u\n", baseband_simd_name(simd), names[k], i, y16_buf[k * n + i], ref_buf[k * n + i]);
+                    failed++;
+                    break;
+                }
+            }
+            if (k < 3 && ref_db[k] != db[k]) {
+                fprintf(stderr, "%s %s: level mismatch: %f != %f\n", baseband_simd_name(simd), names[k], db[k], ref_db[k]);
+                failed++;
+            }
+        }
+
+        printf("%-6s", baseband_simd_name(simd));
+        for (int k = 0; k < 4; ++k) {
+            printf("  %s %7.1f", names[k], throughput(k, cu8_buf, cs16_buf, y16_buf, n) / 1e6);
+        }
+        printf("  Msamples/s\n");
+    }
+
+    free(cu8_buf);
+    free(cs16_buf);
+    free(ref_buf);
+    free(y16_buf);
+    return failed;
+}
+
+/// Check that the fused front end is bit-exact with the envelope, low pass, and FM passes.
+static int fused_test(void)
+{
+    unsigned n = SIMD_TEST_SAMPLES;
+    uint8_t *cu8_buf   = malloc(sizeof(uint8_t) * 2 * n);
+    if (!cu8_buf) {
+        FATAL_MALLOC("fused_test()");
+    }
+    int16_t *cs16_buf  = malloc(sizeof(int16_t) * 2 * n);
+    if (!cs16_buf) {
+        FATAL_MALLOC("fused_test()");
+    }
+    uint16_t *env_buf  = malloc(sizeof(uint16_t) * n);
+    if (!env_buf) {
+        FATAL_MALLOC("fused_test()");
+    }
+    int16_t *ref_buf   = malloc(sizeof(int16_t) * n * 2);
+    if (!ref_buf) {
+        FATAL_MALLOC("fused_test()");
+    }
+    int16_t *y_buf     = malloc(sizeof(int16_t) * n * 2);
+    if (!y_buf) {
+        FATAL_MALLOC("fused_test()");
+    }
+
+    // noise with full scale peaks, the envelope of 0/255 peaks overflows the filter state
+    srand(315);
+    for (unsigned i = 0; i < 2 * n; i++) {
+        int r = rand();
+        cu8_buf[i]  = (i / 3000) % 3 == 0 ? (r & 1) * 255 : (uint8_t)(r >> 3);
+        cs16_buf[i] = (i / 3000) % 3 == 0 ? (r & 1 ? 32767 : -32768) : (int16_t)(r >> 2);
+    }
+
+    int failed = 0;
+    char const *names[] = {"CU8 envelope", "CU8 magnitude", "CS16 magnitude"};
+    for (int mode = 0; mode < 3; ++mode) {
+        unsigned sample_size = mode == 2 ? 4 : 2;
+        uint8_t const *iq_buf = mode == 2 ? (uint8_t const *)cs16_buf : cu8_buf;
+        // two blocks to check the state handover, the first is not a multiple of the tile length
+        unsigned len[2] = {n / 2 + 1, n - n / 2 - 1};
+        float ref_db[2];
+        float db[2];
+
+        filter_state_t ref_lp   = {0};
+        demodfm_state_t ref_fm  = {0};
+        filter_state_t lp       = {0};
+        demodfm_state_t fm      = {0};
+        unsigned pos = 0;
+        for (int b = 0; b < 2; ++b) {
+            uint8_t const *x_buf = &iq_buf[pos * sample_size];
+            if (mode == 0)
+                ref_db[b] = envelope_detect(x_buf, env_buf, len[b]);
+            else if (mode == 1)
+                ref_db[b] = magnitude_est_cu8(x_buf, env_buf, len[b]);
+            else
+                ref_db[b] = magnitude_est_cs16((int16_t const *)x_buf, env_buf, len[b]);
+            baseband_low_pass_filter(&ref_lp, env_buf, &ref_buf[pos], len[b]);
+            if (mode == 2)
+                baseband_demod_FM_cs16(&ref_fm, (int16_t const *)x_buf, &ref_buf[n + pos], len[b], 250000, 0.1f);
+            else
+                baseband_demod_FM(&ref_fm, x_buf, &ref_buf[n + pos], len[b], 250000, 0.1f);
+
+            db[b] = baseband_demod_AM_FM(&lp, &fm, x_buf, sample_size, mode == 1, &y_buf[pos], &y_buf[n + pos], len[b], 250000, 0.1f);
+            pos += len[b];
+        }
+
+        for (unsigned i = 0; i < 2 * n; ++i) {
+            if (ref_buf[i] != y_buf[i]) {
+                fprintf(stderr, "fused %s: %s mismatch at %u: %d != %d\n", names[mode], i < n ? "AM" : "FM", i % n, y_buf[i], ref_buf[i]);
+                failed++;
+                break;
+            }
+        }
+        if (ref_db[0] != db[0] || ref_db[1] != db[1]) {
+            fprintf(stderr, "fused %s: level mismatch: %f != %f\n", names[mode], db[1], ref_db[1]);
+            failed++;
+        }
+        if (memcmp(&ref_lp, &lp, sizeof(lp)) || memcmp(&ref_fm, &fm, sizeof(fm))) {
+            fprintf(stderr, "fused %s: state mismatch\n", names[mode]);
+            failed++;
+        }
+
+        // without FM the envelope of the last block is left in the FM buffer
+        lp = (filter_state_t){0};
+        baseband_demod_AM_FM(&lp, NULL, iq_buf, sample_size, mode == 1, y_buf, &y_buf[n], len[0], 250000, 0.1f);
+        baseband_demod_AM_FM(&lp, NULL, &iq_buf[len[0] * sample_size], sample_size, mode == 1, &y_buf[len[0]], &y_buf[n], len[1], 250000, 0.1f);
+        if (memcmp(ref_buf, y_buf, sizeof(int16_t) * n) || memcmp(env_buf, &y_buf[n], sizeof(uint16_t) * len[1])) {
+            fprintf(stderr, "fused %s: mismatch without FM\n", names[mode]);
+            failed++;
+        }
+    }
+
+    free(cu8_buf);
+    free(cs16_buf);
+    free(env_buf);
+    free(ref_buf);
+    free(y_buf);
+    return failed;
+}
+
 int main(int argc, char *argv[])
 {
     baseband_init();
@@ -90,7 +296,8 @@ int main(int argc, char *argv[])
     demodfm_state_t fm_state;
 
     if (argc <= 1) {
-        return 1;
+        // no input file, check and benchmark the SIMD kernels
+        return !!(simd_test() + fused_test());
     }
     filename = argv[1];
 
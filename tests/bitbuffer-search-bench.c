@@ -0,0 +1,167 @@
+/** @file
+    Bitbuffer search benchmark.
+
+    Speed test for searching preambles in rows captured from real devices,
+    bitbuffer_search() vs. the former bit-at-a-time search, and one
+    bitbuffer_search_any() pass vs. a bitbuffer_search() per preamble.
+    All results are checked against the bit-at-a-time search.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+// gcc -O2 -Wall -I ../include -o bitbuffer-search-bench ../src/bitbuffer.c ../tests/bitbuffer-search-bench.c && ./bitbuffer-search-bench [ROUNDS]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bitbuffer.h"
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/// The former bitbuffer_search(), one bit at a time with backtracking.
+static unsigned search_ref(bitbuffer_t *bitbuffer, unsigned row, unsigned start,
+        const uint8_t *pattern, unsigned pattern_bits_len)
+{
+    uint8_t *bits = bitbuffer->bb[row];
+    unsigned len  = bitbuffer->bits_per_row[row];
+    unsigned ipos = start;
+    unsigned ppos = 0;
+
+    while (ipos < len && ppos < pattern_bits_len) {
+        if ((bits[ipos >> 3] >> (7 - (ipos & 7)) & 1) == (pattern[ppos >> 3] >> (7 - (ppos & 7)) & 1)) {
+            ppos++;
+            ipos++;
+            if (ppos == pattern_bits_len)
+                return ipos - pattern_bits_len;
+        }
+        else {
+            ipos -= ppos;
+            ipos++;
+            ppos = 0;
+        }
+    }
+    return len;
+}
+
+// rows from the code examples of the decoders
+static char const *const captures[] = {
+        "{112}c6880000e80000846d20fffbfb39",
+        "{124}25202ca00daa55aabbd2d2d2d2d200",
+        "{134}000002aabfac40051099858125e54015c0",
+        "{135}ffeaaaaabfac40051099858125e2403f00",
+        "{136}ffffffffffd62002884cc2c092f1201f80",
+        "{155}2ad455555516ea2918ae353b802b2d3f8029a12",
+        "{164}772c2eceaa4f3eddeaa4d7b2d2d2d2d2d20000000",
+        "{167}5555552caaaaacaad2aab532b3352b5532d32cccfe",
+        "{193}333333354ab32d334b2d4ab2caaab34cb34d554aacd2b2cd8",
+        "{205}55555555545ba924d23100058631ff99fe68b004e92dffe073f8",
+        "{211}555554b2aab4b2b552acb4d332acb4cab54caaacd4cad32b4b55e",
+        "{213}0000000000000000000000000c3adfe6b1f0f92eff258f4fe1f0f8",
+        "{273}2492b4a5a3ca10aaaaaaaaaaaaaa8bdacbaaaa2daaaaaaaaaa0000000000000000000",
+};
+
+// typical preambles and sync words
+static uint8_t const preamble_2dd4[]   = {0xaa, 0xaa, 0x2d, 0xd4};
+static uint8_t const preamble_545b[]   = {0x55, 0x54, 0x5b};
+static uint8_t const preamble_bfac[]   = {0xaa, 0xbf, 0xac};
+static uint8_t const preamble_d2[]     = {0xd2, 0xd2};
+static uint8_t const preamble_ffd6[]   = {0xff, 0xd6};
+static uint8_t const preamble_aa55[]   = {0xaa, 0x55, 0xaa};
+static uint8_t const preamble_3333[]   = {0x33, 0x33, 0x35};
+static uint8_t const preamble_long[]   = {0x55, 0x55, 0x55, 0x55, 0x54, 0x5b, 0xa9, 0x24, 0xd2, 0x31};
+
+static bitbuffer_pattern_t const preambles[] = {
+        {preamble_2dd4, 32},
+        {preamble_545b, 24},
+        {preamble_bfac, 24},
+        {preamble_d2, 16},
+        {preamble_ffd6, 15},
+        {preamble_aa55, 24},
+        {preamble_3333, 20},
+        {preamble_long, 80},
+};
+
+#define NUM_PREAMBLES (sizeof(preambles) / sizeof(*preambles))
+
+int main(int argc, char *argv[])
+{
+    int rounds = argc > 1 ? atoi(argv[1]) : 20000;
+    if (rounds <= 0)
+        rounds = 20000;
+
+    bitbuffer_t bits = {0};
+    unsigned num_rows = sizeof(captures) / sizeof(*captures);
+    for (unsigned i = 0; i < num_rows; ++i) {
+        bitbuffer_t row = {0};
+        bitbuffer_parse(&row, captures[i]);
+        if (i)
+            bitbuffer_add_row(&bits);
+        for (unsigned j = 0; j < row.bits_per_row[0]; ++j)
+            bitbuffer_add_bit(&bits, row.bb[0][j >> 3] >> (7 - (j & 7)) & 1);
+    }
+
+    // check every start position against the bit-at-a-time search
+    unsigned errors = 0;
+    for (unsigned row = 0; row < bits.num_rows; ++row) {
+        for (unsigned start = 0; start <= bits.bits_per_row[row] + 1u; ++start) {
+            unsigned best = bits.bits_per_row[row];
+            for (unsigned k = 0; k < NUM_PREAMBLES; ++k) {
+                unsigned ref = search_ref(&bits, row, start, preambles[k].bits, preambles[k].bits_len);
+                unsigned pos = bitbuffer_search(&bits, row, start, preambles[k].bits, preambles[k].bits_len);
+                if (pos != ref) {
+                    fprintf(stderr, "row %u start %u preamble %u: %u, expected %u\n", row, start, k, pos, ref);
+                    errors++;
+                }
+                if (ref < best)
+                    best = ref;
+            }
+            if (bitbuffer_search_any(&bits, row, start, preambles, NUM_PREAMBLES, NULL) != best) {
+                fprintf(stderr, "row %u start %u: search_any mismatch\n", row, start);
+                errors++;
+            }
+        }
+    }
+    if (errors) {
+        fprintf(stderr, "%u mismatches\n", errors);
+        return 1;
+    }
+
+    unsigned sink = 0;
+    unsigned searches = rounds * bits.num_rows * NUM_PREAMBLES;
+
+    double t0 = now_ns();
+    for (int r = 0; r < rounds; ++r)
+        for (unsigned row = 0; row < bits.num_rows; ++row)
+            for (unsigned k = 0; k < NUM_PREAMBLES; ++k)
+                sink += search_ref(&bits, row, 0, preambles[k].bits, preambles[k].bits_len);
+    double t1 = now_ns();
+    for (int r = 0; r < rounds; ++r)
+        for (unsigned row = 0; row < bits.num_rows; ++row)
+            for (unsigned k = 0; k < NUM_PREAMBLES; ++k)
+                sink += bitbuffer_search(&bits, row, 0, preambles[k].bits, preambles[k].bits_len);
+    double t2 = now_ns();
+    for (int r = 0; r < rounds; ++r)
+        for (unsigned row = 0; row < bits.num_rows; ++row)
+            sink += bitbuffer_search_any(&bits, row, 0, preambles, NUM_PREAMBLES, NULL);
+    double t3 = now_ns();
+
+    printf("%u rows, %u preambles, %d rounds\n", bits.num_rows, (unsigned)NUM_PREAMBLES, rounds);
+    printf("%-24s %10.1f ns/search\n", "bit-at-a-time", (t1 - t0) / searches);
+    printf("%-24s %10.1f ns/search\n", "bitbuffer_search", (t2 - t1) / searches);
+    printf("%-24s %10.1f ns/search\n", "bitbuffer_search_any", (t3 - t2) / searches);
+    printf("(%u)\n", sink);
+
+    return 0;
+}
@@ -54,4 +54,28 @@ int main(void)
     data_output_free(csv_output);
 
     data_free(data);
+
+    // elements appended and prepended share the memory of the event, keys are interned
+    data = data_int(NULL, "id", "ID", NULL, 1234);
+    data = data_str(data, "model", "Model", NULL, "Test");
+    for (int i = 0; i < 40; ++i) {
+        data = data_dbl(data, "temperature_F", "Temperature", "%.1f F", 32.0 + i);
+    }
+    data = data_prepend(data, data_str(NULL, "time", "", NULL, "2026-01-01 00:00:00"));
+    if (data->next->key != data_intern("id") || data_key_id(data->next->key) == data_key_id(data->key)) {
+        return 1;
+    }
+    data->next->key    = data_intern("id_renamed");
+    data->next->format = data_strcpy(data->next, "%d");
+    if (!data->next->key || !data->next->format) {
+        return 1;
+    }
+
+    json_output = data_output_json_create(0, stdout);
+    data_output_print(json_output, data_retain(data)); fprintf(stdout, "\n");
+    data_free(data); // released by the retain
+    data_output_print(json_output, data); fprintf(stdout, "\n");
+    data_output_free(json_output);
+
+    data_free(data);
 }
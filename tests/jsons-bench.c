@@ -0,0 +1,92 @@
+/** @file
+    JSON serialization benchmark.
+
+    Speed test for rendering an event for 1, 4, and 8 JSON outputs,
+    each output formatting the event vs. one shared rendering.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+// gcc -O2 -Wall -I ../include -o jsons-bench ../src/data.c ../src/abuf.c ../tests/jsons-bench.c && ./jsons-bench [EVENTS]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "data.h"
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static data_t *make_event(int i)
+{
+    /* clang-format off */
+    return data_make(
+            "time",             "",             DATA_STRING, "2026-01-01 12:34:56",
+            "model",            "",             DATA_STRING, "Acurite-5n1",
+            "message_type",     NULL,           DATA_INT,    56,
+            "id",               NULL,           DATA_INT,    i & 0xfff,
+            "channel",          NULL,           DATA_STRING, "A",
+            "sequence_num",     NULL,           DATA_INT,    i % 3,
+            "battery_ok",       "Battery",      DATA_INT,    1,
+            "wind_avg_km_h",    "Wind Speed",   DATA_FORMAT, "%.1f km/h", DATA_DOUBLE, 3.5 + (i % 10),
+            "temperature_F",    "Temperature",  DATA_FORMAT, "%.1f F",    DATA_DOUBLE, 68.5 + (i % 20),
+            "humidity",         "Humidity",     DATA_FORMAT, "%u %%",     DATA_INT,    40 + (i % 50),
+            "mic",              "Integrity",    DATA_STRING, "CHECKSUM",
+            NULL);
+    /* clang-format on */
+}
+
+int main(int argc, char *argv[])
+{
+    int events = argc > 1 ? atoi(argv[1]) : 200000;
+    if (events <= 0)
+        events = 200000;
+
+    unsigned outputs_list[] = {1, 4, 8};
+    size_t sink = 0;
+
+    printf("%8s %14s %14s\n", "outputs", "each ns/evt", "shared ns/evt");
+    for (unsigned k = 0; k < sizeof(outputs_list) / sizeof(*outputs_list); ++k) {
+        unsigned outputs = outputs_list[k];
+
+        // every output formats the event
+        double start = now_ns();
+        for (int i = 0; i < events; ++i) {
+            data_t *data = make_event(i);
+            for (unsigned j = 0; j < outputs; ++j) {
+                char buf[2048];
+                sink += data_print_jsons(data, buf, sizeof(buf));
+            }
+            data_free(data);
+        }
+        double each = (now_ns() - start) / events;
+
+        // one rendering shared by all outputs
+        start = now_ns();
+        for (int i = 0; i < events; ++i) {
+            data_t *data = make_event(i);
+            for (unsigned j = 0; j < outputs; ++j) {
+                size_t len = 0;
+                data_jsons(data, &len);
+                sink += len;
+            }
+            data_free(data);
+        }
+        double shared = (now_ns() - start) / events;
+
+        printf("%8u %14.0f %14.0f\n", outputs, each, shared);
+    }
+
+    return sink == 0; // keep the work observable
+}
@@ -0,0 +1,103 @@
+/** @file
+    MQTT output test.
+
+    The PUBLISH packets batched by the MQTT output must be byte-identical
+    to the packets of mg_mqtt_publish().
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "output_mqtt.h"
+#include "mongoose.h"
+
+#define ASSERT_EQUALS(a, b)                                                     \
+    do {                                                                        \
+        if ((a) == (b))                                                         \
+            ++passed;                                                           \
+        else {                                                                  \
+            ++failed;                                                           \
+            fprintf(stderr, "FAIL line %d: %ld <> %ld\n", __LINE__, (long)(a), (long)(b)); \
+        }                                                                       \
+    } while (0)
+
+static void null_handler(struct mg_connection *nc, int ev, void *ev_data)
+{
+    (void)nc;
+    (void)ev;
+    (void)ev_data;
+}
+
+int main(void)
+{
+    unsigned passed = 0;
+    unsigned failed = 0;
+
+    struct mg_mgr mgr;
+    mg_mgr_init(&mgr, NULL);
+    // an unconnected socket, mg_mqtt_publish() only appends to the send buffer
+    struct mg_connection *nc = mg_add_sock(&mgr, INVALID_SOCKET, null_handler);
+    mg_set_protocol_mqtt(nc);
+
+    char long_topic[300];
+    memset(long_topic, 't', sizeof(long_topic) - 1);
+    long_topic[sizeof(long_topic) - 1] = '\0';
+    char const *topics[] = {"", "rtl_433/host/events", long_topic};
+
+    // remaining lengths of one, two, and three bytes
+    size_t const lens[] = {0, 10, 100, 126, 127, 128, 200, 16383, 16384, 20000};
+    char *payload = malloc(20000);
+    if (!payload) {
+        fprintf(stderr, "mqtt:: malloc failed\n");
+        return 1;
+    }
+    for (size_t i = 0; i < 20000; ++i)
+        payload[i] = (char)('a' + i % 26);
+
+    int const flags[] = {MG_MQTT_QOS(0), MG_MQTT_QOS(0) | MG_MQTT_RETAIN, MG_MQTT_QOS(1), MG_MQTT_QOS(1) | MG_MQTT_RETAIN};
+
+    fprintf(stderr, "mqtt:: publish encoding\n");
+    struct mbuf out;
+    mbuf_init(&out, 0);
+    uint16_t message_id = 0x1234;
+    for (size_t t = 0; t < sizeof(topics) / sizeof(*topics); ++t) {
+        for (size_t l = 0; l < sizeof(lens) / sizeof(*lens); ++l) {
+            for (size_t f = 0; f < sizeof(flags) / sizeof(*flags); ++f) {
+                mbuf_clear(&out);
+                mbuf_remove(&nc->send_mbuf, nc->send_mbuf.len);
+                mqtt_publish_encode(&out, topics[t], message_id, flags[f], payload, lens[l]);
+                mg_mqtt_publish(nc, topics[t], message_id, flags[f], payload, lens[l]);
+                ASSERT_EQUALS(out.len, nc->send_mbuf.len);
+                ASSERT_EQUALS(memcmp(out.buf, nc->send_mbuf.buf, out.len < nc->send_mbuf.len ? out.len : nc->send_mbuf.len), 0);
+                message_id += 0x0101;
+            }
+        }
+    }
+
+    fprintf(stderr, "mqtt:: batched packets\n");
+    mbuf_clear(&out);
+    mbuf_remove(&nc->send_mbuf, nc->send_mbuf.len);
+    for (int i = 0; i < 3; ++i) {
+        mqtt_publish_encode(&out, topics[1], (uint16_t)(i + 1), MG_MQTT_QOS(1), payload, 200);
+        mg_mqtt_publish(nc, topics[1], (uint16_t)(i + 1), MG_MQTT_QOS(1), payload, 200);
+    }
+    ASSERT_EQUALS(out.len, nc->send_mbuf.len);
+    ASSERT_EQUALS(memcmp(out.buf, nc->send_mbuf.buf, out.len < nc->send_mbuf.len ? out.len : nc->send_mbuf.len), 0);
+
+    mbuf_free(&out);
+    free(payload);
+    mg_mgr_free(&mgr);
+
+    fprintf(stderr, "mqtt:: test (%u/%u) passed, (%u) failed.\n", passed, passed + failed, failed);
+
+    return failed > 0;
+}
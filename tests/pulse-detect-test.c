@@ -0,0 +1,157 @@
+/** @file
+    Pulse detector test.
+
+    FSK packages longer than PD_MAX_PULSES are returned in segments,
+    the last segment must end the package whatever its length.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "pulse_detect.h"
+#include "pulse_data.h"
+
+#define ASSERT_EQUALS(a, b)                                                     \
+    do {                                                                        \
+        if ((a) == (b))                                                         \
+            ++passed;                                                           \
+        else {                                                                  \
+            ++failed;                                                           \
+            fprintf(stderr, "FAIL line %d: %ld <> %ld\n", __LINE__, (long)(a), (long)(b)); \
+        }                                                                       \
+    } while (0)
+
+#define SAMP_RATE   250000
+#define BIT_SAMPLES 100    ///< samples per FSK pulse and per gap
+#define SILENCE     25000  ///< samples of noise around the telegrams
+#define CHUNK       131072 ///< samples per call, as the default buffer size
+#define MAX_TELEGRAMS 4
+
+/// A synthetic capture: FSK telegrams of alternating mark and space, separated by noise.
+typedef struct capture {
+    int16_t *am;
+    int16_t *fm;
+    unsigned len;
+} capture_t;
+
+static unsigned capture_make(capture_t *cap, unsigned const *telegrams, unsigned count)
+{
+    unsigned len = SILENCE;
+    for (unsigned t = 0; t < count; ++t)
+        len += telegrams[t] * 2 * BIT_SAMPLES + SILENCE;
+
+    cap->am = malloc(len * sizeof(*cap->am));
+    if (!cap->am)
+        return 0;
+    cap->fm = malloc(len * sizeof(*cap->fm));
+    if (!cap->fm) {
+        free(cap->am);
+        return 0;
+    }
+    cap->len = len;
+
+    unsigned pos = 0;
+    for (unsigned t = 0; t <= count; ++t) {
+        for (unsigned i = 0; i < SILENCE; ++i, ++pos) {
+            cap->am[pos] = 20 + (i * 7 % 13); // low noise
+            cap->fm[pos] = (int16_t)((i * 2654435761u >> 16) % 16000) - 8000;
+        }
+        if (t == count)
+            break;
+        for (unsigned n = 0; n < telegrams[t] * 2 * BIT_SAMPLES; ++n, ++pos) {
+            cap->am[pos] = 8000;
+            cap->fm[pos] = (n / BIT_SAMPLES) & 1 ? -6000 : 6000;
+        }
+    }
+    return len;
+}
+
+/// Run the detector over the capture, returns the number of telegrams and their pulse counts.
+static unsigned detect_telegrams(capture_t const *cap, unsigned fpdm, unsigned *pulse_counts, unsigned *segment_counts)
+{
+    pulse_detect_t *pulse_detect = pulse_detect_create();
+    if (!pulse_detect)
+        return 0;
+    pulse_detect_set_levels(pulse_detect, 0, 0.0f, -12.1442f, 9.0f, 0);
+
+    pulse_data_t *pulses     = calloc(1, sizeof(*pulses));
+    pulse_data_t *fsk_pulses = calloc(1, sizeof(*fsk_pulses));
+    if (!pulses || !fsk_pulses) {
+        free(pulses);
+        free(fsk_pulses);
+        pulse_detect_free(pulse_detect);
+        return 0;
+    }
+
+    unsigned telegrams = 0;
+    unsigned pulse_sum = 0;
+    for (unsigned pos = 0; pos < cap->len; pos += CHUNK) {
+        unsigned len = cap->len - pos < CHUNK ? cap->len - pos : CHUNK;
+        int package_type;
+        while ((package_type = pulse_detect_package(pulse_detect, &cap->am[pos], &cap->fm[pos], len, SAMP_RATE, pos, pulses, fsk_pulses, fpdm))) {
+            if (package_type != PULSE_DATA_FSK)
+                continue;
+            pulse_sum += fsk_pulses->num_pulses;
+            if (fsk_pulses->continued)
+                continue;
+            if (telegrams < MAX_TELEGRAMS) {
+                pulse_counts[telegrams]   = pulse_sum;
+                segment_counts[telegrams] = fsk_pulses->segment + 1;
+            }
+            telegrams += 1;
+            pulse_sum = 0;
+        }
+    }
+
+    free(pulses);
+    free(fsk_pulses);
+    pulse_detect_free(pulse_detect);
+    return telegrams;
+}
+
+int main(void)
+{
+    unsigned passed = 0;
+    unsigned failed = 0;
+
+    unsigned pulse_counts[MAX_TELEGRAMS];
+    unsigned segment_counts[MAX_TELEGRAMS];
+
+    for (unsigned fpdm = FSK_PULSE_DETECT_OLD; fpdm <= FSK_PULSE_DETECT_NEW; ++fpdm) {
+        fprintf(stderr, "pulse_detect:: %s FSK detector\n", fpdm == FSK_PULSE_DETECT_OLD ? "old" : "new");
+
+        // a short telegram after the long one must not be lost
+        for (unsigned k = 1; k <= 3; ++k) {
+            for (unsigned j = 1; j <= 17; ++j) {
+                unsigned telegrams[] = {(PD_MAX_PULSES - 1) * k + j, 500};
+                capture_t cap;
+                if (!capture_make(&cap, telegrams, 2)) {
+                    fprintf(stderr, "pulse_detect:: malloc failed\n");
+                    return 1;
+                }
+                unsigned found = detect_telegrams(&cap, fpdm, pulse_counts, segment_counts);
+                ASSERT_EQUALS(found, 2);
+                if (found == 2) {
+                    // the edges of the carrier add the same pulses to each telegram, segments must not add or lose any
+                    ASSERT_EQUALS(pulse_counts[0] - telegrams[0], pulse_counts[1] - telegrams[1]);
+                    ASSERT_EQUALS(segment_counts[0], k + 1);
+                    ASSERT_EQUALS(segment_counts[1], 1);
+                }
+                free(cap.am);
+                free(cap.fm);
+            }
+        }
+    }
+
+    fprintf(stderr, "pulse_detect:: test (%u/%u) passed, (%u) failed.\n", passed, passed + failed, failed);
+
+    return failed > 0;
+}
@@ -0,0 +1,155 @@
+/** @file
+    Pulse slicer benchmark.
+
+    Speed test for running all default decoders on the packages of a pulse
+    file (binary or .ook text), including a copy of each package, and the
+    time the slicers spent clearing a new bitbuffer for every candidate
+    decoder before they shared one.
+
+    Copyright (C) 2026 rtl_433 contributors
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+*/
+
+// cmake --build build --target slicer-bench && ./build/tests/slicer-bench FILE [ROUNDS]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rtl_433.h"
+#include "r_api.h"
+#include "r_private.h"
+#include "pulse_data.h"
+#include "pulse_file.h"
+#include "bitbuffer.h"
+#include "compat_time.h"
+#include "logger.h"
+
+static void consume_bits(bitbuffer_t *bits)
+{
+    (void)bits;
+}
+
+static void quiet_log(log_level_t level, char const *src, char const *msg, void *userdata)
+{
+    (void)level;
+    (void)src;
+    (void)msg;
+    (void)userdata;
+}
+
+// an opaque call keeps the compiler from eliding the cleared buffer
+static void (*volatile consume)(bitbuffer_t *) = consume_bits;
+
+/// The former per slice cost, a new zeroed bitbuffer on the stack.
+static void clear_new_bitbuffers(unsigned n)
+{
+    for (unsigned i = 0; i < n; ++i) {
+        bitbuffer_t bits = {0};
+        consume(&bits);
+    }
+}
+
+/// Read all packages of a pulse file, returns the number of packages.
+static unsigned load_packages(FILE *file, pulse_data_t **packages)
+{
+    unsigned num = 0;
+    unsigned cap = 0;
+    pulse_data_t *pd = NULL;
+
+    pulse_reader_t *reader = pulse_reader_open(file);
+    if (!reader)
+        rewind(file);
+    for (;;) {
+        if (num == cap) {
+            cap = cap ? cap * 2 : 64;
+            pulse_data_t *grown = realloc(pd, cap * sizeof(*pd));
+            if (!grown) {
+                fprintf(stderr, "realloc() failed\n");
+                exit(1);
+            }
+            pd = grown;
+        }
+        if (reader) {
+            if (pulse_reader_read(reader, &pd[num], NULL) <= 0)
+                break;
+        }
+        else {
+            pulse_data_load(file, &pd[num], 250000);
+            if (!pd[num].num_pulses)
+                break;
+        }
+        num++;
+    }
+    pulse_reader_free(reader);
+
+    *packages = pd;
+    return num;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s FILE [ROUNDS]\n", argv[0]);
+        return 1;
+    }
+    int rounds = argc > 2 ? atoi(argv[2]) : 10;
+    if (rounds <= 0)
+        rounds = 10;
+
+    // decoder output and logs are not part of the benchmark
+    r_logger_set_log_handler(quiet_log, NULL);
+
+    FILE *file = fopen(argv[1], "rb");
+    if (!file) {
+        fprintf(stderr, "Can't open \"%s\"\n", argv[1]);
+        return 1;
+    }
+    pulse_data_t *packages;
+    unsigned num_packages = load_packages(file, &packages);
+    fclose(file);
+    if (!num_packages) {
+        fprintf(stderr, "No packages in \"%s\"\n", argv[1]);
+        return 1;
+    }
+
+    r_cfg_t *cfg = r_create_cfg();
+    cfg->verbosity = LOG_CRITICAL;
+    register_all_protocols(cfg, 0);
+
+    unsigned candidates = 0;
+    unsigned events     = 0;
+    pulse_data_t pulse_data;
+
+    uint64_t t0 = time_monotonic_ns();
+    for (int r = 0; r < rounds; ++r) {
+        for (unsigned i = 0; i < num_packages; ++i) {
+            // the decoders may modify the package
+            pulse_data = packages[i];
+            if (pulse_data.fsk_f2_est)
+                events += run_fsk_demods(&cfg->demod->r_devs, &pulse_data);
+            else
+                events += run_ook_demods(&cfg->demod->r_devs, &pulse_data);
+            candidates += pulse_data.num_candidates;
+        }
+    }
+    uint64_t t1 = time_monotonic_ns();
+    clear_new_bitbuffers(candidates);
+    uint64_t t2 = time_monotonic_ns();
+
+    unsigned runs = rounds * num_packages;
+    printf("%u packages, %u decoders, %d rounds, %.1f candidates/package, %u events\n",
+            num_packages, (unsigned)cfg->demod->r_devs.len, rounds, (double)candidates / runs, events);
+    printf("%-28s %10.1f us/package\n", "all decoders", (double)(t1 - t0) / runs / 1000);
+    printf("%-28s %10.1f us/package\n", "new bitbuffer per candidate", (double)(t2 - t1) / runs / 1000);
+
+    r_free_cfg(cfg);
+    free(cfg);
+    free(packages);
+
+    return 0;
+}